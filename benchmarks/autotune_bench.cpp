@@ -0,0 +1,210 @@
+#include "autotune_engine.h"
+#include "audio_buffer.h"
+#include "batch_pitch_detector.h"
+#include "pitch_corrector.h"
+#include "pitch_detector.h"
+#include "quantizer.h"
+#include <benchmark/benchmark.h>
+#include <cmath>
+#include <vector>
+
+// Hot-path benchmarks. Every case reports samples per second (counting
+// every channel) as items_per_second and, for audio paths, the real-time
+// factor: seconds of audio processed per second of wall-clock time.
+// Run with --benchmark_out=results.json --benchmark_out_format=json to
+// record a release baseline.
+
+namespace {
+
+using namespace autotune;
+
+const std::vector<int64_t> kBufferSizes = {64, 128, 256, 512, 1024, 2048, 4096};
+const std::vector<int64_t> kSampleRates = {44100, 48000, 96000, 192000};
+const std::vector<int64_t> kChannelCounts = {1, 2};
+
+constexpr float kTestPitch = 220.0f;
+constexpr float kTargetPitch = 233.08f;
+
+/**
+ * @brief Planar sine test signal with owned storage
+ */
+struct TestBlock {
+    std::vector<Sample> storage;
+    std::vector<Sample*> channels;
+    
+    TestBlock(uint32_t frames, ChannelCount channel_count, SampleRate sample_rate)
+        : storage(static_cast<size_t>(frames) * channel_count), channels(channel_count) {
+        for (ChannelCount ch = 0; ch < channel_count; ++ch) {
+            channels[ch] = storage.data() + static_cast<size_t>(ch) * frames;
+            for (uint32_t i = 0; i < frames; ++i) {
+                channels[ch][i] = 0.5f * std::sin(2.0f * static_cast<float>(M_PI) * kTestPitch * i / sample_rate);
+            }
+        }
+    }
+    
+    AudioBlockView view() {
+        return AudioBlockView(channels.data(), static_cast<ChannelCount>(channels.size()),
+                              static_cast<uint32_t>(storage.size() / channels.size()));
+    }
+};
+
+/**
+ * @brief Report samples per second and the real-time factor
+ * @param state Benchmark state
+ * @param frames Frames processed per iteration
+ * @param channels Channels per frame
+ * @param sample_rate Sample rate of the processed audio
+ */
+void report_throughput(benchmark::State& state, uint32_t frames, ChannelCount channels, SampleRate sample_rate) {
+    double iterations = static_cast<double>(state.iterations());
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * frames * channels);
+    state.counters["realtime_factor"] = benchmark::Counter(iterations * frames / sample_rate,
+                                                           benchmark::Counter::kIsRate);
+}
+
+// Args: buffer size, sample rate
+void BM_PitchDetector_DetectPitch(benchmark::State& state) {
+    uint32_t buffer_size = static_cast<uint32_t>(state.range(0));
+    SampleRate sample_rate = static_cast<SampleRate>(state.range(1));
+    PitchDetector detector(sample_rate, buffer_size);
+    TestBlock block(buffer_size, 1, sample_rate);
+    
+    float confidence = 0.0f;
+    for (auto _ : state) {
+        float pitch = detector.detect_pitch(block.channels[0], buffer_size, confidence);
+        benchmark::DoNotOptimize(pitch);
+    }
+    report_throughput(state, buffer_size, 1, sample_rate);
+}
+BENCHMARK(BM_PitchDetector_DetectPitch)
+    ->ArgsProduct({kBufferSizes, kSampleRates})
+    ->ArgNames({"buffer", "rate"});
+
+// Args: voices, buffer size (48 kHz; compare against voices x BM_PitchDetector_DetectPitch)
+void BM_BatchPitchDetector_DetectPitch(benchmark::State& state) {
+    uint32_t voice_count = static_cast<uint32_t>(state.range(0));
+    uint32_t buffer_size = static_cast<uint32_t>(state.range(1));
+    const SampleRate sample_rate = 48000;
+    BatchPitchDetector detector(voice_count, sample_rate, buffer_size);
+    TestBlock block(buffer_size, 1, sample_rate);
+    std::vector<const Sample*> windows(voice_count, block.channels[0]);
+    std::vector<Sample> interleaved(static_cast<size_t>(buffer_size) * voice_count);
+    BatchPitchDetector::interleave(windows.data(), voice_count, buffer_size, interleaved.data());
+    std::vector<BatchPitchDetector::Estimate> estimates(voice_count);
+    
+    for (auto _ : state) {
+        detector.detect_pitch(interleaved.data(), buffer_size, estimates.data());
+        benchmark::DoNotOptimize(estimates.data());
+        benchmark::ClobberMemory();
+    }
+    report_throughput(state, buffer_size, voice_count, sample_rate);
+}
+BENCHMARK(BM_BatchPitchDetector_DetectPitch)
+    ->ArgsProduct({{4, 8, 16, 64}, {512, 1024, 2048}})
+    ->ArgNames({"voices", "buffer"});
+
+// Args: buffer size, sample rate, channels, backend (0 = PSOLA, 1 = phase vocoder)
+void BM_PitchCorrector_CorrectPitch(benchmark::State& state) {
+    uint32_t buffer_size = static_cast<uint32_t>(state.range(0));
+    SampleRate sample_rate = static_cast<SampleRate>(state.range(1));
+    ChannelCount channels = static_cast<ChannelCount>(state.range(2));
+    PitchCorrector corrector(sample_rate, buffer_size, channels);
+    corrector.set_backend(state.range(3) == 0 ? PitchCorrector::Backend::PSOLA
+                                              : PitchCorrector::Backend::PHASE_VOCODER);
+    TestBlock input(buffer_size, channels, sample_rate);
+    TestBlock output(buffer_size, channels, sample_rate);
+    AudioBlockView input_view = input.view();
+    AudioBlockView output_view = output.view();
+    
+    for (auto _ : state) {
+        ProcessingResult result = corrector.correct_pitch(input_view, output_view, kTestPitch, kTargetPitch);
+        benchmark::DoNotOptimize(result);
+        benchmark::ClobberMemory();
+    }
+    report_throughput(state, buffer_size, channels, sample_rate);
+}
+BENCHMARK(BM_PitchCorrector_CorrectPitch)
+    ->ArgsProduct({kBufferSizes, kSampleRates, kChannelCounts, {0, 1}})
+    ->ArgNames({"buffer", "rate", "channels", "backend"});
+
+// Args: scale
+void BM_Quantizer_QuantizePitch(benchmark::State& state) {
+    Quantizer quantizer(44100);
+    Quantizer::Scale scale = static_cast<Quantizer::Scale>(state.range(0));
+    
+    // One detection per entry, spread over the vocal range
+    std::vector<float> pitches(1024);
+    for (size_t i = 0; i < pitches.size(); ++i) {
+        pitches[i] = 80.0f * std::pow(2.0f, 4.0f * i / pitches.size());
+    }
+    
+    for (auto _ : state) {
+        for (float pitch : pitches) {
+            benchmark::DoNotOptimize(quantizer.quantize_pitch(pitch, scale, 60, 0.8f));
+        }
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) * pitches.size());
+}
+BENCHMARK(BM_Quantizer_QuantizePitch)
+    ->Arg(static_cast<int64_t>(Quantizer::Scale::CHROMATIC))
+    ->Arg(static_cast<int64_t>(Quantizer::Scale::MAJOR))
+    ->Arg(static_cast<int64_t>(Quantizer::Scale::BLUES))
+    ->ArgName("scale");
+
+// Args: buffer size, channels (sample rate does not affect ring traffic)
+void BM_AudioBuffer_WriteRead(benchmark::State& state) {
+    uint32_t buffer_size = static_cast<uint32_t>(state.range(0));
+    ChannelCount channels = static_cast<ChannelCount>(state.range(1));
+    AudioBuffer buffer(buffer_size * 4, channels);
+    TestBlock input(buffer_size, channels, 44100);
+    TestBlock output(buffer_size, channels, 44100);
+    AudioBlockView input_view = input.view();
+    AudioBlockView output_view = output.view();
+    
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(buffer.write(input_view));
+        benchmark::DoNotOptimize(buffer.read(output_view));
+        benchmark::ClobberMemory();
+    }
+    report_throughput(state, buffer_size, channels, 44100);
+}
+BENCHMARK(BM_AudioBuffer_WriteRead)
+    ->ArgsProduct({kBufferSizes, kChannelCounts})
+    ->ArgNames({"buffer", "channels"});
+
+// Args: buffer size, sample rate, channels
+void BM_AutotuneEngine_Process(benchmark::State& state) {
+    uint32_t buffer_size = static_cast<uint32_t>(state.range(0));
+    SampleRate sample_rate = static_cast<SampleRate>(state.range(1));
+    ChannelCount channels = static_cast<ChannelCount>(state.range(2));
+    AutotuneEngine engine(sample_rate, buffer_size, channels);
+    engine.set_mode(AutotuneEngine::Mode::FULL_AUTOTUNE);
+    engine.prepare(buffer_size);
+    TestBlock input(buffer_size, channels, sample_rate);
+    TestBlock output(buffer_size, channels, sample_rate);
+    AudioBlockView input_view = input.view();
+    AudioBlockView output_view = output.view();
+    
+    for (auto _ : state) {
+        ProcessingResult result = engine.process(input_view, output_view);
+        benchmark::DoNotOptimize(result);
+        benchmark::ClobberMemory();
+    }
+    report_throughput(state, buffer_size, channels, sample_rate);
+}
+BENCHMARK(BM_AutotuneEngine_Process)
+    ->ArgsProduct({kBufferSizes, kSampleRates, kChannelCounts})
+    ->ArgNames({"buffer", "rate", "channels"});
+
+} // namespace
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::AddCustomContext("autotune_version", AUTOTUNE_VERSION);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
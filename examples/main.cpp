@@ -3,6 +3,7 @@
 #include <vector>
 #include <cmath>
 #include <iomanip>
+#include <chrono>
 
 using namespace autotune;
 
@@ -265,6 +266,35 @@ void demo_realtime_simulation() {
     std::cout << "CPU usage: " << metrics.cpu_usage_percent << "%" << std::endl;
 }
 
+/**
+ * @brief Demonstrate multi-threaded offline rendering of a whole file
+ */
+void demo_offline_render() {
+    std::cout << "\n=== Offline Rendering ===" << std::endl;
+    
+    const SampleRate sample_rate = 44100;
+    AutotuneEngine engine(sample_rate, 512, 2);
+    engine.set_scale(Quantizer::Scale::MAJOR, 60);
+    engine.set_mode(AutotuneEngine::Mode::FULL_AUTOTUNE);
+    
+    // 30 seconds of slightly flat A4, interleaved stereo
+    std::vector<Sample> mono = generate_sine_wave(435.0f, sample_rate, 30.0f);
+    std::vector<float> input(mono.size() * 2);
+    for (size_t i = 0; i < mono.size(); ++i) {
+        input[i * 2] = mono[i];
+        input[i * 2 + 1] = mono[i];
+    }
+    std::vector<float> output(input.size());
+    
+    auto start = std::chrono::high_resolution_clock::now();
+    bool success = engine.render_offline(input.data(), mono.size(), output.data());
+    auto end = std::chrono::high_resolution_clock::now();
+    
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
+    std::cout << "Rendered 30 s of audio in " << duration.count() << " ms"
+              << (success ? " ✓" : " ✗") << std::endl;
+}
+
 int main() {
     std::cout << "AutoTune Real-Time Audio Engine Demo" << std::endl;
     std::cout << "====================================" << std::endl;
@@ -276,6 +306,7 @@ int main() {
         demo_pitch_correction();
         demo_scales_and_modes();
         demo_realtime_simulation();
+        demo_offline_render();
         
         std::cout << "\n=== Demo Complete ===" << std::endl;
         std::cout << "All demos completed successfully!" << std::endl;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "audio_types.h"
+#include <atomic>
 #include <vector>
 #include <memory>
 
@@ -8,12 +9,28 @@ namespace autotune {
 
 /**
  * @brief Real-time audio buffer for circular buffering and efficient processing
- * 
- * This class provides a lock-free circular buffer optimized for real-time audio
- * processing with minimal latency and memory allocations.
+ *
+ * This class provides a lock-free single-producer/single-consumer circular
+ * buffer optimized for real-time audio processing with minimal latency and
+ * memory allocations. One thread may write while another reads; positions
+ * are published with acquire/release ordering. Samples are stored planar
+ * (one contiguous ring per channel) in power-of-two storage so transfers
+ * are at most two memcpy segments per channel.
  */
 class AudioBuffer {
 public:
+    /**
+     * @brief Contiguous ring region, split in two where it wraps
+     *
+     * Returned by acquire_write() and peek_read() for in-place access.
+     */
+    struct Region {
+        AudioBlockView first;   // Starts at the current ring position
+        AudioBlockView second;  // Wrapped remainder (frame_count 0 if none)
+        
+        uint32_t frame_count() const { return first.frame_count + second.frame_count; }
+    };
+    
     /**
      * @brief Construct AudioBuffer
      * @param capacity Maximum number of audio frames to store
@@ -27,7 +44,7 @@ public:
     ~AudioBuffer();
     
     /**
-     * @brief Write audio frames to the buffer
+     * @brief Write audio frames to the buffer (producer thread)
      * @param frames Pointer to audio frames
      * @param frame_count Number of frames to write
      * @return Number of frames actually written
@@ -35,13 +52,53 @@ public:
     uint32_t write(const AudioFrame* frames, uint32_t frame_count);
     
     /**
-     * @brief Read audio frames from the buffer
+     * @brief Read audio frames from the buffer (consumer thread)
      * @param frames Pointer to output buffer
      * @param frame_count Number of frames to read
      * @return Number of frames actually read
      */
     uint32_t read(AudioFrame* frames, uint32_t frame_count);
     
+    /**
+     * @brief Write a planar audio block to the buffer (producer thread)
+     * @param block Source block (channels beyond channels() are ignored)
+     * @return Number of frames actually written
+     */
+    uint32_t write(const AudioBlockView& block);
+    
+    /**
+     * @brief Read audio frames into a planar block (consumer thread)
+     * @param block Destination block (up to block.frame_count frames)
+     * @return Number of frames actually read
+     */
+    uint32_t read(AudioBlockView& block);
+    
+    /**
+     * @brief Reserve writable ring space for in-place filling (producer thread)
+     * @param frame_count Requested frames (clamped to space())
+     * @return Writable region; valid until commit_write()
+     */
+    Region acquire_write(uint32_t frame_count);
+    
+    /**
+     * @brief Publish frames filled through acquire_write()
+     * @param frame_count Number of frames to publish (<= acquired size)
+     */
+    void commit_write(uint32_t frame_count);
+    
+    /**
+     * @brief Access readable frames in place (consumer thread)
+     * @param frame_count Requested frames (clamped to available())
+     * @return Readable region; valid until release_read()
+     */
+    Region peek_read(uint32_t frame_count);
+    
+    /**
+     * @brief Release frames consumed through peek_read()
+     * @param frame_count Number of frames to release (<= peeked size)
+     */
+    void release_read(uint32_t frame_count);
+    
     /**
      * @brief Get number of available frames for reading
      * @return Available frame count
@@ -67,7 +124,7 @@ public:
     bool full() const;
     
     /**
-     * @brief Clear the buffer
+     * @brief Clear the buffer (not thread-safe; call while neither side is active)
      */
     void clear();
     
@@ -84,11 +141,59 @@ public:
     ChannelCount channels() const { return channels_; }
 
 private:
-    std::vector<AudioFrame> buffer_;
+    static constexpr size_t kCacheLineSize = 64;
+    
+    std::vector<Sample> buffer_;        // Planar: channel ch starts at ch * storage_size_
     uint32_t capacity_;
+    uint32_t storage_size_;             // Power of two >= capacity_
+    uint32_t mask_;
     ChannelCount channels_;
-    volatile uint32_t read_pos_;
-    volatile uint32_t write_pos_;
+    
+    // Channel pointer tables backing the Region views (one set per side)
+    std::vector<Sample*> write_first_;
+    std::vector<Sample*> write_second_;
+    std::vector<Sample*> read_first_;
+    std::vector<Sample*> read_second_;
+    
+    // Free-running positions (wrap via mask_), one cache line per side.
+    // Each side keeps a cached copy of the other side's position so the
+    // shared line is only touched when the cached value runs out.
+    alignas(kCacheLineSize) std::atomic<uint32_t> write_pos_;
+    uint32_t cached_read_pos_;
+    alignas(kCacheLineSize) std::atomic<uint32_t> read_pos_;
+    uint32_t cached_write_pos_;
+    
+    /**
+     * @brief Get start of a channel's ring storage
+     * @param channel Channel index
+     * @return Pointer to the channel ring
+     */
+    Sample* channel_data(ChannelCount channel) { return buffer_.data() + static_cast<size_t>(channel) * storage_size_; }
+    
+    /**
+     * @brief Build a two-segment region starting at a ring position
+     * @param position Free-running start position
+     * @param frame_count Region size
+     * @param first First segment pointer table
+     * @param second Second segment pointer table
+     * @return Region view
+     */
+    Region make_region(uint32_t position, uint32_t frame_count,
+                       std::vector<Sample*>& first, std::vector<Sample*>& second);
+    
+    /**
+     * @brief Frames writable from the producer side
+     * @param wanted Frames the caller needs (refreshes the cached read position if short)
+     * @return Free space
+     */
+    uint32_t producer_space(uint32_t wanted);
+    
+    /**
+     * @brief Frames readable from the consumer side
+     * @param wanted Frames the caller needs (refreshes the cached write position if short)
+     * @return Available frames
+     */
+    uint32_t consumer_available(uint32_t wanted);
     
     // Non-copyable
     AudioBuffer(const AudioBuffer&) = delete;
@@ -0,0 +1,261 @@
+#pragma once
+
+#include "audio_types.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace autotune {
+
+/**
+ * @brief PCM sample encodings supported by the file reader and writer
+ */
+enum class SampleFormat {
+    INT16,      // 16-bit signed integer
+    INT24,      // 24-bit signed integer, packed in 3 bytes
+    FLOAT32     // 32-bit IEEE float
+};
+
+/**
+ * @brief Bytes per sample of a format
+ * @param format Sample format
+ * @return Size of one sample in bytes
+ */
+uint32_t bytes_per_sample(SampleFormat format);
+
+/**
+ * @brief Get printable sample format name
+ * @param format Sample format
+ * @return Name string ("int16", "int24" or "float32")
+ */
+const char* sample_format_name(SampleFormat format);
+
+/**
+ * @brief Parse a sample format name
+ * @param name Name as returned by sample_format_name()
+ * @param format Parsed format (unchanged on failure)
+ * @return True if the name is known
+ */
+bool parse_sample_format(const std::string& name, SampleFormat& format);
+
+/**
+ * @brief Layout of the sample data in an audio file
+ */
+struct AudioFileInfo {
+    SampleRate sample_rate = 44100;
+    ChannelCount channels = 1;
+    SampleFormat format = SampleFormat::INT16;
+    uint64_t frame_count = 0;       // Complete frames in the data chunk
+    uint64_t data_offset = 0;       // Byte offset of the first sample
+    bool rf64 = false;              // Sizes came from an RF64/BW64 ds64 chunk
+    
+    uint32_t frame_bytes() const { return bytes_per_sample(format) * channels; }
+};
+
+/**
+ * @brief Sequential reader for WAV, RF64/BW64 and headerless PCM files
+ *
+ * Regular files are memory-mapped and read front to back; pages that have
+ * been converted are released again, so memory use stays at a few chunks
+ * however large the file is. Files that cannot be mapped (special files,
+ * non-POSIX platforms) are read through a reusable chunk buffer instead.
+ * Samples are always returned as interleaved floats in [-1, 1).
+ *
+ * Sample data is assumed to be little-endian like the host (x86, ARM).
+ */
+class AudioFileReader {
+public:
+    AudioFileReader();
+    ~AudioFileReader();
+    
+    /**
+     * @brief Open a WAV or RF64/BW64 file
+     * @param path File path
+     * @return False if the file cannot be opened or is not supported (see get_error())
+     */
+    bool open(const std::string& path);
+    
+    /**
+     * @brief Open a headerless interleaved PCM file
+     * @param path File path
+     * @param sample_rate Sample rate of the data
+     * @param channels Channels per frame
+     * @param format Sample encoding
+     * @return False if the file cannot be opened (see get_error())
+     */
+    bool open_raw(const std::string& path, SampleRate sample_rate, ChannelCount channels, SampleFormat format);
+    
+    /**
+     * @brief Close the file (also done by the destructor)
+     */
+    void close();
+    
+    /**
+     * @brief Choose between memory mapping and buffered reads (before open())
+     * @param enabled True to memory-map regular files (default)
+     */
+    void set_memory_mapping(bool enabled) { memory_mapping_ = enabled; }
+    
+    /**
+     * @brief Check whether the open file is memory-mapped
+     * @return True if reads come straight from the mapping
+     */
+    bool is_memory_mapped() const { return map_ != nullptr; }
+    
+    bool is_open() const { return file_ != nullptr || map_ != nullptr; }
+    const AudioFileInfo& get_info() const { return info_; }
+    const std::string& get_error() const { return error_; }
+    
+    /**
+     * @brief Read and convert the next frames
+     * @param interleaved Output (frame_count * channels samples)
+     * @param frame_count Frames wanted
+     * @return Frames read (less than frame_count only at the end of the data)
+     */
+    size_t read(Sample* interleaved, size_t frame_count);
+    
+    /**
+     * @brief Get the read position
+     * @return Frames read so far
+     */
+    uint64_t get_position() const { return position_; }
+
+private:
+    AudioFileInfo info_;
+    std::string error_;
+    bool memory_mapping_;
+    
+    std::FILE* file_;                   // Buffered fallback
+    std::vector<uint8_t> chunk_;        // Raw bytes for one read() in the fallback
+    
+    const uint8_t* map_;                // Whole-file mapping (POSIX)
+    uint64_t map_size_;
+    uint64_t released_;                 // Mapping bytes already handed back to the OS
+    
+    uint64_t file_size_;
+    uint64_t position_;
+    
+    /**
+     * @brief Open the file and map it if possible
+     * @param path File path
+     * @return False if the file cannot be opened
+     */
+    bool open_file(const std::string& path);
+    
+    /**
+     * @brief Copy bytes at an absolute file offset (header parsing)
+     * @param offset Byte offset
+     * @param destination Output buffer
+     * @param size Number of bytes
+     * @return False if the file is shorter
+     */
+    bool read_at(uint64_t offset, void* destination, size_t size);
+    
+    /**
+     * @brief Parse the RIFF/RF64 chunk list into info_
+     * @return False if the header is invalid or unsupported
+     */
+    bool parse_header();
+    
+    /**
+     * @brief Check info_ and derive the frame count from the data size
+     * @param data_size Bytes of sample data
+     * @return False if the layout is unusable
+     */
+    bool finish_open(uint64_t data_size);
+    
+    /**
+     * @brief Let the OS drop mapped pages that have been consumed
+     * @param offset Byte offset up to which the mapping has been read
+     */
+    void release_consumed(uint64_t offset);
+    
+    bool fail(const std::string& message);
+    
+    // Non-copyable
+    AudioFileReader(const AudioFileReader&) = delete;
+    AudioFileReader& operator=(const AudioFileReader&) = delete;
+};
+
+/**
+ * @brief Streaming writer for WAV and headerless PCM files
+ *
+ * Samples are converted chunk by chunk and appended, so the output is never
+ * held in memory. A WAV header is written up front with placeholder sizes
+ * and a reserved JUNK chunk; close() fills in the sizes and, when the data
+ * outgrew the 4 GB RIFF limit, turns the file into RF64 in place.
+ */
+class AudioFileWriter {
+public:
+    /**
+     * @brief Output containers
+     */
+    enum class Container {
+        WAV,        // RIFF/WAVE, promoted to RF64 past 4 GB
+        RAW         // Headerless interleaved samples
+    };
+    
+    AudioFileWriter();
+    ~AudioFileWriter();
+    
+    /**
+     * @brief Create (or truncate) an output file
+     * @param path File path
+     * @param sample_rate Sample rate of the data
+     * @param channels Channels per frame
+     * @param format Sample encoding
+     * @param container Output container
+     * @return False if the file cannot be created (see get_error())
+     */
+    bool open(const std::string& path, SampleRate sample_rate, ChannelCount channels,
+              SampleFormat format, Container container = Container::WAV);
+    
+    /**
+     * @brief Convert and append frames
+     * @param interleaved Input (frame_count * channels samples)
+     * @param frame_count Number of frames
+     * @return False on a write error (see get_error())
+     */
+    bool write(const Sample* interleaved, size_t frame_count);
+    
+    /**
+     * @brief Finalize the header and close the file
+     * @return False if finalizing failed (also runs from the destructor)
+     */
+    bool close();
+    
+    bool is_open() const { return file_ != nullptr; }
+    const AudioFileInfo& get_info() const { return info_; }
+    const std::string& get_error() const { return error_; }
+    uint64_t get_frames_written() const { return info_.frame_count; }
+    
+    /**
+     * @brief Largest RIFF chunk size that still fits a plain WAV header
+     * @return Byte limit past which close() writes RF64
+     */
+    uint64_t get_riff_limit() const { return riff_limit_; }
+    
+    /**
+     * @brief Lower the RIFF limit (testing the RF64 path without 4 GB of data)
+     * @param limit RIFF chunk size past which close() writes RF64
+     */
+    void set_riff_limit(uint64_t limit) { riff_limit_ = limit; }
+
+private:
+    AudioFileInfo info_;
+    Container container_;
+    std::string error_;
+    std::FILE* file_;
+    std::vector<uint8_t> chunk_;        // Converted bytes for one write()
+    uint64_t riff_limit_;
+    
+    bool write_header();
+    bool finalize_header();
+    bool fail(const std::string& message);
+    
+    // Non-copyable
+    AudioFileWriter(const AudioFileWriter&) = delete;
+    AudioFileWriter& operator=(const AudioFileWriter&) = delete;
+};
+
+} // namespace autotune
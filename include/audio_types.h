@@ -23,6 +23,39 @@ struct AudioFrame {
     ChannelCount size() const { return static_cast<ChannelCount>(channels.size()); }
 };
 
+// Non-owning planar (structure-of-arrays) view of an audio block.
+// Each channel is one contiguous run of frame_count samples, so host
+// buffers can be wrapped without copies or allocations.
+struct AudioBlockView {
+    Sample* const* channels;
+    ChannelCount channel_count;
+    uint32_t frame_count;
+
+    AudioBlockView() : channels(nullptr), channel_count(0), frame_count(0) {}
+
+    AudioBlockView(Sample* const* channel_data, ChannelCount channel_count, uint32_t frame_count)
+        : channels(channel_data), channel_count(channel_count), frame_count(frame_count) {}
+
+    // Read-only source view (the engine never writes through input views)
+    AudioBlockView(const Sample* const* channel_data, ChannelCount channel_count, uint32_t frame_count)
+        : channels(const_cast<Sample* const*>(channel_data)),
+          channel_count(channel_count), frame_count(frame_count) {}
+
+    Sample* channel(ChannelCount ch) const { return channels[ch]; }
+    Sample& operator()(ChannelCount ch, uint32_t frame) const { return channels[ch][frame]; }
+
+    bool valid() const { return channels != nullptr && channel_count > 0; }
+
+    // Sub-range view; table receives channel_count offset pointers and must
+    // outlive the returned view
+    AudioBlockView slice(uint32_t offset, uint32_t count, Sample** table) const {
+        for (ChannelCount ch = 0; ch < channel_count; ++ch) {
+            table[ch] = channels[ch] + offset;
+        }
+        return AudioBlockView(table, channel_count, count);
+    }
+};
+
 // Musical note representation
 struct Note {
     float frequency;    // Hz
@@ -42,6 +75,7 @@ struct ProcessingParams {
     float release_time = 0.1f;     // Seconds
     bool enable_quantization = true;
     float quantize_strength = 0.8f;
+    float retune_time = 0.05f;     // Seconds per note transition when planning ahead (0 = instant)
 };
 
 // Audio processing result
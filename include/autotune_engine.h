@@ -5,7 +5,13 @@
 #include "pitch_detector.h"
 #include "pitch_corrector.h"
 #include "quantizer.h"
+#include "parameter_mailbox.h"
+#include "performance_monitor.h"
+#include "pitch_track.h"
+#include "pitch_planner.h"
+#include "rhythm_quantizer.h"
 #include <memory>
+#include <mutex>
 #include <vector>
 
 namespace autotune {
@@ -16,6 +22,14 @@ namespace autotune {
  * This is the primary interface for the real-time audio processing engine.
  * It combines pitch detection, correction, and quantization into a single
  * easy-to-use class optimized for low-latency performance.
+ * 
+ * Parameters, mode and scale may be changed from any control thread while
+ * another thread calls process(): setters publish a snapshot through a
+ * lock-free mailbox that process() picks up at the start of the next block,
+ * and the correction strength then ramps there per sample instead of
+ * stepping. Setters only contend with each other, never with process().
+ * The remaining setters reconfigure components directly and must not race
+ * with process().
  */
 class AutotuneEngine {
 public:
@@ -24,11 +38,20 @@ public:
      */
     enum class Mode {
         PITCH_CORRECTION,   // Only pitch correction
-        QUANTIZATION,       // Only quantization
-        FULL_AUTOTUNE,     // Both pitch correction and quantization
+        QUANTIZATION,       // Only rhythmic quantization: onsets slipped onto the tempo grid
+        FULL_AUTOTUNE,     // Both: pitch correction, then onsets of the corrected audio slipped
         BYPASS             // Pass-through mode
     };
     
+    /**
+     * @brief Latency/quality trade-off presets (see set_latency_profile)
+     */
+    enum class LatencyProfile {
+        LIVE,       // Shortest delay for monitoring: high pitch floor, decimated analysis
+        BALANCED,   // Construction defaults: PSOLA with an 80 Hz floor
+        STUDIO      // Mixdown quality: phase vocoder, dense analysis
+    };
+    
     /**
      * @brief Construct AutotuneEngine
      * @param sample_rate Audio sample rate
@@ -43,6 +66,34 @@ public:
      */
     ~AutotuneEngine();
     
+    /**
+     * @brief Preallocate all processing state for blocks up to max_block_size
+     *
+     * Call from a non-real-time thread before streaming starts. After this,
+     * process() makes no heap allocations for blocks of up to max_block_size
+     * frames. The constructor prepares for buffer_size frames.
+     * @param max_block_size Largest frame_count that will be passed to process()
+     */
+    void prepare(uint32_t max_block_size);
+    
+    /**
+     * @brief Get the block size the engine is prepared for
+     * @return Maximum allocation-free frame count
+     */
+    uint32_t get_max_block_size() const { return max_block_size_; }
+    
+    /**
+     * @brief Create an engine configured like this one (allocates; not for the audio thread)
+     *
+     * The clone gets this engine's sample rate, buffer size, channel count,
+     * prepared block size and configuration, and a fresh stream state: it
+     * sounds as this engine would after reset(). Window, FFT and filter
+     * tables are shared between engines, so a clone only allocates its own
+     * buffers.
+     * @return New engine (check is_initialized())
+     */
+    std::unique_ptr<AutotuneEngine> clone() const;
+    
     /**
      * @brief Process audio in real-time
      * @param input Input audio buffer
@@ -53,6 +104,39 @@ public:
     ProcessingResult process(const AudioFrame* input, AudioFrame* output, 
                            uint32_t frame_count);
     
+    /**
+     * @brief Process a planar audio block in real-time
+     * @param input Input block
+     * @param output Output block (same channel and frame count as input)
+     * @return Processing result with performance metrics
+     */
+    ProcessingResult process(const AudioBlockView& input, AudioBlockView& output);
+    
+    /**
+     * @brief Memory layout of contiguous sample buffers
+     */
+    enum class BufferLayout {
+        INTERLEAVED,    // frame_count frames of get_channels() samples each
+        PLANAR          // get_channels() channels of frame_count samples each
+    };
+    
+    /**
+     * @brief Process a contiguous buffer of any length
+     *
+     * Works directly on the caller's memory: planar buffers are processed
+     * through block views, interleaved ones are deinterleaved block by block
+     * into preallocated scratch. Blocks are at most get_max_block_size()
+     * frames, so nothing allocates however long the buffer is. Output may
+     * be the input buffer.
+     * @param input Input samples (frame_count * get_channels())
+     * @param output Output samples (same layout and size as input)
+     * @param frame_count Number of frames
+     * @param layout Layout of both buffers
+     * @return Result of the last block (success only if every block succeeded)
+     */
+    ProcessingResult process_buffer(const Sample* input, Sample* output, size_t frame_count,
+                                    BufferLayout layout = BufferLayout::INTERLEAVED);
+    
     /**
      * @brief Process single audio frame
      * @param input Input audio frame
@@ -62,7 +146,36 @@ public:
     ProcessingResult process_frame(const AudioFrame& input, AudioFrame& output);
     
     /**
-     * @brief Set processing parameters
+     * @brief Options for offline rendering
+     */
+    struct OfflineRenderOptions {
+        uint32_t segment_frames;    // Frames per segment (0 = 10 seconds)
+        uint32_t overlap_frames;    // Cross-fade length at segment seams (0 = 50 ms)
+        uint32_t thread_count;      // Worker threads (0 = one per core)
+        
+        OfflineRenderOptions() : segment_frames(0), overlap_frames(0), thread_count(0) {}
+    };
+    
+    /**
+     * @brief Render a whole interleaved file offline using all cores
+     *
+     * The file is split into overlapping segments that are processed in
+     * parallel, each by a fresh engine with this engine's configuration
+     * (independent detector/corrector state), and the seams are cross-faded.
+     * This engine's own processing state is not touched. The output does not
+     * depend on the thread count and is latency-compensated: out[i] lines up
+     * with interleaved[i] rather than trailing it like streaming output.
+     * @param interleaved Input samples (frames * channel count, interleaved)
+     * @param frames Number of frames
+     * @param out Output samples (same layout as input, must not alias it)
+     * @param options Segmentation and threading options
+     * @return True if every segment rendered successfully
+     */
+    bool render_offline(const float* interleaved, size_t frames, float* out,
+                        const OfflineRenderOptions& options = OfflineRenderOptions()) const;
+    
+    /**
+     * @brief Set processing parameters (takes effect at the next block)
      * @param params Processing parameters
      */
     void set_parameters(const ProcessingParams& params);
@@ -74,7 +187,7 @@ public:
     const ProcessingParams& get_parameters() const;
     
     /**
-     * @brief Set operating mode
+     * @brief Set operating mode (takes effect at the next block)
      * @param mode Engine operating mode
      */
     void set_mode(Mode mode);
@@ -83,21 +196,192 @@ public:
      * @brief Get current operating mode
      * @return Current mode
      */
-    Mode get_mode() const { return mode_; }
+    Mode get_mode() const { return settings_.mode; }
     
     /**
-     * @brief Set musical scale for quantization
+     * @brief Set musical scale for quantization (takes effect at the next block)
      * @param scale Musical scale
      * @param key_center Root note (MIDI note number)
      */
     void set_scale(Quantizer::Scale scale, int key_center = 60);
     
     /**
-     * @brief Set tempo for rhythmic quantization
+     * @brief Select the pitch detection algorithm (allocates; not for the audio thread)
+     * @param algorithm Detection algorithm (CUSTOM is ignored)
+     */
+    void set_detection_algorithm(PitchDetector::Algorithm algorithm);
+    
+    /**
+     * @brief Get the pitch detection algorithm
+     * @return Active detection algorithm
+     */
+    PitchDetector::Algorithm get_detection_algorithm() const { return pitch_detector_->get_algorithm(); }
+    
+    /**
+     * @brief Select the pitch shifting backend (resets the shifter)
+     * @param backend PSOLA for low cost, PHASE_VOCODER for large shifts with formant preservation
+     */
+    void set_correction_backend(PitchCorrector::Backend backend);
+    
+    /**
+     * @brief Get the pitch shifting backend
+     * @return Active backend
+     */
+    PitchCorrector::Backend get_correction_backend() const { return pitch_corrector_->get_backend(); }
+    
+    /**
+     * @brief Select the phase-vocoder overlap factor
+     * @param overlap 2 or 4 frames per frame length
+     */
+    void set_vocoder_overlap(uint32_t overlap);
+    
+    /**
+     * @brief Configure the sliding analysis window (allocates; not for the audio thread)
+     *
+     * Pitch is tracked over the last window_size input samples and updated
+     * every hop_size samples, independent of the host callback size; each
+     * callback is corrected in hop-aligned pieces. Defaults to buffer_size
+     * and buffer_size / 4.
+     * @param window_size Analysis window (clamped to buffer_size)
+     * @param hop_size Samples between pitch updates
+     */
+    void set_pitch_tracking(uint32_t window_size, uint32_t hop_size);
+    
+    uint32_t get_analysis_window() const { return pitch_detector_->get_window_size(); }
+    uint32_t get_analysis_hop() const { return pitch_detector_->get_hop_size(); }
+    
+    /**
+     * @brief Run pitch analysis at a reduced rate (allocates; not for the audio thread)
+     * @param analysis_rate Target analysis rate in Hz (0 = full rate; see PitchDetector::set_analysis_rate)
+     */
+    void set_analysis_rate(SampleRate analysis_rate);
+    
+    /**
+     * @brief Get the effective pitch analysis rate
+     * @return Analysis rate in Hz
+     */
+    SampleRate get_analysis_rate() const { return pitch_detector_->get_analysis_rate(); }
+    
+    /**
+     * @brief Apply a latency profile (allocates; not for the audio thread)
+     *
+     * Sets the detector window, hop, frequency floor and analysis rate and
+     * the corrector backend, overlap and pitch floor together:
+     * - LIVE: PSOLA with the floor raised to 150 Hz, or to the lowest pitch
+     *   two periods of which fit in buffer_size; window of two floor
+     *   periods, hop window / 4, analysis at 16 kHz. Pitches below the
+     *   floor pass through uncorrected.
+     * - BALANCED: the construction defaults (80 Hz floor, window
+     *   buffer_size, hop buffer_size / 4, full-rate analysis, PSOLA).
+     * - STUDIO: phase vocoder with overlap 4, hop buffer_size / 8.
+     * Individual setters called afterwards override single settings.
+     * @param profile Profile to apply
+     */
+    void set_latency_profile(LatencyProfile profile);
+    
+    /**
+     * @brief Get the most recently applied latency profile
+     * @return Latency profile
+     */
+    LatencyProfile get_latency_profile() const { return latency_profile_; }
+    
+    /**
+     * @brief Get the delay the engine adds between input and output
+     *
+     * The corrector's latency plus any lookahead in modes that correct,
+     * plus the rhythm delay line in modes that quantize, so 0 in BYPASS; the
+     * host's own block buffering comes on top. Follows the most recently
+     * set mode and profile.
+     * @return Latency in samples
+     */
+    uint32_t get_latency_samples() const;
+    
+    /**
+     * @brief Plan the pitch curve ahead (allocates; not for the audio thread)
+     *
+     * With a lookahead the input is delayed by that much before correction
+     * while pitch is still detected on the undelayed input, and a
+     * PitchPlanner turns the estimates ahead of the corrected audio into
+     * the target curve: estimates are aligned with the audio they were
+     * measured on, note boundaries are found before they are reached, and
+     * transitions take ProcessingParams::retune_time, centred on the
+     * boundary. The detector's one-pole smoothing is turned off meanwhile.
+     * The lookahead adds to get_latency_samples(); about 10 ms plus half
+     * the retune time plus 30 ms lets every boundary be planned in full.
+     * Must not race with process().
+     * @param milliseconds Lookahead (0 = correct reactively, the default)
+     */
+    void set_lookahead(float milliseconds);
+    
+    /**
+     * @brief Get the planning lookahead
+     * @return Lookahead in milliseconds
+     */
+    float get_lookahead() const { return lookahead_ms_; }
+    
+    /**
+     * @brief Get the planning lookahead in samples
+     * @return Samples the corrected audio trails pitch detection by
+     */
+    uint32_t get_lookahead_samples() const { return lookahead_; }
+    
+    /**
+     * @brief Set the silence gate (takes effect at the next block)
+     *
+     * Analysis hops quieter than the threshold, or noise-like ones such as
+     * breaths and fricatives, skip pitch detection and count as unvoiced;
+     * the gate has hysteresis and a hold time (see
+     * PitchDetector::set_gate_threshold()). Blocks that are unvoiced
+     * throughout also skip the shifter once its glide has settled (see
+     * PitchCorrector::bypass_block()), which PerformanceMetrics counts as
+     * skipped blocks.
+     * @param threshold_db Gate opening level in dBFS RMS (default -60; -infinity disables the gate)
+     */
+    void set_silence_gate(float threshold_db);
+    
+    /**
+     * @brief Get the silence gate opening level
+     * @return Level in dBFS RMS
+     */
+    float get_silence_gate() const { return settings_.silence_gate_db; }
+    
+    /**
+     * @brief Set tempo for rhythmic quantization (takes effect at the next block)
      * @param tempo Tempo in BPM
      */
     void set_tempo(float tempo);
     
+    /**
+     * @brief Set the time signature the beat of the grid follows (takes effect at the next block)
+     * @param time_signature Time signature (default FOUR_FOUR)
+     */
+    void set_time_signature(Quantizer::TimeSignature time_signature);
+    
+    /**
+     * @brief Get the time signature
+     * @return Time signature
+     */
+    Quantizer::TimeSignature get_time_signature() const { return settings_.time_signature; }
+    
+    /**
+     * @brief Set the grid QUANTIZATION and FULL_AUTOTUNE move onsets to (takes effect at the next block)
+     *
+     * Onsets found in the input (after correction in FULL_AUTOTUNE) are slipped towards the nearest position
+     * of the grid at the current tempo by ProcessingParams::quantize_strength,
+     * by at most RhythmQuantizer::get_max_slip(), through a delay line
+     * reported by get_latency_samples() (see RhythmQuantizer). The grid
+     * starts at the first frame processed after entering the mode or
+     * after reset().
+     * @param grid Grid resolution (default SIXTEENTH_NOTE)
+     */
+    void set_rhythm_grid(Quantizer::GridResolution grid);
+    
+    /**
+     * @brief Get the rhythmic quantization grid
+     * @return Grid resolution
+     */
+    Quantizer::GridResolution get_rhythm_grid() const { return settings_.grid; }
+    
     /**
      * @brief Enable/disable specific processing features
      * @param enable_pitch_correction Enable pitch correction
@@ -109,23 +393,75 @@ public:
                           bool enable_formant_preservation = true);
     
     /**
-     * @brief Get current performance metrics
-     * @return Performance metrics
+     * @brief Processing time statistics of process() calls
      */
     struct PerformanceMetrics {
-        float average_latency_ms;
-        float cpu_usage_percent;
-        uint32_t buffer_underruns;
-        uint32_t frames_processed;
+        float average_latency_ms;       // Mean processing time per callback
+        float p50_latency_ms;           // Percentiles are bucket edges (within 6.25%)
+        float p99_latency_ms;
+        float p999_latency_ms;
+        float max_latency_ms;
+        float cpu_usage_percent;        // Processing time relative to audio time
+        float detect_ms;                // Mean time per callback in each stage
+        float quantize_ms;
+        float correct_ms;
+        uint32_t deadline_misses;       // Callbacks slower than the audio they produced
+        uint32_t buffer_underruns;      // Same as deadline_misses (each one would underrun the device)
+        uint64_t callbacks;
+        uint64_t frames_processed;
+        uint64_t skipped_blocks;        // Callbacks that bypassed the shifter (unvoiced throughout)
+        float skipped_block_ratio;      // skipped_blocks / callbacks
         
-        PerformanceMetrics() : average_latency_ms(0.0f), cpu_usage_percent(0.0f),
-                              buffer_underruns(0), frames_processed(0) {}
+        PerformanceMetrics() : average_latency_ms(0.0f), p50_latency_ms(0.0f), p99_latency_ms(0.0f),
+                              p999_latency_ms(0.0f), max_latency_ms(0.0f), cpu_usage_percent(0.0f),
+                              detect_ms(0.0f), quantize_ms(0.0f), correct_ms(0.0f),
+                              deadline_misses(0), buffer_underruns(0), callbacks(0), frames_processed(0),
+                              skipped_blocks(0), skipped_block_ratio(0.0f) {}
     };
     
+    /**
+     * @brief Get current performance metrics
+     *
+     * Lock-free: safe to poll from a monitoring thread while another thread
+     * calls process().
+     * @return Performance metrics
+     */
     PerformanceMetrics get_performance_metrics() const;
     
     /**
-     * @brief Reset all processing state
+     * @brief Record every pitch estimate into a track (allocates; offline use)
+     *
+     * Clears the track, stores the detector settings in its key and appends
+     * one point per analysis hop from then on. Positions count frames from
+     * this call (or the next reset()). Must not race with process().
+     * @param track Track to fill (must outlive recording; nullptr stops recording)
+     */
+    void record_pitch_track(PitchTrack* track);
+    
+    /**
+     * @brief Follow a recorded track instead of detecting pitch
+     *
+     * While a track is set, process() skips pitch detection and applies the
+     * recorded estimates at their positions, so a re-render only repeats
+     * quantization and correction: reset(), set_pitch_track() and process
+     * the same audio the same way to reproduce the recorded render exactly
+     * with any scale, key or strength. Not used by render_offline(). Does
+     * not check the detector settings or content hash; compare the track's
+     * key with get_pitch_analysis_key() for that. Must not race with process().
+     * @param track Recorded track (must outlive use; nullptr returns to live detection)
+     * @return False if the track was recorded at another sample rate (live detection is kept)
+     */
+    bool set_pitch_track(const PitchTrack* track);
+    
+    /**
+     * @brief Describe the current detector settings as a track key
+     * @param content_hash Hash of the audio about to be analysed
+     * @return Key a track recorded now would carry
+     */
+    PitchTrack::AnalysisKey get_pitch_analysis_key(uint64_t content_hash = 0) const;
+    
+    /**
+     * @brief Reset all processing state (restarts pitch track recording and playback)
      */
     void reset();
     
@@ -135,12 +471,21 @@ public:
      */
     bool is_initialized() const { return initialized_; }
     
+    /**
+     * @brief Get channel count
+     * @return Number of audio channels
+     */
+    ChannelCount get_channels() const { return channels_; }
+    
     /**
      * @brief Get recommended buffer size for given sample rate
      * @param sample_rate Sample rate
+     * @param profile Latency profile the engine will run (LIVE halves the
+     *        block, STUDIO doubles it)
      * @return Recommended buffer size
      */
-    static uint32_t get_recommended_buffer_size(SampleRate sample_rate);
+    static uint32_t get_recommended_buffer_size(SampleRate sample_rate,
+                                                LatencyProfile profile = LatencyProfile::BALANCED);
 
 private:
     // Core components
@@ -149,31 +494,77 @@ private:
     std::unique_ptr<PitchDetector> pitch_detector_;
     std::unique_ptr<PitchCorrector> pitch_corrector_;
     std::unique_ptr<Quantizer> quantizer_;
+    std::unique_ptr<RhythmQuantizer> rhythm_quantizer_;
+    uint64_t rhythm_origin_ = 0;            // Grid position of the first frame after a restart
+    uint32_t rhythm_delay_ = 0;             // Correction latency the grid was shifted back by
+    
+    /**
+     * @brief Everything control threads can change while process() runs
+     */
+    struct Settings {
+        ProcessingParams params;
+        Mode mode = Mode::FULL_AUTOTUNE;
+        Quantizer::Scale scale = Quantizer::Scale::MAJOR;
+        int key_center = 60;
+        float silence_gate_db = -60.0f;
+        Quantizer::GridResolution grid = Quantizer::GridResolution::SIXTEENTH_NOTE;
+        float tempo = 120.0f;
+        Quantizer::TimeSignature time_signature = Quantizer::TimeSignature::FOUR_FOUR;
+    };
     
     // Configuration
     SampleRate sample_rate_;
     uint32_t buffer_size_;
     ChannelCount channels_;
-    Mode mode_;
-    ProcessingParams params_;
     bool initialized_;
     
+    // Control-thread settings and their hand-off to the audio thread
+    Settings settings_;                         // Latest settings, read by the getters
+    std::mutex settings_mutex_;                 // Serializes setters only
+    ParameterMailbox<Settings> settings_mailbox_;
+    Settings active_settings_;                  // Audio-thread copy, refreshed per block
+    SmoothedParameter correction_strength_;     // Per-sample ramp of active correction strength
+    bool streaming_;                            // Set by the first block; until then settings jump
+    
     // Processing state
-    std::vector<AudioFrame> processing_buffer_;
+    uint32_t max_block_size_;               // Frames the scratch below is sized for
     std::vector<float> mono_buffer_;
+    std::vector<Sample*> input_slice_;      // Channel table for hop-sized sub-blocks
+    std::vector<Sample> planar_buffer_;     // Deinterleaved frames for the frame API
+    std::vector<Sample*> planar_input_;
+    std::vector<Sample*> planar_output_;
+    std::vector<const Sample*> buffer_input_;   // Channel tables into process_buffer() memory
+    std::vector<Sample*> buffer_output_;
+    std::vector<PitchCorrector::PitchSegment> pitch_segments_;  // Pitch runs handed to correct_block()
+    std::vector<float> strength_curve_;     // Ramping correction strength per frame
     float current_pitch_;
     float target_pitch_;
     float confidence_;
     
+    // Pitch track recording and playback
+    PitchTrack* recorded_track_;
+    const PitchTrack* pitch_track_;
+    size_t pitch_track_index_;              // Next point of pitch_track_ to apply
+    uint64_t track_position_;               // Frames since recording/playback started
+    
+    // Lookahead planning (inactive when lookahead_ is 0)
+    float lookahead_ms_;
+    uint32_t lookahead_;
+    PitchPlanner planner_;
+    std::unique_ptr<AudioBuffer> lookahead_buffer_;     // Input delay line
+    std::vector<Sample> lookahead_scratch_;             // Delayed block handed to the corrector
+    std::vector<Sample*> lookahead_channels_;
+    
     // Performance monitoring
-    mutable PerformanceMetrics metrics_;
-    std::vector<float> latency_history_;
-    uint32_t performance_counter_;
+    PerformanceMonitor monitor_;
     
-    // Scale and quantization settings
-    Quantizer::Scale current_scale_;
-    int key_center_;
-    float tempo_;
+    LatencyProfile latency_profile_;
+    
+    // Processing chain specialized for the active mode, picked when the mode changes
+    using Pipeline = ProcessingResult (AutotuneEngine::*)(const AudioBlockView&, AudioBlockView&);
+    Pipeline pipeline_;                     // For blocks of channels_ channels
+    Pipeline fallback_pipeline_;            // For blocks of any other channel count
+    bool pass_through_;                     // The active chain leaves the audio unchanged
     
     /**
      * @brief Initialize all components
@@ -182,46 +573,184 @@ private:
     bool initialize_components();
     
     /**
-     * @brief Process audio with pitch correction
-     * @param input Input frames
-     * @param output Output frames
-     * @param frame_count Number of frames
+     * @brief Publish settings_ to the audio thread (settings_mutex_ held)
+     */
+    void publish_settings();
+    
+    /**
+     * @brief Pick up settings published since the last block (audio thread)
+     */
+    void apply_pending_settings();
+    
+    /**
+     * @brief Whether a mode runs the pitch corrector
+     * @param mode Processing mode
+     * @return True for PITCH_CORRECTION and FULL_AUTOTUNE
+     */
+    static constexpr bool corrects(Mode mode) {
+        return mode == Mode::PITCH_CORRECTION || mode == Mode::FULL_AUTOTUNE;
+    }
+    
+    /**
+     * @brief Whether a mode runs the rhythm quantizer
+     * @param mode Processing mode
+     * @return True for QUANTIZATION and FULL_AUTOTUNE
+     */
+    static constexpr bool quantizes(Mode mode) {
+        return mode == Mode::QUANTIZATION || mode == Mode::FULL_AUTOTUNE;
+    }
+    
+    /**
+     * @brief Delay of the corrected audio behind the input (corrector plus lookahead)
+     */
+    uint32_t correction_latency() const { return pitch_corrector_->get_latency_samples() + lookahead_; }
+    
+    /**
+     * @brief Restart the rhythm delay line with the grid at rhythm_origin_ (audio thread)
+     *
+     * In FULL_AUTOTUNE the rhythm quantizer hears the corrected audio, which
+     * trails the input by correction_latency(); its grid is shifted back by
+     * that much so it stays on the input's timeline.
+     */
+    void restart_rhythm();
+    
+    /**
+     * @brief Point pipeline_ and fallback_pipeline_ at the chain for the active mode
+     */
+    void select_pipeline();
+    
+    /**
+     * @brief Pick the channel-count specializations of one mode's chain
+     */
+    template <Mode M>
+    void select_pipeline_for();
+    
+    /**
+     * @brief Whole processing chain of one mode, with dead stages compiled out
+     *
+     * Stages run in place on the caller's block: detection reads the input,
+     * correction writes the output directly, and in FULL_AUTOTUNE the
+     * rhythm quantizer then slips onsets of the output in place, so no
+     * intermediate frames are copied. QUANTIZATION runs the rhythm
+     * quantizer alone.
+     * @tparam M Processing mode
+     * @tparam C Channel count of every block (0 = any)
+     * @param input Input block
+     * @param output Output block
      * @return Processing result
      */
-    ProcessingResult process_pitch_correction(const AudioFrame* input, 
-                                            AudioFrame* output, 
-                                            uint32_t frame_count);
+    template <Mode M, ChannelCount C>
+    ProcessingResult run_pipeline(const AudioBlockView& input, AudioBlockView& output);
     
     /**
-     * @brief Process audio with quantization
-     * @param input Input frames
-     * @param output Output frames
-     * @param frame_count Number of frames
+     * @brief Process a planar block with pitch correction
+     * @tparam C Channel count of the block (0 = any)
+     * @param input Input block
+     * @param output Output block
      * @return Processing result
      */
-    ProcessingResult process_quantization(const AudioFrame* input, 
-                                        AudioFrame* output, 
-                                        uint32_t frame_count);
+    template <ChannelCount C>
+    ProcessingResult process_pitch_correction(const AudioBlockView& input, AudioBlockView& output);
     
     /**
-     * @brief Convert stereo to mono for pitch detection
-     * @param input Input frames
+     * @brief Process a planar block with rhythmic quantization
+     * @param input Input block
+     * @param output Output block
+     * @return Processing result
+     */
+    ProcessingResult process_rhythm(const AudioBlockView& input, AudioBlockView& output);
+    
+    /**
+     * @brief Size the lookahead delay line and planner for the current settings (allocates)
+     */
+    void configure_lookahead();
+    
+    /**
+     * @brief Fill the delay line with silence and clear the planner
+     */
+    void prime_lookahead();
+    
+    /**
+     * @brief Pass a block through the lookahead delay line
+     * @param input Undelayed input (at most get_channels() channels)
+     * @return Channel table of the input from lookahead_ samples earlier
+     */
+    const Sample* const* delay_input(const AudioBlockView& input);
+    
+    /**
+     * @brief Mono signal of a block for pitch detection
+     * @tparam C Channel count of the block (0 = any)
+     * @param input Input block (at most buffer_size frames)
+     * @return The only channel for mono blocks, otherwise the downmix in mono_buffer_
+     */
+    template <ChannelCount C>
+    const Sample* mono_input(const AudioBlockView& input);
+    
+    /**
+     * @brief Feed mono samples to the pitch tracker and pick up new estimates
+     * @param samples Mono samples
+     * @param sample_count Number of samples (at most one hop)
+     */
+    void track_pitch(const Sample* samples, uint32_t sample_count);
+    
+    /**
+     * @brief Apply pitch track points due at the current position
+     * @return Frames until the next point
+     */
+    uint32_t follow_pitch_track();
+    
+    /**
+     * @brief Average every channel of a planar block into mono_buffer_ for pitch detection
+     * @param input Input block
+     */
+    void convert_to_mono(const AudioBlockView& input);
+    
+    /**
+     * @brief Copy frames sample by sample without reallocating frame storage
+     * @param input Source frames
+     * @param output Destination frames
      * @param frame_count Number of frames
      */
-    void convert_to_mono(const AudioFrame* input, uint32_t frame_count);
+    static void copy_frames(const AudioFrame* input, AudioFrame* output, uint32_t frame_count);
+    
+    /**
+     * @brief Copy a planar block channel by channel (no-op when aliased)
+     * @param input Source block
+     * @param output Destination block
+     */
+    static void copy_block(const AudioBlockView& input, AudioBlockView& output);
     
     /**
-     * @brief Update performance metrics
-     * @param processing_time Processing time in seconds
+     * @brief Copy parameters, mode, scale, tempo and features to another engine
+     * @param target Engine to configure
      */
-    void update_performance_metrics(float processing_time);
+    void copy_configuration(AutotuneEngine& target) const;
+    
+    /**
+     * @brief Render one offline segment block by block, compensating the processing latency
+     * @param input Interleaved input from the start of the segment
+     * @param input_frames Input frames available (beyond the segment; missing frames read as silence)
+     * @param output Interleaved output of the segment
+     * @param frames Segment length in frames
+     * @param position Frame the segment starts at in the whole input (places the rhythm grid)
+     * @return True if every block processed successfully
+     */
+    bool render_segment(const float* input, size_t input_frames, float* output, size_t frames,
+                        size_t position) const;
     
     /**
      * @brief Calculate target pitch based on quantization
      * @param detected_pitch Current detected pitch
+     * @param strength Quantize strength (1 = the scale note itself)
      * @return Target pitch for correction
      */
-    float calculate_target_pitch(float detected_pitch);
+    float calculate_target_pitch(float detected_pitch, float strength);
+    
+    /**
+     * @brief Take a new estimate into the correction state
+     * @param position Frame the estimate applies from
+     */
+    void apply_estimate(uint64_t position);
     
     // Non-copyable
     AutotuneEngine(const AutotuneEngine&) = delete;
@@ -0,0 +1,211 @@
+#pragma once
+
+#include "audio_types.h"
+#include "fft.h"
+#include "pitch_estimator.h"
+#include <memory>
+#include <vector>
+
+namespace autotune {
+
+/**
+ * @brief Pitch detection for many voices at once
+ *
+ * Runs the windowed autocorrelation detector of PitchDetector over several
+ * voices that share a sample rate and window size. The windows are laid out
+ * lane-interleaved (sample i of voice v at i * voice_count + v), so each
+ * vector instruction of the windowing, correlation and peak-picking loops
+ * covers 4, 8 or 16 voices instead of a few samples of one short window.
+ *
+ * The FFT method runs one radix-2 transform over all voices, with every
+ * butterfly applied to a whole row of lanes; two voices share each complex
+ * lane (one in the real, one in the imaginary part), so the voices cost one
+ * forward and one inverse transform per pair. The DIRECT method sums only
+ * the lags the frequency range can produce, which pays off for short
+ * windows and narrow ranges.
+ *
+ * Thresholding, range validation and smoothing match PitchDetector with the
+ * same autocorrelation method; each voice keeps its own smoothing state.
+ * All buffers are allocated in the constructor, so detect_pitch() is safe on
+ * the audio thread.
+ */
+class BatchPitchDetector {
+public:
+    /**
+     * @brief Autocorrelation algorithms
+     */
+    using AutocorrelationMethod = AutocorrelationEstimator::Method;
+
+    /**
+     * @brief Detection result of one voice
+     */
+    struct Estimate {
+        float pitch = 0.0f;         // Hz (0.0 if no pitch detected)
+        float confidence = 0.0f;    // 0.0 - 1.0
+    };
+
+    /**
+     * @brief Construct BatchPitchDetector
+     * @param voice_count Number of voices detected per call
+     * @param sample_rate Audio sample rate shared by all voices
+     * @param buffer_size Longest window per voice
+     */
+    BatchPitchDetector(uint32_t voice_count, SampleRate sample_rate, uint32_t buffer_size = 512);
+
+    /**
+     * @brief Destructor
+     */
+    ~BatchPitchDetector();
+
+    /**
+     * @brief Detect the pitch of every voice from lane-interleaved windows
+     * @param interleaved sample_count * voice_count samples
+     * @param sample_count Samples per voice (<= buffer_size)
+     * @param estimates Output, one per voice
+     */
+    void detect_pitch(const Sample* interleaved, uint32_t sample_count, Estimate* estimates);
+
+    /**
+     * @brief Detect the pitch of every voice from separate mono windows
+     * @param windows One window pointer per voice
+     * @param sample_count Samples per voice (<= buffer_size)
+     * @param estimates Output, one per voice
+     */
+    void detect_pitch(const Sample* const* windows, uint32_t sample_count, Estimate* estimates);
+
+    /**
+     * @brief Lay out separate mono windows lane-interleaved
+     * @param windows One window pointer per voice
+     * @param voice_count Number of voices
+     * @param sample_count Samples per voice
+     * @param output sample_count * voice_count samples
+     */
+    static void interleave(const Sample* const* windows, uint32_t voice_count,
+                           uint32_t sample_count, Sample* output);
+
+    /**
+     * @brief Set minimum detectable frequency (all voices)
+     * @param min_freq Minimum frequency in Hz
+     */
+    void set_min_frequency(float min_freq);
+
+    /**
+     * @brief Set maximum detectable frequency (all voices)
+     * @param max_freq Maximum frequency in Hz
+     */
+    void set_max_frequency(float max_freq);
+
+    /**
+     * @brief Set confidence threshold for pitch detection
+     * @param threshold Minimum confidence (0.0 - 1.0)
+     */
+    void set_confidence_threshold(float threshold);
+
+    /**
+     * @brief Select autocorrelation algorithm
+     * @param method Autocorrelation method (default FFT)
+     */
+    void set_autocorrelation_method(AutocorrelationMethod method) { method_ = method; }
+
+    /**
+     * @brief Set the one-pole smoothing of successive detections per voice
+     * @param factor Weight of the previous estimate (0 = none, clamped below 1)
+     */
+    void set_smoothing(float factor);
+
+    /**
+     * @brief Get current settings
+     */
+    uint32_t get_voice_count() const { return voice_count_; }
+    uint32_t get_buffer_size() const { return buffer_size_; }
+    float get_min_frequency() const { return min_frequency_; }
+    float get_max_frequency() const { return max_frequency_; }
+    float get_confidence_threshold() const { return confidence_threshold_; }
+    float get_smoothing() const { return pitch_smoothing_factor_; }
+    AutocorrelationMethod get_autocorrelation_method() const { return method_; }
+
+    /**
+     * @brief Reset the smoothing state of every voice
+     */
+    void reset();
+
+private:
+    uint32_t voice_count_;
+    SampleRate sample_rate_;
+    uint32_t buffer_size_;
+    float min_frequency_;
+    float max_frequency_;
+    float confidence_threshold_;
+    float pitch_smoothing_factor_;
+    AutocorrelationMethod method_;
+
+    // Hanning window shared with AutocorrelationEstimator, fetched again
+    // only when the window length changes
+    std::shared_ptr<const std::vector<float>> window_;
+
+    // Lane-interleaved working buffers
+    std::vector<Sample> interleaved_buffer_;    // detect_pitch() from separate windows
+    std::vector<Sample> windowed_buffer_;
+    std::vector<float> autocorr_;               // r(lag) of voice v at lag * voice_count + v
+
+    /**
+     * @brief Twiddle and bit-reversal tables of one transform size
+     */
+    struct FftTables {
+        std::vector<FFT::Complex> twiddles;
+        std::vector<uint32_t> bit_reverse;
+    };
+
+    // Lane FFT state (zero-padded to >= 2 * buffer_size). Row i of each part
+    // holds fft_lanes_ values: the first half of the voices in the real part,
+    // the rest in the imaginary part, padded to whole vectors.
+    uint32_t fft_size_;
+    uint32_t fft_lanes_;
+    std::shared_ptr<const FftTables> fft_tables_;
+    std::vector<float> fft_real_;               // Windows, then their spectra
+    std::vector<float> fft_imag_;
+    std::vector<float> power_real_;             // Power spectra, then autocorrelations
+    std::vector<float> power_imag_;
+
+    // Per-voice peak search and smoothing
+    std::vector<uint32_t> peak_lags_;
+    std::vector<float> peak_values_;
+    std::vector<float> previous_pitch_;
+
+    /**
+     * @brief Fill autocorr_ with the direct lag sum over the search range
+     * @param sample_count Samples per voice
+     * @param min_lag First lag needed besides zero
+     * @param last_lag Last lag needed
+     */
+    void compute_direct(uint32_t sample_count, uint32_t min_lag, uint32_t last_lag);
+
+    /**
+     * @brief Fill autocorr_ via the power spectra of the lane FFT
+     * @param sample_count Samples per voice
+     * @param last_lag Last lag needed
+     */
+    void compute_fft(uint32_t sample_count, uint32_t last_lag);
+
+    /**
+     * @brief In-place complex FFT over all lanes, from bit-reversed to natural row order
+     * @param re Real parts (fft_size_ rows)
+     * @param im Imaginary parts
+     * @param first_length Length of the first stage to run (earlier stages already applied)
+     * @param inverse True for inverse transform (unnormalized)
+     */
+    void transform(float* re, float* im, uint32_t first_length, bool inverse);
+
+    /**
+     * @brief Compute the tables of a transform size
+     * @param size Transform size (power of two)
+     * @return Tables
+     */
+    static FftTables build_tables(uint32_t size);
+
+    // Non-copyable
+    BatchPitchDetector(const BatchPitchDetector&) = delete;
+    BatchPitchDetector& operator=(const BatchPitchDetector&) = delete;
+};
+
+} // namespace autotune
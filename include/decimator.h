@@ -0,0 +1,66 @@
+#pragma once
+
+#include "audio_types.h"
+#include <memory>
+#include <vector>
+
+namespace autotune {
+
+/**
+ * @brief Anti-aliased integer-factor decimator for analysis paths
+ *
+ * A linear-phase windowed-sinc FIR evaluated only at the retained output
+ * positions (the polyphase form: each output costs taps() multiplies, none
+ * are spent on discarded samples). Windows are decimated independently and
+ * only outputs whose full filter support lies inside the window are
+ * produced, so there are no edge transients. Coefficients are designed in
+ * the constructor, once per factor and passband for all decimators (see
+ * TableCache); decimate() never allocates.
+ */
+class Decimator {
+public:
+    /**
+     * @brief Construct Decimator
+     * @param factor Decimation factor (>= 1; 1 copies the input)
+     * @param passband Passband edge as a fraction of the output rate (0.0 - 0.5)
+     */
+    explicit Decimator(uint32_t factor, float passband = 0.25f);
+    
+    /**
+     * @brief Destructor
+     */
+    ~Decimator();
+    
+    /**
+     * @brief Decimate one window of samples
+     * @param input Input samples at the full rate
+     * @param sample_count Number of input samples
+     * @param output Output buffer (at least output_count(sample_count) samples)
+     * @return Number of samples written
+     */
+    uint32_t decimate(const Sample* input, uint32_t sample_count, Sample* output) const;
+    
+    /**
+     * @brief Number of outputs decimate() produces for a window
+     * @param sample_count Number of input samples
+     * @return Output sample count (0 if the window is shorter than the filter)
+     */
+    uint32_t output_count(uint32_t sample_count) const;
+    
+    uint32_t factor() const { return factor_; }
+    uint32_t taps() const { return static_cast<uint32_t>(coefficients_->size()); }
+
+private:
+    uint32_t factor_;
+    std::shared_ptr<const std::vector<float>> coefficients_;   // Symmetric, so no reversal is needed
+    
+    /**
+     * @brief Design the filter
+     * @param factor Decimation factor (> 1)
+     * @param passband Passband edge as a fraction of the output rate (clamped)
+     * @return Coefficients
+     */
+    static std::vector<float> design(uint32_t factor, float passband);
+};
+
+} // namespace autotune
@@ -0,0 +1,171 @@
+#pragma once
+
+#include "autotune_engine.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace autotune {
+
+class WorkStealingDeque;
+
+/**
+ * @brief Pool of AutotuneEngine voices processed in parallel per callback
+ *
+ * Owns one engine per voice and a fixed set of worker threads. Each call to
+ * process() hands every voice to the workers through per-worker
+ * work-stealing deques (the calling thread helps as well), then waits for
+ * the callback deadline. Voices that have not started by the deadline are
+ * cancelled and passed through dry; cancelled voices and voices finishing
+ * after the deadline are reported as missed.
+ */
+class EnginePool {
+public:
+    /**
+     * @brief Construct EnginePool
+     * @param voice_count Number of voices (one engine each)
+     * @param sample_rate Audio sample rate
+     * @param buffer_size Processing buffer size per engine
+     * @param channels Number of audio channels per voice
+     * @param worker_count Worker threads (0 = one per core besides the caller; capped at voice_count)
+     */
+    EnginePool(uint32_t voice_count, SampleRate sample_rate, uint32_t buffer_size = 512,
+               ChannelCount channels = 2, uint32_t worker_count = 0);
+    
+    /**
+     * @brief Destructor (stops and joins all workers)
+     */
+    ~EnginePool();
+    
+    /**
+     * @brief Process one callback for all voices
+     * @param inputs Input block per voice (voice_count() entries, equal frame counts)
+     * @param outputs Output block per voice (voice_count() entries)
+     * @return True if every voice finished before the deadline
+     */
+    bool process(const AudioBlockView* inputs, AudioBlockView* outputs);
+    
+    /**
+     * @brief Access a voice's engine for configuration
+     * @param voice Voice index
+     * @return Engine reference (do not call process() on it directly while the pool runs)
+     */
+    AutotuneEngine& engine(uint32_t voice) { return *engines_[voice]; }
+    
+    /**
+     * @brief Get the result of a voice from the last process() call
+     * @param voice Voice index
+     * @return Processing result (success == false if the voice was cancelled)
+     */
+    const ProcessingResult& get_result(uint32_t voice) const { return results_[voice]; }
+    
+    /**
+     * @brief Get voices that missed the deadline in the last process() call
+     * @return Voice indices in ascending order
+     */
+    const std::vector<uint32_t>& get_missed_voices() const { return missed_voices_; }
+    
+    /**
+     * @brief Get total deadline misses of a voice since construction or reset_statistics()
+     * @param voice Voice index
+     * @return Miss count
+     */
+    uint64_t get_deadline_misses(uint32_t voice) const { return deadline_misses_[voice]; }
+    
+    /**
+     * @brief Set the fraction of the callback period available for processing
+     * @param fraction Deadline as a fraction of frame_count / sample_rate (0.05 - 1.0)
+     */
+    void set_deadline_fraction(float fraction);
+    
+    /**
+     * @brief Get the deadline fraction
+     * @return Fraction of the callback period
+     */
+    float get_deadline_fraction() const { return deadline_fraction_; }
+    
+    /**
+     * @brief Reset accumulated deadline-miss counters
+     */
+    void reset_statistics();
+    
+    uint32_t voice_count() const { return static_cast<uint32_t>(engines_.size()); }
+    uint32_t worker_count() const { return static_cast<uint32_t>(workers_.size()); }
+
+private:
+    enum VoiceState : uint32_t {
+        VOICE_PENDING,
+        VOICE_RUNNING,
+        VOICE_DONE,
+        VOICE_LATE,         // Finished after the deadline
+        VOICE_CANCELLED
+    };
+    
+    using Clock = std::chrono::steady_clock;
+    
+    SampleRate sample_rate_;
+    float deadline_fraction_;
+    
+    std::vector<std::unique_ptr<AutotuneEngine>> engines_;
+    std::vector<ProcessingResult> results_;
+    std::vector<uint64_t> deadline_misses_;
+    std::vector<uint32_t> missed_voices_;
+    
+    // Current callback's jobs
+    std::vector<AudioBlockView> inputs_;
+    std::vector<AudioBlockView> outputs_;
+    std::unique_ptr<std::atomic<uint32_t>[]> voice_states_;
+    std::atomic<uint32_t> unclaimed_voices_;
+    Clock::time_point deadline_;    // Published to workers with generation_
+    
+    // Workers; deque index worker_count() belongs to the calling thread
+    std::vector<std::unique_ptr<WorkStealingDeque>> deques_;
+    std::vector<std::thread> workers_;
+    std::atomic<uint32_t> active_workers_;
+    std::atomic<uint64_t> generation_;
+    std::atomic<bool> stopping_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_condition_;
+    
+    /**
+     * @brief Worker thread main loop
+     * @param worker_index Index of the worker's own deque
+     */
+    void worker_loop(uint32_t worker_index);
+    
+    /**
+     * @brief Pop/steal and run jobs until no voice is left unclaimed
+     * @param worker_index Own deque index
+     */
+    void run_jobs(uint32_t worker_index);
+    
+    /**
+     * @brief Take one job from the own deque or steal from another
+     * @param worker_index Own deque index
+     * @param voice Output voice index
+     * @return True if a job was found
+     */
+    bool find_job(uint32_t worker_index, uint32_t& voice);
+    
+    /**
+     * @brief Claim and process a voice if it is still pending
+     * @param voice Voice index
+     */
+    void run_voice(uint32_t voice);
+    
+    /**
+     * @brief Copy input to output for a cancelled voice
+     * @param voice Voice index
+     */
+    void pass_through(uint32_t voice);
+    
+    // Non-copyable
+    EnginePool(const EnginePool&) = delete;
+    EnginePool& operator=(const EnginePool&) = delete;
+};
+
+} // namespace autotune
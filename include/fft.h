@@ -0,0 +1,104 @@
+#pragma once
+
+#include "audio_types.h"
+#include <complex>
+#include <memory>
+#include <vector>
+
+namespace autotune {
+
+/**
+ * @brief Radix-2 real-input FFT with precomputed twiddle tables
+ *
+ * All twiddle factors, bit-reversal tables and scratch memory are allocated
+ * in the constructor, so forward() and inverse() never allocate and are
+ * safe to call from the audio thread. The tables depend only on the size
+ * and are shared by all transforms of that size (see TableCache); only the
+ * scratch memory is per instance.
+ */
+class FFT {
+public:
+    using Complex = std::complex<float>;
+    
+    /**
+     * @brief Construct FFT
+     * @param size Transform size (rounded up to a power of two, minimum 4)
+     */
+    explicit FFT(uint32_t size);
+    
+    /**
+     * @brief Destructor
+     */
+    ~FFT();
+    
+    /**
+     * @brief Forward real FFT
+     * @param input Real input samples (size() values)
+     * @param output Complex spectrum (size() / 2 + 1 bins)
+     */
+    void forward(const Sample* input, Complex* output);
+    
+    /**
+     * @brief Inverse real FFT (normalized, so inverse(forward(x)) == x)
+     * @param input Complex spectrum (size() / 2 + 1 bins)
+     * @param output Real output samples (size() values)
+     */
+    void inverse(const Complex* input, Sample* output);
+    
+    /**
+     * @brief Get transform size
+     * @return Number of real samples per transform
+     */
+    uint32_t size() const { return size_; }
+    
+    /**
+     * @brief Get number of spectrum bins produced by forward()
+     * @return size() / 2 + 1
+     */
+    uint32_t bin_count() const { return half_size_ + 1; }
+    
+    /**
+     * @brief Round up to the next power of two
+     * @param value Input value
+     * @return Smallest power of two >= value
+     */
+    static uint32_t next_power_of_two(uint32_t value);
+
+private:
+    uint32_t size_;
+    uint32_t half_size_;
+    
+    /**
+     * @brief Twiddles for the half-size complex FFT and the real split/merge step
+     */
+    struct Tables {
+        std::vector<Complex> twiddles;
+        std::vector<Complex> split_twiddles;
+        std::vector<uint32_t> bit_reverse;
+    };
+    
+    std::shared_ptr<const Tables> tables_;
+    const Complex* twiddles_;               // Into tables_
+    const Complex* split_twiddles_;
+    const uint32_t* bit_reverse_;
+    std::vector<Complex> work_;
+    
+    /**
+     * @brief Compute the tables of a transform size
+     * @param size Transform size (power of two)
+     * @return Tables
+     */
+    static Tables build_tables(uint32_t size);
+    
+    /**
+     * @brief In-place complex FFT of half_size_ points on work_
+     * @param inverse True for inverse transform (unnormalized)
+     */
+    void transform(bool inverse);
+    
+    // Non-copyable
+    FFT(const FFT&) = delete;
+    FFT& operator=(const FFT&) = delete;
+};
+
+} // namespace autotune
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "audio_types.h"
+#include <array>
+#include <atomic>
+#include <type_traits>
+
+namespace autotune {
+
+/**
+ * @brief Lock-free triple buffer handing parameter snapshots to the audio thread
+ *
+ * The writer fills its private back slot and swaps it with the shared
+ * middle slot; the reader swaps the middle slot with its private front slot
+ * only when a newer snapshot has been published. Each side touches one
+ * atomic exchange per transfer and never waits on the other, and the reader
+ * always sees a complete snapshot (the latest one; intermediate ones may be
+ * skipped). One writer at a time: callers with several writer threads must
+ * serialize publish() among themselves.
+ */
+template <typename T>
+class ParameterMailbox {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "snapshots are copied on the audio thread and must not allocate");
+
+public:
+    /**
+     * @brief Construct ParameterMailbox
+     * @param initial Snapshot every slot starts with
+     */
+    explicit ParameterMailbox(const T& initial = T())
+        : slots_{{initial, initial, initial}}, back_(0), middle_(1), front_(2) {}
+    
+    /**
+     * @brief Publish a new snapshot (writer side)
+     * @param value Snapshot to hand over
+     */
+    void publish(const T& value) {
+        slots_[back_] = value;
+        back_ = middle_.exchange(static_cast<uint8_t>(back_ | kFresh), std::memory_order_acq_rel) & kIndexMask;
+    }
+    
+    /**
+     * @brief Pick up the latest snapshot if one arrived since the last call (reader side)
+     * @param value Receives the snapshot; untouched if nothing new was published
+     * @return True if value was updated
+     */
+    bool fetch(T& value) {
+        if ((middle_.load(std::memory_order_relaxed) & kFresh) == 0) {
+            return false;
+        }
+        front_ = middle_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+        value = slots_[front_];
+        return true;
+    }
+
+private:
+    static constexpr uint8_t kIndexMask = 0x3;
+    static constexpr uint8_t kFresh = 0x4;      // Middle slot holds an unread snapshot
+    
+    std::array<T, 3> slots_;
+    alignas(64) uint8_t back_;                  // Writer only
+    alignas(64) std::atomic<uint8_t> middle_;   // Slot index plus kFresh
+    alignas(64) uint8_t front_;                 // Reader only
+};
+
+/**
+ * @brief Control-rate parameter with a per-sample linear ramp
+ *
+ * set_target() starts a ramp from the current value that reaches the
+ * target after a fixed number of samples; fill() renders the ramp one value
+ * per sample so automation steps never reach the signal as a jump.
+ */
+class SmoothedParameter {
+public:
+    /**
+     * @brief Construct SmoothedParameter
+     * @param value Initial value
+     * @param ramp_samples Ramp length in samples (at least 1)
+     */
+    explicit SmoothedParameter(float value = 0.0f, uint32_t ramp_samples = 1)
+        : current_(value), target_(value), step_(0.0f), remaining_(0),
+          ramp_samples_(ramp_samples > 0 ? ramp_samples : 1) {}
+    
+    /**
+     * @brief Ramp towards a new value
+     * @param target Value to reach after the ramp length
+     */
+    void set_target(float target) {
+        if (target == target_) {
+            return;
+        }
+        target_ = target;
+        remaining_ = ramp_samples_;
+        step_ = (target_ - current_) / ramp_samples_;
+    }
+    
+    /**
+     * @brief Jump to a value without ramping
+     * @param value New value
+     */
+    void reset(float value) {
+        current_ = target_ = value;
+        step_ = 0.0f;
+        remaining_ = 0;
+    }
+    
+    /**
+     * @brief Render the next values and advance the ramp
+     * @param output One value per sample
+     * @param sample_count Number of samples
+     */
+    void fill(float* output, uint32_t sample_count) {
+        uint32_t i = 0;
+        for (; i < sample_count && remaining_ > 0; ++i) {
+            current_ = --remaining_ == 0 ? target_ : current_ + step_;
+            output[i] = current_;
+        }
+        for (; i < sample_count; ++i) {
+            output[i] = target_;
+        }
+    }
+    
+    bool is_ramping() const { return remaining_ > 0; }
+    float get_value() const { return current_; }
+    float get_target() const { return target_; }
+
+private:
+    float current_;
+    float target_;
+    float step_;
+    uint32_t remaining_;
+    uint32_t ramp_samples_;
+};
+
+} // namespace autotune
@@ -0,0 +1,178 @@
+#pragma once
+
+#include "audio_types.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+
+namespace autotune {
+
+/**
+ * @brief Lock-free per-callback timing statistics
+ *
+ * Callback processing times go into a fixed-bucket histogram with 16
+ * linear sub-buckets per power of two of nanoseconds, so percentiles are
+ * reported within 6.25% (rounded up to the bucket edge) from 1 ns to over a
+ * minute without any allocation. Per-stage times are accumulated over a
+ * callback and committed with it, and every callback that takes longer than
+ * the audio it produced counts as a deadline miss.
+ *
+ * Only the audio thread writes (relaxed loads and stores, no locks and no
+ * read-modify-write); snapshot() may be polled from any thread at any time.
+ * A snapshot taken while a callback is being committed can be off by that
+ * one callback but is never torn within a counter.
+ */
+class PerformanceMonitor {
+public:
+    using Clock = std::chrono::steady_clock;
+    
+    /**
+     * @brief Processing stages timed inside a callback
+     */
+    enum class Stage {
+        DETECT,     // Pitch tracking
+        QUANTIZE,   // Target pitch selection
+        CORRECT     // Pitch shifting
+    };
+    static constexpr uint32_t kStageCount = 3;
+    
+    /**
+     * @brief Statistics at one point in time
+     */
+    struct Snapshot {
+        uint64_t callbacks = 0;
+        uint64_t frames_processed = 0;
+        uint64_t deadline_misses = 0;       // Callbacks slower than their audio period
+        uint64_t skipped_callbacks = 0;     // Callbacks that skipped the processing (see mark_skipped())
+        double skipped_ratio = 0.0;         // skipped_callbacks / callbacks
+        double mean_ms = 0.0;
+        double p50_ms = 0.0;
+        double p99_ms = 0.0;
+        double p999_ms = 0.0;
+        double max_ms = 0.0;
+        double load_percent = 0.0;          // Processing time relative to audio time
+        std::array<double, kStageCount> stage_mean_ms{};   // Per callback, indexed by Stage
+        std::array<double, kStageCount> stage_max_ms{};
+    };
+    
+    /**
+     * @brief Construct PerformanceMonitor
+     * @param sample_rate Sample rate of the processed audio (sets the deadline)
+     */
+    explicit PerformanceMonitor(SampleRate sample_rate);
+    
+    /**
+     * @brief Add time spent in a stage to the current callback (audio thread)
+     * @param stage Processing stage
+     * @param nanoseconds Time spent
+     */
+    void add_stage_time(Stage stage, uint64_t nanoseconds) {
+        pending_stage_ns_[static_cast<uint32_t>(stage)] += nanoseconds;
+    }
+    
+    /**
+     * @brief Count the current callback as skipped by a gate (audio thread)
+     */
+    void mark_skipped() { pending_skipped_ = true; }
+    
+    /**
+     * @brief Commit one callback and its stage times (audio thread)
+     * @param nanoseconds Total processing time of the callback
+     * @param frame_count Frames the callback produced
+     */
+    void record_callback(uint64_t nanoseconds, uint32_t frame_count);
+    
+    /**
+     * @brief Read the current statistics (any thread, never blocks)
+     * @return Statistics snapshot
+     */
+    Snapshot snapshot() const;
+    
+    /**
+     * @brief Clear all statistics (not concurrently with record_callback())
+     */
+    void reset();
+    
+    /**
+     * @brief Nanoseconds elapsed since a time point
+     * @param start Start time
+     * @return Elapsed nanoseconds
+     */
+    static uint64_t nanoseconds_since(Clock::time_point start) {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    }
+    
+    /**
+     * @brief Histogram bucket holding a duration
+     * @param nanoseconds Duration
+     * @return Bucket index (< kBucketCount)
+     */
+    static uint32_t bucket_index(uint64_t nanoseconds);
+    
+    /**
+     * @brief Smallest duration past a bucket
+     * @param bucket Bucket index
+     * @return Exclusive upper edge in nanoseconds
+     */
+    static uint64_t bucket_upper_edge(uint32_t bucket);
+    
+    static constexpr uint32_t kSubBucketBits = 4;
+    static constexpr uint32_t kSubBuckets = 1u << kSubBucketBits;
+    static constexpr uint32_t kMaxExponent = 36;    // Durations are clamped below 2^36 ns (~69 s)
+    static constexpr uint32_t kBucketCount = kSubBuckets * (kMaxExponent - kSubBucketBits + 1);
+
+private:
+    using Counter = std::atomic<uint64_t>;
+    
+    SampleRate sample_rate_;
+    std::array<uint64_t, kStageCount> pending_stage_ns_;    // Audio thread only
+    bool pending_skipped_;
+    
+    std::array<Counter, kBucketCount> buckets_;
+    Counter callbacks_;
+    Counter frames_processed_;
+    Counter deadline_misses_;
+    Counter skipped_callbacks_;
+    Counter total_ns_;
+    Counter max_ns_;
+    std::array<Counter, kStageCount> stage_total_ns_;
+    std::array<Counter, kStageCount> stage_max_ns_;
+    
+    /**
+     * @brief Single-writer increment (no read-modify-write)
+     * @param counter Counter to advance
+     * @param amount Amount to add
+     */
+    static void add(Counter& counter, uint64_t amount) {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+    
+    /**
+     * @brief Single-writer running maximum
+     * @param counter Counter holding the maximum
+     * @param value Candidate value
+     */
+    static void raise(Counter& counter, uint64_t value) {
+        if (value > counter.load(std::memory_order_relaxed)) {
+            counter.store(value, std::memory_order_relaxed);
+        }
+    }
+    
+    /**
+     * @brief Duration below which a fraction of callbacks finished
+     * @param counts Bucket counts
+     * @param total Sum of counts
+     * @param fraction Fraction of callbacks (0.0 - 1.0)
+     * @param max_ns Largest recorded duration (caps the bucket edge)
+     * @return Percentile in nanoseconds
+     */
+    static uint64_t percentile(const std::array<uint64_t, kBucketCount>& counts, uint64_t total,
+                               double fraction, uint64_t max_ns);
+    
+    // Non-copyable
+    PerformanceMonitor(const PerformanceMonitor&) = delete;
+    PerformanceMonitor& operator=(const PerformanceMonitor&) = delete;
+};
+
+} // namespace autotune
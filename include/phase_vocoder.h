@@ -0,0 +1,224 @@
+#pragma once
+
+#include "audio_types.h"
+#include "fft.h"
+#include <memory>
+#include <vector>
+
+namespace autotune {
+
+/**
+ * @brief Streaming STFT phase-vocoder pitch shifter
+ *
+ * Shifts pitch directly in the frequency domain: spectral peaks are moved
+ * to ratio times their measured frequency together with their region of
+ * influence, and every bin in a region keeps its phase relative to the
+ * peak (identity phase locking, Laroche & Dolson), which avoids the
+ * phasiness of bin-by-bin vocoders. With formant preservation enabled the
+ * magnitudes are re-shaped by a cepstrally smoothed spectral envelope so
+ * the formants stay put while the harmonics move.
+ *
+ * Channels are linked: peaks, regions and phase rotations are found once
+ * on the sum of the channel spectra and the same mapping is applied to
+ * every channel's own spectrum, so inter-channel phase (the stereo image)
+ * survives the shift and each extra channel costs only its two FFTs and
+ * one complex multiply-add per bin.
+ *
+ * Square-root Hann analysis and synthesis windows overlap-add to a
+ * constant at 2x and 4x overlap. Output is delayed by latency() samples
+ * (one frame). FFT plans and all per-channel state are allocated in the
+ * constructor; process() never allocates.
+ */
+class PhaseVocoder {
+public:
+    /**
+     * @brief Construct PhaseVocoder
+     * @param sample_rate Audio sample rate (sets the frame size, ~40 ms)
+     * @param channels Number of channels to preallocate
+     * @param overlap Frames per frame length (2 or 4)
+     */
+    PhaseVocoder(SampleRate sample_rate, ChannelCount channels = 1, uint32_t overlap = 4);
+    
+    /**
+     * @brief Destructor
+     */
+    ~PhaseVocoder();
+    
+    /**
+     * @brief Pitch-shift planar channels with a common ratio
+     * @param input Input channel pointers
+     * @param output Output channel pointers
+     * @param channels Number of channels (<= channel_count())
+     * @param offset First sample to process in each channel
+     * @param sample_count Number of samples
+     * @param ratio Pitch shift ratio for frames completed in this call
+     */
+    void process(const Sample* const* input, Sample* const* output, ChannelCount channels,
+                 uint32_t offset, uint32_t sample_count, float ratio);
+    
+    /**
+     * @brief Pass planar channels through delayed by latency(), skipping the FFTs
+     *
+     * The stream stays aligned with process(): the next call to process()
+     * restarts the phase tracking on its first frame and keeps playing the
+     * delayed input until overlap-add is complete again, so switching
+     * between the two at ratio 1 leaves no seam.
+     * @param input Input channel pointers
+     * @param output Output channel pointers
+     * @param channels Number of channels (<= channel_count())
+     * @param offset First sample to process in each channel
+     * @param sample_count Number of samples
+     */
+    void delay(const Sample* const* input, Sample* const* output, ChannelCount channels,
+               uint32_t offset, uint32_t sample_count);
+    
+    /**
+     * @brief Select the overlap factor (resets the stream; never allocates)
+     * @param overlap 2 (cheaper, lower latency) or 4 (higher quality); other values are ignored
+     */
+    void set_overlap(uint32_t overlap);
+    
+    /**
+     * @brief Get overlap factor
+     * @return Frames per frame length
+     */
+    uint32_t get_overlap() const { return overlap_; }
+    
+    /**
+     * @brief Enable spectral-envelope (formant) preservation
+     * @param preserve True to keep formants in place
+     */
+    void set_formant_preservation(bool preserve) { preserve_formants_ = preserve; }
+    
+    /**
+     * @brief Get formant preservation setting
+     * @return True if formants are preserved
+     */
+    bool get_formant_preservation() const { return preserve_formants_; }
+    
+    /**
+     * @brief Grow the per-channel state (allocates; not for the audio thread)
+     * @param channels Number of channels
+     */
+    void allocate_channels(ChannelCount channels);
+    
+    /**
+     * @brief Clear all stream state
+     */
+    void reset();
+    
+    uint32_t latency() const { return frame_size_; }
+    uint32_t frame_size() const { return frame_size_; }
+    uint32_t hop_size() const { return hop_size_; }
+    ChannelCount channel_count() const { return channels_; }
+
+private:
+    SampleRate sample_rate_;
+    ChannelCount channels_;
+    uint32_t frame_size_;
+    uint32_t bin_count_;
+    uint32_t overlap_;
+    uint32_t hop_size_;
+    uint32_t lifter_;                   // Cepstral coefficients kept for the envelope
+    bool preserve_formants_;
+    uint32_t fifo_position_;            // Input FIFO write index, from frame_size_ - hop_size_ up to frame_size_
+    bool delayed_;                      // The last frame was passed through by delay()
+    bool prime_phases_;                 // Next analysis starts the phase tracking afresh
+    uint32_t warmup_frames_;            // Frames whose overlap-add is still incomplete after delay()
+    
+    FFT fft_;
+    std::shared_ptr<const std::vector<float>> window_;  // Square-root Hann analysis window (shared per size)
+    std::vector<float> synthesis_window_;   // Analysis window scaled for constant overlap-add
+    
+    /**
+     * @brief One peak's region of influence and how it moves
+     */
+    struct Region {
+        uint32_t start;
+        uint32_t end;
+        int32_t shift;                          // Bins the region moves by
+        FFT::Complex rotor;                     // Unit phase rotation applied to the region
+    };
+    
+    // Per-channel stream state (channels_ runs each)
+    std::vector<Sample> input_fifo_;            // frame_size_ per channel
+    std::vector<Sample> output_accumulator_;    // frame_size_ per channel
+    std::vector<Sample> output_fifo_;           // Finished hop per channel (room for the largest hop)
+    std::vector<FFT::Complex> channel_spectra_; // bin_count_ per channel, current frame
+    
+    // Linked phase state of the channel sum
+    std::vector<float> analysis_phase_;
+    std::vector<float> synthesis_phase_;
+    
+    // Per-frame scratch shared by all channels
+    std::vector<Sample> frame_;
+    std::vector<FFT::Complex> spectrum_;        // Channel sum, then sum of the shifted spectra
+    std::vector<FFT::Complex> shifted_;
+    std::vector<float> magnitude_;
+    std::vector<float> phase_;
+    std::vector<float> frequency_;              // Measured frequency in bins
+    std::vector<float> envelope_;
+    std::vector<uint32_t> peaks_;
+    std::vector<Region> regions_;
+    uint32_t region_count_;
+    std::vector<float> gains_;                  // Formant correction per source bin
+    bool reshape_;                              // gains_ apply to this frame
+    
+    /**
+     * @brief Feed samples through the FIFOs, finishing frames as they fill
+     * @param delayed Pass the frames through instead of shifting them
+     */
+    void stream(const Sample* const* input, Sample* const* output, ChannelCount channels,
+                uint32_t offset, uint32_t sample_count, float ratio, bool delayed);
+    
+    /**
+     * @brief Finish the full input frame and queue the next output hop
+     * @param channels Number of channels
+     * @param ratio Pitch shift ratio
+     * @param delayed Queue the frame's oldest input hop instead of shifting
+     */
+    void end_frame(ChannelCount channels, float ratio, bool delayed);
+    
+    /**
+     * @brief Move a channel's completed output hop to its output FIFO
+     * @param channel Channel index
+     */
+    void emit_hop(ChannelCount channel);
+    
+    /**
+     * @brief Shift one full input frame of every channel and overlap-add the results
+     * @param channels Number of channels
+     * @param ratio Pitch shift ratio
+     */
+    void process_frames(ChannelCount channels, float ratio);
+    
+    /**
+     * @brief Find peaks and regions of a spectrum and how each one moves
+     * @param spectrum Analysis spectrum (the channel sum)
+     * @param ratio Pitch shift ratio
+     */
+    void analyze(const FFT::Complex* spectrum, float ratio);
+    
+    /**
+     * @brief Move one channel's spectrum along the analysed regions into shifted_
+     * @param spectrum Channel spectrum
+     */
+    void shift_spectrum(const FFT::Complex* spectrum);
+    
+    /**
+     * @brief Inverse-transform shifted_ into a channel's output and emit its oldest hop
+     * @param channel Channel index
+     */
+    void synthesize(ChannelCount channel);
+    
+    /**
+     * @brief Smooth magnitude_ into envelope_ by liftering the real cepstrum
+     */
+    void compute_envelope();
+    
+    // Non-copyable
+    PhaseVocoder(const PhaseVocoder&) = delete;
+    PhaseVocoder& operator=(const PhaseVocoder&) = delete;
+};
+
+} // namespace autotune
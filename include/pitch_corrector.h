@@ -1,6 +1,8 @@
 #pragma once
 
 #include "audio_types.h"
+#include "phase_vocoder.h"
+#include <memory>
 #include <vector>
 
 namespace autotune {
@@ -8,17 +10,70 @@ namespace autotune {
 /**
  * @brief Real-time pitch correction with smooth transitions
  * 
- * This class implements pitch shifting and correction algorithms
- * optimized for musical applications with minimal artifacts.
+ * Streaming TD-PSOLA: analysis pitch marks are placed one detected period
+ * apart and carried across calls, two-period Hann grains around them are
+ * overlap-added into a persistent output ring at synthesis marks spaced
+ * one shifted period apart, and each output sample is normalized by the
+ * summed window. Output is delayed by a fixed get_latency_samples(), long
+ * enough that every grain touching a sample has been added before it is
+ * emitted; all buffers are sized in the constructor for the longest period
+ * the shifter resolves, so processing never allocates.
+ * 
+ * A PhaseVocoder backend can be selected instead for large corrections:
+ * it preserves formants (see set_formant_preservation()) at the cost of
+ * more CPU and one STFT frame of latency.
  */
 class PitchCorrector {
 public:
+    /**
+     * @brief Pitch shifting algorithms
+     */
+    enum class Backend {
+        PSOLA,          // Time-domain pitch-synchronous overlap-add (cheap, small shifts)
+        PHASE_VOCODER   // Phase-locked STFT vocoder with formant preservation (large shifts)
+    };
+    
+    /**
+     * @brief Run of frames with constant detected and target pitch
+     */
+    struct PitchSegment {
+        uint32_t frames;
+        float input_pitch;              // Hz (<= 0 = unvoiced)
+        float target_pitch;             // Hz
+    };
+    
+    /**
+     * @brief Pitch trajectory of a block for correct_block()
+     *
+     * Either per-frame arrays or, when segments is set, consecutive runs
+     * covering the block (the arrays are then ignored).
+     */
+    struct PitchCurve {
+        const float* input_pitch;       // Detected pitch per frame (Hz, <= 0 = unvoiced)
+        const float* target_pitch;      // Target pitch per frame (Hz)
+        float correction_strength;      // Correction amount (0.0 - 1.0)
+        const float* strength_curve;    // Per-frame correction amount overriding correction_strength (optional)
+        const PitchSegment* segments;   // Runs in block order (optional)
+        uint32_t segment_count;
+        
+        PitchCurve(const float* input = nullptr, const float* target = nullptr, float strength = 1.0f,
+                   const float* strengths = nullptr)
+            : input_pitch(input), target_pitch(target), correction_strength(strength),
+              strength_curve(strengths), segments(nullptr), segment_count(0) {}
+        
+        PitchCurve(const PitchSegment* runs, uint32_t run_count, float strength = 1.0f,
+                   const float* strengths = nullptr)
+            : input_pitch(nullptr), target_pitch(nullptr), correction_strength(strength),
+              strength_curve(strengths), segments(runs), segment_count(run_count) {}
+    };
+    
     /**
      * @brief Construct PitchCorrector
      * @param sample_rate Audio sample rate
      * @param buffer_size Processing buffer size
+     * @param channels Number of channels to preallocate shifter state for
      */
-    PitchCorrector(SampleRate sample_rate, uint32_t buffer_size = 512);
+    PitchCorrector(SampleRate sample_rate, uint32_t buffer_size = 512, ChannelCount channels = 1);
     
     /**
      * @brief Destructor
@@ -40,8 +95,56 @@ public:
                                  float input_pitch, float target_pitch,
                                  float correction_strength = 1.0f);
     
+    /**
+     * @brief Correct pitch of a whole multichannel block in one call
+     * 
+     * Frames with equal curve values are shifted as one run, so a curve that
+     * changes once per analysis hop costs one run per hop (a ramping
+     * strength_curve splits runs while it ramps). A segment curve hands the
+     * runs over directly and is not scanned per frame. All channels
+     * share the same pitch marks, and every channel is corrected.
+     * 
+     * @param input Input channel pointers
+     * @param output Output channel pointers
+     * @param channels Number of channels (<= the count given at construction)
+     * @param frames Number of frames per channel
+     * @param pitch_curve Detected and target pitch for every frame (segments must add up to frames)
+     * @return Processing result (pitches of the last frame)
+     */
+    ProcessingResult correct_block(const float* const* input, float* const* output,
+                                   ChannelCount channels, uint32_t frames,
+                                   const PitchCurve& pitch_curve);
+    
+    /**
+     * @brief Pass an unvoiced block through with the latency of correction
+     *
+     * For blocks the caller knows need no shifting (silence, breaths). Once
+     * the ratio has glided back to 1 the backend stops placing grains or
+     * transforming frames and plays its input delay line instead; until
+     * then the block is corrected as unvoiced. A following correct_block()
+     * takes over where the delay line leaves off, without a seam.
+     * 
+     * @param input Input channel pointers
+     * @param output Output channel pointers
+     * @param channels Number of channels (<= the count given at construction)
+     * @param frames Number of frames per channel
+     * @return Processing result
+     */
+    ProcessingResult bypass_block(const float* const* input, float* const* output,
+                                  ChannelCount channels, uint32_t frames);
+    
+    /**
+     * @brief Whether the shifter was skipped by the latest bypass_block()
+     * @return True while bypassed (until the next corrected samples)
+     */
+    bool is_bypassed() const { return bypassed_; }
+    
     /**
      * @brief Correct pitch of audio frame
+     * 
+     * Streams one sample of every channel through the shifter; prefer
+     * correct_block() for anything longer than a frame.
+     * 
      * @param input Input audio frame
      * @param output Output corrected frame
      * @param input_pitch Detected input pitch (Hz)
@@ -53,6 +156,24 @@ public:
                                  float input_pitch, float target_pitch,
                                  float correction_strength = 1.0f);
     
+    /**
+     * @brief Correct pitch of a planar audio block
+     * 
+     * All channels share the same pitch marks, so they stay phase-linked.
+     * Blocks with more channels than were preallocated grow the shifter
+     * state once (not real-time safe).
+     * 
+     * @param input Input audio block
+     * @param output Output block (same channel and frame count as input)
+     * @param input_pitch Detected input pitch (Hz)
+     * @param target_pitch Target pitch (Hz)
+     * @param correction_strength Correction amount (0.0 - 1.0)
+     * @return Processing result
+     */
+    ProcessingResult correct_pitch(const AudioBlockView& input, AudioBlockView& output,
+                                 float input_pitch, float target_pitch,
+                                 float correction_strength = 1.0f);
+    
     /**
      * @brief Set processing parameters
      * @param params Processing parameters
@@ -65,12 +186,73 @@ public:
      */
     const ProcessingParams& get_parameters() const { return params_; }
     
+    /**
+     * @brief Select the pitch shifting backend (resets the shifter; never allocates)
+     * @param backend Backend to use; latency changes with it
+     */
+    void set_backend(Backend backend);
+    
+    /**
+     * @brief Get the pitch shifting backend
+     * @return Active backend
+     */
+    Backend get_backend() const { return backend_; }
+    
+    /**
+     * @brief Select the phase-vocoder overlap factor (resets the vocoder; never allocates)
+     * @param overlap 2 (cheaper, less latency) or 4 (better transients and phase coherence)
+     */
+    void set_vocoder_overlap(uint32_t overlap);
+    
+    /**
+     * @brief Get the phase-vocoder overlap factor
+     * @return Frames per frame length
+     */
+    uint32_t get_vocoder_overlap() const { return vocoder_.get_overlap(); }
+    
+    /**
+     * @brief Set the lowest pitch the PSOLA backend resolves
+     * 
+     * The longest period sets the PSOLA latency (three periods), so raising
+     * the floor trades low voices for less delay. Resizes the rings and
+     * resets; call from the control thread, not the audio thread.
+     * 
+     * @param min_pitch Lowest pitch in Hz (clamped to 20 - 1000 Hz)
+     */
+    void set_minimum_pitch(float min_pitch);
+    
+    /**
+     * @brief Get the lowest pitch the PSOLA backend resolves
+     * @return Pitch floor in Hz
+     */
+    float get_minimum_pitch() const { return min_pitch_; }
+    
     /**
      * @brief Set formant preservation (affects voice quality)
+     * 
+     * Used by the PHASE_VOCODER backend, which keeps the spectral envelope
+     * in place while the harmonics move. PSOLA grains already carry the
+     * source formants for the moderate shifts it is suited to.
+     * 
      * @param preserve True to preserve formants
      */
     void set_formant_preservation(bool preserve);
     
+    /**
+     * @brief Get formant preservation setting
+     * @return True if formants are preserved
+     */
+    bool get_formant_preservation() const { return preserve_formants_; }
+    
+    /**
+     * @brief Get the fixed delay between input and output
+     * @return Latency in samples of the active backend (also reported in
+     *         ProcessingResult::latency_samples)
+     */
+    uint32_t get_latency_samples() const {
+        return backend_ == Backend::PHASE_VOCODER ? vocoder_.latency() : latency_;
+    }
+    
     /**
      * @brief Reset internal state
      */
@@ -81,30 +263,60 @@ private:
     uint32_t buffer_size_;
     ProcessingParams params_;
     bool preserve_formants_;
+    Backend backend_;
+    PhaseVocoder vocoder_;
     
     // PSOLA (Pitch Synchronous Overlap and Add) state
-    std::vector<Sample> overlap_buffer_;
-    std::vector<Sample> grain_buffer_;
-    std::vector<float> window_;
+    ChannelCount channels_;
+    float min_pitch_;                   // Pitch floor (Hz)
+    uint32_t min_period_;               // Shortest analysis period (samples)
+    uint32_t max_period_;               // Longest analysis period; sets the latency
+    uint32_t latency_;
+    uint32_t ring_size_;                // Power of two
+    uint32_t ring_mask_;
+    std::vector<Sample> input_history_; // channels_ rings of recent input
+    std::vector<Sample> output_ring_;   // channels_ overlap-add accumulators
+    std::vector<float> weight_ring_;    // Summed synthesis window per output sample
+    std::vector<Sample> grain_buffer_;  // One windowed grain, reused for every grain
+    std::vector<float> window_;         // Window of the current grain
+    std::shared_ptr<const std::vector<float>> hann_table_;  // Half Hann window, interpolated per grain
+    std::vector<const Sample*> frame_input_;    // Channel tables for single-frame calls
+    std::vector<Sample*> frame_output_;
+    
+    // Pitch mark state, in absolute sample positions
+    int64_t input_position_;            // Index of the next input sample
+    double analysis_marks_[2];          // Previous and latest analysis marks
+    float mark_periods_[2];             // Period each analysis mark was placed with
+    double synthesis_phase_;            // Next output grain, in mark intervals past analysis_marks_[0]
     
-    // Pitch shifting state
-    float phase_accumulator_;
-    float previous_input_pitch_;
-    float previous_target_pitch_;
-    uint32_t grain_size_;
-    uint32_t hop_size_;
-    uint32_t overlap_size_;
+    // Bypass: output positions in [delay_start_, delay_end_) are read
+    // straight from input_history_ instead of the overlap-add rings
+    bool bypassed_;
+    int64_t delay_start_;
+    int64_t delay_end_;
     
-    // Envelope following for smooth transitions
-    float envelope_follower_;
-    float attack_coeff_;
-    float release_coeff_;
+    // Pitch ratio glide for smooth transitions
+    float current_ratio_;
+    float target_ratio_;
+    float attack_rate_;                 // log2 of the ratio error left after one sample
+    float release_rate_;
     
     /**
      * @brief Initialize processing parameters
      */
     void initialize_parameters();
     
+    /**
+     * @brief Derive periods, latency and ring size from the pitch floor and size the buffers
+     */
+    void configure_periods();
+    
+    /**
+     * @brief Move current_ratio_ towards target_ratio_ (attack or release glide)
+     * @param samples Time the glide covers
+     */
+    void glide_ratio(float samples);
+    
     /**
      * @brief Calculate pitch shift ratio
      * @param input_pitch Input frequency
@@ -114,42 +326,130 @@ private:
      */
     float calculate_pitch_ratio(float input_pitch, float target_pitch, float strength);
     
+    /**
+     * @brief Size the per-channel rings
+     * @param channels Number of channels
+     */
+    void allocate_channels(ChannelCount channels);
+    
+    /**
+     * @brief Correct one constant-pitch run of planar channels sharing one set of pitch marks
+     * @param input Input channel pointers
+     * @param output Output channel pointers
+     * @param channels Number of channels
+     * @param offset First sample of the run in each channel
+     * @param sample_count Number of samples in the run
+     * @param input_pitch Detected input pitch (Hz)
+     * @param target_pitch Target pitch (Hz)
+     * @param strength Correction strength
+     * @return Processing result
+     */
+    ProcessingResult process_channels(const Sample* const* input, Sample* const* output,
+                                      ChannelCount channels, uint32_t offset, uint32_t sample_count,
+                                      float input_pitch, float target_pitch, float strength);
+    
+    /**
+     * @brief process_channels() for a backend fixed at compile time
+     * @tparam B Backend
+     */
+    template <Backend B>
+    ProcessingResult shift_channels(const Sample* const* input, Sample* const* output,
+                                    ChannelCount channels, uint32_t offset, uint32_t sample_count,
+                                    float input_pitch, float target_pitch, float strength);
+    
+    /**
+     * @brief Correct a validated block run by run with one backend
+     * @tparam B Backend
+     * @param input Input channel pointers
+     * @param output Output channel pointers
+     * @param channels Number of channels
+     * @param frames Frames per channel
+     * @param pitch_curve Per-frame pitch trajectory
+     * @return Result of the last run
+     */
+    template <Backend B>
+    ProcessingResult correct_runs(const float* const* input, float* const* output,
+                                  ChannelCount channels, uint32_t frames, const PitchCurve& pitch_curve);
+    
+    /**
+     * @brief Shift one constant-pitch run, split where a strength curve changes
+     * @tparam B Backend
+     * @param input Input channel pointers
+     * @param output Output channel pointers
+     * @param channels Number of channels
+     * @param offset First frame of the run
+     * @param frames Frames in the run
+     * @param input_pitch Detected pitch of the run
+     * @param target_pitch Target pitch of the run
+     * @param pitch_curve Curve providing the strength
+     * @return Result of the last piece
+     */
+    template <Backend B>
+    ProcessingResult shift_run(const float* const* input, float* const* output, ChannelCount channels,
+                               uint32_t offset, uint32_t frames, float input_pitch, float target_pitch,
+                               const PitchCurve& pitch_curve);
+    
     /**
      * @brief Apply time-domain pitch shifting using PSOLA
-     * @param input Input samples
-     * @param output Output samples
-     * @param sample_count Number of samples
-     * @param pitch_ratio Pitch shift ratio
-     * @return Processing success
+     * @param input Input channel pointers
+     * @param output Output channel pointers
+     * @param channels Number of channels
+     * @param offset First sample to process in each channel
+     * @param sample_count Number of samples (<= buffer size)
+     * @param period Analysis period for marks placed in this chunk (samples)
+     */
+    void apply_psola_shift(const Sample* const* input, Sample* const* output, ChannelCount channels,
+                           uint32_t offset, uint32_t sample_count, float period);
+    
+    /**
+     * @brief Delay a chunk through the PSOLA history without placing grains
+     * @param input Input channel pointers
+     * @param output Output channel pointers
+     * @param channels Number of channels
+     * @param offset First sample to process in each channel
+     * @param sample_count Number of samples (<= buffer size)
+     */
+    void delay_psola(const Sample* const* input, Sample* const* output, ChannelCount channels,
+                     uint32_t offset, uint32_t sample_count);
+    
+    /**
+     * @brief Append a chunk to each channel's input history
+     */
+    void write_history(const Sample* const* input, ChannelCount channels, uint32_t offset, uint32_t sample_count);
+    
+    /**
+     * @brief Output the samples that are now latency_ old and clear their ring slots
+     */
+    void emit_samples(Sample* const* output, ChannelCount channels, uint32_t offset, uint32_t sample_count);
+    
+    /**
+     * @brief Whether bypass_block() may stop shifting now
+     * @return True once the ratio is back at 1 and the previous hand-over has played out
      */
-    bool apply_psola_shift(const Sample* input, Sample* output, 
-                          uint32_t sample_count, float pitch_ratio);
+    bool can_bypass() const;
     
     /**
-     * @brief Find pitch marks for PSOLA
-     * @param samples Input samples
-     * @param sample_count Number of samples
-     * @param pitch Current pitch estimate
-     * @param marks Output pitch marks
-     * @return Number of marks found
+     * @brief Leave the bypass before shifting again
+     * @param period Period of the first analysis marks
      */
-    uint32_t find_pitch_marks(const Sample* samples, uint32_t sample_count,
-                             float pitch, std::vector<uint32_t>& marks);
+    void resume(float period);
     
     /**
-     * @brief Apply windowing function
-     * @param data Input/output data
-     * @param size Window size
-     * @param window_type Window type (0=Hanning, 1=Hamming)
+     * @brief Place pitch marks and overlap-add every grain the buffered input allows
+     * @param channels Number of channels
+     * @param input_end Absolute index one past the newest buffered input sample
+     * @param period Period for newly placed analysis marks
      */
-    void apply_window(Sample* data, uint32_t size, int window_type = 0);
+    void place_pitch_marks(ChannelCount channels, int64_t input_end, float period);
     
     /**
-     * @brief Update envelope follower
-     * @param input Current input level
-     * @return Envelope value
+     * @brief Overlap-add one Hann grain into the output ring
+     * @param channels Number of channels
+     * @param analysis_mark Grain centre in the input
+     * @param period Grain half-length in samples
+     * @param synthesis_mark Grain centre in the output
      */
-    float update_envelope(float input);
+    void add_grain(ChannelCount channels, double analysis_mark, float period, double synthesis_mark);
     
     // Non-copyable
     PitchCorrector(const PitchCorrector&) = delete;
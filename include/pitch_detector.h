@@ -1,6 +1,8 @@
 #pragma once
 
 #include "audio_types.h"
+#include "pitch_estimator.h"
+#include "decimator.h"
 #include <vector>
 #include <memory>
 
@@ -10,10 +12,26 @@ namespace autotune {
  * @brief Real-time pitch detection using autocorrelation and harmonic analysis
  * 
  * This class implements efficient pitch detection algorithms optimized for
- * real-time performance with low latency.
+ * real-time performance with low latency. The period estimation itself is
+ * delegated to a pluggable PitchEstimator (autocorrelation, YIN or MPM).
  */
 class PitchDetector {
 public:
+    /**
+     * @brief Autocorrelation algorithms
+     */
+    using AutocorrelationMethod = AutocorrelationEstimator::Method;
+    
+    /**
+     * @brief Period estimation algorithms
+     */
+    enum class Algorithm {
+        AUTOCORRELATION,    // Windowed autocorrelation peak (default)
+        YIN,                // Cumulative-mean-normalized difference
+        MPM,                // McLeod normalized square difference
+        CUSTOM              // User estimator installed with set_estimator()
+    };
+    
     /**
      * @brief Construct PitchDetector
      * @param sample_rate Audio sample rate
@@ -37,12 +55,53 @@ public:
     
     /**
      * @brief Detect pitch from audio frame
-     * @param frame Audio frame (uses first channel for mono processing)
+     * @param frame Audio frame (channels are averaged)
      * @param confidence Output confidence level
      * @return Detected frequency in Hz
      */
     float detect_pitch(const AudioFrame& frame, float& confidence);
     
+    /**
+     * @brief Detect pitch from a planar audio block
+     * @param block Audio block (channels are mixed down to mono)
+     * @param confidence Output confidence level
+     * @return Detected frequency in Hz
+     */
+    float detect_pitch(const AudioBlockView& block, float& confidence);
+    
+    /**
+     * @brief Configure streaming pitch tracking (allocates; not for the audio thread)
+     *
+     * push_samples() keeps a history of the last window_size samples and
+     * runs detection over it every hop_size samples, independent of how the
+     * host splits the stream into callbacks.
+     * @param window_size Analysis window (clamped to buffer_size)
+     * @param hop_size Samples between estimates (clamped to 1 - window_size)
+     */
+    void set_tracking(uint32_t window_size, uint32_t hop_size);
+    
+    /**
+     * @brief Append samples to the tracking history (audio thread)
+     * @param samples Mono samples
+     * @param sample_count Number of samples
+     * @return Number of new estimates produced (at hop boundaries with a full window)
+     */
+    uint32_t push_samples(const Sample* samples, uint32_t sample_count);
+    
+    /**
+     * @brief Samples push_samples() accepts before the next hop boundary
+     * @return Samples until the next estimate (1 - hop_size)
+     */
+    uint32_t samples_until_estimate() const { return hop_countdown_; }
+    
+    /**
+     * @brief Get the latest tracked estimate
+     */
+    float get_tracked_pitch() const { return tracked_pitch_; }
+    float get_tracked_confidence() const { return tracked_confidence_; }
+    uint32_t get_window_size() const { return window_size_; }
+    uint32_t get_hop_size() const { return hop_size_; }
+    
     /**
      * @brief Set minimum detectable frequency
      * @param min_freq Minimum frequency in Hz
@@ -61,12 +120,101 @@ public:
      */
     void set_confidence_threshold(float threshold);
     
+    /**
+     * @brief Set the silence gate of push_samples() (0 disables it)
+     *
+     * Windows whose RMS level is below the threshold, or that cross zero
+     * more often than any pitch up to max_frequency would (breaths,
+     * fricatives), skip detection and count as unvoiced. An open gate
+     * closes only below half the opening level and after staying there for
+     * a short hold time, so decaying notes are not chopped.
+     * @param threshold Opening level as linear RMS
+     */
+    void set_gate_threshold(float threshold);
+    
+    float get_gate_threshold() const { return gate_threshold_; }
+    
+    /**
+     * @brief Whether the gate skipped detection of the latest window
+     */
+    bool is_gated() const { return gated_; }
+    
+    /**
+     * @brief Set the one-pole smoothing of successive detections
+     *
+     * Each estimate moves this fraction of the way back towards the
+     * previous one. Smoothing steadies the estimate but makes it lag note
+     * changes by a few hops; callers that smooth with lookahead themselves
+     * (see PitchPlanner) turn it off.
+     * @param factor Weight of the previous estimate (0 = none, clamped below 1; default kDefaultSmoothing)
+     */
+    void set_smoothing(float factor);
+    
+    float get_smoothing() const { return pitch_smoothing_factor_; }
+    
+    static constexpr float kDefaultSmoothing = 0.8f;
+    
+    /**
+     * @brief Select autocorrelation algorithm
+     * @param method Autocorrelation method
+     */
+    void set_autocorrelation_method(AutocorrelationMethod method);
+    
+    /**
+     * @brief Select period estimation algorithm (allocates; not for the audio thread)
+     * @param algorithm Algorithm (CUSTOM is ignored; use set_estimator())
+     */
+    void set_algorithm(Algorithm algorithm);
+    
+    /**
+     * @brief Analyse at a reduced rate (allocates; not for the audio thread)
+     *
+     * The window is anti-alias decimated by floor(sample_rate / analysis_rate)
+     * before period estimation, and the coarse period is then refined at the
+     * full rate with a short normalized-correlation search around it. Keep
+     * analysis_rate at least 4x the max frequency (e.g. 16000).
+     * @param analysis_rate Target analysis rate in Hz (0 = analyse at full rate)
+     */
+    void set_analysis_rate(SampleRate analysis_rate);
+    
+    /**
+     * @brief Get the effective analysis rate
+     * @return Decimated analysis rate in Hz (sample rate when not decimating)
+     */
+    SampleRate get_analysis_rate() const { return sample_rate_ / get_decimation_factor(); }
+    
+    /**
+     * @brief Get the analysis decimation factor
+     * @return Decimation factor (1 = full rate)
+     */
+    uint32_t get_decimation_factor() const { return decimator_ ? decimator_->factor() : 1; }
+    
+    /**
+     * @brief Get the longest window the estimator sees
+     * @return buffer_size, or the decimated length of a buffer_size window
+     */
+    uint32_t analysis_window_size() const { return decimator_ ? buffer_size_ / decimator_->factor() + 1 : buffer_size_; }
+    
+    /**
+     * @brief Install a custom period estimator (allocates; not for the audio thread)
+     * @param estimator Estimator able to handle windows of analysis_window_size() samples
+     */
+    void set_estimator(std::unique_ptr<PitchEstimator> estimator);
+    
+    /**
+     * @brief Access the active estimator (e.g. to tune YIN thresholds)
+     * @return Active estimator
+     */
+    PitchEstimator& get_estimator() { return *estimator_; }
+    
     /**
      * @brief Get current settings
      */
     float get_min_frequency() const { return min_frequency_; }
     float get_max_frequency() const { return max_frequency_; }
     float get_confidence_threshold() const { return confidence_threshold_; }
+    AutocorrelationMethod get_autocorrelation_method() const { return autocorr_method_; }
+    Algorithm get_algorithm() const { return algorithm_; }
     
     /**
      * @brief Reset internal state
@@ -79,47 +227,81 @@ private:
     float min_frequency_;
     float max_frequency_;
     float confidence_threshold_;
+    AutocorrelationMethod autocorr_method_;
+    Algorithm algorithm_;
+    std::unique_ptr<PitchEstimator> estimator_;
     
-    // Internal buffers for processing
-    std::vector<Sample> windowed_buffer_;
-    std::vector<Sample> autocorr_buffer_;
-    std::vector<float> hanning_window_;
+    // Downmix buffer for block input
+    std::vector<Sample> mono_buffer_;
+    
+    // Streaming tracker. Every sample is written twice (at i and
+    // i + window_size_), so the latest window is always one contiguous run.
+    std::vector<Sample> history_;
+    uint32_t window_size_;
+    uint32_t hop_size_;
+    uint32_t history_position_;     // Oldest sample of the current window
+    uint32_t history_fill_;
+    uint32_t hop_countdown_;
+    float tracked_pitch_;
+    float tracked_confidence_;
+    
+    // Silence gate
+    float gate_threshold_;          // Opening RMS level (0 = disabled)
+    bool gate_open_;
+    bool gated_;                    // The latest window skipped detection
+    uint32_t gate_hold_;            // Samples the open gate ignores quiet windows for
+    
+    // Decimated analysis path (null when analysing at full rate)
+    std::unique_ptr<Decimator> decimator_;
+    std::vector<Sample> decimated_buffer_;
+    std::vector<float> energy_prefix_;      // Running sum of squares for refinement
     
     // Previous frame for smoothing
     float previous_pitch_;
     float pitch_smoothing_factor_;
     
     /**
-     * @brief Apply Hanning window to input samples
-     * @param input Input samples
-     * @param output Windowed output
-     * @param size Number of samples
+     * @brief Create the estimator for a built-in algorithm
+     * @param algorithm Algorithm (not CUSTOM)
+     * @return New estimator sized for buffer_size_
      */
-    void apply_window(const Sample* input, Sample* output, uint32_t size);
+    std::unique_ptr<PitchEstimator> make_estimator(Algorithm algorithm) const;
     
     /**
-     * @brief Compute autocorrelation
-     * @param input Input samples
-     * @param output Autocorrelation result
-     * @param size Number of samples
+     * @brief Advance the silence gate over the latest window
+     * @param samples Window samples
+     * @param sample_count Window size
+     * @return True if the window should be analysed
      */
-    void compute_autocorrelation(const Sample* input, Sample* output, uint32_t size);
+    bool update_gate(const Sample* samples, uint32_t sample_count);
     
     /**
-     * @brief Find peak in autocorrelation function
-     * @param autocorr Autocorrelation data
-     * @param size Data size
+     * @brief Estimate the period, through the decimated path when enabled
+     * @param samples Audio samples at the full rate
+     * @param sample_count Number of samples
+     * @param min_lag Shortest period (full-rate samples)
+     * @param max_lag Longest period (full-rate samples)
      * @param confidence Output confidence
-     * @return Peak position (samples)
+     * @return Period in full-rate samples (0.0 if none found)
+     */
+    float estimate_period(const Sample* samples, uint32_t sample_count,
+                          uint32_t min_lag, uint32_t max_lag, float& confidence);
+    
+    /**
+     * @brief Refine a coarse period by hill-climbing the full-rate NSDF
+     * @param samples Audio samples at the full rate
+     * @param sample_count Number of samples
+     * @param coarse_period Coarse period estimate (full-rate samples)
+     * @return Refined fractional period
      */
-    uint32_t find_autocorr_peak(const Sample* autocorr, uint32_t size, float& confidence);
+    float refine_period(const Sample* samples, uint32_t sample_count, float coarse_period);
     
     /**
      * @brief Convert lag to frequency
-     * @param lag Lag in samples
+     * @param lag Lag in samples (fractional)
      * @return Frequency in Hz
      */
-    float lag_to_frequency(uint32_t lag) const;
+    float lag_to_frequency(float lag) const;
     
     /**
      * @brief Smooth pitch estimate
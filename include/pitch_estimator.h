@@ -0,0 +1,224 @@
+#pragma once
+
+#include "audio_types.h"
+#include "fft.h"
+#include <memory>
+#include <vector>
+
+namespace autotune {
+
+/**
+ * @brief Interface for period estimation algorithms used by PitchDetector
+ *
+ * An estimator turns one mono analysis window into a fractional period in
+ * samples plus a confidence value. Implementations preallocate everything
+ * for windows of up to max_size samples in their constructor, so
+ * estimate_period() is safe to call from the audio thread.
+ */
+class PitchEstimator {
+public:
+    virtual ~PitchEstimator() = default;
+    
+    /**
+     * @brief Estimate the fundamental period of a mono window
+     * @param samples Audio samples (unwindowed)
+     * @param sample_count Number of samples (<= max_size given at construction)
+     * @param min_lag Shortest period to consider (samples)
+     * @param max_lag Longest period to consider (samples)
+     * @param confidence Output confidence level (0.0 - 1.0)
+     * @return Period in samples with sub-sample precision (0.0 if none found)
+     */
+    virtual float estimate_period(const Sample* samples, uint32_t sample_count,
+                                  uint32_t min_lag, uint32_t max_lag, float& confidence) = 0;
+    
+    /**
+     * @brief Get printable algorithm name
+     * @return Name string
+     */
+    virtual const char* name() const = 0;
+    
+    /**
+     * @brief Refine an extremum position by fitting a parabola through its neighbours
+     * @param values Function values
+     * @param index Index of the local extremum (1 <= index < size - 1 for refinement)
+     * @param size Number of values
+     * @return Fractional extremum position
+     */
+    static float parabolic_interpolation(const float* values, uint32_t index, uint32_t size);
+};
+
+/**
+ * @brief Windowed autocorrelation peak picking (the original detector)
+ *
+ * Picks the global autocorrelation maximum in the lag range; confidence is
+ * the peak relative to the zero-lag energy.
+ */
+class AutocorrelationEstimator : public PitchEstimator {
+public:
+    /**
+     * @brief Autocorrelation algorithms
+     */
+    enum class Method {
+        DIRECT,     // O(N^2) time-domain lag sum
+        FFT         // O(N log N) Wiener-Khinchin (power spectrum of zero-padded FFT)
+    };
+    
+    /**
+     * @brief Construct AutocorrelationEstimator
+     * @param max_size Largest analysis window
+     * @param method Autocorrelation algorithm
+     */
+    explicit AutocorrelationEstimator(uint32_t max_size, Method method = Method::FFT);
+    
+    float estimate_period(const Sample* samples, uint32_t sample_count,
+                          uint32_t min_lag, uint32_t max_lag, float& confidence) override;
+    const char* name() const override { return "autocorrelation"; }
+    
+    void set_method(Method method) { method_ = method; }
+    Method get_method() const { return method_; }
+    
+    /**
+     * @brief Hanning window shared by every estimator of the same length
+     *
+     * The first request for a length builds it (allocates, under the cache
+     * lock); estimators fetch it again only when their window length changes.
+     * @param size Window length
+     * @return Shared immutable window (built on first use)
+     */
+    static std::shared_ptr<const std::vector<float>> shared_window(uint32_t size);
+
+private:
+    uint32_t max_size_;
+    Method method_;
+    std::shared_ptr<const std::vector<float>> window_;  // Shared window of the current length
+    std::vector<Sample> windowed_buffer_;
+    std::vector<Sample> autocorr_buffer_;
+    
+    // FFT autocorrelation state (zero-padded to >= 2 * max_size)
+    FFT fft_;
+    std::vector<Sample> fft_buffer_;
+    std::vector<FFT::Complex> spectrum_buffer_;
+    
+    /**
+     * @brief Compute autocorrelation with the direct lag sum
+     * @param input Input samples
+     * @param output Autocorrelation result
+     * @param size Number of samples
+     */
+    void compute_direct(const Sample* input, Sample* output, uint32_t size);
+    
+    /**
+     * @brief Compute autocorrelation via FFT power spectrum
+     * @param input Input samples
+     * @param output Autocorrelation result
+     * @param size Number of samples
+     */
+    void compute_fft(const Sample* input, Sample* output, uint32_t size);
+    
+    /**
+     * @brief Write a Hanning window
+     * @param window Output (size values)
+     * @param size Window length
+     */
+    static void fill_window(float* window, uint32_t size);
+};
+
+/**
+ * @brief Shared state for estimators built on the squared difference function
+ *
+ * Computes, for every lag tau, the autocorrelation r(tau) of the unwindowed
+ * window via FFT and the energy term m(tau) = sum of x[j]^2 + x[j+tau]^2
+ * over the overlapping part, so that d(tau) = m(tau) - 2 r(tau) costs
+ * O(N log N) instead of O(N^2).
+ */
+class DifferenceEstimator : public PitchEstimator {
+public:
+    /**
+     * @brief Construct DifferenceEstimator
+     * @param max_size Largest analysis window
+     */
+    explicit DifferenceEstimator(uint32_t max_size);
+
+protected:
+    std::vector<float> autocorr_;   // r(tau)
+    std::vector<float> energy_;     // m(tau)
+    std::vector<float> function_;   // Per-algorithm result (CMND or NSDF)
+    
+    /**
+     * @brief Fill autocorr_ and energy_ for lags 0 .. max_lag
+     * @param samples Input samples
+     * @param sample_count Number of samples
+     * @param max_lag Largest lag needed
+     */
+    void compute_terms(const Sample* samples, uint32_t sample_count, uint32_t max_lag);
+    
+    /**
+     * @brief Clamp a lag range to what the window can resolve
+     * @param sample_count Window length
+     * @param min_lag In/out shortest period
+     * @param max_lag In/out longest period (limited to half the window)
+     * @return False if the range is empty
+     */
+    static bool clamp_lag_range(uint32_t sample_count, uint32_t& min_lag, uint32_t& max_lag);
+
+private:
+    FFT fft_;
+    std::vector<Sample> fft_buffer_;
+    std::vector<FFT::Complex> spectrum_buffer_;
+};
+
+/**
+ * @brief YIN estimator (de Cheveigne & Kawahara)
+ *
+ * Uses the cumulative-mean-normalized difference function and picks the
+ * first dip below an absolute threshold, which avoids the octave errors of
+ * plain autocorrelation peak picking. Confidence is 1 - CMND at the dip.
+ */
+class YinEstimator : public DifferenceEstimator {
+public:
+    /**
+     * @brief Construct YinEstimator
+     * @param max_size Largest analysis window
+     * @param threshold Absolute CMND threshold (typically 0.1 - 0.2)
+     */
+    explicit YinEstimator(uint32_t max_size, float threshold = 0.15f);
+    
+    float estimate_period(const Sample* samples, uint32_t sample_count,
+                          uint32_t min_lag, uint32_t max_lag, float& confidence) override;
+    const char* name() const override { return "yin"; }
+    
+    void set_threshold(float threshold);
+    float get_threshold() const { return threshold_; }
+
+private:
+    float threshold_;
+};
+
+/**
+ * @brief McLeod Pitch Method estimator (normalized square difference function)
+ *
+ * Collects the key maximum of every positive NSDF lobe and picks the first
+ * one within cutoff of the highest. Confidence is the NSDF value (clarity)
+ * at the chosen peak.
+ */
+class MpmEstimator : public DifferenceEstimator {
+public:
+    /**
+     * @brief Construct MpmEstimator
+     * @param max_size Largest analysis window
+     * @param cutoff Fraction of the highest key maximum a peak must reach (typically 0.9)
+     */
+    explicit MpmEstimator(uint32_t max_size, float cutoff = 0.9f);
+    
+    float estimate_period(const Sample* samples, uint32_t sample_count,
+                          uint32_t min_lag, uint32_t max_lag, float& confidence) override;
+    const char* name() const override { return "mpm"; }
+    
+    void set_cutoff(float cutoff);
+    float get_cutoff() const { return cutoff_; }
+
+private:
+    float cutoff_;
+};
+
+} // namespace autotune
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "audio_types.h"
+#include "pitch_corrector.h"
+#include <vector>
+
+namespace autotune {
+
+/**
+ * @brief Lookahead planner for the target pitch curve
+ *
+ * Collects pitch estimates a fixed lookahead ahead of the audio they are
+ * applied to and plans the correction from what is coming rather than
+ * reacting to the latest estimate:
+ * - Each estimate is moved back to the centre of the window it was
+ *   measured over, so notes are corrected where they are sung.
+ * - Note boundaries are found ahead of time on the full-strength scale
+ *   notes: a new note has to hold for a short minimum before it replaces
+ *   the current one, and shorter excursions keep the current note.
+ * - The planned note curve moves between notes over the retune time,
+ *   centred on the boundary (0 = hard tune), and the detected pitch is
+ *   median-filtered over neighbouring estimates instead of lagging
+ *   through a one-pole smoother.
+ * The result comes out per estimate as constant-pitch segments that the
+ * corrector consumes directly. Boundaries closer to the present than the
+ * lookahead covers are planned with what has arrived so far.
+ *
+ * All storage is sized in configure(); push() and plan() never allocate.
+ */
+class PitchPlanner {
+public:
+    using Segment = PitchCorrector::PitchSegment;
+
+    PitchPlanner();
+
+    /**
+     * @brief Size the planner for a stream (allocates; not for the audio thread)
+     *
+     * Clears all estimates.
+     * @param sample_rate Audio sample rate
+     * @param lookahead Samples the planned stream trails the estimates by
+     * @param window_size Detector window the estimates are measured over
+     * @param hop_size Samples between estimates
+     * @param max_block Largest frame count passed to plan()
+     */
+    void configure(SampleRate sample_rate, uint32_t lookahead, uint32_t window_size, uint32_t hop_size,
+                   uint32_t max_block);
+
+    /**
+     * @brief Set how long transitions between notes take
+     * @param seconds Retune time (0 = instant, clamped to kMaxRetuneSeconds)
+     */
+    void set_retune_time(float seconds);
+
+    float get_retune_time() const { return retune_time_; }
+    uint32_t get_lookahead() const { return lookahead_; }
+
+    /**
+     * @brief Add the next pitch estimate (positions must not decrease)
+     * @param position First input frame the estimate applies to when used reactively
+     * @param pitch Detected pitch in Hz (<= 0 = unvoiced)
+     * @param note Full-strength scale note of the pitch in Hz
+     */
+    void push(uint64_t position, float pitch, float note);
+
+    /**
+     * @brief Plan the segments of a block of the delayed stream
+     * @param position Input frame of the block's first frame (negative before the stream)
+     * @param frames Frames in the block
+     * @param strength Quantize strength applied on top of the planned notes
+     * @param segments Output runs (room for frames entries); they add up to frames
+     * @return Number of segments written
+     */
+    uint32_t plan(int64_t position, uint32_t frames, float strength, Segment* segments);
+
+    /**
+     * @brief Drop all estimates and note state
+     */
+    void reset();
+
+    static constexpr float kMaxRetuneSeconds = 0.5f;
+
+private:
+    /**
+     * @brief One estimate and its plan
+     */
+    struct Point {
+        int64_t position;       // Delayed-stream frame the estimate starts at
+        float pitch;            // Detected pitch (Hz)
+        float note;             // Scale note (MIDI)
+        float label;            // Note of the segment the estimate belongs to (MIDI)
+        bool voiced;
+        bool planned;           // input and target are final
+        float input;            // Planned detected pitch (Hz)
+        float target;           // Planned note (MIDI)
+    };
+
+    SampleRate sample_rate_;
+    uint32_t lookahead_;
+    uint32_t hop_size_;
+    int64_t alignment_;             // Frames estimates are moved back by
+    float retune_time_;
+    uint32_t retune_half_;          // Estimates either side averaged for transitions
+    uint32_t min_note_points_;      // Estimates a new note must hold for
+
+    // Estimates by sequence number, kept in a ring
+    std::vector<Point> points_;
+    uint64_t first_;                // Oldest estimate still held
+    uint64_t end_;                  // One past the newest
+    uint64_t next_;                 // First estimate the stream has not reached
+
+    // Note segmentation
+    bool note_voiced_;              // A note is sounding
+    float note_;                    // Its label
+    bool candidate_;                // A different note is waiting to be confirmed
+    uint64_t candidate_start_;
+    uint32_t candidate_count_;
+    float candidate_note_;
+
+    Point& at(uint64_t sequence) { return points_[sequence % points_.size()]; }
+
+    /**
+     * @brief Assign the newest estimate to a note, confirming pending notes
+     * @param sequence Sequence number of the estimate
+     */
+    void label(uint64_t sequence);
+
+    /**
+     * @brief Fix the input pitch and planned note of an estimate
+     * @param sequence Sequence number of the estimate
+     */
+    void finalize(uint64_t sequence);
+};
+
+} // namespace autotune
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "audio_types.h"
+#include <string>
+#include <vector>
+
+namespace autotune {
+
+/**
+ * @brief Recorded pitch analysis of one piece of audio
+ *
+ * A sequence of (position, pitch, confidence) estimates as produced by the
+ * engine's pitch tracker, one per analysis hop. The estimates depend only on
+ * the input audio and the detector settings, so a track recorded once can
+ * stand in for live detection when the same audio is rendered again with a
+ * different scale, key or strength (see AutotuneEngine::set_pitch_track()).
+ *
+ * The AnalysisKey identifies what the track is valid for: the detector
+ * settings, filled in by the engine when recording, and a hash of the input
+ * audio that the caller sets (e.g. from hash_samples() over the file).
+ */
+class PitchTrack {
+public:
+    /**
+     * @brief One pitch estimate
+     */
+    struct Point {
+        uint64_t position;      // First frame the estimate applies to
+        float pitch;            // Hz (0.0 = unvoiced)
+        float confidence;       // 0.0 - 1.0
+    };
+    
+    /**
+     * @brief Everything the estimates depend on
+     */
+    struct AnalysisKey {
+        uint64_t content_hash = 0;      // Caller-provided hash of the input audio
+        SampleRate sample_rate = 0;
+        uint32_t window_size = 0;
+        uint32_t hop_size = 0;
+        uint32_t algorithm = 0;         // PitchDetector::Algorithm
+        SampleRate analysis_rate = 0;
+        float min_frequency = 0.0f;
+        float max_frequency = 0.0f;
+        float confidence_threshold = 0.0f;
+        float gate_threshold = 0.0f;    // Silence gate RMS level (0 = no gate)
+        float smoothing = 0.0f;         // Detector smoothing factor
+        
+        bool operator==(const AnalysisKey& other) const;
+        bool operator!=(const AnalysisKey& other) const { return !(*this == other); }
+    };
+    
+    PitchTrack() = default;
+    
+    /**
+     * @brief Append an estimate (positions must not decrease)
+     * @param position First frame the estimate applies to
+     * @param pitch Detected pitch in Hz
+     * @param confidence Detection confidence
+     */
+    void add(uint64_t position, float pitch, float confidence) {
+        points_.push_back({position, pitch, confidence});
+    }
+    
+    /**
+     * @brief Remove all estimates (the key is kept)
+     */
+    void clear() { points_.clear(); }
+    
+    const std::vector<Point>& get_points() const { return points_; }
+    size_t size() const { return points_.size(); }
+    bool empty() const { return points_.empty(); }
+    
+    const AnalysisKey& get_key() const { return key_; }
+    void set_key(const AnalysisKey& key) { key_ = key; }
+    void set_content_hash(uint64_t content_hash) { key_.content_hash = content_hash; }
+    
+    /**
+     * @brief Encode key and estimates into the binary track format
+     * @return Serialized bytes (little-endian; positions delta-coded)
+     */
+    std::vector<uint8_t> serialize() const;
+    
+    /**
+     * @brief Decode a serialized track
+     * @param data Serialized bytes
+     * @param size Number of bytes
+     * @return False if the data is not a valid track (track unchanged)
+     */
+    bool deserialize(const uint8_t* data, size_t size);
+    
+    /**
+     * @brief Write the track to a file
+     * @param path File path
+     * @return True if the file was written completely
+     */
+    bool save(const std::string& path) const;
+    
+    /**
+     * @brief Read a track written by save()
+     * @param path File path
+     * @return False if the file is missing or invalid (track unchanged)
+     */
+    bool load(const std::string& path);
+    
+    /**
+     * @brief Fold samples into a 64-bit content hash (FNV-1a over the bit patterns)
+     *
+     * Call repeatedly with consecutive pieces of the audio, passing the
+     * previous result as seed; the result does not depend on how the audio
+     * was split.
+     * @param samples Samples (any layout, hashed in memory order)
+     * @param count Number of samples
+     * @param seed Hash of the preceding samples (kHashSeed to start)
+     * @return Updated hash
+     */
+    static uint64_t hash_samples(const Sample* samples, size_t count, uint64_t seed = kHashSeed);
+    
+    static constexpr uint64_t kHashSeed = 0xcbf29ce484222325ull;
+
+private:
+    AnalysisKey key_;
+    std::vector<Point> points_;
+};
+
+} // namespace autotune
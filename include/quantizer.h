@@ -11,6 +11,15 @@ namespace autotune {
  * 
  * This class provides quantization capabilities for both rhythmic
  * and pitch elements to help musicians stay in time and in tune.
+ * 
+ * Pitch quantization goes through a per-scale lookup table over one
+ * octave of fractional MIDI positions. The tables of the built-in scales
+ * are computed once per process and shared by every quantizer; only the
+ * custom scale's table is per instance and rebuilt when its intervals
+ * change. The key center is an
+ * offset into it and the strength is applied after the lookup, so neither
+ * invalidates it. Frequency/MIDI conversion on that path uses fast
+ * log2/exp2 approximations (well under 0.1 cent).
  */
 class Quantizer {
 public:
@@ -83,6 +92,19 @@ public:
     uint32_t quantize_timing(uint32_t input_time, GridResolution grid_resolution,
                            float strength = 1.0f);
     
+    /**
+     * @brief Quantize a stream position to rhythmic grid
+     *
+     * Same as above with the grid position in double precision, so grid
+     * targets stay sample-accurate over arbitrarily long streams.
+     * @param input_time Input time position (samples since the grid origin)
+     * @param grid_resolution Rhythmic grid resolution
+     * @param strength Quantization strength (0.0 - 1.0)
+     * @return Quantized time position (samples)
+     */
+    int64_t quantize_timing(int64_t input_time, GridResolution grid_resolution,
+                            float strength = 1.0f);
+    
     /**
      * @brief Set tempo for rhythmic quantization
      * @param tempo Tempo in beats per minute
@@ -101,6 +123,16 @@ public:
      */
     void set_custom_scale(const std::vector<int>& intervals);
     
+    /**
+     * @brief Make scale the one quantize_pitch() is tabulated for
+     * 
+     * quantize_pitch() does this itself when the scale changes; calling it
+     * up front keeps the (small) table rebuild off the audio thread.
+     * 
+     * @param scale Musical scale
+     */
+    void prepare_scale(Scale scale);
+    
     /**
      * @brief Get nearest note in scale
      * @param input_pitch Input frequency (Hz)
@@ -146,9 +178,24 @@ private:
     float tempo_;
     TimeSignature time_signature_;
     
-    // Scale definitions (intervals in semitones)
+    // Scale definitions (intervals in semitones), indexed by Scale
     std::array<std::vector<int>, 8> scale_intervals_;
-    std::vector<int> custom_scale_intervals_;
+    
+    // Nearest scale note for every 1 / kTableResolution semitone of the
+    // octave above the key center. Each bin holds at most one decision
+    // boundary, so lookups are exact.
+    static constexpr uint32_t kTableResolution = 32;
+    struct ScaleTableEntry {
+        float boundary;     // Octave position where the nearest note changes
+        float lower;        // Nearest note below the boundary (semitones from the octave start)
+        float upper;        // Nearest note from the boundary on
+    };
+    using ScaleTable = std::array<ScaleTableEntry, 12 * kTableResolution>;
+    ScaleTable custom_table_;
+    const ScaleTable* builtin_table_;   // Shared table of the tabulated built-in scale (nullptr = custom_table_)
+    Scale table_scale_;
+    bool table_valid_;
+    bool table_passthrough_;    // Tabulated scale has no notes
     
     // Timing calculations
     float samples_per_beat_;
@@ -164,6 +211,33 @@ private:
      */
     void update_timing();
     
+    /**
+     * @brief Tables of the built-in scales, shared by all instances
+     * @return Tables indexed by Scale (CUSTOM excluded)
+     */
+    static const std::array<ScaleTable, 7>& builtin_scale_tables();
+    
+    /**
+     * @brief Tabulate the nearest-note function of a set of intervals
+     * @param intervals Scale intervals (not empty)
+     * @param table Output table
+     */
+    static void fill_scale_table(const std::vector<int>& intervals, ScaleTable& table);
+    
+    /**
+     * @brief Select the table of a scale, tabulating a custom one
+     * @param scale Scale type
+     */
+    void build_scale_table(Scale scale);
+    
+    /**
+     * @brief Nearest note in the tabulated scale
+     * @param midi_note Input MIDI note (can be fractional)
+     * @param key_center Root note
+     * @return Nearest MIDI note in scale
+     */
+    float lookup_scale_note(float midi_note, int key_center) const;
+    
     /**
      * @brief Get scale intervals for given scale type
      * @param scale Scale type
@@ -178,16 +252,8 @@ private:
      * @param key_center Root note
      * @return Nearest MIDI note in scale
      */
-    float find_nearest_scale_note(float midi_note, const std::vector<int>& intervals,
-                                 int key_center) const;
-    
-    /**
-     * @brief Calculate grid position for timing quantization
-     * @param time_samples Time position in samples
-     * @param resolution Grid resolution
-     * @return Grid position
-     */
-    float calculate_grid_position(uint32_t time_samples, GridResolution resolution) const;
+    static float find_nearest_scale_note(float midi_note, const std::vector<int>& intervals,
+                                        int key_center);
     
     /**
      * @brief Get samples per grid unit
@@ -0,0 +1,165 @@
+#pragma once
+
+#include "audio_types.h"
+#include "quantizer.h"
+#include <array>
+#include <cstddef>
+#include <vector>
+
+namespace autotune {
+
+/**
+ * @brief Streaming rhythmic quantizer: slips transients onto the tempo grid
+ *
+ * Onsets are detected from the energy of short hops against a decaying
+ * envelope of the hops before them, and each one is given a slip towards
+ * the nearest grid position from Quantizer::quantize_timing(). The output
+ * plays the input through a fixed delay with the current slip added to the
+ * read position; a new slip takes over with a short crossfade placed just
+ * before its onset, so the transient itself is played untouched and the
+ * gap or overlap the move leaves falls into the material before it.
+ *
+ * The delay is the largest slip plus the fade and detection time, so
+ * onsets are known before the output reaches them. Between switches the
+ * output is a straight copy from the delay line; samples are only mixed
+ * during the fades and only touched again when an onset is refined, so the
+ * cost beyond the copy grows with the number of onsets, not the length of
+ * the audio.
+ *
+ * All storage is sized in prepare(); process() never allocates.
+ */
+class RhythmQuantizer {
+public:
+    /**
+     * @brief Construct RhythmQuantizer
+     * @param sample_rate Audio sample rate
+     * @param channels Number of audio channels
+     */
+    RhythmQuantizer(SampleRate sample_rate, ChannelCount channels);
+
+    /**
+     * @brief Size the delay line for a block size (allocates; not for the audio thread)
+     *
+     * Clears the stream as reset() does.
+     * @param max_block Largest frame count passed to process()
+     */
+    void prepare(uint32_t max_block);
+
+    /**
+     * @brief Quantize one block of planar audio
+     *
+     * Input and output may be the same buffers.
+     * @param input Input channel pointers
+     * @param output Output channel pointers
+     * @param channel_count Channels in the block (at most the constructed count)
+     * @param frame_count Frames in the block (at most the prepared block size)
+     * @param quantizer Quantizer holding the tempo grid
+     * @param grid Grid resolution onsets are moved to
+     * @param strength How far onsets move towards the grid (0.0 - 1.0)
+     * @return Processing result
+     */
+    ProcessingResult process(const Sample* const* input, Sample* const* output, ChannelCount channel_count,
+                             uint32_t frame_count, Quantizer& quantizer, Quantizer::GridResolution grid,
+                             float strength);
+
+    /**
+     * @brief Restart the stream (no onsets, nothing slipped, silent delay line)
+     * @param position Grid position of the next input frame (samples, may be negative)
+     */
+    void reset(int64_t position = 0);
+
+    uint32_t get_latency_samples() const { return latency_; }
+    uint32_t get_max_slip() const { return max_slip_; }
+    uint32_t get_max_block_size() const { return max_block_; }
+
+    /**
+     * @brief Onsets detected since the last reset
+     */
+    uint64_t get_onset_count() const { return onset_count_; }
+
+private:
+    /**
+     * @brief A slip taking effect at an output frame
+     */
+    struct Switch {
+        int64_t time;       // Output frame the fade starts at
+        int64_t slip;       // Frames the read position is moved by
+    };
+
+    static constexpr uint32_t kMaxSwitches = 16;
+
+    SampleRate sample_rate_;
+    ChannelCount channels_;
+    uint32_t hop_size_;             // Onset detection resolution
+    uint32_t fade_;                 // Crossfade length
+    uint32_t pre_roll_;             // Fades end this long before their onset
+    uint32_t max_slip_;
+    uint32_t latency_;
+    uint32_t min_onset_interval_;
+    uint32_t max_block_;
+    std::vector<float> fade_curve_; // Fade-in gains
+
+    // Delay line: planar, one power-of-two ring per channel
+    std::vector<Sample> ring_;
+    uint32_t ring_size_;
+    uint32_t ring_mask_;
+    int64_t origin_;                // First stream frame (reads before it are silent)
+    int64_t written_;               // One past the newest input frame
+
+    // Onset detection
+    uint32_t hop_fill_;
+    double hop_energy_;
+    float envelope_;                // Decaying peak of recent hop energies
+    int64_t last_onset_;
+    uint64_t onset_count_;
+
+    // Slips
+    std::array<Switch, kMaxSwitches> switches_;
+    uint32_t switch_head_;
+    uint32_t switch_count_;
+    int64_t scheduled_slip_;        // Slip after the newest scheduled switch
+    int64_t scheduled_end_;         // Output frame its fade ends at
+    int64_t slip_;                  // Slip being played
+    int64_t fade_from_;             // Slip being faded out
+    int64_t fade_start_;
+    bool fading_;
+
+    Sample* ring_channel(ChannelCount ch) { return ring_.data() + static_cast<size_t>(ch) * ring_size_; }
+
+    /**
+     * @brief Check the hop that just filled for an onset
+     * @param channel_count Channels written to the delay line
+     */
+    void end_hop(ChannelCount channel_count, Quantizer& quantizer, Quantizer::GridResolution grid,
+                 float strength);
+
+    /**
+     * @brief First frame of the newest hop at onset level
+     * @param channel_count Channels written to the delay line
+     * @param threshold Absolute sample level of the onset
+     */
+    int64_t refine_onset(ChannelCount channel_count, float threshold);
+
+    /**
+     * @brief Queue the slip moving an onset onto the grid
+     */
+    void schedule(int64_t onset, Quantizer& quantizer, Quantizer::GridResolution grid, float strength);
+
+    /**
+     * @brief Copy delayed input frames from the ring (silence before the stream)
+     * @param ch Channel
+     * @param position Stream frame of the first sample
+     * @param destination Output samples
+     * @param count Frames to copy
+     */
+    void read(ChannelCount ch, int64_t position, Sample* destination, uint32_t count);
+
+    /**
+     * @brief Sample of the delay line (silence before the stream)
+     */
+    Sample sample_at(ChannelCount ch, int64_t position) {
+        return position < origin_ ? 0.0f : ring_channel(ch)[static_cast<uint64_t>(position) & ring_mask_];
+    }
+};
+
+} // namespace autotune
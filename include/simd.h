@@ -0,0 +1,203 @@
+#pragma once
+
+#include "audio_types.h"
+
+namespace autotune {
+namespace simd {
+
+/**
+ * @brief Instruction sets available to the kernel dispatcher
+ */
+enum class InstructionSet {
+    SCALAR,     // Portable reference implementation
+    SSE2,       // x86 128-bit
+    AVX2,       // x86 256-bit (selected at runtime when the CPU supports it)
+    NEON        // ARM 128-bit
+};
+
+/**
+ * @brief Get the instruction set the kernels currently dispatch to
+ * @return Active instruction set (best supported one by default)
+ */
+InstructionSet active_instruction_set();
+
+/**
+ * @brief Force a specific instruction set (for testing and A/B comparisons)
+ * @param instruction_set Instruction set to use
+ * @return False if the CPU or build does not support it (selection unchanged)
+ */
+bool set_instruction_set(InstructionSet instruction_set);
+
+/**
+ * @brief Check whether an instruction set can be used on this machine
+ * @param instruction_set Instruction set to query
+ * @return True if supported by both the build and the CPU
+ */
+bool is_supported(InstructionSet instruction_set);
+
+/**
+ * @brief Get printable instruction set name
+ * @param instruction_set Instruction set
+ * @return Name string
+ */
+const char* instruction_set_name(InstructionSet instruction_set);
+
+/**
+ * @brief Element-wise multiply (windowing): output[i] = a[i] * b[i]
+ * @param a First input
+ * @param b Second input
+ * @param output Output (may alias a or b)
+ * @param count Number of samples
+ */
+void multiply(const Sample* a, const Sample* b, Sample* output, uint32_t count);
+
+/**
+ * @brief Two-channel mix: output[i] = (a[i] + b[i]) * gain
+ * @param a First input
+ * @param b Second input
+ * @param output Output (may alias a or b)
+ * @param gain Gain applied to the sum
+ * @param count Number of samples
+ */
+void mix(const Sample* a, const Sample* b, Sample* output, float gain, uint32_t count);
+
+/**
+ * @brief Average any number of planar channels into one
+ * @param channels Channel pointers
+ * @param channel_count Number of channels
+ * @param output Mono output
+ * @param count Number of samples
+ */
+void downmix(const Sample* const* channels, ChannelCount channel_count, Sample* output, uint32_t count);
+
+/**
+ * @brief Apply gain: output[i] = input[i] * gain
+ * @param input Input samples
+ * @param gain Gain factor
+ * @param output Output (may alias input)
+ * @param count Number of samples
+ */
+void scale(const Sample* input, float gain, Sample* output, uint32_t count);
+
+/**
+ * @brief Dot product (correlation term): sum of a[i] * b[i]
+ * @param a First input
+ * @param b Second input
+ * @param count Number of samples
+ * @return Dot product
+ */
+float dot(const Sample* a, const Sample* b, uint32_t count);
+
+/**
+ * @brief Scale lane-interleaved frames: output[i * lanes + v] = input[i * lanes + v] * gains[i]
+ *
+ * Lane-interleaved buffers hold one value per voice for each frame i, so
+ * one vector operation covers several voices at the same position.
+ * @param input Interleaved input (count * lanes values)
+ * @param gains One gain per frame (e.g. a window)
+ * @param output Interleaved output (may alias input)
+ * @param lanes Values per frame
+ * @param count Number of frames
+ */
+void scale_lanes(const Sample* input, const float* gains, Sample* output, uint32_t lanes, uint32_t count);
+
+/**
+ * @brief Per-lane dot products: output[v] = sum of a[i * lanes + v] * b[i * lanes + v]
+ * @param a First interleaved input
+ * @param b Second interleaved input
+ * @param output One result per lane
+ * @param lanes Values per frame
+ * @param count Number of frames
+ */
+void dot_lanes(const Sample* a, const Sample* b, float* output, uint32_t lanes, uint32_t count);
+
+/**
+ * @brief One radix-2 FFT stage on lane-interleaved split-complex rows
+ *
+ * Row r is the complex value re[r * lanes + v] + i im[r * lanes + v] of
+ * lane v. The rows form groups of 2 * half_length; within each group, rows
+ * j and j + half_length become a + w b and a - w b with
+ * w = twiddles[j * twiddle_step], so one call performs a whole
+ * decimation-in-time stage for every lane at once.
+ * @param re Real parts (row_count * lanes values)
+ * @param im Imaginary parts
+ * @param twiddles Interleaved (real, imaginary) twiddle factors
+ * @param twiddle_step Twiddle index stride of the stage
+ * @param half_length Butterflies per group
+ * @param row_count Total rows (a multiple of 2 * half_length)
+ * @param lanes Values per row
+ * @param inverse Use conjugate twiddles
+ */
+void butterfly_lanes(Sample* re, Sample* im, const float* twiddles, uint32_t twiddle_step,
+                     uint32_t half_length, uint32_t row_count, uint32_t lanes, bool inverse);
+
+/**
+ * @brief Two consecutive radix-2 FFT stages on lane-interleaved split-complex rows
+ *
+ * Same as butterfly_lanes() with half_length = quarter_length followed by
+ * half_length = 2 * quarter_length, but each row is loaded and stored once
+ * for both stages.
+ * @param re Real parts (row_count * lanes values)
+ * @param im Imaginary parts
+ * @param twiddles Interleaved (real, imaginary) twiddle factors
+ * @param twiddle_step Twiddle index stride of the second stage
+ * @param quarter_length Butterflies per group of the first stage
+ * @param row_count Total rows (a multiple of 4 * quarter_length)
+ * @param lanes Values per row
+ * @param inverse Use conjugate twiddles
+ */
+void fused_butterfly_lanes(Sample* re, Sample* im, const float* twiddles, uint32_t twiddle_step,
+                           uint32_t quarter_length, uint32_t row_count, uint32_t lanes, bool inverse);
+
+/**
+ * @brief Convert 16-bit PCM to float: output[i] = input[i] / 32768
+ * @param input PCM samples
+ * @param output Float samples
+ * @param count Number of samples
+ */
+void int16_to_float(const int16_t* input, Sample* output, uint32_t count);
+
+/**
+ * @brief Convert float to 16-bit PCM (rounded to nearest, clipped to full scale)
+ * @param input Float samples
+ * @param output PCM samples
+ * @param count Number of samples
+ */
+void float_to_int16(const Sample* input, int16_t* output, uint32_t count);
+
+/**
+ * @brief Convert packed little-endian 24-bit PCM to float: output[i] = value / 2^23
+ * @param input PCM bytes (3 per sample)
+ * @param output Float samples
+ * @param count Number of samples
+ */
+void int24_to_float(const uint8_t* input, Sample* output, uint32_t count);
+
+/**
+ * @brief Convert float to packed little-endian 24-bit PCM (rounded, clipped)
+ * @param input Float samples
+ * @param output PCM bytes (3 per sample)
+ * @param count Number of samples
+ */
+void float_to_int24(const Sample* input, uint8_t* output, uint32_t count);
+
+/**
+ * @brief Scalar reference kernels (always available, never dispatched)
+ */
+namespace scalar {
+void multiply(const Sample* a, const Sample* b, Sample* output, uint32_t count);
+void mix(const Sample* a, const Sample* b, Sample* output, float gain, uint32_t count);
+void scale(const Sample* input, float gain, Sample* output, uint32_t count);
+float dot(const Sample* a, const Sample* b, uint32_t count);
+void scale_lanes(const Sample* input, const float* gains, Sample* output, uint32_t lanes, uint32_t count);
+void dot_lanes(const Sample* a, const Sample* b, float* output, uint32_t lanes, uint32_t count);
+void butterfly_lanes(Sample* re, Sample* im, const float* twiddles, uint32_t twiddle_step,
+                     uint32_t half_length, uint32_t row_count, uint32_t lanes, bool inverse);
+void fused_butterfly_lanes(Sample* re, Sample* im, const float* twiddles, uint32_t twiddle_step,
+                           uint32_t quarter_length, uint32_t row_count, uint32_t lanes, bool inverse);
+void int16_to_float(const int16_t* input, Sample* output, uint32_t count);
+void float_to_int16(const Sample* input, int16_t* output, uint32_t count);
+} // namespace scalar
+
+} // namespace simd
+} // namespace autotune
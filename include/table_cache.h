@@ -0,0 +1,57 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace autotune {
+
+/**
+ * @brief Process-wide cache of immutable lookup tables
+ *
+ * Windows, FFT twiddles and filter designs depend only on a size or two,
+ * so every engine created for the same sample rate and buffer size would
+ * compute identical copies. Tables are built on first request under a lock
+ * and shared from then on; they live until the process exits. Requesting
+ * one may allocate and lock, so it belongs in constructors and
+ * reconfiguration, never on the audio thread.
+ *
+ * @tparam Tag Type distinguishing tables that share key and table types
+ * @tparam Key Ordered key the table depends on
+ * @tparam Table Table type
+ */
+template <typename Tag, typename Key, typename Table>
+class TableCache {
+public:
+    /**
+     * @brief Get the table for a key, building it on first use
+     * @param key Table parameters
+     * @param build Callable returning the table for key
+     * @return Shared immutable table
+     */
+    template <typename Build>
+    static std::shared_ptr<const Table> get(const Key& key, Build&& build) {
+        Storage& storage = instance();
+        std::lock_guard<std::mutex> lock(storage.mutex);
+        auto found = storage.tables.find(key);
+        if (found != storage.tables.end()) {
+            return found->second;
+        }
+        std::shared_ptr<const Table> table = std::make_shared<const Table>(build());
+        storage.tables.emplace(key, table);
+        return table;
+    }
+
+private:
+    struct Storage {
+        std::mutex mutex;
+        std::map<Key, std::shared_ptr<const Table>> tables;
+    };
+
+    static Storage& instance() {
+        static Storage storage;
+        return storage;
+    }
+};
+
+} // namespace autotune
@@ -0,0 +1,168 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#if defined(AUTOTUNE_TRACY)
+#include <tracy/Tracy.hpp>
+#endif
+
+namespace autotune {
+
+/**
+ * @brief Scoped timing zones on the processing hot path
+ *
+ * Zones are placed with the AUTOTUNE_TRACE_* macros below. Builds configured
+ * with -DAUTOTUNE_TRACING=ON record every zone into a fixed ring per thread;
+ * otherwise the macros expand to nothing and their arguments are never
+ * evaluated. With -DAUTOTUNE_TRACY=ON the zones are also sent to Tracy.
+ *
+ * Only the owning thread writes its ring (a release fence, relaxed slot
+ * stores and one release store per zone, no locks); once full, the oldest
+ * zones are overwritten.
+ * collect() and the exporters may run on any thread while zones are being
+ * recorded; they skip zones that may have been overwritten while reading,
+ * so a full ring yields its newest kRingCapacity - 1 zones. A thread's
+ * first zone allocates and registers its ring under a lock; call
+ * register_thread() during setup to keep that off the audio thread.
+ */
+namespace trace {
+
+constexpr uint32_t kRingCapacity = 8192;    // Zones kept per thread
+constexpr int32_t kNoVoice = -1;
+
+/**
+ * @brief One recorded zone
+ */
+struct Event {
+    const char* name;       // Static string passed to the zone
+    uint64_t start_ns;      // Since the trace clock's epoch
+    uint64_t duration_ns;
+    uint32_t thread;        // Registration order of the recording thread
+    int32_t voice;          // Voice the zone worked on (kNoVoice if none)
+};
+
+/**
+ * @brief Recording thread as listed in an export
+ */
+struct ThreadInfo {
+    uint32_t thread;
+    std::string name;       // Empty if never named
+};
+
+/**
+ * @brief Current time on the trace clock
+ * @return Nanoseconds since the first call in this process
+ */
+uint64_t now();
+
+/**
+ * @brief Append a finished zone to the calling thread's ring
+ * @param name Zone name (must outlive every export, e.g. a string literal)
+ * @param start_ns Start time from now()
+ * @param end_ns End time from now()
+ * @param voice Voice index (kNoVoice if none)
+ */
+void record(const char* name, uint64_t start_ns, uint64_t end_ns, int32_t voice = kNoVoice);
+
+/**
+ * @brief Create the calling thread's ring if it has none yet
+ */
+void register_thread();
+
+/**
+ * @brief Name the calling thread in exports (registers it)
+ * @param name Thread name
+ */
+void set_thread_name(const char* name);
+
+/**
+ * @brief Copy the recorded zones of every thread
+ * @return Zones ordered by start time
+ */
+std::vector<Event> collect();
+
+/**
+ * @brief List every registered thread
+ * @return Threads in registration order
+ */
+std::vector<ThreadInfo> threads();
+
+/**
+ * @brief Drop the zones recorded so far (recording continues)
+ */
+void clear();
+
+/**
+ * @brief Render the recorded zones as Chrome trace event JSON
+ *
+ * The result loads in chrome://tracing and Perfetto: one complete ("X")
+ * event per zone with timestamps in microseconds, the voice as an
+ * argument, and thread name metadata.
+ * @return JSON document
+ */
+std::string export_chrome_json();
+
+/**
+ * @brief Write export_chrome_json() to a file
+ * @param path File path
+ * @return True if the file was written completely
+ */
+bool save_chrome_json(const std::string& path);
+
+/**
+ * @brief Records the enclosing scope as a zone
+ */
+class Zone {
+public:
+    explicit Zone(const char* name, int32_t voice = kNoVoice)
+        : name_(name), voice_(voice), start_ns_(now()) {}
+
+    ~Zone() { record(name_, start_ns_, now(), voice_); }
+
+private:
+    const char* name_;
+    int32_t voice_;
+    uint64_t start_ns_;
+
+    // Non-copyable
+    Zone(const Zone&) = delete;
+    Zone& operator=(const Zone&) = delete;
+};
+
+} // namespace trace
+
+} // namespace autotune
+
+#define AUTOTUNE_TRACE_CONCAT_INNER(a, b) a##b
+#define AUTOTUNE_TRACE_CONCAT(a, b) AUTOTUNE_TRACE_CONCAT_INNER(a, b)
+
+#if defined(AUTOTUNE_TRACY)
+#define AUTOTUNE_TRACY_ZONE(name) ZoneScopedN(name)
+#define AUTOTUNE_TRACY_ZONE_VOICE(name, voice) ZoneScopedN(name); ZoneValue(static_cast<uint64_t>(voice))
+#define AUTOTUNE_TRACY_THREAD_NAME(name) tracy::SetThreadName(name)
+#else
+#define AUTOTUNE_TRACY_ZONE(name) static_cast<void>(0)
+#define AUTOTUNE_TRACY_ZONE_VOICE(name, voice) static_cast<void>(0)
+#define AUTOTUNE_TRACY_THREAD_NAME(name) static_cast<void>(0)
+#endif
+
+#if defined(AUTOTUNE_TRACING)
+// Time the rest of the enclosing scope (name must be a string literal)
+#define AUTOTUNE_TRACE_ZONE(name) \
+    AUTOTUNE_TRACY_ZONE(name); \
+    ::autotune::trace::Zone AUTOTUNE_TRACE_CONCAT(autotune_trace_zone_, __LINE__)(name)
+// Same, tagged with the voice being processed
+#define AUTOTUNE_TRACE_ZONE_VOICE(name, voice) \
+    AUTOTUNE_TRACY_ZONE_VOICE(name, voice); \
+    ::autotune::trace::Zone AUTOTUNE_TRACE_CONCAT(autotune_trace_zone_, __LINE__)(name, static_cast<int32_t>(voice))
+// Name the calling thread in exports
+#define AUTOTUNE_TRACE_THREAD_NAME(name) \
+    AUTOTUNE_TRACY_THREAD_NAME(name); \
+    ::autotune::trace::set_thread_name(name)
+#else
+#define AUTOTUNE_TRACE_ZONE(name) static_cast<void>(0)
+#define AUTOTUNE_TRACE_ZONE_VOICE(name, voice) static_cast<void>(0)
+#define AUTOTUNE_TRACE_THREAD_NAME(name) static_cast<void>(0)
+#endif
@@ -4,12 +4,28 @@
 
 namespace autotune {
 
-AudioBuffer::AudioBuffer(uint32_t capacity, ChannelCount channels)
-    : capacity_(capacity), channels_(channels), read_pos_(0), write_pos_(0) {
-    buffer_.resize(capacity);
-    for (auto& frame : buffer_) {
-        frame = AudioFrame(channels);
+namespace {
+
+uint32_t round_up_power_of_two(uint32_t value) {
+    uint32_t result = 1;
+    while (result < value) {
+        result <<= 1;
     }
+    return result;
+}
+
+} // namespace
+
+AudioBuffer::AudioBuffer(uint32_t capacity, ChannelCount channels)
+    : capacity_(std::max(capacity, 1u)), storage_size_(round_up_power_of_two(std::max(capacity, 1u))),
+      mask_(storage_size_ - 1), channels_(channels),
+      write_pos_(0), cached_read_pos_(0), read_pos_(0), cached_write_pos_(0) {
+    buffer_.resize(static_cast<size_t>(storage_size_) * channels_, 0.0f);
+    
+    write_first_.resize(channels_);
+    write_second_.resize(channels_);
+    read_first_.resize(channels_);
+    read_second_.resize(channels_);
 }
 
 AudioBuffer::~AudioBuffer() = default;
@@ -17,74 +33,166 @@ AudioBuffer::~AudioBuffer() = default;
 uint32_t AudioBuffer::write(const AudioFrame* frames, uint32_t frame_count) {
     if (!frames || frame_count == 0) return 0;
     
-    uint32_t written = 0;
-    uint32_t current_write = write_pos_;
+    uint32_t to_write = std::min(frame_count, producer_space(frame_count));
+    uint32_t current_write = write_pos_.load(std::memory_order_relaxed);
     
-    for (uint32_t i = 0; i < frame_count && !full(); ++i) {
-        // Copy frame data
-        for (ChannelCount ch = 0; ch < channels_ && ch < frames[i].size(); ++ch) {
-            buffer_[current_write][ch] = frames[i][ch];
+    for (ChannelCount ch = 0; ch < channels_; ++ch) {
+        Sample* ring = channel_data(ch);
+        for (uint32_t i = 0; i < to_write; ++i) {
+            ring[(current_write + i) & mask_] = ch < frames[i].size() ? frames[i][ch] : 0.0f;
         }
-        
-        current_write = (current_write + 1) % capacity_;
-        ++written;
     }
     
-    write_pos_ = current_write;
-    return written;
+    write_pos_.store(current_write + to_write, std::memory_order_release);
+    return to_write;
 }
 
 uint32_t AudioBuffer::read(AudioFrame* frames, uint32_t frame_count) {
     if (!frames || frame_count == 0) return 0;
     
-    uint32_t read = 0;
-    uint32_t current_read = read_pos_;
+    uint32_t to_read = std::min(frame_count, consumer_available(frame_count));
+    uint32_t current_read = read_pos_.load(std::memory_order_relaxed);
     
-    for (uint32_t i = 0; i < frame_count && !empty(); ++i) {
-        // Copy frame data
-        frames[i] = AudioFrame(channels_);
-        for (ChannelCount ch = 0; ch < channels_; ++ch) {
-            frames[i][ch] = buffer_[current_read][ch];
+    for (uint32_t i = 0; i < to_read; ++i) {
+        // Copy frame data (only reallocates frames of the wrong width)
+        if (frames[i].size() != channels_) {
+            frames[i] = AudioFrame(channels_);
         }
-        
-        current_read = (current_read + 1) % capacity_;
-        ++read;
     }
     
-    read_pos_ = current_read;
-    return read;
+    for (ChannelCount ch = 0; ch < channels_; ++ch) {
+        const Sample* ring = channel_data(ch);
+        for (uint32_t i = 0; i < to_read; ++i) {
+            frames[i][ch] = ring[(current_read + i) & mask_];
+        }
+    }
+    
+    read_pos_.store(current_read + to_read, std::memory_order_release);
+    return to_read;
 }
 
-uint32_t AudioBuffer::available() const {
-    if (write_pos_ >= read_pos_) {
-        return write_pos_ - read_pos_;
-    } else {
-        return capacity_ - read_pos_ + write_pos_;
+uint32_t AudioBuffer::write(const AudioBlockView& block) {
+    if (!block.valid() || block.frame_count == 0) return 0;
+    
+    uint32_t to_write = std::min(block.frame_count, producer_space(block.frame_count));
+    Region region = make_region(write_pos_.load(std::memory_order_relaxed), to_write,
+                                write_first_, write_second_);
+    uint32_t first_count = region.first.frame_count;
+    uint32_t second_count = region.second.frame_count;
+    
+    for (ChannelCount ch = 0; ch < channels_; ++ch) {
+        if (ch < block.channel_count) {
+            std::memcpy(region.first.channels[ch], block.channels[ch], first_count * sizeof(Sample));
+            std::memcpy(region.second.channels[ch], block.channels[ch] + first_count, second_count * sizeof(Sample));
+        } else {
+            std::memset(region.first.channels[ch], 0, first_count * sizeof(Sample));
+            std::memset(region.second.channels[ch], 0, second_count * sizeof(Sample));
+        }
     }
+    
+    commit_write(to_write);
+    return to_write;
+}
+
+uint32_t AudioBuffer::read(AudioBlockView& block) {
+    if (!block.valid() || block.frame_count == 0) return 0;
+    
+    Region region = peek_read(block.frame_count);
+    uint32_t first_count = region.first.frame_count;
+    uint32_t second_count = region.second.frame_count;
+    ChannelCount channel_count = std::min(channels_, block.channel_count);
+    
+    for (ChannelCount ch = 0; ch < channel_count; ++ch) {
+        std::memcpy(block.channels[ch], region.first.channels[ch], first_count * sizeof(Sample));
+        std::memcpy(block.channels[ch] + first_count, region.second.channels[ch], second_count * sizeof(Sample));
+    }
+    
+    release_read(region.frame_count());
+    return region.frame_count();
+}
+
+AudioBuffer::Region AudioBuffer::acquire_write(uint32_t frame_count) {
+    uint32_t to_write = std::min(frame_count, producer_space(frame_count));
+    return make_region(write_pos_.load(std::memory_order_relaxed), to_write,
+                       write_first_, write_second_);
+}
+
+void AudioBuffer::commit_write(uint32_t frame_count) {
+    uint32_t current_write = write_pos_.load(std::memory_order_relaxed);
+    write_pos_.store(current_write + frame_count, std::memory_order_release);
+}
+
+AudioBuffer::Region AudioBuffer::peek_read(uint32_t frame_count) {
+    uint32_t to_read = std::min(frame_count, consumer_available(frame_count));
+    return make_region(read_pos_.load(std::memory_order_relaxed), to_read,
+                       read_first_, read_second_);
+}
+
+void AudioBuffer::release_read(uint32_t frame_count) {
+    uint32_t current_read = read_pos_.load(std::memory_order_relaxed);
+    read_pos_.store(current_read + frame_count, std::memory_order_release);
+}
+
+uint32_t AudioBuffer::available() const {
+    uint32_t write = write_pos_.load(std::memory_order_acquire);
+    uint32_t read = read_pos_.load(std::memory_order_acquire);
+    return write - read;
 }
 
 uint32_t AudioBuffer::space() const {
-    return capacity_ - available() - 1; // -1 to distinguish full from empty
+    return capacity_ - available();
 }
 
 bool AudioBuffer::empty() const {
-    return read_pos_ == write_pos_;
+    return available() == 0;
 }
 
 bool AudioBuffer::full() const {
-    return ((write_pos_ + 1) % capacity_) == read_pos_;
+    return available() >= capacity_;
 }
 
 void AudioBuffer::clear() {
-    read_pos_ = 0;
-    write_pos_ = 0;
+    write_pos_.store(0, std::memory_order_relaxed);
+    read_pos_.store(0, std::memory_order_relaxed);
+    cached_read_pos_ = 0;
+    cached_write_pos_ = 0;
     
     // Clear buffer contents
-    for (auto& frame : buffer_) {
-        for (ChannelCount ch = 0; ch < channels_; ++ch) {
-            frame[ch] = 0.0f;
-        }
+    std::fill(buffer_.begin(), buffer_.end(), 0.0f);
+}
+
+AudioBuffer::Region AudioBuffer::make_region(uint32_t position, uint32_t frame_count,
+                                             std::vector<Sample*>& first, std::vector<Sample*>& second) {
+    uint32_t start = position & mask_;
+    uint32_t first_count = std::min(frame_count, storage_size_ - start);
+    uint32_t second_count = frame_count - first_count;
+    
+    for (ChannelCount ch = 0; ch < channels_; ++ch) {
+        first[ch] = channel_data(ch) + start;
+        second[ch] = channel_data(ch);
+    }
+    
+    Region region;
+    region.first = AudioBlockView(first.data(), channels_, first_count);
+    region.second = AudioBlockView(second.data(), channels_, second_count);
+    return region;
+}
+
+uint32_t AudioBuffer::producer_space(uint32_t wanted) {
+    uint32_t current_write = write_pos_.load(std::memory_order_relaxed);
+    if (capacity_ - (current_write - cached_read_pos_) < wanted) {
+        // Cached consumer position is stale; refresh from the shared line
+        cached_read_pos_ = read_pos_.load(std::memory_order_acquire);
+    }
+    return capacity_ - (current_write - cached_read_pos_);
+}
+
+uint32_t AudioBuffer::consumer_available(uint32_t wanted) {
+    uint32_t current_read = read_pos_.load(std::memory_order_relaxed);
+    if (cached_write_pos_ - current_read < wanted) {
+        cached_write_pos_ = write_pos_.load(std::memory_order_acquire);
     }
+    return cached_write_pos_ - current_read;
 }
 
 } // namespace autotune
@@ -0,0 +1,553 @@
+#include "audio_file.h"
+#include "simd.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define AUTOTUNE_HAVE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace autotune {
+
+namespace {
+
+// Conversions run in pieces that fit the uint32_t kernel counts
+constexpr uint32_t kConvertSamples = 1u << 20;
+
+// Consumed mapping is handed back to the OS in steps of this size
+constexpr uint64_t kReleaseBytes = 32ull << 20;
+
+constexpr uint16_t kFormatPcm = 0x0001;
+constexpr uint16_t kFormatFloat = 0x0003;
+constexpr uint16_t kFormatExtensible = 0xFFFE;
+
+constexpr uint32_t kRiffHeaderBytes = 12;
+constexpr uint32_t kDs64Bytes = 28;     // riff size, data size, sample count, table length
+constexpr uint32_t kSizePlaceholder = 0xFFFFFFFF;
+
+uint16_t read_u16(const uint8_t* bytes) {
+    return static_cast<uint16_t>(bytes[0] | bytes[1] << 8);
+}
+
+uint32_t read_u32(const uint8_t* bytes) {
+    return static_cast<uint32_t>(bytes[0]) | static_cast<uint32_t>(bytes[1]) << 8 |
+           static_cast<uint32_t>(bytes[2]) << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+}
+
+uint64_t read_u64(const uint8_t* bytes) {
+    return static_cast<uint64_t>(read_u32(bytes)) | static_cast<uint64_t>(read_u32(bytes + 4)) << 32;
+}
+
+void append_id(std::vector<uint8_t>& bytes, const char* id) {
+    bytes.insert(bytes.end(), id, id + 4);
+}
+
+void append_u16(std::vector<uint8_t>& bytes, uint16_t value) {
+    bytes.push_back(static_cast<uint8_t>(value));
+    bytes.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void append_u32(std::vector<uint8_t>& bytes, uint32_t value) {
+    append_u16(bytes, static_cast<uint16_t>(value));
+    append_u16(bytes, static_cast<uint16_t>(value >> 16));
+}
+
+void append_u64(std::vector<uint8_t>& bytes, uint64_t value) {
+    append_u32(bytes, static_cast<uint32_t>(value));
+    append_u32(bytes, static_cast<uint32_t>(value >> 32));
+}
+
+bool seek_file(std::FILE* file, uint64_t offset) {
+#if defined(_WIN32)
+    return _fseeki64(file, static_cast<__int64>(offset), SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+/**
+ * @brief Convert encoded samples to float
+ */
+void decode_samples(const uint8_t* input, SampleFormat format, Sample* output, size_t count) {
+    uint32_t sample_bytes = bytes_per_sample(format);
+    while (count > 0) {
+        uint32_t piece = static_cast<uint32_t>(std::min<size_t>(count, kConvertSamples));
+        switch (format) {
+            case SampleFormat::INT16:
+                simd::int16_to_float(reinterpret_cast<const int16_t*>(input), output, piece);
+                break;
+            case SampleFormat::INT24:
+                simd::int24_to_float(input, output, piece);
+                break;
+            case SampleFormat::FLOAT32:
+                std::memcpy(output, input, piece * sizeof(Sample));
+                break;
+        }
+        input += static_cast<size_t>(piece) * sample_bytes;
+        output += piece;
+        count -= piece;
+    }
+}
+
+/**
+ * @brief Convert float samples to an encoding
+ */
+void encode_samples(const Sample* input, SampleFormat format, uint8_t* output, size_t count) {
+    uint32_t sample_bytes = bytes_per_sample(format);
+    while (count > 0) {
+        uint32_t piece = static_cast<uint32_t>(std::min<size_t>(count, kConvertSamples));
+        switch (format) {
+            case SampleFormat::INT16:
+                simd::float_to_int16(input, reinterpret_cast<int16_t*>(output), piece);
+                break;
+            case SampleFormat::INT24:
+                simd::float_to_int24(input, output, piece);
+                break;
+            case SampleFormat::FLOAT32:
+                std::memcpy(output, input, piece * sizeof(Sample));
+                break;
+        }
+        input += piece;
+        output += static_cast<size_t>(piece) * sample_bytes;
+        count -= piece;
+    }
+}
+
+} // namespace
+
+uint32_t bytes_per_sample(SampleFormat format) {
+    switch (format) {
+        case SampleFormat::INT16: return 2;
+        case SampleFormat::INT24: return 3;
+        case SampleFormat::FLOAT32: return 4;
+        default: return 0;
+    }
+}
+
+const char* sample_format_name(SampleFormat format) {
+    switch (format) {
+        case SampleFormat::INT16: return "int16";
+        case SampleFormat::INT24: return "int24";
+        case SampleFormat::FLOAT32: return "float32";
+        default: return "unknown";
+    }
+}
+
+bool parse_sample_format(const std::string& name, SampleFormat& format) {
+    const SampleFormat formats[] = {SampleFormat::INT16, SampleFormat::INT24, SampleFormat::FLOAT32};
+    for (SampleFormat candidate : formats) {
+        if (name == sample_format_name(candidate)) {
+            format = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+// AudioFileReader
+
+AudioFileReader::AudioFileReader()
+    : memory_mapping_(true), file_(nullptr), map_(nullptr), map_size_(0), released_(0),
+      file_size_(0), position_(0) {
+}
+
+AudioFileReader::~AudioFileReader() {
+    close();
+}
+
+bool AudioFileReader::open(const std::string& path) {
+    if (!open_file(path)) {
+        return false;
+    }
+    if (!parse_header()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool AudioFileReader::open_raw(const std::string& path, SampleRate sample_rate, ChannelCount channels,
+                               SampleFormat format) {
+    if (!open_file(path)) {
+        return false;
+    }
+    info_.sample_rate = sample_rate;
+    info_.channels = channels;
+    info_.format = format;
+    info_.data_offset = 0;
+    if (!finish_open(file_size_)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void AudioFileReader::close() {
+#if defined(AUTOTUNE_HAVE_MMAP)
+    if (map_) {
+        munmap(const_cast<uint8_t*>(map_), map_size_);
+    }
+#endif
+    map_ = nullptr;
+    map_size_ = 0;
+    released_ = 0;
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+    file_size_ = 0;
+    position_ = 0;
+    info_ = AudioFileInfo();
+}
+
+bool AudioFileReader::open_file(const std::string& path) {
+    close();
+    error_.clear();
+
+#if defined(AUTOTUNE_HAVE_MMAP)
+    if (memory_mapping_) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return fail("cannot open " + path);
+        }
+        struct stat status;
+        if (fstat(fd, &status) == 0 && S_ISREG(status.st_mode) && status.st_size > 0) {
+            void* map = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_SHARED, fd, 0);
+            if (map != MAP_FAILED) {
+                // Let the kernel read ahead; consumed pages are released in read()
+                madvise(map, static_cast<size_t>(status.st_size), MADV_SEQUENTIAL);
+                map_ = static_cast<const uint8_t*>(map);
+                map_size_ = static_cast<uint64_t>(status.st_size);
+                file_size_ = map_size_;
+            }
+        }
+        ::close(fd);    // The mapping stays valid
+        if (map_) {
+            return true;
+        }
+    }
+#endif
+
+    file_ = std::fopen(path.c_str(), "rb");
+    if (!file_) {
+        return fail("cannot open " + path);
+    }
+#if defined(_WIN32)
+    int64_t size = std::fseek(file_, 0, SEEK_END) == 0 ? _ftelli64(file_) : -1;
+#else
+    int64_t size = std::fseek(file_, 0, SEEK_END) == 0 ? static_cast<int64_t>(ftello(file_)) : -1;
+#endif
+    if (size < 0) {
+        return fail("cannot determine the size of " + path);
+    }
+    file_size_ = static_cast<uint64_t>(size);
+    return true;
+}
+
+bool AudioFileReader::read_at(uint64_t offset, void* destination, size_t size) {
+    if (offset + size > file_size_) {
+        return false;
+    }
+    if (map_) {
+        std::memcpy(destination, map_ + offset, size);
+        return true;
+    }
+    return seek_file(file_, offset) && std::fread(destination, 1, size, file_) == size;
+}
+
+bool AudioFileReader::parse_header() {
+    uint8_t riff[kRiffHeaderBytes];
+    if (!read_at(0, riff, sizeof(riff)) || std::memcmp(riff + 8, "WAVE", 4) != 0) {
+        return fail("not a WAV file");
+    }
+    bool rf64 = std::memcmp(riff, "RF64", 4) == 0 || std::memcmp(riff, "BW64", 4) == 0;
+    if (!rf64 && std::memcmp(riff, "RIFF", 4) != 0) {
+        return fail("not a WAV file");
+    }
+    info_.rf64 = rf64;
+    
+    bool have_format = false;
+    uint64_t ds64_data_size = 0;
+    uint64_t offset = kRiffHeaderBytes;
+    uint8_t header[8];
+    while (read_at(offset, header, sizeof(header))) {
+        uint64_t size = read_u32(header + 4);
+        uint64_t body = offset + sizeof(header);
+        
+        if (std::memcmp(header, "ds64", 4) == 0) {
+            uint8_t ds64[24];
+            if (size < sizeof(ds64) || !read_at(body, ds64, sizeof(ds64))) {
+                return fail("truncated ds64 chunk");
+            }
+            ds64_data_size = read_u64(ds64 + 8);
+        } else if (std::memcmp(header, "fmt ", 4) == 0) {
+            uint8_t format[40] = {};
+            if (size < 16 || !read_at(body, format, std::min<uint64_t>(size, sizeof(format)))) {
+                return fail("truncated fmt chunk");
+            }
+            uint16_t tag = read_u16(format);
+            uint16_t channels = read_u16(format + 2);
+            uint32_t sample_rate = read_u32(format + 4);
+            uint16_t block_align = read_u16(format + 12);
+            uint16_t bits = read_u16(format + 14);
+            if (tag == kFormatExtensible && size >= 40) {
+                tag = read_u16(format + 24);    // First bytes of the sub-format GUID
+            }
+            
+            if (tag == kFormatPcm && bits == 16) {
+                info_.format = SampleFormat::INT16;
+            } else if (tag == kFormatPcm && bits == 24) {
+                info_.format = SampleFormat::INT24;
+            } else if (tag == kFormatFloat && bits == 32) {
+                info_.format = SampleFormat::FLOAT32;
+            } else {
+                return fail("unsupported sample format (format tag " + std::to_string(tag) + ", " +
+                            std::to_string(bits) + " bits)");
+            }
+            info_.channels = channels;
+            info_.sample_rate = sample_rate;
+            if (channels == 0 || block_align != info_.frame_bytes()) {
+                return fail("invalid fmt chunk");
+            }
+            have_format = true;
+        } else if (std::memcmp(header, "data", 4) == 0) {
+            if (!have_format) {
+                return fail("data chunk before fmt chunk");
+            }
+            if (rf64 && size == kSizePlaceholder) {
+                size = ds64_data_size;
+            } else if (size == 0 || size == kSizePlaceholder) {
+                // Header never finalized (recorder stopped): take the rest of the file
+                size = file_size_ - body;
+            }
+            info_.data_offset = body;
+            return finish_open(std::min(size, file_size_ - body));
+        }
+        
+        offset = body + size + (size & 1);     // Chunks are padded to even sizes
+    }
+    
+    return fail(have_format ? "no data chunk" : "no fmt chunk");
+}
+
+bool AudioFileReader::finish_open(uint64_t data_size) {
+    if (info_.sample_rate == 0 || info_.channels == 0) {
+        return fail("invalid sample rate or channel count");
+    }
+    info_.frame_count = data_size / info_.frame_bytes();
+    position_ = 0;
+    released_ = info_.data_offset - info_.data_offset % kReleaseBytes;
+    if (file_ && !seek_file(file_, info_.data_offset)) {
+        return fail("cannot seek to sample data");
+    }
+    return true;
+}
+
+size_t AudioFileReader::read(Sample* interleaved, size_t frame_count) {
+    if (!is_open() || !interleaved) {
+        return 0;
+    }
+    frame_count = static_cast<size_t>(std::min<uint64_t>(frame_count, info_.frame_count - position_));
+    if (frame_count == 0) {
+        return 0;
+    }
+    
+    size_t bytes = frame_count * info_.frame_bytes();
+    uint64_t offset = info_.data_offset + position_ * info_.frame_bytes();
+    const uint8_t* source = nullptr;
+    if (map_) {
+        source = map_ + offset;
+    } else {
+        if (chunk_.size() < bytes) {
+            chunk_.resize(bytes);
+        }
+        size_t got = std::fread(chunk_.data(), 1, bytes, file_);
+        frame_count = got / info_.frame_bytes();
+        bytes = frame_count * info_.frame_bytes();
+        source = chunk_.data();
+    }
+    
+    decode_samples(source, info_.format, interleaved, frame_count * info_.channels);
+    position_ += frame_count;
+    if (map_) {
+        release_consumed(offset + bytes);
+    }
+    return frame_count;
+}
+
+void AudioFileReader::release_consumed(uint64_t offset) {
+#if defined(AUTOTUNE_HAVE_MMAP)
+    // Clean file-backed pages are simply dropped and would be re-read on access
+    if (offset < released_ + kReleaseBytes) {
+        return;
+    }
+    uint64_t end = offset - offset % kReleaseBytes;
+    madvise(const_cast<uint8_t*>(map_) + released_, static_cast<size_t>(end - released_), MADV_DONTNEED);
+    released_ = end;
+#else
+    (void)offset;
+#endif
+}
+
+bool AudioFileReader::fail(const std::string& message) {
+    error_ = message;
+    return false;
+}
+
+// AudioFileWriter
+
+AudioFileWriter::AudioFileWriter()
+    : container_(Container::WAV), file_(nullptr), riff_limit_(std::numeric_limits<uint32_t>::max()) {
+}
+
+AudioFileWriter::~AudioFileWriter() {
+    close();
+}
+
+bool AudioFileWriter::open(const std::string& path, SampleRate sample_rate, ChannelCount channels,
+                           SampleFormat format, Container container) {
+    close();
+    error_.clear();
+    if (sample_rate == 0 || channels == 0) {
+        return fail("invalid sample rate or channel count");
+    }
+    
+    info_ = AudioFileInfo();
+    info_.sample_rate = sample_rate;
+    info_.channels = channels;
+    info_.format = format;
+    container_ = container;
+    
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        return fail("cannot create " + path);
+    }
+    if (container_ == Container::WAV && !write_header()) {
+        std::fclose(file_);
+        file_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+bool AudioFileWriter::write_header() {
+    bool is_float = info_.format == SampleFormat::FLOAT32;
+    uint32_t sample_bytes = bytes_per_sample(info_.format);
+    
+    std::vector<uint8_t> header;
+    append_id(header, "RIFF");
+    append_u32(header, 0);
+    append_id(header, "WAVE");
+    
+    // Reserved for the ds64 chunk if close() has to promote the file to RF64
+    append_id(header, "JUNK");
+    append_u32(header, kDs64Bytes);
+    header.insert(header.end(), kDs64Bytes, 0);
+    
+    append_id(header, "fmt ");
+    append_u32(header, is_float ? 18 : 16);
+    append_u16(header, is_float ? kFormatFloat : kFormatPcm);
+    append_u16(header, static_cast<uint16_t>(info_.channels));
+    append_u32(header, info_.sample_rate);
+    append_u32(header, info_.sample_rate * info_.frame_bytes());
+    append_u16(header, static_cast<uint16_t>(info_.frame_bytes()));
+    append_u16(header, static_cast<uint16_t>(sample_bytes * 8));
+    if (is_float) {
+        append_u16(header, 0);      // cbSize
+    }
+    
+    append_id(header, "data");
+    append_u32(header, 0);
+    info_.data_offset = header.size();
+    
+    if (std::fwrite(header.data(), 1, header.size(), file_) != header.size()) {
+        return fail("cannot write WAV header");
+    }
+    return true;
+}
+
+bool AudioFileWriter::write(const Sample* interleaved, size_t frame_count) {
+    if (!file_) {
+        return fail("file is not open");
+    }
+    if (frame_count == 0) {
+        return true;
+    }
+    
+    size_t samples = frame_count * info_.channels;
+    size_t bytes = frame_count * info_.frame_bytes();
+    if (chunk_.size() < bytes) {
+        chunk_.resize(bytes);
+    }
+    encode_samples(interleaved, info_.format, chunk_.data(), samples);
+    if (std::fwrite(chunk_.data(), 1, bytes, file_) != bytes) {
+        return fail("write failed (disk full?)");
+    }
+    info_.frame_count += frame_count;
+    return true;
+}
+
+bool AudioFileWriter::finalize_header() {
+    uint64_t data_size = info_.frame_count * info_.frame_bytes();
+    uint64_t pad = data_size & 1;
+    if (pad && std::fputc(0, file_) == EOF) {
+        return fail("write failed (disk full?)");
+    }
+    
+    uint64_t riff_size = info_.data_offset - 8 + data_size + pad;
+    std::vector<uint8_t> bytes;
+    if (riff_size <= riff_limit_) {
+        append_u32(bytes, static_cast<uint32_t>(riff_size));
+        if (!seek_file(file_, 4) || std::fwrite(bytes.data(), 1, 4, file_) != 4) {
+            return fail("cannot finalize WAV header");
+        }
+        bytes.clear();
+        append_u32(bytes, static_cast<uint32_t>(data_size));
+    } else {
+        // RF64: 32-bit sizes become placeholders, the real ones go in ds64
+        append_id(bytes, "RF64");
+        append_u32(bytes, kSizePlaceholder);
+        append_id(bytes, "WAVE");
+        append_id(bytes, "ds64");
+        append_u32(bytes, kDs64Bytes);
+        append_u64(bytes, riff_size);
+        append_u64(bytes, data_size);
+        append_u64(bytes, info_.frame_count);
+        append_u32(bytes, 0);       // No table entries
+        if (!seek_file(file_, 0) || std::fwrite(bytes.data(), 1, bytes.size(), file_) != bytes.size()) {
+            return fail("cannot finalize RF64 header");
+        }
+        bytes.clear();
+        append_u32(bytes, kSizePlaceholder);
+        info_.rf64 = true;
+    }
+    
+    if (!seek_file(file_, info_.data_offset - 4) || std::fwrite(bytes.data(), 1, 4, file_) != 4) {
+        return fail("cannot finalize WAV header");
+    }
+    return true;
+}
+
+bool AudioFileWriter::close() {
+    if (!file_) {
+        return error_.empty();
+    }
+    bool success = container_ != Container::WAV || finalize_header();
+    if (std::fclose(file_) != 0) {
+        success = fail("close failed");
+    }
+    file_ = nullptr;
+    return success;
+}
+
+bool AudioFileWriter::fail(const std::string& message) {
+    error_ = message;
+    return false;
+}
+
+} // namespace autotune
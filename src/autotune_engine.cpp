@@ -1,26 +1,87 @@
 #include "autotune_engine.h"
+#include "simd.h"
+#include "trace.h"
 #include <algorithm>
-#include <chrono>
+#include <atomic>
 #include <cmath>
+#include <cstring>
+#include <thread>
 
 namespace autotune {
 
+namespace {
+
+// Offline rendering defaults
+constexpr float kDefaultSegmentSeconds = 10.0f;
+constexpr float kDefaultOverlapSeconds = 0.05f;
+
+// Correction strength changes ramp over this long
+constexpr float kParameterRampSeconds = 0.02f;
+
+// Latency profile settings (see set_latency_profile)
+constexpr float kBalancedPitchFloor = 80.0f;
+constexpr float kLivePitchFloor = 150.0f;
+constexpr SampleRate kLiveAnalysisRate = 16000;
+
+/**
+ * @brief Linear RMS level of a gate threshold
+ */
+float gate_level(float threshold_db) {
+    return std::pow(10.0f, threshold_db / 20.0f);
+}
+
+} // namespace
+
 AutotuneEngine::AutotuneEngine(SampleRate sample_rate, uint32_t buffer_size, ChannelCount channels)
     : sample_rate_(sample_rate), buffer_size_(buffer_size), channels_(channels),
-      mode_(Mode::FULL_AUTOTUNE), initialized_(false), current_pitch_(0.0f),
-      target_pitch_(0.0f), confidence_(0.0f), performance_counter_(0),
-      current_scale_(Quantizer::Scale::MAJOR), key_center_(60), tempo_(120.0f) {
+      initialized_(false),
+      correction_strength_(1.0f, static_cast<uint32_t>(kParameterRampSeconds * sample_rate)),
+      streaming_(false), max_block_size_(0), current_pitch_(0.0f),
+      target_pitch_(0.0f), confidence_(0.0f), recorded_track_(nullptr), pitch_track_(nullptr),
+      pitch_track_index_(0), track_position_(0), lookahead_ms_(0.0f), lookahead_(0), monitor_(sample_rate),
+      latency_profile_(LatencyProfile::BALANCED), pipeline_(nullptr),
+      fallback_pipeline_(nullptr), pass_through_(false) {
     
     // Initialize default parameters
-    params_.sample_rate = sample_rate;
-    params_.buffer_size = buffer_size;
+    settings_.params.sample_rate = sample_rate;
+    settings_.params.buffer_size = buffer_size;
+    active_settings_ = settings_;
+    correction_strength_.reset(settings_.params.correction_strength);
+    select_pipeline();
     
     initialized_ = initialize_components();
+    if (initialized_) {
+        quantizer_->prepare_scale(active_settings_.scale);
+    }
 }
 
 AutotuneEngine::~AutotuneEngine() = default;
 
+void AutotuneEngine::prepare(uint32_t max_block_size) {
+    max_block_size = std::max(max_block_size, 1u);
+    max_block_size_ = max_block_size;
+    
+    pitch_segments_.assign(max_block_size, PitchCorrector::PitchSegment());
+    strength_curve_.assign(max_block_size, 0.0f);
+    
+    planar_buffer_.assign(static_cast<size_t>(max_block_size) * channels_ * 2, 0.0f);
+    planar_input_.resize(channels_);
+    planar_output_.resize(channels_);
+    buffer_input_.resize(channels_);
+    buffer_output_.resize(channels_);
+    for (ChannelCount ch = 0; ch < channels_; ++ch) {
+        planar_input_[ch] = planar_buffer_.data() + static_cast<size_t>(ch) * max_block_size;
+        planar_output_[ch] = planar_buffer_.data() + static_cast<size_t>(channels_ + ch) * max_block_size;
+    }
+    configure_lookahead();
+    if (rhythm_quantizer_) {
+        rhythm_quantizer_->prepare(max_block_size);
+        restart_rhythm();
+    }
+}
+
 ProcessingResult AutotuneEngine::process(const AudioFrame* input, AudioFrame* output, uint32_t frame_count) {
+    AUTOTUNE_TRACE_ZONE("AutotuneEngine::process");
     ProcessingResult result;
     
     if (!initialized_ || !input || !output || frame_count == 0) {
@@ -28,52 +89,111 @@ ProcessingResult AutotuneEngine::process(const AudioFrame* input, AudioFrame* ou
         return result;
     }
     
-    auto start_time = std::chrono::high_resolution_clock::now();
+    auto start_time = PerformanceMonitor::Clock::now();
     
-    // Prepare processing buffer
-    if (processing_buffer_.size() != frame_count) {
-        processing_buffer_.resize(frame_count);
-        for (auto& frame : processing_buffer_) {
-            frame = AudioFrame(channels_);
+    // Oversized blocks grow the scratch buffer once (not real-time safe);
+    // call prepare() up front to avoid this on the audio thread
+    if (frame_count > max_block_size_) {
+        prepare(frame_count);
+    }
+    apply_pending_settings();
+    
+    if (pass_through_) {
+        copy_frames(input, output, frame_count);
+        result.success = true;
+    } else {
+        // Deinterleave once, run the chain planar and interleave the result
+        for (uint32_t i = 0; i < frame_count; ++i) {
+            for (ChannelCount ch = 0; ch < channels_; ++ch) {
+                planar_input_[ch][i] = ch < input[i].size() ? input[i][ch] : 0.0f;
+            }
+        }
+        
+        AudioBlockView planar_input(planar_input_.data(), channels_, frame_count);
+        AudioBlockView planar_output(planar_output_.data(), channels_, frame_count);
+        result = (this->*pipeline_)(planar_input, planar_output);
+        
+        for (uint32_t i = 0; i < frame_count; ++i) {
+            ChannelCount channel_count = std::min(output[i].size(), channels_);
+            for (ChannelCount ch = 0; ch < channel_count; ++ch) {
+                output[i][ch] = planar_output_[ch][i];
+            }
         }
     }
     
-    // Copy input to processing buffer
-    for (uint32_t i = 0; i < frame_count; ++i) {
-        processing_buffer_[i] = input[i];
+    monitor_.record_callback(PerformanceMonitor::nanoseconds_since(start_time), frame_count);
+    
+    return result;
+}
+
+ProcessingResult AutotuneEngine::process(const AudioBlockView& input, AudioBlockView& output) {
+    AUTOTUNE_TRACE_ZONE("AutotuneEngine::process");
+    ProcessingResult result;
+    
+    if (!initialized_ || !input.valid() || !output.valid() || input.frame_count == 0 ||
+        input.channel_count != output.channel_count ||
+        input.frame_count != output.frame_count) {
+        result.success = false;
+        return result;
     }
     
-    // Process based on current mode
-    switch (mode_) {
-        case Mode::PITCH_CORRECTION:
-            result = process_pitch_correction(input, output, frame_count);
-            break;
-        case Mode::QUANTIZATION:
-            result = process_quantization(input, output, frame_count);
-            break;
-        case Mode::FULL_AUTOTUNE:
-            // First apply pitch correction, then quantization
-            result = process_pitch_correction(input, processing_buffer_.data(), frame_count);
-            if (result.success) {
-                ProcessingResult quant_result = process_quantization(processing_buffer_.data(), output, frame_count);
-                result.success = result.success && quant_result.success;
+    auto start_time = PerformanceMonitor::Clock::now();
+    
+    apply_pending_settings();
+    
+    // The chain for the active mode runs directly on the caller's buffers
+    Pipeline pipeline = input.channel_count == channels_ ? pipeline_ : fallback_pipeline_;
+    result = (this->*pipeline)(input, output);
+    
+    monitor_.record_callback(PerformanceMonitor::nanoseconds_since(start_time), input.frame_count);
+    
+    return result;
+}
+
+ProcessingResult AutotuneEngine::process_buffer(const Sample* input, Sample* output, size_t frame_count,
+                                                BufferLayout layout) {
+    ProcessingResult result;
+    if (!initialized_ || !input || !output || frame_count == 0) {
+        result.success = false;
+        return result;
+    }
+    
+    bool success = true;
+    uint32_t max_block = get_max_block_size();
+    for (size_t offset = 0; offset < frame_count; offset += max_block) {
+        uint32_t block = static_cast<uint32_t>(std::min<size_t>(max_block, frame_count - offset));
+        
+        if (layout == BufferLayout::PLANAR) {
+            for (ChannelCount ch = 0; ch < channels_; ++ch) {
+                buffer_input_[ch] = input + ch * frame_count + offset;
+                buffer_output_[ch] = output + ch * frame_count + offset;
             }
-            break;
-        case Mode::BYPASS:
-            // Pass through
-            for (uint32_t i = 0; i < frame_count; ++i) {
-                output[i] = input[i];
+            AudioBlockView input_view(buffer_input_.data(), channels_, block);
+            AudioBlockView output_view(buffer_output_.data(), channels_, block);
+            result = process(input_view, output_view);
+        } else {
+            const Sample* source = input + offset * channels_;
+            for (uint32_t i = 0; i < block; ++i) {
+                for (ChannelCount ch = 0; ch < channels_; ++ch) {
+                    planar_input_[ch][i] = source[i * channels_ + ch];
+                }
             }
-            result.success = true;
-            break;
+            
+            AudioBlockView input_view(planar_input_.data(), channels_, block);
+            AudioBlockView output_view(planar_output_.data(), channels_, block);
+            result = process(input_view, output_view);
+            
+            Sample* destination = output + offset * channels_;
+            for (uint32_t i = 0; i < block; ++i) {
+                for (ChannelCount ch = 0; ch < channels_; ++ch) {
+                    destination[i * channels_ + ch] = planar_output_[ch][i];
+                }
+            }
+        }
+        success = success && result.success;
     }
     
-    auto end_time = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end_time - start_time);
-    float processing_time = duration.count() / 1000.0f; // Convert to milliseconds
-    
-    update_performance_metrics(processing_time);
-    
+    result.success = success;
     return result;
 }
 
@@ -81,34 +201,316 @@ ProcessingResult AutotuneEngine::process_frame(const AudioFrame& input, AudioFra
     return process(&input, &output, 1);
 }
 
-void AutotuneEngine::set_parameters(const ProcessingParams& params) {
-    params_ = params;
+bool AutotuneEngine::render_offline(const float* interleaved, size_t frames, float* out,
+                                    const OfflineRenderOptions& options) const {
+    if (!initialized_ || !interleaved || !out || interleaved == out) {
+        return false;
+    }
+    if (frames == 0) {
+        return true;
+    }
     
-    if (pitch_corrector_) {
-        pitch_corrector_->set_parameters(params);
+    size_t segment_frames = options.segment_frames > 0 ? options.segment_frames
+        : static_cast<size_t>(kDefaultSegmentSeconds * sample_rate_);
+    segment_frames = std::max<size_t>(segment_frames, buffer_size_);
+    size_t overlap_frames = options.overlap_frames > 0 ? options.overlap_frames
+        : static_cast<size_t>(kDefaultOverlapSeconds * sample_rate_);
+    overlap_frames = std::min(overlap_frames, segment_frames / 2);
+    
+    size_t segment_count = (frames + segment_frames - 1) / segment_frames;
+    
+    // Segment k owns [k * segment_frames, (k + 1) * segment_frames) but starts
+    // overlap_frames earlier; that lead-in is rendered into its own buffer and
+    // cross-faded with the previous segment's tail once all segments are done
+    std::vector<float> lead_in(segment_count * overlap_frames * channels_);
+    std::vector<char> segment_ok(segment_count, 0);
+    std::atomic<size_t> next_segment(0);
+    
+    auto worker = [&]() {
+        std::vector<float> segment_output;
+        size_t segment;
+        while ((segment = next_segment.fetch_add(1)) < segment_count) {
+            size_t body_start = segment * segment_frames;
+            size_t body_end = std::min(body_start + segment_frames, frames);
+            size_t lead = segment > 0 ? overlap_frames : 0;
+            size_t start = body_start - lead;
+            size_t length = body_end - start;
+            
+            try {
+                segment_output.resize(length * channels_);
+                if (!render_segment(interleaved + start * channels_, frames - start, segment_output.data(), length,
+                                    start)) {
+                    continue;
+                }
+            } catch (...) {
+                continue;
+            }
+            
+            std::copy(segment_output.begin(), segment_output.begin() + lead * channels_,
+                      lead_in.begin() + segment * overlap_frames * channels_);
+            std::copy(segment_output.begin() + lead * channels_, segment_output.end(),
+                      out + body_start * channels_);
+            segment_ok[segment] = 1;
+        }
+    };
+    
+    size_t thread_count = options.thread_count > 0 ? options.thread_count
+        : std::max(1u, std::thread::hardware_concurrency());
+    thread_count = std::min(thread_count, segment_count);
+    
+    // The calling thread renders too
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for (size_t t = 1; t < thread_count; ++t) {
+        threads.emplace_back(worker);
     }
+    worker();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    // Raised-cosine cross-fade; the two gains always sum to one
+    const float pi = static_cast<float>(M_PI);
+    for (size_t segment = 1; segment < segment_count; ++segment) {
+        float* seam = out + (segment * segment_frames - overlap_frames) * channels_;
+        const float* incoming = lead_in.data() + segment * overlap_frames * channels_;
+        for (size_t i = 0; i < overlap_frames; ++i) {
+            float fade_in = 0.5f - 0.5f * std::cos(pi * (i + 0.5f) / overlap_frames);
+            for (ChannelCount ch = 0; ch < channels_; ++ch) {
+                size_t index = i * channels_ + ch;
+                seam[index] += fade_in * (incoming[index] - seam[index]);
+            }
+        }
+    }
+    
+    return std::all_of(segment_ok.begin(), segment_ok.end(), [](char ok) { return ok != 0; });
+}
+
+void AutotuneEngine::set_parameters(const ProcessingParams& params) {
+    std::lock_guard<std::mutex> lock(settings_mutex_);
+    settings_.params = params;
+    publish_settings();
 }
 
 const ProcessingParams& AutotuneEngine::get_parameters() const {
-    return params_;
+    return settings_.params;
 }
 
 void AutotuneEngine::set_mode(Mode mode) {
-    mode_ = mode;
+    std::lock_guard<std::mutex> lock(settings_mutex_);
+    settings_.mode = mode;
+    publish_settings();
 }
 
 void AutotuneEngine::set_scale(Quantizer::Scale scale, int key_center) {
-    current_scale_ = scale;
-    key_center_ = key_center;
+    std::lock_guard<std::mutex> lock(settings_mutex_);
+    settings_.scale = scale;
+    settings_.key_center = key_center;
+    publish_settings();
 }
 
-void AutotuneEngine::set_tempo(float tempo) {
-    tempo_ = tempo;
-    if (quantizer_) {
-        quantizer_->set_tempo(tempo);
+void AutotuneEngine::set_silence_gate(float threshold_db) {
+    std::lock_guard<std::mutex> lock(settings_mutex_);
+    settings_.silence_gate_db = threshold_db;
+    publish_settings();
+}
+
+void AutotuneEngine::set_rhythm_grid(Quantizer::GridResolution grid) {
+    std::lock_guard<std::mutex> lock(settings_mutex_);
+    settings_.grid = grid;
+    publish_settings();
+}
+
+void AutotuneEngine::publish_settings() {
+    settings_mailbox_.publish(settings_);
+}
+
+void AutotuneEngine::apply_pending_settings() {
+    Settings previous = active_settings_;
+    if (!settings_mailbox_.fetch(active_settings_)) {
+        return;
+    }
+    
+    if (active_settings_.mode != previous.mode) {
+        select_pipeline();
+        
+        // The rhythm delay line restarts empty rather than replaying stale audio
+        if (quantizes(active_settings_.mode)) {
+            restart_rhythm();
+        }
+    }
+    
+    // Only glide times need the corrector's coefficients recomputed
+    const ProcessingParams& params = active_settings_.params;
+    if (params.attack_time != previous.params.attack_time ||
+        params.release_time != previous.params.release_time) {
+        pitch_corrector_->set_parameters(params);
+    }
+    if (params.retune_time != previous.params.retune_time) {
+        planner_.set_retune_time(params.retune_time);
+    }
+    if (active_settings_.scale != previous.scale) {
+        quantizer_->prepare_scale(active_settings_.scale);
+    }
+    if (active_settings_.tempo != previous.tempo) {
+        quantizer_->set_tempo(active_settings_.tempo);
+    }
+    if (active_settings_.time_signature != previous.time_signature) {
+        quantizer_->set_time_signature(active_settings_.time_signature);
+    }
+    if (active_settings_.silence_gate_db != previous.silence_gate_db) {
+        pitch_detector_->set_gate_threshold(gate_level(active_settings_.silence_gate_db));
+    }
+    
+    // Nothing has been output before the first block, so there is nothing to ramp from
+    if (streaming_) {
+        correction_strength_.set_target(params.correction_strength);
+    } else {
+        correction_strength_.reset(params.correction_strength);
+    }
+}
+
+void AutotuneEngine::set_detection_algorithm(PitchDetector::Algorithm algorithm) {
+    if (pitch_detector_) {
+        pitch_detector_->set_algorithm(algorithm);
+    }
+}
+
+void AutotuneEngine::set_pitch_tracking(uint32_t window_size, uint32_t hop_size) {
+    if (pitch_detector_) {
+        pitch_detector_->set_tracking(window_size, hop_size);
+        configure_lookahead();
+    }
+}
+
+void AutotuneEngine::set_analysis_rate(SampleRate analysis_rate) {
+    if (pitch_detector_) {
+        pitch_detector_->set_analysis_rate(analysis_rate);
+    }
+}
+
+void AutotuneEngine::set_correction_backend(PitchCorrector::Backend backend) {
+    if (pitch_corrector_) {
+        pitch_corrector_->set_backend(backend);
     }
 }
 
+void AutotuneEngine::set_vocoder_overlap(uint32_t overlap) {
+    if (pitch_corrector_) {
+        pitch_corrector_->set_vocoder_overlap(overlap);
+    }
+}
+
+void AutotuneEngine::set_latency_profile(LatencyProfile profile) {
+    latency_profile_ = profile;
+    if (!pitch_detector_ || !pitch_corrector_) {
+        return;
+    }
+    
+    float floor = kBalancedPitchFloor;
+    uint32_t window = buffer_size_;
+    uint32_t hop = buffer_size_ / 4;
+    SampleRate analysis_rate = 0;
+    PitchCorrector::Backend backend = PitchCorrector::Backend::PSOLA;
+    uint32_t overlap = 2;
+    
+    switch (profile) {
+        case LatencyProfile::LIVE: {
+            // The PSOLA delay is three floor periods and the detector needs
+            // two of them in its window, so both follow the floor
+            floor = std::max(kLivePitchFloor, 2.0f * sample_rate_ / buffer_size_);
+            window = std::min(buffer_size_, static_cast<uint32_t>(std::ceil(2.0f * sample_rate_ / floor)));
+            hop = window / 4;
+            analysis_rate = kLiveAnalysisRate;
+            break;
+        }
+        case LatencyProfile::STUDIO:
+            hop = buffer_size_ / 8;
+            backend = PitchCorrector::Backend::PHASE_VOCODER;
+            overlap = 4;
+            break;
+        default:
+            break;
+    }
+    
+    pitch_detector_->set_min_frequency(floor);
+    pitch_detector_->set_tracking(window, std::max(1u, hop));
+    pitch_detector_->set_analysis_rate(analysis_rate);
+    pitch_corrector_->set_minimum_pitch(floor);
+    pitch_corrector_->set_backend(backend);
+    pitch_corrector_->set_vocoder_overlap(overlap);
+    configure_lookahead();
+}
+
+uint32_t AutotuneEngine::get_latency_samples() const {
+    uint32_t latency = 0;
+    if (corrects(settings_.mode) && pitch_corrector_) {
+        latency += correction_latency();
+    }
+    if (quantizes(settings_.mode) && rhythm_quantizer_) {
+        latency += rhythm_quantizer_->get_latency_samples();
+    }
+    return latency;
+}
+
+void AutotuneEngine::set_lookahead(float milliseconds) {
+    lookahead_ms_ = std::max(milliseconds, 0.0f);
+    lookahead_ = static_cast<uint32_t>(std::lround(lookahead_ms_ * 0.001f * sample_rate_));
+    if (pitch_detector_) {
+        // The planner smooths with lookahead instead
+        pitch_detector_->set_smoothing(lookahead_ > 0 ? 0.0f : PitchDetector::kDefaultSmoothing);
+    }
+    configure_lookahead();
+}
+
+void AutotuneEngine::configure_lookahead() {
+    if (lookahead_ == 0 || !pitch_detector_) {
+        lookahead_buffer_.reset();
+        return;
+    }
+    
+    lookahead_buffer_ = std::make_unique<AudioBuffer>(lookahead_ + max_block_size_, channels_);
+    lookahead_scratch_.assign(static_cast<size_t>(max_block_size_) * channels_, 0.0f);
+    lookahead_channels_.resize(channels_);
+    for (ChannelCount ch = 0; ch < channels_; ++ch) {
+        lookahead_channels_[ch] = lookahead_scratch_.data() + static_cast<size_t>(ch) * max_block_size_;
+    }
+    planner_.configure(sample_rate_, lookahead_, pitch_detector_->get_window_size(),
+                       pitch_detector_->get_hop_size(), max_block_size_);
+    planner_.set_retune_time(active_settings_.params.retune_time);
+    prime_lookahead();
+}
+
+void AutotuneEngine::prime_lookahead() {
+    lookahead_buffer_->clear();
+    AudioBuffer::Region region = lookahead_buffer_->acquire_write(lookahead_);
+    for (ChannelCount ch = 0; ch < channels_; ++ch) {
+        std::memset(region.first.channels[ch], 0, region.first.frame_count * sizeof(Sample));
+        std::memset(region.second.channels[ch], 0, region.second.frame_count * sizeof(Sample));
+    }
+    lookahead_buffer_->commit_write(lookahead_);
+    planner_.reset();
+}
+
+const Sample* const* AutotuneEngine::delay_input(const AudioBlockView& input) {
+    lookahead_buffer_->write(input);
+    AudioBlockView delayed(lookahead_channels_.data(), input.channel_count, input.frame_count);
+    lookahead_buffer_->read(delayed);
+    return lookahead_channels_.data();
+}
+
+void AutotuneEngine::set_tempo(float tempo) {
+    std::lock_guard<std::mutex> lock(settings_mutex_);
+    settings_.tempo = tempo;
+    publish_settings();
+}
+
+void AutotuneEngine::set_time_signature(Quantizer::TimeSignature time_signature) {
+    std::lock_guard<std::mutex> lock(settings_mutex_);
+    settings_.time_signature = time_signature;
+    publish_settings();
+}
+
 void AutotuneEngine::configure_features(bool enable_pitch_correction,
                                        bool enable_quantization,
                                        bool enable_formant_preservation) {
@@ -117,19 +519,37 @@ void AutotuneEngine::configure_features(bool enable_pitch_correction,
     }
     
     // Update mode based on enabled features
+    Mode mode = Mode::BYPASS;
     if (enable_pitch_correction && enable_quantization) {
-        mode_ = Mode::FULL_AUTOTUNE;
+        mode = Mode::FULL_AUTOTUNE;
     } else if (enable_pitch_correction) {
-        mode_ = Mode::PITCH_CORRECTION;
+        mode = Mode::PITCH_CORRECTION;
     } else if (enable_quantization) {
-        mode_ = Mode::QUANTIZATION;
-    } else {
-        mode_ = Mode::BYPASS;
+        mode = Mode::QUANTIZATION;
     }
+    set_mode(mode);
 }
 
 AutotuneEngine::PerformanceMetrics AutotuneEngine::get_performance_metrics() const {
-    return metrics_;
+    PerformanceMonitor::Snapshot snapshot = monitor_.snapshot();
+    
+    PerformanceMetrics metrics;
+    metrics.average_latency_ms = static_cast<float>(snapshot.mean_ms);
+    metrics.p50_latency_ms = static_cast<float>(snapshot.p50_ms);
+    metrics.p99_latency_ms = static_cast<float>(snapshot.p99_ms);
+    metrics.p999_latency_ms = static_cast<float>(snapshot.p999_ms);
+    metrics.max_latency_ms = static_cast<float>(snapshot.max_ms);
+    metrics.cpu_usage_percent = static_cast<float>(snapshot.load_percent);
+    metrics.detect_ms = static_cast<float>(snapshot.stage_mean_ms[static_cast<uint32_t>(PerformanceMonitor::Stage::DETECT)]);
+    metrics.quantize_ms = static_cast<float>(snapshot.stage_mean_ms[static_cast<uint32_t>(PerformanceMonitor::Stage::QUANTIZE)]);
+    metrics.correct_ms = static_cast<float>(snapshot.stage_mean_ms[static_cast<uint32_t>(PerformanceMonitor::Stage::CORRECT)]);
+    metrics.deadline_misses = static_cast<uint32_t>(snapshot.deadline_misses);
+    metrics.buffer_underruns = metrics.deadline_misses;
+    metrics.callbacks = snapshot.callbacks;
+    metrics.frames_processed = snapshot.frames_processed;
+    metrics.skipped_blocks = snapshot.skipped_callbacks;
+    metrics.skipped_block_ratio = static_cast<float>(snapshot.skipped_ratio);
+    return metrics;
 }
 
 void AutotuneEngine::reset() {
@@ -148,22 +568,42 @@ void AutotuneEngine::reset() {
     if (output_buffer_) {
         output_buffer_->clear();
     }
+    if (lookahead_buffer_) {
+        prime_lookahead();
+    }
+    if (rhythm_quantizer_) {
+        restart_rhythm();
+    }
     
     current_pitch_ = 0.0f;
     target_pitch_ = 0.0f;
     confidence_ = 0.0f;
-    metrics_ = PerformanceMetrics();
-    performance_counter_ = 0;
-    latency_history_.clear();
+    if (recorded_track_) {
+        recorded_track_->clear();
+    }
+    pitch_track_index_ = 0;
+    track_position_ = 0;
+    correction_strength_.reset(correction_strength_.get_target());
+    streaming_ = false;
+    monitor_.reset();
 }
 
-uint32_t AutotuneEngine::get_recommended_buffer_size(SampleRate sample_rate) {
+uint32_t AutotuneEngine::get_recommended_buffer_size(SampleRate sample_rate, LatencyProfile profile) {
     // Recommended buffer sizes for low latency based on sample rate
-    if (sample_rate <= 22050) return 128;
-    if (sample_rate <= 44100) return 256;
-    if (sample_rate <= 48000) return 512;
-    if (sample_rate <= 96000) return 1024;
-    return 2048;
+    uint32_t size = 2048;
+    if (sample_rate <= 22050) size = 128;
+    else if (sample_rate <= 44100) size = 256;
+    else if (sample_rate <= 48000) size = 512;
+    else if (sample_rate <= 96000) size = 1024;
+    
+    switch (profile) {
+        case LatencyProfile::LIVE:
+            return size / 2;
+        case LatencyProfile::STUDIO:
+            return size * 2;
+        default:
+            return size;
+    }
 }
 
 bool AutotuneEngine::initialize_components() {
@@ -174,12 +614,18 @@ bool AutotuneEngine::initialize_components() {
         
         // Create processing components
         pitch_detector_ = std::make_unique<PitchDetector>(sample_rate_, buffer_size_);
-        pitch_corrector_ = std::make_unique<PitchCorrector>(sample_rate_, buffer_size_);
-        quantizer_ = std::make_unique<Quantizer>(sample_rate_, tempo_);
+        pitch_corrector_ = std::make_unique<PitchCorrector>(sample_rate_, buffer_size_, channels_);
+        quantizer_ = std::make_unique<Quantizer>(sample_rate_, active_settings_.tempo);
+        rhythm_quantizer_ = std::make_unique<RhythmQuantizer>(sample_rate_, channels_);
+        
+        // Track pitch over one buffer, updated four times per buffer
+        pitch_detector_->set_tracking(buffer_size_, std::max(1u, buffer_size_ / 4));
+        pitch_detector_->set_gate_threshold(gate_level(settings_.silence_gate_db));
         
         // Initialize buffers
         mono_buffer_.resize(buffer_size_, 0.0f);
-        latency_history_.reserve(100); // Keep last 100 measurements
+        input_slice_.resize(channels_);
+        prepare(buffer_size_);
         
         return true;
     } catch (...) {
@@ -187,108 +633,423 @@ bool AutotuneEngine::initialize_components() {
     }
 }
 
-ProcessingResult AutotuneEngine::process_pitch_correction(const AudioFrame* input, 
-                                                        AudioFrame* output, 
-                                                        uint32_t frame_count) {
+void AutotuneEngine::select_pipeline() {
+    switch (active_settings_.mode) {
+        case Mode::PITCH_CORRECTION:
+            select_pipeline_for<Mode::PITCH_CORRECTION>();
+            break;
+        case Mode::QUANTIZATION:
+            select_pipeline_for<Mode::QUANTIZATION>();
+            break;
+        case Mode::FULL_AUTOTUNE:
+            select_pipeline_for<Mode::FULL_AUTOTUNE>();
+            break;
+        case Mode::BYPASS:
+            select_pipeline_for<Mode::BYPASS>();
+            break;
+    }
+}
+
+template <AutotuneEngine::Mode M>
+void AutotuneEngine::select_pipeline_for() {
+    switch (channels_) {
+        case 1:
+            pipeline_ = &AutotuneEngine::run_pipeline<M, 1>;
+            break;
+        case 2:
+            pipeline_ = &AutotuneEngine::run_pipeline<M, 2>;
+            break;
+        default:
+            pipeline_ = &AutotuneEngine::run_pipeline<M, 0>;
+            break;
+    }
+    fallback_pipeline_ = &AutotuneEngine::run_pipeline<M, 0>;
+    pass_through_ = M == Mode::BYPASS;
+}
+
+template <AutotuneEngine::Mode M, ChannelCount C>
+ProcessingResult AutotuneEngine::run_pipeline(const AudioBlockView& input, AudioBlockView& output) {
+    if constexpr (M == Mode::FULL_AUTOTUNE) {
+        // Onsets of the corrected audio are slipped in place; a new
+        // correction latency moves that audio against the grid
+        ProcessingResult result = process_pitch_correction<C>(input, output);
+        if (correction_latency() != rhythm_delay_) {
+            restart_rhythm();
+        }
+        if (result.success) {
+            ProcessingResult rhythm = process_rhythm(output, output);
+            result.success = rhythm.success;
+            result.latency_samples += rhythm.latency_samples;
+        }
+        return result;
+    } else if constexpr (corrects(M)) {
+        return process_pitch_correction<C>(input, output);
+    } else if constexpr (M == Mode::QUANTIZATION) {
+        return process_rhythm(input, output);
+    } else {
+        ProcessingResult result;
+        copy_block(input, output);
+        result.success = true;
+        return result;
+    }
+}
+
+template <ChannelCount C>
+const Sample* AutotuneEngine::mono_input(const AudioBlockView& input) {
+    if constexpr (C == 1) {
+        return input.channels[0];
+    } else if constexpr (C == 2) {
+        simd::mix(input.channels[0], input.channels[1], mono_buffer_.data(), 0.5f, input.frame_count);
+        return mono_buffer_.data();
+    } else {
+        convert_to_mono(input);
+        return mono_buffer_.data();
+    }
+}
+
+template <ChannelCount C>
+ProcessingResult AutotuneEngine::process_pitch_correction(const AudioBlockView& input, AudioBlockView& output) {
     ProcessingResult result;
     
-    if (frame_count == 0) {
+    if (input.frame_count == 0) {
         result.success = false;
         return result;
     }
     
-    // Convert to mono for pitch detection
-    convert_to_mono(input, frame_count);
+    // Oversized blocks or channel counts grow the scratch state once (not
+    // real-time safe)
+    if (input.frame_count > pitch_segments_.size()) {
+        prepare(input.frame_count);
+    }
+    if (input.channel_count > input_slice_.size()) {
+        input_slice_.resize(input.channel_count);
+    }
+    const bool planning = lookahead_ > 0;
+    if (planning && input.channel_count > channels_) {
+        result.success = false;
+        return result;
+    }
     
-    // Detect pitch
-    current_pitch_ = pitch_detector_->detect_pitch(mono_buffer_.data(), 
-                                                  std::min(frame_count, static_cast<uint32_t>(mono_buffer_.size())), 
-                                                  confidence_);
+    // Track pitch in pieces that end on hop boundaries (or on the points of
+    // a recorded track) so every new estimate takes effect from the next
+    // sample on, collecting the pitch in runs
+    PitchCorrector::PitchSegment* segments = pitch_segments_.data();
+    uint32_t segment_count = 0;
+    uint64_t block_position = track_position_;
+    uint32_t offset = 0;
+    while (offset < input.frame_count) {
+        uint32_t chunk;
+        if (pitch_track_) {
+            chunk = std::min(input.frame_count - offset, follow_pitch_track());
+        } else {
+            chunk = std::min(input.frame_count - offset, pitch_detector_->samples_until_estimate());
+            AudioBlockView input_chunk = input.slice(offset, chunk, input_slice_.data());
+            track_pitch(mono_input<C>(input_chunk), chunk);
+        }
+        
+        if (!planning) {
+            if (segment_count > 0 && segments[segment_count - 1].input_pitch == current_pitch_ &&
+                segments[segment_count - 1].target_pitch == target_pitch_) {
+                segments[segment_count - 1].frames += chunk;
+            } else {
+                segments[segment_count++] = {chunk, current_pitch_, target_pitch_};
+            }
+        }
+        offset += chunk;
+        track_position_ += chunk;
+    }
     
-    // Calculate target pitch
-    target_pitch_ = calculate_target_pitch(current_pitch_);
+    // With lookahead the corrector gets the delayed input and the curve
+    // planned for it from the estimates already ahead of it
+    const Sample* const* source = input.channels;
+    if (planning) {
+        source = delay_input(input);
+        AUTOTUNE_TRACE_ZONE("AutotuneEngine::plan");
+        auto plan_start = PerformanceMonitor::Clock::now();
+        segment_count = planner_.plan(static_cast<int64_t>(block_position) - lookahead_, input.frame_count,
+                                      active_settings_.params.quantize_strength, segments);
+        monitor_.add_stage_time(PerformanceMonitor::Stage::QUANTIZE, PerformanceMonitor::nanoseconds_since(plan_start));
+    }
+    bool unvoiced = std::all_of(segments, segments + segment_count,
+                                [](const PitchCorrector::PitchSegment& segment) { return segment.input_pitch <= 0.0f; });
     
-    // Apply pitch correction to each frame
-    for (uint32_t i = 0; i < frame_count; ++i) {
-        result = pitch_corrector_->correct_pitch(input[i], output[i], 
-                                               current_pitch_, target_pitch_,
-                                               params_.correction_strength);
-        if (!result.success) {
-            break;
+    // Correct the whole block in one call; the strength is a per-frame ramp
+    // while it moves towards newly set parameters
+    PitchCorrector::PitchCurve curve(segments, segment_count, correction_strength_.get_target());
+    if (correction_strength_.is_ramping()) {
+        correction_strength_.fill(strength_curve_.data(), input.frame_count);
+        curve.strength_curve = strength_curve_.data();
+    }
+    streaming_ = true;
+    auto correct_start = PerformanceMonitor::Clock::now();
+    if (unvoiced) {
+        // Nothing to shift: silence and breaths play through the delay line
+        result = pitch_corrector_->bypass_block(source, output.channels, input.channel_count,
+                                                input.frame_count);
+        if (pitch_corrector_->is_bypassed()) {
+            monitor_.mark_skipped();
         }
+    } else {
+        result = pitch_corrector_->correct_block(source, output.channels, input.channel_count,
+                                                 input.frame_count, curve);
     }
+    monitor_.add_stage_time(PerformanceMonitor::Stage::CORRECT, PerformanceMonitor::nanoseconds_since(correct_start));
     
-    result.detected_pitch = current_pitch_;
-    result.corrected_pitch = target_pitch_;
+    // Pitches of the audio just corrected
+    result.detected_pitch = segments[segment_count - 1].input_pitch;
+    result.corrected_pitch = segments[segment_count - 1].target_pitch;
     result.confidence = confidence_;
     
     return result;
 }
 
-ProcessingResult AutotuneEngine::process_quantization(const AudioFrame* input, 
-                                                    AudioFrame* output, 
-                                                    uint32_t frame_count) {
-    ProcessingResult result;
-    result.success = true;
+ProcessingResult AutotuneEngine::process_rhythm(const AudioBlockView& input, AudioBlockView& output) {
+    // Oversized blocks grow the delay line once (not real-time safe)
+    if (input.frame_count > rhythm_quantizer_->get_max_block_size()) {
+        prepare(input.frame_count);
+    }
     
-    // For now, quantization is applied through pitch correction
-    // In a more sophisticated implementation, this would handle timing quantization
+    streaming_ = true;
+    AUTOTUNE_TRACE_ZONE("AutotuneEngine::quantize_rhythm");
+    auto quantize_start = PerformanceMonitor::Clock::now();
+    ProcessingResult result = rhythm_quantizer_->process(input.channels, output.channels, input.channel_count,
+                                                         input.frame_count, *quantizer_, active_settings_.grid,
+                                                         active_settings_.params.quantize_strength);
+    monitor_.add_stage_time(PerformanceMonitor::Stage::QUANTIZE, PerformanceMonitor::nanoseconds_since(quantize_start));
+    return result;
+}
+
+void AutotuneEngine::restart_rhythm() {
+    rhythm_delay_ = active_settings_.mode == Mode::FULL_AUTOTUNE ? correction_latency() : 0;
+    rhythm_quantizer_->reset(static_cast<int64_t>(rhythm_origin_) - static_cast<int64_t>(rhythm_delay_));
+}
+
+void AutotuneEngine::track_pitch(const Sample* samples, uint32_t sample_count) {
+    auto detect_start = PerformanceMonitor::Clock::now();
+    uint32_t estimates = pitch_detector_->push_samples(samples, sample_count);
+    monitor_.add_stage_time(PerformanceMonitor::Stage::DETECT, PerformanceMonitor::nanoseconds_since(detect_start));
+    if (estimates == 0) {
+        return;
+    }
     
-    // Simple passthrough with potential timing adjustments
-    for (uint32_t i = 0; i < frame_count; ++i) {
-        output[i] = input[i];
+    current_pitch_ = pitch_detector_->get_tracked_pitch();
+    confidence_ = pitch_detector_->get_tracked_confidence();
+    if (recorded_track_) {
+        recorded_track_->add(track_position_, current_pitch_, confidence_);
+    }
+    apply_estimate(track_position_);
+}
+
+void AutotuneEngine::apply_estimate(uint64_t position) {
+    // Quantize now, or hand the scale note to the planner, which applies
+    // the strength once it has planned the note curve
+    AUTOTUNE_TRACE_ZONE("AutotuneEngine::quantize");
+    auto quantize_start = PerformanceMonitor::Clock::now();
+    if (lookahead_ > 0) {
+        planner_.push(position, current_pitch_, calculate_target_pitch(current_pitch_, 1.0f));
+    } else {
+        target_pitch_ = calculate_target_pitch(current_pitch_, active_settings_.params.quantize_strength);
+    }
+    monitor_.add_stage_time(PerformanceMonitor::Stage::QUANTIZE, PerformanceMonitor::nanoseconds_since(quantize_start));
+}
+
+uint32_t AutotuneEngine::follow_pitch_track() {
+    const std::vector<PitchTrack::Point>& points = pitch_track_->get_points();
+    bool updated = false;
+    while (pitch_track_index_ < points.size() && points[pitch_track_index_].position <= track_position_) {
+        current_pitch_ = points[pitch_track_index_].pitch;
+        confidence_ = points[pitch_track_index_].confidence;
+        if (lookahead_ > 0) {
+            apply_estimate(points[pitch_track_index_].position);
+        }
+        ++pitch_track_index_;
+        updated = true;
     }
     
-    return result;
+    // Reactively only the latest point matters
+    if (updated && lookahead_ == 0) {
+        apply_estimate(track_position_);
+    }
+    
+    if (pitch_track_index_ == points.size()) {
+        return UINT32_MAX;
+    }
+    return static_cast<uint32_t>(std::min<uint64_t>(points[pitch_track_index_].position - track_position_,
+                                                    UINT32_MAX));
+}
+
+void AutotuneEngine::record_pitch_track(PitchTrack* track) {
+    recorded_track_ = track;
+    track_position_ = 0;
+    if (track) {
+        track->clear();
+        track->set_key(get_pitch_analysis_key(track->get_key().content_hash));
+    }
+}
+
+bool AutotuneEngine::set_pitch_track(const PitchTrack* track) {
+    if (track && track->get_key().sample_rate != sample_rate_) {
+        return false;
+    }
+    pitch_track_ = track;
+    pitch_track_index_ = 0;
+    track_position_ = 0;
+    return true;
 }
 
-void AutotuneEngine::convert_to_mono(const AudioFrame* input, uint32_t frame_count) {
-    uint32_t samples_to_process = std::min(frame_count, static_cast<uint32_t>(mono_buffer_.size()));
+PitchTrack::AnalysisKey AutotuneEngine::get_pitch_analysis_key(uint64_t content_hash) const {
+    PitchTrack::AnalysisKey key;
+    key.content_hash = content_hash;
+    key.sample_rate = sample_rate_;
+    if (pitch_detector_) {
+        key.window_size = pitch_detector_->get_window_size();
+        key.hop_size = pitch_detector_->get_hop_size();
+        key.algorithm = static_cast<uint32_t>(pitch_detector_->get_algorithm());
+        key.analysis_rate = pitch_detector_->get_analysis_rate();
+        key.min_frequency = pitch_detector_->get_min_frequency();
+        key.max_frequency = pitch_detector_->get_max_frequency();
+        key.confidence_threshold = pitch_detector_->get_confidence_threshold();
+        key.gate_threshold = gate_level(settings_.silence_gate_db);
+        key.smoothing = pitch_detector_->get_smoothing();
+    }
+    return key;
+}
+
+void AutotuneEngine::convert_to_mono(const AudioBlockView& input) {
+    uint32_t samples_to_process = std::min(input.frame_count, static_cast<uint32_t>(mono_buffer_.size()));
     
-    for (uint32_t i = 0; i < samples_to_process; ++i) {
-        if (input[i].size() == 1) {
-            // Already mono
-            mono_buffer_[i] = input[i][0];
-        } else if (input[i].size() >= 2) {
-            // Mix stereo to mono
-            mono_buffer_[i] = (input[i][0] + input[i][1]) * 0.5f;
-        } else {
-            mono_buffer_[i] = 0.0f;
+    // Every channel contributes, so pitch is found wherever the voice is panned
+    simd::downmix(input.channels, input.channel_count, mono_buffer_.data(), samples_to_process);
+}
+
+void AutotuneEngine::copy_block(const AudioBlockView& input, AudioBlockView& output) {
+    for (ChannelCount ch = 0; ch < input.channel_count; ++ch) {
+        if (input.channels[ch] != output.channels[ch]) {
+            std::memcpy(output.channels[ch], input.channels[ch], input.frame_count * sizeof(Sample));
         }
     }
 }
 
-void AutotuneEngine::update_performance_metrics(float processing_time) {
-    latency_history_.push_back(processing_time);
-    if (latency_history_.size() > 100) {
-        latency_history_.erase(latency_history_.begin());
+void AutotuneEngine::copy_frames(const AudioFrame* input, AudioFrame* output, uint32_t frame_count) {
+    if (input == output) {
+        return;
     }
     
-    // Calculate average latency
-    if (!latency_history_.empty()) {
-        float sum = 0.0f;
-        for (float latency : latency_history_) {
-            sum += latency;
+    for (uint32_t i = 0; i < frame_count; ++i) {
+        ChannelCount channel_count = std::min(input[i].size(), output[i].size());
+        for (ChannelCount ch = 0; ch < channel_count; ++ch) {
+            output[i][ch] = input[i][ch];
         }
-        metrics_.average_latency_ms = sum / latency_history_.size();
     }
+}
+
+std::unique_ptr<AutotuneEngine> AutotuneEngine::clone() const {
+    auto engine = std::make_unique<AutotuneEngine>(sample_rate_, buffer_size_, channels_);
+    if (!engine->is_initialized()) {
+        return engine;
+    }
+    copy_configuration(*engine);
+    if (max_block_size_ != engine->get_max_block_size()) {
+        engine->prepare(max_block_size_);
+    }
+    return engine;
+}
+
+void AutotuneEngine::copy_configuration(AutotuneEngine& target) const {
+    target.set_parameters(settings_.params);
+    target.set_mode(settings_.mode);
+    target.set_scale(settings_.scale, settings_.key_center);
+    target.set_tempo(settings_.tempo);
+    target.set_time_signature(settings_.time_signature);
+    target.set_silence_gate(settings_.silence_gate_db);
+    target.set_rhythm_grid(settings_.grid);
+    target.set_lookahead(lookahead_ms_);
+    target.latency_profile_ = latency_profile_;
+    if (pitch_detector_ && target.pitch_detector_) {
+        target.pitch_detector_->set_algorithm(pitch_detector_->get_algorithm());
+        target.pitch_detector_->set_min_frequency(pitch_detector_->get_min_frequency());
+        target.pitch_detector_->set_max_frequency(pitch_detector_->get_max_frequency());
+        target.pitch_detector_->set_confidence_threshold(pitch_detector_->get_confidence_threshold());
+        target.pitch_detector_->set_smoothing(pitch_detector_->get_smoothing());
+        target.pitch_detector_->set_autocorrelation_method(pitch_detector_->get_autocorrelation_method());
+        target.pitch_detector_->set_tracking(pitch_detector_->get_window_size(),
+                                             pitch_detector_->get_hop_size());
+        if (pitch_detector_->get_decimation_factor() > 1) {
+            target.pitch_detector_->set_analysis_rate(pitch_detector_->get_analysis_rate());
+        }
+        target.configure_lookahead();
+    }
+    if (pitch_corrector_ && target.pitch_corrector_) {
+        target.pitch_corrector_->set_formant_preservation(pitch_corrector_->get_formant_preservation());
+        target.pitch_corrector_->set_backend(pitch_corrector_->get_backend());
+        target.pitch_corrector_->set_vocoder_overlap(pitch_corrector_->get_vocoder_overlap());
+        target.pitch_corrector_->set_minimum_pitch(pitch_corrector_->get_minimum_pitch());
+    }
+}
+
+bool AutotuneEngine::render_segment(const float* input, size_t input_frames, float* output, size_t frames,
+                                    size_t position) const {
+    AutotuneEngine engine(sample_rate_, buffer_size_, channels_);
+    if (!engine.is_initialized()) {
+        return false;
+    }
+    copy_configuration(engine);
+    engine.apply_pending_settings();
+    engine.rhythm_origin_ = position;
+    engine.restart_rhythm();
     
-    // Estimate CPU usage (simplified)
-    float max_processing_time = (static_cast<float>(buffer_size_) / sample_rate_) * 1000.0f;
-    metrics_.cpu_usage_percent = (processing_time / max_processing_time) * 100.0f;
+    // Planar scratch for one block in and out
+    std::vector<Sample> planar(static_cast<size_t>(buffer_size_) * channels_ * 2);
+    std::vector<Sample*> input_channels(channels_);
+    std::vector<Sample*> output_channels(channels_);
+    for (ChannelCount ch = 0; ch < channels_; ++ch) {
+        input_channels[ch] = planar.data() + static_cast<size_t>(ch) * buffer_size_;
+        output_channels[ch] = planar.data() + static_cast<size_t>(channels_ + ch) * buffer_size_;
+    }
+    
+    // Output trails input by the processing latency, so run that much past
+    // the segment and drop as much from the front to stay time-aligned
+    size_t latency = engine.get_latency_samples();
+    size_t total = frames + latency;
+    
+    for (size_t offset = 0; offset < total; offset += buffer_size_) {
+        uint32_t block = static_cast<uint32_t>(std::min<size_t>(buffer_size_, total - offset));
+        
+        for (uint32_t i = 0; i < block; ++i) {
+            size_t frame = offset + i;
+            for (ChannelCount ch = 0; ch < channels_; ++ch) {
+                input_channels[ch][i] = frame < input_frames ? input[frame * channels_ + ch] : 0.0f;
+            }
+        }
+        
+        AudioBlockView input_view(input_channels.data(), channels_, block);
+        AudioBlockView output_view(output_channels.data(), channels_, block);
+        if (!engine.process(input_view, output_view).success) {
+            return false;
+        }
+        
+        for (uint32_t i = 0; i < block; ++i) {
+            size_t frame = offset + i;
+            if (frame < latency) {
+                continue;
+            }
+            for (ChannelCount ch = 0; ch < channels_; ++ch) {
+                output[(frame - latency) * channels_ + ch] = output_channels[ch][i];
+            }
+        }
+    }
     
-    metrics_.frames_processed += buffer_size_;
-    performance_counter_++;
+    return true;
 }
 
-float AutotuneEngine::calculate_target_pitch(float detected_pitch) {
+float AutotuneEngine::calculate_target_pitch(float detected_pitch, float strength) {
     if (detected_pitch <= 0.0f || !quantizer_) {
         return detected_pitch;
     }
     
     // Use quantizer to find target pitch
-    return quantizer_->quantize_pitch(detected_pitch, current_scale_, key_center_, 
-                                     params_.quantize_strength);
+    return quantizer_->quantize_pitch(detected_pitch, active_settings_.scale, active_settings_.key_center,
+                                     strength);
 }
 
 } // namespace autotune
@@ -0,0 +1,315 @@
+#include "batch_pitch_detector.h"
+#include "pitch_detector.h"
+#include "simd.h"
+#include "table_cache.h"
+#include <algorithm>
+#include <cmath>
+
+namespace autotune {
+
+namespace {
+
+// Smoothing at or above 1 would freeze the estimate
+constexpr float kMaxSmoothing = 0.99f;
+
+// FFT rows are padded to whole 128-bit vectors so no lane takes the scalar tail
+constexpr uint32_t kLaneBlock = 4;
+
+// Power spectra of the two voices packed into each lane of one bin:
+// power_a = |Z + Z'|^2 / 4 and power_b = |Z - Z'|^2 / 4 with Z' = conj(Z[-k])
+void split_power(const float* re_k, const float* im_k, const float* re_m, const float* im_m,
+                 float* power_a, float* power_b, uint32_t lanes) {
+    for (uint32_t v = 0; v < lanes; ++v) {
+        float real_sum = re_k[v] + re_m[v];
+        float real_difference = re_k[v] - re_m[v];
+        float imag_sum = im_k[v] + im_m[v];
+        float imag_difference = im_k[v] - im_m[v];
+        power_a[v] = 0.25f * (real_sum * real_sum + imag_difference * imag_difference);
+        power_b[v] = 0.25f * (imag_sum * imag_sum + real_difference * real_difference);
+    }
+}
+
+void copy_row(const float* input, float* output, uint32_t count) {
+    for (uint32_t v = 0; v < count; ++v) {
+        output[v] = input[v];
+    }
+}
+
+} // namespace
+
+BatchPitchDetector::BatchPitchDetector(uint32_t voice_count, SampleRate sample_rate, uint32_t buffer_size)
+    : voice_count_(std::max(voice_count, 1u)), sample_rate_(sample_rate), buffer_size_(buffer_size),
+      min_frequency_(80.0f), max_frequency_(2000.0f), confidence_threshold_(0.3f),
+      pitch_smoothing_factor_(PitchDetector::kDefaultSmoothing), method_(AutocorrelationMethod::FFT),
+      fft_size_(FFT::next_power_of_two(std::max(buffer_size_ * 2, 4u))),
+      fft_lanes_(((voice_count_ + 1) / 2 + kLaneBlock - 1) / kLaneBlock * kLaneBlock) {
+    
+    size_t lane_samples = static_cast<size_t>(buffer_size_) * voice_count_;
+    interleaved_buffer_.resize(lane_samples, 0.0f);
+    windowed_buffer_.resize(lane_samples, 0.0f);
+    autocorr_.resize(lane_samples, 0.0f);
+    peak_lags_.resize(voice_count_, 0);
+    peak_values_.resize(voice_count_, 0.0f);
+    previous_pitch_.resize(voice_count_, 0.0f);
+    
+    fft_tables_ = TableCache<BatchPitchDetector, uint32_t, FftTables>::get(fft_size_, [this]() {
+        return build_tables(fft_size_);
+    });
+    fft_real_.resize(static_cast<size_t>(fft_size_) * fft_lanes_, 0.0f);
+    fft_imag_.resize(static_cast<size_t>(fft_size_) * fft_lanes_, 0.0f);
+    power_real_.resize(static_cast<size_t>(fft_size_) * fft_lanes_, 0.0f);
+    power_imag_.resize(static_cast<size_t>(fft_size_) * fft_lanes_, 0.0f);
+    
+    // The same Hanning window the single-voice autocorrelation estimator shares
+    window_ = AutocorrelationEstimator::shared_window(buffer_size_);
+}
+
+BatchPitchDetector::~BatchPitchDetector() = default;
+
+void BatchPitchDetector::detect_pitch(const Sample* interleaved, uint32_t sample_count, Estimate* estimates) {
+    if (!estimates) {
+        return;
+    }
+    std::fill(estimates, estimates + voice_count_, Estimate{});
+    if (!interleaved || sample_count < 2 || sample_count > buffer_size_) {
+        return;
+    }
+    
+    // Lag range as in PitchDetector / AutocorrelationEstimator
+    uint32_t min_lag = static_cast<uint32_t>(sample_rate_ / max_frequency_);
+    uint32_t max_lag = static_cast<uint32_t>(sample_rate_ / min_frequency_);
+    min_lag = std::max(1u, std::min(min_lag, sample_count - 1));
+    max_lag = std::min(max_lag, sample_count - 1);
+    if (min_lag >= max_lag) {
+        return;
+    }
+    
+    if (sample_count != window_->size()) {
+        window_ = AutocorrelationEstimator::shared_window(sample_count);
+    }
+    const uint32_t lanes = voice_count_;
+    simd::scale_lanes(interleaved, window_->data(), windowed_buffer_.data(), lanes, sample_count);
+    
+    // Zero lag for the confidence, the search range, and one lag either side
+    // of it for the parabolic fit
+    uint32_t last_lag = std::min(max_lag + 1, sample_count - 1);
+    if (method_ == AutocorrelationMethod::FFT) {
+        compute_fft(sample_count, last_lag);
+    } else {
+        compute_direct(sample_count, min_lag, last_lag);
+    }
+    
+    const float* autocorr = autocorr_.data();
+    // Peak picking runs lag-major so the inner loop walks the lanes
+    const float* first_row = autocorr + static_cast<size_t>(min_lag) * lanes;
+    std::fill(peak_lags_.begin(), peak_lags_.end(), min_lag);
+    std::copy(first_row, first_row + lanes, peak_values_.begin());
+    for (uint32_t lag = min_lag + 1; lag <= max_lag; ++lag) {
+        const float* row = autocorr + static_cast<size_t>(lag) * lanes;
+        for (uint32_t v = 0; v < lanes; ++v) {
+            if (row[v] > peak_values_[v]) {
+                peak_values_[v] = row[v];
+                peak_lags_[v] = lag;
+            }
+        }
+    }
+    
+    for (uint32_t v = 0; v < lanes; ++v) {
+        float energy = autocorr[v];
+        float confidence = energy > 0.0f ? std::clamp(peak_values_[v] / energy, 0.0f, 1.0f) : 0.0f;
+        if (confidence < confidence_threshold_) {
+            continue;
+        }
+        
+        uint32_t peak_lag = peak_lags_[v];
+        float period = static_cast<float>(peak_lag);
+        if (peak_lag + 1 < sample_count) {
+            float values[3] = {autocorr[static_cast<size_t>(peak_lag - 1) * lanes + v],
+                               peak_values_[v],
+                               autocorr[static_cast<size_t>(peak_lag + 1) * lanes + v]};
+            period = (peak_lag - 1) + PitchEstimator::parabolic_interpolation(values, 1, 3);
+        }
+        if (period <= 0.0f) {
+            continue;
+        }
+        
+        float pitch = static_cast<float>(sample_rate_) / period;
+        if (pitch < min_frequency_ || pitch > max_frequency_) {
+            continue;
+        }
+        
+        // Simple exponential smoothing, as PitchDetector does
+        if (previous_pitch_[v] != 0.0f) {
+            pitch = pitch_smoothing_factor_ * previous_pitch_[v] + (1.0f - pitch_smoothing_factor_) * pitch;
+        }
+        previous_pitch_[v] = pitch;
+        estimates[v].pitch = pitch;
+        estimates[v].confidence = confidence;
+    }
+}
+
+void BatchPitchDetector::compute_direct(uint32_t sample_count, uint32_t min_lag, uint32_t last_lag) {
+    const uint32_t lanes = voice_count_;
+    const Sample* windowed = windowed_buffer_.data();
+    float* autocorr = autocorr_.data();
+    
+    simd::dot_lanes(windowed, windowed, autocorr, lanes, sample_count);
+    for (uint32_t lag = std::max(min_lag - 1, 1u); lag <= last_lag; ++lag) {
+        size_t offset = static_cast<size_t>(lag) * lanes;
+        simd::dot_lanes(windowed, windowed + offset, autocorr + offset, lanes, sample_count - lag);
+    }
+}
+
+void BatchPitchDetector::compute_fft(uint32_t sample_count, uint32_t last_lag) {
+    const uint32_t lanes = voice_count_;
+    const uint32_t half = fft_lanes_;
+    const uint32_t lower = (lanes + 1) / 2;     // Voices in the real part
+    const uint32_t upper = lanes - lower;       // Voices in the imaginary part
+    const uint32_t* bit_reverse = fft_tables_->bit_reverse.data();
+    float* re = fft_real_.data();
+    float* im = fft_imag_.data();
+    
+    // Pack voice pairs into complex lanes, zero-padded to the transform size
+    // so the circular correlation equals the linear one. Rows are written in
+    // bit-reversed order, which the decimation-in-time stages expect. Frame
+    // i < size / 2 lands on the even row bit_reverse[i] and its odd neighbour
+    // holds padding, so the first stage just copies each row onto the next.
+    const Sample* windowed = windowed_buffer_.data();
+    for (uint32_t i = 0; i < fft_size_ / 2; ++i) {
+        size_t row = static_cast<size_t>(bit_reverse[i]) * half;
+        if (i < sample_count) {
+            const Sample* frame = windowed + static_cast<size_t>(i) * lanes;
+            copy_row(frame, re + row, lower);
+            copy_row(frame + lower, im + row, upper);
+            std::fill(re + row + lower, re + row + half, 0.0f);
+            std::fill(im + row + upper, im + row + half, 0.0f);
+        } else {
+            std::fill(re + row, re + row + half, 0.0f);
+            std::fill(im + row, im + row + half, 0.0f);
+        }
+        copy_row(re + row, re + row + half, half);
+        copy_row(im + row, im + row + half, half);
+    }
+    
+    transform(re, im, 4, false);
+    
+    // Split Z = A + iB into the power spectra of both voices: with
+    // Z' = conj(Z[-k]), A = (Z + Z') / 2 and B = (Z - Z') / 2i. Both spectra
+    // are real and even, so A + iB transforms back to r_a + i r_b. The
+    // result goes to bit-reversed rows for the inverse transform.
+    float* power_re = power_real_.data();
+    float* power_im = power_imag_.data();
+    for (uint32_t k = 0; k <= fft_size_ / 2; ++k) {
+        uint32_t mirror = (fft_size_ - k) & (fft_size_ - 1);
+        size_t row_k = static_cast<size_t>(k) * half;
+        size_t row_m = static_cast<size_t>(mirror) * half;
+        size_t out_k = static_cast<size_t>(bit_reverse[k]) * half;
+        split_power(re + row_k, im + row_k, re + row_m, im + row_m, power_re + out_k, power_im + out_k, half);
+        if (mirror != k) {
+            size_t out_m = static_cast<size_t>(bit_reverse[mirror]) * half;
+            copy_row(power_re + out_k, power_re + out_m, half);
+            copy_row(power_im + out_k, power_im + out_m, half);
+        }
+    }
+    
+    transform(power_re, power_im, 2, true);
+    
+    // Unpack into the lane layout (unnormalized; only ratios are used)
+    float* autocorr = autocorr_.data();
+    for (uint32_t lag = 0; lag <= last_lag; ++lag) {
+        float* row = autocorr + static_cast<size_t>(lag) * lanes;
+        copy_row(power_re + static_cast<size_t>(lag) * half, row, lower);
+        copy_row(power_im + static_cast<size_t>(lag) * half, row + lower, upper);
+    }
+}
+
+void BatchPitchDetector::transform(float* re, float* im, uint32_t first_length, bool inverse) {
+    // std::complex<float> arrays are (real, imaginary) float pairs
+    const float* twiddles = reinterpret_cast<const float*>(fft_tables_->twiddles.data());
+    
+    // Iterative radix-2 stages over bit-reversed rows; every butterfly
+    // covers all lanes, so even the short first stages fill whole vectors.
+    // Stages run in fused pairs to halve the passes over the rows, with one
+    // single stage first when their number is odd.
+    uint32_t stages = 0;
+    for (uint32_t length = first_length; length <= fft_size_; length <<= 1) {
+        ++stages;
+    }
+    uint32_t length = first_length;
+    if (stages % 2 != 0) {
+        simd::butterfly_lanes(re, im, twiddles, fft_size_ / length, length / 2, fft_size_, fft_lanes_, inverse);
+        length <<= 1;
+    }
+    for (; length <= fft_size_; length <<= 2) {
+        simd::fused_butterfly_lanes(re, im, twiddles, fft_size_ / (2 * length), length / 2, fft_size_,
+                                    fft_lanes_, inverse);
+    }
+}
+
+BatchPitchDetector::FftTables BatchPitchDetector::build_tables(uint32_t size) {
+    FftTables tables;
+    
+    tables.twiddles.resize(size / 2);
+    for (uint32_t i = 0; i < tables.twiddles.size(); ++i) {
+        double angle = -2.0 * M_PI * i / size;
+        tables.twiddles[i] = FFT::Complex(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+    }
+    
+    uint32_t bits = 0;
+    while ((1u << bits) < size) {
+        ++bits;
+    }
+    tables.bit_reverse.resize(size);
+    for (uint32_t i = 0; i < size; ++i) {
+        uint32_t reversed = 0;
+        for (uint32_t b = 0; b < bits; ++b) {
+            reversed |= ((i >> b) & 1u) << (bits - 1 - b);
+        }
+        tables.bit_reverse[i] = reversed;
+    }
+    return tables;
+}
+
+void BatchPitchDetector::detect_pitch(const Sample* const* windows, uint32_t sample_count, Estimate* estimates) {
+    if (!windows || sample_count > buffer_size_) {
+        if (estimates) {
+            std::fill(estimates, estimates + voice_count_, Estimate{});
+        }
+        return;
+    }
+    
+    interleave(windows, voice_count_, sample_count, interleaved_buffer_.data());
+    detect_pitch(interleaved_buffer_.data(), sample_count, estimates);
+}
+
+void BatchPitchDetector::interleave(const Sample* const* windows, uint32_t voice_count,
+                                    uint32_t sample_count, Sample* output) {
+    for (uint32_t v = 0; v < voice_count; ++v) {
+        const Sample* window = windows[v];
+        for (uint32_t i = 0; i < sample_count; ++i) {
+            output[static_cast<size_t>(i) * voice_count + v] = window[i];
+        }
+    }
+}
+
+void BatchPitchDetector::set_min_frequency(float min_freq) {
+    min_frequency_ = std::max(1.0f, min_freq);
+}
+
+void BatchPitchDetector::set_max_frequency(float max_freq) {
+    max_frequency_ = std::min(static_cast<float>(sample_rate_) / 2.0f, max_freq);
+}
+
+void BatchPitchDetector::set_confidence_threshold(float threshold) {
+    confidence_threshold_ = std::clamp(threshold, 0.0f, 1.0f);
+}
+
+void BatchPitchDetector::set_smoothing(float factor) {
+    pitch_smoothing_factor_ = std::clamp(factor, 0.0f, kMaxSmoothing);
+}
+
+void BatchPitchDetector::reset() {
+    std::fill(previous_pitch_.begin(), previous_pitch_.end(), 0.0f);
+}
+
+} // namespace autotune
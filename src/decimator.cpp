@@ -0,0 +1,74 @@
+#include "decimator.h"
+#include "simd.h"
+#include "table_cache.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace autotune {
+
+Decimator::Decimator(uint32_t factor, float passband)
+    : factor_(std::max(factor, 1u)) {
+    
+    passband = std::clamp(passband, 0.05f, 0.45f);
+    coefficients_ = TableCache<Decimator, std::pair<uint32_t, float>, std::vector<float>>::get(
+        std::make_pair(factor_, passband), [this, passband]() { return design(factor_, passband); });
+}
+
+std::vector<float> Decimator::design(uint32_t factor, float passband) {
+    if (factor == 1) {
+        return std::vector<float>(1, 1.0f);
+    }
+    
+    // Everything above the output Nyquist may alias, but only content that
+    // folds back below the passband edge matters, so the stopband starts at
+    // output_rate - passband. Blackman transition width is ~5.5 / taps.
+    double output_rate = 1.0 / factor;
+    double transition = output_rate * (1.0 - 2.0 * passband);
+    uint32_t taps = static_cast<uint32_t>(std::ceil(5.5 / transition)) | 1u;
+    double cutoff = 0.5 * output_rate;
+    
+    std::vector<float> coefficients(taps);
+    double center = 0.5 * (taps - 1);
+    double sum = 0.0;
+    for (uint32_t i = 0; i < taps; ++i) {
+        double x = i - center;
+        double sinc = x == 0.0 ? 2.0 * cutoff : std::sin(2.0 * M_PI * cutoff * x) / (M_PI * x);
+        double window = 0.42 - 0.5 * std::cos(2.0 * M_PI * i / (taps - 1)) +
+                        0.08 * std::cos(4.0 * M_PI * i / (taps - 1));
+        coefficients[i] = static_cast<float>(sinc * window);
+        sum += coefficients[i];
+    }
+    
+    // Unity DC gain
+    for (auto& coefficient : coefficients) {
+        coefficient = static_cast<float>(coefficient / sum);
+    }
+    return coefficients;
+}
+
+Decimator::~Decimator() = default;
+
+uint32_t Decimator::output_count(uint32_t sample_count) const {
+    uint32_t taps = this->taps();
+    return sample_count < taps ? 0 : (sample_count - taps) / factor_ + 1;
+}
+
+uint32_t Decimator::decimate(const Sample* input, uint32_t sample_count, Sample* output) const {
+    uint32_t count = output_count(sample_count);
+    if (!input || !output) {
+        return 0;
+    }
+    
+    if (factor_ == 1) {
+        std::memcpy(output, input, count * sizeof(Sample));
+        return count;
+    }
+    
+    for (uint32_t i = 0; i < count; ++i) {
+        output[i] = simd::dot(input + static_cast<size_t>(i) * factor_, coefficients_->data(), taps());
+    }
+    return count;
+}
+
+} // namespace autotune
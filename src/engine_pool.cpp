@@ -0,0 +1,329 @@
+#include "engine_pool.h"
+#include "trace.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace autotune {
+
+/**
+ * @brief Bounded Chase-Lev work-stealing deque of voice indices
+ *
+ * The owner pushes and pops at the bottom; other threads steal from the
+ * top. Capacity is fixed at construction so no operation allocates.
+ */
+class WorkStealingDeque {
+public:
+    explicit WorkStealingDeque(uint32_t capacity)
+        : buffer_(nullptr), mask_(0), top_(0), bottom_(0) {
+        uint32_t size = 1;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        buffer_.reset(new std::atomic<uint32_t>[size]);
+        mask_ = size - 1;
+    }
+    
+    bool push(uint32_t item) {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        int64_t top = top_.load(std::memory_order_acquire);
+        if (bottom - top > static_cast<int64_t>(mask_)) {
+            return false;
+        }
+        buffer_[bottom & mask_].store(item, std::memory_order_relaxed);
+        bottom_.store(bottom + 1, std::memory_order_seq_cst);
+        return true;
+    }
+    
+    bool pop(uint32_t& item) {
+        int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(bottom, std::memory_order_seq_cst);
+        int64_t top = top_.load(std::memory_order_seq_cst);
+        
+        if (top > bottom) {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return false;
+        }
+        
+        item = buffer_[bottom & mask_].load(std::memory_order_relaxed);
+        if (top == bottom) {
+            // Last item: race against thieves for it
+            bool won = top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                                    std::memory_order_relaxed);
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+    
+    bool steal(uint32_t& item) {
+        int64_t top = top_.load(std::memory_order_seq_cst);
+        int64_t bottom = bottom_.load(std::memory_order_seq_cst);
+        if (top >= bottom) {
+            return false;
+        }
+        
+        item = buffer_[top & mask_].load(std::memory_order_relaxed);
+        return top_.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst,
+                                            std::memory_order_relaxed);
+    }
+    
+    // Only valid while no other thread touches the deque
+    void clear() {
+        top_.store(0, std::memory_order_relaxed);
+        bottom_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::unique_ptr<std::atomic<uint32_t>[]> buffer_;
+    uint32_t mask_;
+    alignas(64) std::atomic<int64_t> top_;
+    alignas(64) std::atomic<int64_t> bottom_;
+};
+
+namespace {
+
+// Spin this many times before a worker sleeps on the condition variable
+constexpr int kWorkerSpinIterations = 2000;
+
+} // namespace
+
+EnginePool::EnginePool(uint32_t voice_count, SampleRate sample_rate, uint32_t buffer_size,
+                       ChannelCount channels, uint32_t worker_count)
+    : sample_rate_(sample_rate), deadline_fraction_(1.0f), unclaimed_voices_(0),
+      active_workers_(0), generation_(0), stopping_(false) {
+    
+    // Voices after the first are clones: they share its tables
+    engines_.reserve(voice_count);
+    for (uint32_t v = 0; v < voice_count; ++v) {
+        engines_.push_back(v == 0 ? std::make_unique<AutotuneEngine>(sample_rate, buffer_size, channels)
+                                  : engines_[0]->clone());
+    }
+    
+    results_.resize(voice_count);
+    deadline_misses_.resize(voice_count, 0);
+    missed_voices_.reserve(voice_count);
+    inputs_.resize(voice_count);
+    outputs_.resize(voice_count);
+    voice_states_.reset(new std::atomic<uint32_t>[std::max(voice_count, 1u)]);
+    for (uint32_t v = 0; v < voice_count; ++v) {
+        voice_states_[v].store(VOICE_DONE, std::memory_order_relaxed);
+    }
+    
+    // The calling thread also processes jobs, so leave it one core
+    if (worker_count == 0) {
+        uint32_t hardware = std::thread::hardware_concurrency();
+        worker_count = hardware > 1 ? hardware - 1 : 1;
+    }
+    worker_count = std::max(1u, std::min(worker_count, voice_count));
+    
+    // One deque per worker plus one for the calling thread
+    for (uint32_t i = 0; i <= worker_count; ++i) {
+        deques_.push_back(std::make_unique<WorkStealingDeque>(voice_count + 1));
+    }
+    
+    workers_.reserve(worker_count);
+    for (uint32_t i = 0; i < worker_count; ++i) {
+        workers_.emplace_back(&EnginePool::worker_loop, this, i);
+    }
+}
+
+EnginePool::~EnginePool() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stopping_.store(true, std::memory_order_seq_cst);
+    }
+    wake_condition_.notify_all();
+    
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+bool EnginePool::process(const AudioBlockView* inputs, AudioBlockView* outputs) {
+    uint32_t voices = voice_count();
+    missed_voices_.clear();
+    
+    if (!inputs || !outputs || voices == 0) {
+        return voices == 0;
+    }
+    
+    double period_seconds = static_cast<double>(inputs[0].frame_count) / sample_rate_;
+    Clock::time_point deadline = Clock::now() + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(period_seconds * deadline_fraction_));
+    
+    // Workers still leaving the previous callback may be reading the deques
+    while (active_workers_.load(std::memory_order_seq_cst) != 0) {
+        std::this_thread::yield();
+    }
+    deadline_ = deadline;
+    
+    // Publish jobs, spreading voices round-robin over all deques
+    uint32_t caller_index = worker_count();
+    for (auto& deque : deques_) {
+        deque->clear();
+    }
+    for (uint32_t v = 0; v < voices; ++v) {
+        inputs_[v] = inputs[v];
+        outputs_[v] = outputs[v];
+        results_[v] = ProcessingResult();
+        voice_states_[v].store(VOICE_PENDING, std::memory_order_relaxed);
+        deques_[v % deques_.size()]->push(v);
+    }
+    unclaimed_voices_.store(voices, std::memory_order_seq_cst);
+    
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        generation_.fetch_add(1, std::memory_order_release);
+    }
+    wake_condition_.notify_all();
+    
+    // Help until every voice has been claimed or the deadline passes
+    while (unclaimed_voices_.load(std::memory_order_acquire) > 0 && Clock::now() < deadline) {
+        uint32_t voice;
+        if (find_job(caller_index, voice)) {
+            run_voice(voice);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    
+    // Wait for running voices, but only until the deadline
+    bool all_finished = false;
+    while (!all_finished && Clock::now() < deadline) {
+        all_finished = true;
+        for (uint32_t v = 0; v < voices; ++v) {
+            uint32_t state = voice_states_[v].load(std::memory_order_acquire);
+            if (state == VOICE_PENDING || state == VOICE_RUNNING) {
+                all_finished = false;
+                break;
+            }
+        }
+        if (!all_finished) {
+            std::this_thread::yield();
+        }
+    }
+    
+    // Past the deadline: cancel voices that never started
+    for (uint32_t v = 0; v < voices; ++v) {
+        uint32_t expected = VOICE_PENDING;
+        if (voice_states_[v].compare_exchange_strong(expected, VOICE_CANCELLED,
+                                                      std::memory_order_acq_rel)) {
+            unclaimed_voices_.fetch_sub(1, std::memory_order_acq_rel);
+            pass_through(v);
+        }
+    }
+    
+    // Outputs must not be touched after returning, so running voices finish.
+    // Voices stamp their own lateness, so misses are seen even if the caller
+    // was descheduled past the deadline.
+    for (uint32_t v = 0; v < voices; ++v) {
+        uint32_t state;
+        while ((state = voice_states_[v].load(std::memory_order_acquire)) == VOICE_RUNNING) {
+            std::this_thread::yield();
+        }
+        if (state == VOICE_LATE || state == VOICE_CANCELLED) {
+            missed_voices_.push_back(v);
+            ++deadline_misses_[v];
+        }
+    }
+    
+    return missed_voices_.empty();
+}
+
+void EnginePool::set_deadline_fraction(float fraction) {
+    deadline_fraction_ = std::clamp(fraction, 0.05f, 1.0f);
+}
+
+void EnginePool::reset_statistics() {
+    std::fill(deadline_misses_.begin(), deadline_misses_.end(), 0);
+    missed_voices_.clear();
+}
+
+void EnginePool::worker_loop(uint32_t worker_index) {
+    AUTOTUNE_TRACE_THREAD_NAME("EnginePool worker");
+    uint64_t seen_generation = 0;
+    
+    while (true) {
+        // Spin briefly for low wake-up latency, then sleep
+        uint64_t generation = generation_.load(std::memory_order_acquire);
+        for (int spin = 0; spin < kWorkerSpinIterations && generation == seen_generation &&
+                           !stopping_.load(std::memory_order_relaxed); ++spin) {
+            std::this_thread::yield();
+            generation = generation_.load(std::memory_order_acquire);
+        }
+        
+        if (generation == seen_generation) {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_condition_.wait(lock, [this, seen_generation]() {
+                return stopping_.load(std::memory_order_relaxed) ||
+                       generation_.load(std::memory_order_relaxed) != seen_generation;
+            });
+            generation = generation_.load(std::memory_order_acquire);
+        }
+        
+        if (stopping_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        seen_generation = generation;
+        
+        // Register before looking at the jobs so process() can wait for us
+        active_workers_.fetch_add(1, std::memory_order_seq_cst);
+        run_jobs(worker_index);
+        active_workers_.fetch_sub(1, std::memory_order_seq_cst);
+    }
+}
+
+void EnginePool::run_jobs(uint32_t worker_index) {
+    while (unclaimed_voices_.load(std::memory_order_seq_cst) > 0) {
+        uint32_t voice;
+        if (find_job(worker_index, voice)) {
+            run_voice(voice);
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool EnginePool::find_job(uint32_t worker_index, uint32_t& voice) {
+    if (deques_[worker_index]->pop(voice)) {
+        return true;
+    }
+    
+    uint32_t deque_count = static_cast<uint32_t>(deques_.size());
+    for (uint32_t offset = 1; offset < deque_count; ++offset) {
+        if (deques_[(worker_index + offset) % deque_count]->steal(voice)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void EnginePool::run_voice(uint32_t voice) {
+    uint32_t expected = VOICE_PENDING;
+    if (!voice_states_[voice].compare_exchange_strong(expected, VOICE_RUNNING,
+                                                       std::memory_order_acq_rel)) {
+        return;
+    }
+    unclaimed_voices_.fetch_sub(1, std::memory_order_acq_rel);
+    
+    AUTOTUNE_TRACE_ZONE_VOICE("EnginePool::voice", voice);
+    results_[voice] = engines_[voice]->process(inputs_[voice], outputs_[voice]);
+    uint32_t finished = Clock::now() > deadline_ ? VOICE_LATE : VOICE_DONE;
+    voice_states_[voice].store(finished, std::memory_order_release);
+}
+
+void EnginePool::pass_through(uint32_t voice) {
+    const AudioBlockView& input = inputs_[voice];
+    AudioBlockView& output = outputs_[voice];
+    ChannelCount channels = std::min(input.channel_count, output.channel_count);
+    uint32_t frames = std::min(input.frame_count, output.frame_count);
+    
+    for (ChannelCount ch = 0; ch < channels; ++ch) {
+        if (input.channels[ch] != output.channels[ch]) {
+            std::memcpy(output.channels[ch], input.channels[ch], frames * sizeof(Sample));
+        }
+    }
+}
+
+} // namespace autotune
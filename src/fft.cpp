@@ -0,0 +1,142 @@
+#include "fft.h"
+#include "table_cache.h"
+#include <algorithm>
+#include <cmath>
+
+namespace autotune {
+
+namespace {
+
+// std::complex operator* handles inf/nan via a library call unless
+// -ffast-math is set, which dominates the butterfly cost
+inline FFT::Complex complex_multiply(const FFT::Complex& a, const FFT::Complex& b) {
+    return FFT::Complex(a.real() * b.real() - a.imag() * b.imag(),
+                        a.real() * b.imag() + a.imag() * b.real());
+}
+
+} // namespace
+
+FFT::FFT(uint32_t size)
+    : size_(next_power_of_two(std::max(size, 4u))), half_size_(size_ / 2) {
+    
+    tables_ = TableCache<FFT, uint32_t, Tables>::get(size_, [this]() { return build_tables(size_); });
+    twiddles_ = tables_->twiddles.data();
+    split_twiddles_ = tables_->split_twiddles.data();
+    bit_reverse_ = tables_->bit_reverse.data();
+    work_.resize(half_size_);
+}
+
+FFT::Tables FFT::build_tables(uint32_t size) {
+    Tables tables;
+    uint32_t half_size = size / 2;
+    
+    // Twiddles for the half-size complex transform
+    tables.twiddles.resize(half_size / 2);
+    for (uint32_t i = 0; i < tables.twiddles.size(); ++i) {
+        double angle = -2.0 * M_PI * i / half_size;
+        tables.twiddles[i] = Complex(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+    }
+    
+    // Twiddles used to split/merge the packed real spectrum
+    tables.split_twiddles.resize(half_size);
+    for (uint32_t k = 0; k < half_size; ++k) {
+        double angle = -2.0 * M_PI * k / size;
+        tables.split_twiddles[k] = Complex(static_cast<float>(std::cos(angle)), static_cast<float>(std::sin(angle)));
+    }
+    
+    // Bit-reversal permutation for the half-size transform
+    uint32_t bits = 0;
+    while ((1u << bits) < half_size) {
+        ++bits;
+    }
+    tables.bit_reverse.resize(half_size);
+    for (uint32_t i = 0; i < half_size; ++i) {
+        uint32_t reversed = 0;
+        for (uint32_t b = 0; b < bits; ++b) {
+            reversed |= ((i >> b) & 1u) << (bits - 1 - b);
+        }
+        tables.bit_reverse[i] = reversed;
+    }
+    return tables;
+}
+
+FFT::~FFT() = default;
+
+void FFT::forward(const Sample* input, Complex* output) {
+    // Pack even/odd samples into a half-size complex sequence
+    for (uint32_t n = 0; n < half_size_; ++n) {
+        work_[n] = Complex(input[2 * n], input[2 * n + 1]);
+    }
+    
+    transform(false);
+    
+    // Split the packed spectrum into the real-input spectrum
+    output[0] = Complex(work_[0].real() + work_[0].imag(), 0.0f);
+    output[half_size_] = Complex(work_[0].real() - work_[0].imag(), 0.0f);
+    
+    for (uint32_t k = 1; k < half_size_; ++k) {
+        Complex z = work_[k];
+        Complex zc = std::conj(work_[half_size_ - k]);
+        Complex even = 0.5f * (z + zc);
+        Complex difference = z - zc;
+        Complex odd(0.5f * difference.imag(), -0.5f * difference.real());  // -i/2 * difference
+        output[k] = even + complex_multiply(split_twiddles_[k], odd);
+    }
+}
+
+void FFT::inverse(const Complex* input, Sample* output) {
+    // Merge the real-input spectrum back into a packed half-size spectrum
+    for (uint32_t k = 0; k < half_size_; ++k) {
+        Complex x = input[k];
+        Complex xc = std::conj(input[half_size_ - k]);
+        Complex even = 0.5f * (x + xc);
+        Complex odd = complex_multiply(0.5f * (x - xc), std::conj(split_twiddles_[k]));
+        work_[k] = even + Complex(-odd.imag(), odd.real());  // even + i * odd
+    }
+    
+    transform(true);
+    
+    float scale = 1.0f / static_cast<float>(half_size_);
+    for (uint32_t n = 0; n < half_size_; ++n) {
+        output[2 * n] = work_[n].real() * scale;
+        output[2 * n + 1] = work_[n].imag() * scale;
+    }
+}
+
+uint32_t FFT::next_power_of_two(uint32_t value) {
+    uint32_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+void FFT::transform(bool inverse) {
+    for (uint32_t i = 0; i < half_size_; ++i) {
+        uint32_t j = bit_reverse_[i];
+        if (i < j) {
+            std::swap(work_[i], work_[j]);
+        }
+    }
+    
+    // Iterative radix-2 butterflies
+    for (uint32_t length = 2; length <= half_size_; length <<= 1) {
+        uint32_t half_length = length / 2;
+        uint32_t step = half_size_ / length;
+        
+        for (uint32_t start = 0; start < half_size_; start += length) {
+            for (uint32_t j = 0; j < half_length; ++j) {
+                Complex w = twiddles_[j * step];
+                if (inverse) {
+                    w = std::conj(w);
+                }
+                Complex a = work_[start + j];
+                Complex b = complex_multiply(work_[start + j + half_length], w);
+                work_[start + j] = a + b;
+                work_[start + j + half_length] = a - b;
+            }
+        }
+    }
+}
+
+} // namespace autotune
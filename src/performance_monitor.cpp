@@ -0,0 +1,158 @@
+#include "performance_monitor.h"
+#include <algorithm>
+#include <cmath>
+
+namespace autotune {
+
+namespace {
+
+constexpr double kNanosecondsPerMillisecond = 1e6;
+
+/**
+ * @brief Index of the highest set bit (value > 0)
+ */
+inline uint32_t highest_bit(uint64_t value) {
+    uint32_t bit = 0;
+    for (uint32_t shift = 32; shift > 0; shift >>= 1) {
+        if (value >> shift) {
+            value >>= shift;
+            bit += shift;
+        }
+    }
+    return bit;
+}
+
+} // namespace
+
+PerformanceMonitor::PerformanceMonitor(SampleRate sample_rate)
+    : sample_rate_(sample_rate) {
+    reset();
+}
+
+uint32_t PerformanceMonitor::bucket_index(uint64_t nanoseconds) {
+    nanoseconds = std::min<uint64_t>(nanoseconds, (uint64_t(1) << kMaxExponent) - 1);
+    if (nanoseconds < kSubBuckets) {
+        return static_cast<uint32_t>(nanoseconds);
+    }
+    
+    // The top kSubBucketBits + 1 bits select the bucket: the highest bit
+    // picks the power of two, the next ones the linear sub-bucket inside it
+    uint32_t exponent = highest_bit(nanoseconds);
+    uint32_t sub_bucket = static_cast<uint32_t>(nanoseconds >> (exponent - kSubBucketBits)) - kSubBuckets;
+    return kSubBuckets * (exponent - kSubBucketBits + 1) + sub_bucket;
+}
+
+uint64_t PerformanceMonitor::bucket_upper_edge(uint32_t bucket) {
+    if (bucket < kSubBuckets) {
+        return bucket + 1;
+    }
+    uint32_t exponent = bucket / kSubBuckets + kSubBucketBits - 1;
+    uint64_t sub_bucket = bucket % kSubBuckets;
+    return (kSubBuckets + sub_bucket + 1) << (exponent - kSubBucketBits);
+}
+
+void PerformanceMonitor::record_callback(uint64_t nanoseconds, uint32_t frame_count) {
+    add(buckets_[bucket_index(nanoseconds)], 1);
+    add(total_ns_, nanoseconds);
+    raise(max_ns_, nanoseconds);
+    add(frames_processed_, frame_count);
+    
+    // The callback must finish within the audio it produces
+    uint64_t period_ns = sample_rate_ > 0
+        ? static_cast<uint64_t>(frame_count) * 1000000000ull / sample_rate_ : 0;
+    if (nanoseconds > period_ns) {
+        add(deadline_misses_, 1);
+    }
+    
+    for (uint32_t stage = 0; stage < kStageCount; ++stage) {
+        add(stage_total_ns_[stage], pending_stage_ns_[stage]);
+        raise(stage_max_ns_[stage], pending_stage_ns_[stage]);
+        pending_stage_ns_[stage] = 0;
+    }
+    if (pending_skipped_) {
+        add(skipped_callbacks_, 1);
+        pending_skipped_ = false;
+    }
+    
+    // Published last: readers that see the new count see a complete callback
+    callbacks_.store(callbacks_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+PerformanceMonitor::Snapshot PerformanceMonitor::snapshot() const {
+    Snapshot snapshot;
+    snapshot.callbacks = callbacks_.load(std::memory_order_acquire);
+    if (snapshot.callbacks == 0) {
+        return snapshot;
+    }
+    
+    // Relaxed reads only: the writer is never waited on
+    snapshot.frames_processed = frames_processed_.load(std::memory_order_relaxed);
+    snapshot.deadline_misses = deadline_misses_.load(std::memory_order_relaxed);
+    snapshot.skipped_callbacks = skipped_callbacks_.load(std::memory_order_relaxed);
+    uint64_t total_ns = total_ns_.load(std::memory_order_relaxed);
+    uint64_t max_ns = max_ns_.load(std::memory_order_relaxed);
+    
+    std::array<uint64_t, kBucketCount> counts;
+    uint64_t recorded = 0;
+    for (uint32_t bucket = 0; bucket < kBucketCount; ++bucket) {
+        counts[bucket] = buckets_[bucket].load(std::memory_order_relaxed);
+        recorded += counts[bucket];
+    }
+    
+    double callbacks = static_cast<double>(snapshot.callbacks);
+    snapshot.mean_ms = total_ns / callbacks / kNanosecondsPerMillisecond;
+    snapshot.skipped_ratio = std::min(1.0, snapshot.skipped_callbacks / callbacks);
+    snapshot.p50_ms = percentile(counts, recorded, 0.5, max_ns) / kNanosecondsPerMillisecond;
+    snapshot.p99_ms = percentile(counts, recorded, 0.99, max_ns) / kNanosecondsPerMillisecond;
+    snapshot.p999_ms = percentile(counts, recorded, 0.999, max_ns) / kNanosecondsPerMillisecond;
+    snapshot.max_ms = max_ns / kNanosecondsPerMillisecond;
+    
+    double audio_ns = sample_rate_ > 0 ? snapshot.frames_processed * 1e9 / sample_rate_ : 0.0;
+    snapshot.load_percent = audio_ns > 0.0 ? 100.0 * total_ns / audio_ns : 0.0;
+    
+    for (uint32_t stage = 0; stage < kStageCount; ++stage) {
+        snapshot.stage_mean_ms[stage] = stage_total_ns_[stage].load(std::memory_order_relaxed) /
+                                        callbacks / kNanosecondsPerMillisecond;
+        snapshot.stage_max_ms[stage] = stage_max_ns_[stage].load(std::memory_order_relaxed) /
+                                       kNanosecondsPerMillisecond;
+    }
+    
+    return snapshot;
+}
+
+uint64_t PerformanceMonitor::percentile(const std::array<uint64_t, kBucketCount>& counts, uint64_t total,
+                                        double fraction, uint64_t max_ns) {
+    if (total == 0) {
+        return 0;
+    }
+    
+    uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * total)));
+    uint64_t seen = 0;
+    for (uint32_t bucket = 0; bucket < kBucketCount; ++bucket) {
+        seen += counts[bucket];
+        if (seen >= rank) {
+            return std::min(bucket_upper_edge(bucket), max_ns);
+        }
+    }
+    return max_ns;
+}
+
+void PerformanceMonitor::reset() {
+    for (auto& bucket : buckets_) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    for (uint32_t stage = 0; stage < kStageCount; ++stage) {
+        pending_stage_ns_[stage] = 0;
+        stage_total_ns_[stage].store(0, std::memory_order_relaxed);
+        stage_max_ns_[stage].store(0, std::memory_order_relaxed);
+    }
+    frames_processed_.store(0, std::memory_order_relaxed);
+    deadline_misses_.store(0, std::memory_order_relaxed);
+    skipped_callbacks_.store(0, std::memory_order_relaxed);
+    pending_skipped_ = false;
+    total_ns_.store(0, std::memory_order_relaxed);
+    max_ns_.store(0, std::memory_order_relaxed);
+    callbacks_.store(0, std::memory_order_release);
+}
+
+} // namespace autotune
@@ -0,0 +1,355 @@
+#include "phase_vocoder.h"
+#include "simd.h"
+#include "table_cache.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace autotune {
+
+namespace {
+
+// ~40 ms frames resolve the harmonics of low voices
+constexpr float kFrameSeconds = 0.04f;
+
+// Envelope keeps quefrencies below 1 ms, under the period of any sung pitch
+constexpr float kLifterSeconds = 0.001f;
+
+// Peaks quieter than this relative to the loudest bin are noise
+constexpr float kPeakThreshold = 1e-4f;
+
+// Limit on the formant correction gain so envelope nulls cannot blow up
+constexpr float kMaxEnvelopeGain = 8.0f;
+
+constexpr float kTwoPi = static_cast<float>(2.0 * M_PI);
+
+inline float wrap_phase(float phase) {
+    return phase - kTwoPi * std::nearbyint(phase / kTwoPi);
+}
+
+} // namespace
+
+PhaseVocoder::PhaseVocoder(SampleRate sample_rate, ChannelCount channels, uint32_t overlap)
+    : sample_rate_(sample_rate), channels_(0),
+      frame_size_(FFT::next_power_of_two(static_cast<uint32_t>(sample_rate * kFrameSeconds))),
+      overlap_(4), preserve_formants_(true), delayed_(false), prime_phases_(false), warmup_frames_(0),
+      fft_(frame_size_) {
+    
+    frame_size_ = fft_.size();
+    bin_count_ = fft_.bin_count();
+    lifter_ = std::clamp(static_cast<uint32_t>(sample_rate_ * kLifterSeconds), 8u, frame_size_ / 4);
+    
+    // Periodic square-root Hann: analysis times synthesis is a Hann window
+    window_ = TableCache<PhaseVocoder, uint32_t, std::vector<float>>::get(frame_size_, [this]() {
+        std::vector<float> window(frame_size_);
+        for (uint32_t i = 0; i < frame_size_; ++i) {
+            window[i] = std::sqrt(0.5f * (1.0f - std::cos(kTwoPi * i / frame_size_)));
+        }
+        return window;
+    });
+    synthesis_window_.resize(frame_size_);
+    
+    frame_.resize(frame_size_, 0.0f);
+    spectrum_.resize(bin_count_);
+    shifted_.resize(bin_count_);
+    magnitude_.resize(bin_count_, 0.0f);
+    phase_.resize(bin_count_, 0.0f);
+    frequency_.resize(bin_count_, 0.0f);
+    envelope_.resize(bin_count_, 1.0f);
+    peaks_.resize(bin_count_, 0);
+    regions_.resize(bin_count_);
+    region_count_ = 0;
+    gains_.resize(bin_count_, 1.0f);
+    reshape_ = false;
+    analysis_phase_.resize(bin_count_, 0.0f);
+    synthesis_phase_.resize(bin_count_, 0.0f);
+    
+    allocate_channels(std::max<ChannelCount>(channels, 1));
+    set_overlap(overlap == 2 ? 2 : 4);
+}
+
+PhaseVocoder::~PhaseVocoder() = default;
+
+void PhaseVocoder::set_overlap(uint32_t overlap) {
+    if (overlap != 2 && overlap != 4) {
+        return;
+    }
+    
+    overlap_ = overlap;
+    hop_size_ = frame_size_ / overlap_;
+    
+    // Hann windows spaced frame / overlap apart sum to overlap / 2
+    float gain = 2.0f / overlap_;
+    simd::scale(window_->data(), gain, synthesis_window_.data(), frame_size_);
+    
+    reset();
+}
+
+void PhaseVocoder::allocate_channels(ChannelCount channels) {
+    if (channels <= channels_) {
+        return;
+    }
+    
+    channels_ = channels;
+    input_fifo_.resize(static_cast<size_t>(channels_) * frame_size_, 0.0f);
+    output_accumulator_.resize(static_cast<size_t>(channels_) * frame_size_, 0.0f);
+    output_fifo_.resize(static_cast<size_t>(channels_) * (frame_size_ / 2), 0.0f);
+    channel_spectra_.resize(static_cast<size_t>(channels_) * bin_count_);
+}
+
+void PhaseVocoder::reset() {
+    std::fill(input_fifo_.begin(), input_fifo_.end(), 0.0f);
+    std::fill(output_accumulator_.begin(), output_accumulator_.end(), 0.0f);
+    std::fill(output_fifo_.begin(), output_fifo_.end(), 0.0f);
+    std::fill(analysis_phase_.begin(), analysis_phase_.end(), 0.0f);
+    std::fill(synthesis_phase_.begin(), synthesis_phase_.end(), 0.0f);
+    fifo_position_ = frame_size_ - hop_size_;
+    delayed_ = false;
+    prime_phases_ = false;
+    warmup_frames_ = 0;
+}
+
+void PhaseVocoder::process(const Sample* const* input, Sample* const* output, ChannelCount channels,
+                           uint32_t offset, uint32_t sample_count, float ratio) {
+    stream(input, output, channels, offset, sample_count, ratio, false);
+}
+
+void PhaseVocoder::delay(const Sample* const* input, Sample* const* output, ChannelCount channels,
+                         uint32_t offset, uint32_t sample_count) {
+    stream(input, output, channels, offset, sample_count, 1.0f, true);
+}
+
+void PhaseVocoder::stream(const Sample* const* input, Sample* const* output, ChannelCount channels,
+                          uint32_t offset, uint32_t sample_count, float ratio, bool delayed) {
+    channels = std::min(channels, channels_);
+    uint32_t fifo_start = frame_size_ - hop_size_;
+    
+    // New input fills the last hop of each frame while the previous
+    // frame's finished hop plays out
+    uint32_t done = 0;
+    while (done < sample_count) {
+        uint32_t count = std::min(sample_count - done, frame_size_ - fifo_position_);
+        for (ChannelCount ch = 0; ch < channels; ++ch) {
+            std::memcpy(input_fifo_.data() + static_cast<size_t>(ch) * frame_size_ + fifo_position_,
+                        input[ch] + offset + done, count * sizeof(Sample));
+            std::memcpy(output[ch] + offset + done,
+                        output_fifo_.data() + static_cast<size_t>(ch) * hop_size_ + (fifo_position_ - fifo_start),
+                        count * sizeof(Sample));
+        }
+        fifo_position_ += count;
+        done += count;
+        
+        if (fifo_position_ == frame_size_) {
+            end_frame(channels, ratio, delayed);
+            fifo_position_ = fifo_start;
+        }
+    }
+}
+
+void PhaseVocoder::end_frame(ChannelCount channels, float ratio, bool delayed) {
+    if (delayed) {
+        // Sums from before the delay age out as if silent frames were added
+        for (ChannelCount ch = 0; ch < channels; ++ch) {
+            emit_hop(ch);
+        }
+        delayed_ = true;
+    } else {
+        // The stale phases would misplace the first frame, and a hop is
+        // complete again once overlap_ shifted frames have been added to it
+        if (delayed_) {
+            delayed_ = false;
+            prime_phases_ = true;
+            warmup_frames_ = overlap_ - 1;
+        }
+        process_frames(channels, ratio);
+    }
+    
+    // The oldest input hop is exactly one frame old when it plays next
+    bool play_input = delayed || warmup_frames_ > 0;
+    uint32_t keep = frame_size_ - hop_size_;
+    for (ChannelCount ch = 0; ch < channels; ++ch) {
+        Sample* fifo = input_fifo_.data() + static_cast<size_t>(ch) * frame_size_;
+        if (play_input) {
+            std::memcpy(output_fifo_.data() + static_cast<size_t>(ch) * hop_size_, fifo,
+                        hop_size_ * sizeof(Sample));
+        }
+        std::memmove(fifo, fifo + hop_size_, keep * sizeof(Sample));
+    }
+    if (!delayed && warmup_frames_ > 0) {
+        --warmup_frames_;
+    }
+}
+
+void PhaseVocoder::process_frames(ChannelCount channels, float ratio) {
+    for (ChannelCount ch = 0; ch < channels; ++ch) {
+        simd::multiply(input_fifo_.data() + static_cast<size_t>(ch) * frame_size_, window_->data(),
+                       frame_.data(), frame_size_);
+        fft_.forward(frame_.data(), channel_spectra_.data() + static_cast<size_t>(ch) * bin_count_);
+    }
+    
+    if (channels == 1) {
+        analyze(channel_spectra_.data(), ratio);
+        shift_spectrum(channel_spectra_.data());
+        for (uint32_t k = 0; k < bin_count_; ++k) {
+            synthesis_phase_[k] = std::arg(shifted_[k]);
+        }
+        synthesize(0);
+        return;
+    }
+    
+    // The sum of the channels drives the shared analysis
+    std::copy(channel_spectra_.begin(), channel_spectra_.begin() + bin_count_, spectrum_.begin());
+    for (ChannelCount ch = 1; ch < channels; ++ch) {
+        const FFT::Complex* spectrum = channel_spectra_.data() + static_cast<size_t>(ch) * bin_count_;
+        for (uint32_t k = 0; k < bin_count_; ++k) {
+            spectrum_[k] += spectrum[k];
+        }
+    }
+    analyze(spectrum_.data(), ratio);
+    
+    // The shift is linear, so the shifted channels sum to the shifted sum,
+    // whose phases continue the linked synthesis phase
+    std::fill(spectrum_.begin(), spectrum_.end(), FFT::Complex(0.0f, 0.0f));
+    for (ChannelCount ch = 0; ch < channels; ++ch) {
+        shift_spectrum(channel_spectra_.data() + static_cast<size_t>(ch) * bin_count_);
+        for (uint32_t k = 0; k < bin_count_; ++k) {
+            spectrum_[k] += shifted_[k];
+        }
+        synthesize(ch);
+    }
+    for (uint32_t k = 0; k < bin_count_; ++k) {
+        synthesis_phase_[k] = std::arg(spectrum_[k]);
+    }
+}
+
+void PhaseVocoder::analyze(const FFT::Complex* spectrum, float ratio) {
+    // Measured frequency of each bin from its phase advance over one hop
+    const float expected = kTwoPi * hop_size_ / frame_size_;
+    float loudest = 0.0f;
+    for (uint32_t k = 0; k < bin_count_; ++k) {
+        magnitude_[k] = std::abs(spectrum[k]);
+        phase_[k] = std::arg(spectrum[k]);
+        if (prime_phases_) {
+            // As if the previous frame held the same spectrum: every bin at
+            // its nominal frequency, and ratio 1 reproduces the input
+            analysis_phase_[k] = phase_[k] - k * expected;
+            synthesis_phase_[k] = analysis_phase_[k];
+        }
+        float deviation = wrap_phase(phase_[k] - analysis_phase_[k] - k * expected);
+        analysis_phase_[k] = phase_[k];
+        frequency_[k] = k + deviation / expected;
+        loudest = std::max(loudest, magnitude_[k]);
+    }
+    prime_phases_ = false;
+    
+    reshape_ = preserve_formants_ && ratio != 1.0f;
+    if (reshape_) {
+        compute_envelope();
+    }
+    
+    // Local maxima over +-2 bins
+    uint32_t peak_count = 0;
+    float threshold = loudest * kPeakThreshold;
+    for (uint32_t k = 2; k + 2 < bin_count_; ++k) {
+        float m = magnitude_[k];
+        if (m > threshold && m > magnitude_[k - 1] && m >= magnitude_[k + 1] &&
+            m > magnitude_[k - 2] && m >= magnitude_[k + 2]) {
+            peaks_[peak_count++] = k;
+        }
+    }
+    
+    // Move each peak's region of influence (bounded by the magnitude minima
+    // between peaks) by the peak's frequency shift. The peak's phase
+    // continues from the output bin it lands in, and every bin of the region
+    // keeps its analysis phase offset from the peak.
+    region_count_ = 0;
+    uint32_t region_start = 0;
+    for (uint32_t i = 0; i < peak_count; ++i) {
+        uint32_t peak = peaks_[i];
+        uint32_t region_end = bin_count_;
+        if (i + 1 < peak_count) {
+            region_end = peak;
+            for (uint32_t k = peak + 1; k < peaks_[i + 1]; ++k) {
+                if (magnitude_[k] < magnitude_[region_end]) {
+                    region_end = k;
+                }
+            }
+            region_end = std::max(region_end, peak + 1);
+        }
+        
+        float shifted_frequency = frequency_[peak] * ratio;
+        int32_t shift = static_cast<int32_t>(std::lround(frequency_[peak] * (ratio - 1.0f)));
+        int32_t target = static_cast<int32_t>(peak) + shift;
+        if (target > 0 && target < static_cast<int32_t>(bin_count_)) {
+            // Bins that would leave the spectrum are dropped
+            uint32_t first = static_cast<uint32_t>(std::max<int32_t>(region_start, -shift));
+            uint32_t last = static_cast<uint32_t>(std::min<int32_t>(region_end, bin_count_ - shift));
+            float peak_phase = synthesis_phase_[target] + expected * shifted_frequency;
+            regions_[region_count_++] = {first, last, shift, std::polar(1.0f, peak_phase - phase_[peak])};
+            
+            if (reshape_) {
+                for (uint32_t k = first; k < last; ++k) {
+                    gains_[k] = std::min(envelope_[k + shift] / envelope_[k], kMaxEnvelopeGain);
+                }
+            }
+        }
+        region_start = region_end;
+    }
+}
+
+void PhaseVocoder::shift_spectrum(const FFT::Complex* spectrum) {
+    // Complex arithmetic spelled out: no sin/cos per bin and no NaN checks
+    std::fill(shifted_.begin(), shifted_.end(), FFT::Complex(0.0f, 0.0f));
+    for (uint32_t r = 0; r < region_count_; ++r) {
+        const Region& region = regions_[r];
+        if (region.start >= region.end) {
+            continue;
+        }
+        float cr = region.rotor.real();
+        float ci = region.rotor.imag();
+        FFT::Complex* destination = shifted_.data() + (static_cast<int32_t>(region.start) + region.shift);
+        for (uint32_t k = region.start; k < region.end; ++k) {
+            float gain = reshape_ ? gains_[k] : 1.0f;
+            float re = spectrum[k].real() * gain;
+            float im = spectrum[k].imag() * gain;
+            destination[k - region.start] += FFT::Complex(re * cr - im * ci, re * ci + im * cr);
+        }
+    }
+}
+
+void PhaseVocoder::synthesize(ChannelCount channel) {
+    Sample* accumulator = output_accumulator_.data() + static_cast<size_t>(channel) * frame_size_;
+    
+    fft_.inverse(shifted_.data(), frame_.data());
+    simd::multiply(frame_.data(), synthesis_window_.data(), frame_.data(), frame_size_);
+    simd::mix(accumulator, frame_.data(), accumulator, 1.0f, frame_size_);
+    emit_hop(channel);
+}
+
+void PhaseVocoder::emit_hop(ChannelCount channel) {
+    // The oldest hop is complete; shift the accumulator along by one hop
+    Sample* accumulator = output_accumulator_.data() + static_cast<size_t>(channel) * frame_size_;
+    uint32_t keep = frame_size_ - hop_size_;
+    std::memcpy(output_fifo_.data() + static_cast<size_t>(channel) * hop_size_, accumulator,
+                hop_size_ * sizeof(Sample));
+    std::memmove(accumulator, accumulator + hop_size_, keep * sizeof(Sample));
+    std::fill(accumulator + keep, accumulator + frame_size_, 0.0f);
+}
+
+void PhaseVocoder::compute_envelope() {
+    // Real cepstrum of the log magnitude (shifted_ and frame_ are free here)
+    for (uint32_t k = 0; k < bin_count_; ++k) {
+        shifted_[k] = FFT::Complex(std::log(std::max(magnitude_[k], 1e-9f)), 0.0f);
+    }
+    fft_.inverse(shifted_.data(), frame_.data());
+    
+    // Keep only the low quefrencies (both ends of the symmetric cepstrum)
+    std::fill(frame_.begin() + lifter_, frame_.end() - (lifter_ - 1), 0.0f);
+    
+    fft_.forward(frame_.data(), shifted_.data());
+    for (uint32_t k = 0; k < bin_count_; ++k) {
+        envelope_[k] = std::exp(shifted_[k].real());
+    }
+}
+
+} // namespace autotune
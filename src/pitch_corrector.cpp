@@ -1,30 +1,67 @@
 #include "pitch_corrector.h"
+#include "simd.h"
+#include "table_cache.h"
+#include "trace.h"
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <limits>
 
 namespace autotune {
 
-PitchCorrector::PitchCorrector(SampleRate sample_rate, uint32_t buffer_size)
-    : sample_rate_(sample_rate), buffer_size_(buffer_size), preserve_formants_(true),
-      phase_accumulator_(0.0f), previous_input_pitch_(0.0f), previous_target_pitch_(0.0f),
-      envelope_follower_(0.0f) {
-    
-    initialize_parameters();
+namespace {
+
+// Pitch range the shifter resolves by default; the lowest pitch sets the latency
+constexpr float kMinimumPitch = 80.0f;
+constexpr float kMaximumPitch = 2000.0f;
+
+// Range accepted by set_minimum_pitch()
+constexpr float kLowestPitchFloor = 20.0f;
+constexpr float kHighestPitchFloor = 1000.0f;
+
+// Mark spacing before the first voiced block
+constexpr float kInitialPitch = 200.0f;
+
+// Floor for the summed window: gaps between widely spaced grains (large
+// downward shifts) fade instead of being amplified back to full level
+constexpr float kMinimumWeight = 0.25f;
+
+// Ratio error within which the shifter counts as back at unity for bypass_block()
+constexpr float kBypassRatioTolerance = 1e-3f;
+
+// Intervals of the half Hann table grains are interpolated from (error < 1e-6)
+constexpr uint32_t kHannTableResolution = 1024;
+
+uint32_t next_power_of_two(uint32_t value) {
+    uint32_t result = 1;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+} // namespace
+
+PitchCorrector::PitchCorrector(SampleRate sample_rate, uint32_t buffer_size, ChannelCount channels)
+    : sample_rate_(sample_rate), buffer_size_(std::max(buffer_size, 1u)), preserve_formants_(true),
+      backend_(Backend::PSOLA), vocoder_(sample_rate, std::max<ChannelCount>(channels, 1)),
+      channels_(0), min_pitch_(kMinimumPitch), input_position_(0), synthesis_phase_(0.0),
+      bypassed_(false), delay_start_(0), delay_end_(0), current_ratio_(1.0f), target_ratio_(1.0f) {
     
-    // Initialize PSOLA buffers
-    grain_size_ = buffer_size * 2;  // Overlap for smooth transitions
-    overlap_size_ = grain_size_ / 4;
-    hop_size_ = grain_size_ - overlap_size_;
+    // 0.5 * (1 + cos(pi * x)) for x in [0, 1], one extra zero for interpolating at x = 1
+    hann_table_ = TableCache<PitchCorrector, uint32_t, std::vector<float>>::get(kHannTableResolution, []() {
+        std::vector<float> table(kHannTableResolution + 2, 0.0f);
+        for (uint32_t i = 0; i <= kHannTableResolution; ++i) {
+            table[i] = static_cast<float>(0.5 * (1.0 + std::cos(M_PI * i / kHannTableResolution)));
+        }
+        return table;
+    });
     
-    overlap_buffer_.resize(overlap_size_, 0.0f);
-    grain_buffer_.resize(grain_size_, 0.0f);
-    window_.resize(grain_size_);
+    initialize_parameters();
+    configure_periods();
+    allocate_channels(std::max<ChannelCount>(channels, 1));
     
-    // Precompute Hanning window for grain processing
-    for (uint32_t i = 0; i < grain_size_; ++i) {
-        window_[i] = 0.5f * (1.0f - std::cos(2.0f * M_PI * i / (grain_size_ - 1)));
-    }
+    reset();
 }
 
 PitchCorrector::~PitchCorrector() = default;
@@ -33,61 +70,208 @@ ProcessingResult PitchCorrector::correct_pitch(const Sample* input, Sample* outp
                                              uint32_t sample_count,
                                              float input_pitch, float target_pitch,
                                              float correction_strength) {
+    AUTOTUNE_TRACE_ZONE("PitchCorrector::correct_pitch");
+    if (!input || !output || sample_count == 0) {
+        ProcessingResult result;
+        result.success = false;
+        return result;
+    }
+    
+    return process_channels(&input, &output, 1, 0, sample_count, input_pitch, target_pitch, correction_strength);
+}
+
+ProcessingResult PitchCorrector::correct_block(const float* const* input, float* const* output,
+                                              ChannelCount channels, uint32_t frames,
+                                              const PitchCurve& pitch_curve) {
+    AUTOTUNE_TRACE_ZONE("PitchCorrector::correct_block");
     ProcessingResult result;
     
-    if (!input || !output || sample_count == 0) {
+    if (!input || !output || channels == 0 || channels > channels_ || frames == 0) {
+        result.success = false;
+        return result;
+    }
+    if (pitch_curve.segments) {
+        uint64_t covered = 0;
+        for (uint32_t i = 0; i < pitch_curve.segment_count; ++i) {
+            covered += pitch_curve.segments[i].frames;
+        }
+        if (covered != frames) {
+            result.success = false;
+            return result;
+        }
+    } else if (!pitch_curve.input_pitch || !pitch_curve.target_pitch) {
         result.success = false;
         return result;
     }
     
-    result.detected_pitch = input_pitch;
-    result.corrected_pitch = target_pitch;
+    // The backend is fixed for the whole block, so runs branch on nothing
+    return backend_ == Backend::PHASE_VOCODER
+        ? correct_runs<Backend::PHASE_VOCODER>(input, output, channels, frames, pitch_curve)
+        : correct_runs<Backend::PSOLA>(input, output, channels, frames, pitch_curve);
+}
+
+ProcessingResult PitchCorrector::bypass_block(const float* const* input, float* const* output,
+                                             ChannelCount channels, uint32_t frames) {
+    AUTOTUNE_TRACE_ZONE("PitchCorrector::bypass_block");
+    ProcessingResult result;
     
-    // If no valid pitch detected or correction strength is zero, pass through
-    if (input_pitch <= 0.0f || correction_strength <= 0.0f) {
-        std::memcpy(output, input, sample_count * sizeof(Sample));
-        result.success = true;
-        result.confidence = 0.0f;
+    if (!input || !output || channels == 0 || channels > channels_ || frames == 0) {
+        result.success = false;
         return result;
     }
     
-    // Calculate pitch shift ratio
-    float pitch_ratio = calculate_pitch_ratio(input_pitch, target_pitch, correction_strength);
+    if (!bypassed_) {
+        if (!can_bypass()) {
+            // Still gliding back; the shifter has to finish the release
+            return process_channels(input, output, channels, 0, frames, 0.0f, 0.0f, 0.0f);
+        }
+        
+        // Grains already cover the output up to the latest analysis mark
+        delay_start_ = std::llround(analysis_marks_[1]);
+        delay_end_ = std::numeric_limits<int64_t>::max();
+        current_ratio_ = 1.0f;
+        target_ratio_ = 1.0f;
+        bypassed_ = true;
+    }
     
-    // Apply pitch shifting using PSOLA
-    result.success = apply_psola_shift(input, output, sample_count, pitch_ratio);
-    result.confidence = 0.8f; // Placeholder confidence
-    result.latency_samples = overlap_size_; // Approximate latency
+    if (backend_ == Backend::PHASE_VOCODER) {
+        vocoder_.delay(input, output, channels, 0, frames);
+    } else {
+        for (uint32_t done = 0; done < frames; done += buffer_size_) {
+            delay_psola(input, output, channels, done, std::min(frames - done, buffer_size_));
+        }
+    }
     
+    result.success = true;
+    result.latency_samples = get_latency_samples();
+    return result;
+}
+
+bool PitchCorrector::can_bypass() const {
+    if (std::abs(current_ratio_ - 1.0f) > kBypassRatioTolerance) {
+        return false;
+    }
+    
+    // A new delay span may only open once the previous one has played out
+    return backend_ == Backend::PHASE_VOCODER ||
+           input_position_ - static_cast<int64_t>(latency_) >= delay_end_;
+}
+
+void PitchCorrector::resume(float period) {
+    // PSOLA restarts its marks at the newest input: the first grain lands
+    // on the latest mark and, at ratio 1, reproduces the input from there on,
+    // so only the output before it still comes from the delay line. The
+    // vocoder re-primes itself.
+    if (backend_ == Backend::PSOLA) {
+        analysis_marks_[0] = static_cast<double>(input_position_) - 2.0 * period;
+        analysis_marks_[1] = static_cast<double>(input_position_) - period;
+        mark_periods_[0] = mark_periods_[1] = period;
+        synthesis_phase_ = 1.0;
+        delay_end_ = std::max<int64_t>(delay_start_, std::llround(analysis_marks_[1]));
+    }
+    bypassed_ = false;
+}
+
+template <PitchCorrector::Backend B>
+ProcessingResult PitchCorrector::correct_runs(const float* const* input, float* const* output,
+                                              ChannelCount channels, uint32_t frames,
+                                              const PitchCurve& pitch_curve) {
+    ProcessingResult result;
+    if (pitch_curve.segments) {
+        uint32_t run_start = 0;
+        for (uint32_t i = 0; i < pitch_curve.segment_count; ++i) {
+            const PitchSegment& segment = pitch_curve.segments[i];
+            if (segment.frames > 0) {
+                result = shift_run<B>(input, output, channels, run_start, segment.frames,
+                                      segment.input_pitch, segment.target_pitch, pitch_curve);
+            }
+            run_start += segment.frames;
+        }
+        return result;
+    }
+    
+    uint32_t run_start = 0;
+    while (run_start < frames) {
+        float input_pitch = pitch_curve.input_pitch[run_start];
+        float target_pitch = pitch_curve.target_pitch[run_start];
+        uint32_t run_end = run_start + 1;
+        while (run_end < frames && pitch_curve.input_pitch[run_end] == input_pitch &&
+               pitch_curve.target_pitch[run_end] == target_pitch) {
+            ++run_end;
+        }
+        
+        result = shift_run<B>(input, output, channels, run_start, run_end - run_start,
+                              input_pitch, target_pitch, pitch_curve);
+        run_start = run_end;
+    }
+    
+    return result;
+}
+
+template <PitchCorrector::Backend B>
+ProcessingResult PitchCorrector::shift_run(const float* const* input, float* const* output, ChannelCount channels,
+                                           uint32_t offset, uint32_t frames, float input_pitch, float target_pitch,
+                                           const PitchCurve& pitch_curve) {
+    const float* strengths = pitch_curve.strength_curve;
+    if (!strengths) {
+        return shift_channels<B>(input, output, channels, offset, frames, input_pitch, target_pitch,
+                                 pitch_curve.correction_strength);
+    }
+    
+    ProcessingResult result;
+    uint32_t end = offset + frames;
+    while (offset < end) {
+        float strength = strengths[offset];
+        uint32_t piece_end = offset + 1;
+        while (piece_end < end && strengths[piece_end] == strength) {
+            ++piece_end;
+        }
+        result = shift_channels<B>(input, output, channels, offset, piece_end - offset,
+                                   input_pitch, target_pitch, strength);
+        offset = piece_end;
+    }
     return result;
 }
 
 ProcessingResult PitchCorrector::correct_pitch(const AudioFrame& input, AudioFrame& output,
                                              float input_pitch, float target_pitch,
                                              float correction_strength) {
-    ProcessingResult result;
+    ChannelCount channels = input.size();
+    if (channels == 0 || channels != output.size()) {
+        ProcessingResult result;
+        result.success = false;
+        return result;
+    }
+    
+    if (channels > channels_) {
+        allocate_channels(channels);
+    }
     
-    if (input.size() != output.size()) {
+    for (ChannelCount ch = 0; ch < channels; ++ch) {
+        frame_input_[ch] = &input[ch];
+        frame_output_[ch] = &output[ch];
+    }
+    return process_channels(frame_input_.data(), frame_output_.data(), channels, 0, 1,
+                            input_pitch, target_pitch, correction_strength);
+}
+
+ProcessingResult PitchCorrector::correct_pitch(const AudioBlockView& input, AudioBlockView& output,
+                                             float input_pitch, float target_pitch,
+                                             float correction_strength) {
+    if (!input.valid() || !output.valid() ||
+        input.channel_count != output.channel_count ||
+        input.frame_count != output.frame_count) {
+        ProcessingResult result;
         result.success = false;
         return result;
     }
     
-    // Process each channel separately
-    // For simplicity, we'll process only the first channel and copy to others
-    if (input.size() > 0) {
-        Sample input_sample = input[0];
-        Sample output_sample;
-        
-        result = correct_pitch(&input_sample, &output_sample, 1, 
-                              input_pitch, target_pitch, correction_strength);
-        
-        // Copy result to all channels
-        for (ChannelCount ch = 0; ch < output.size(); ++ch) {
-            output[ch] = output_sample;
-        }
+    if (input.channel_count > channels_) {
+        allocate_channels(input.channel_count);
     }
     
-    return result;
+    return process_channels(input.channels, output.channels, input.channel_count, 0, input.frame_count,
+                            input_pitch, target_pitch, correction_strength);
 }
 
 void PitchCorrector::set_parameters(const ProcessingParams& params) {
@@ -97,25 +281,96 @@ void PitchCorrector::set_parameters(const ProcessingParams& params) {
 
 void PitchCorrector::set_formant_preservation(bool preserve) {
     preserve_formants_ = preserve;
+    vocoder_.set_formant_preservation(preserve);
+}
+
+void PitchCorrector::set_minimum_pitch(float min_pitch) {
+    min_pitch = std::clamp(min_pitch, kLowestPitchFloor, kHighestPitchFloor);
+    if (min_pitch == min_pitch_) {
+        return;
+    }
+    min_pitch_ = min_pitch;
+    configure_periods();
+    
+    // The ring layout changed, so existing history is meaningless
+    input_history_.assign(static_cast<size_t>(channels_) * ring_size_, 0.0f);
+    output_ring_.assign(static_cast<size_t>(channels_) * ring_size_, 0.0f);
+    reset();
+}
+
+void PitchCorrector::set_backend(Backend backend) {
+    if (backend != backend_) {
+        backend_ = backend;
+        reset();
+    }
+}
+
+void PitchCorrector::set_vocoder_overlap(uint32_t overlap) {
+    vocoder_.set_overlap(overlap);
 }
 
 void PitchCorrector::reset() {
-    phase_accumulator_ = 0.0f;
-    previous_input_pitch_ = 0.0f;
-    previous_target_pitch_ = 0.0f;
-    envelope_follower_ = 0.0f;
+    vocoder_.reset();
+    std::fill(input_history_.begin(), input_history_.end(), 0.0f);
+    std::fill(output_ring_.begin(), output_ring_.end(), 0.0f);
+    std::fill(weight_ring_.begin(), weight_ring_.end(), 0.0f);
     
-    std::fill(overlap_buffer_.begin(), overlap_buffer_.end(), 0.0f);
-    std::fill(grain_buffer_.begin(), grain_buffer_.end(), 0.0f);
+    // Two virtual marks in the (silent) past start the mark sequence
+    float period = std::clamp(sample_rate_ / kInitialPitch,
+                              static_cast<float>(min_period_), static_cast<float>(max_period_));
+    input_position_ = 0;
+    analysis_marks_[0] = -2.0 * period;
+    analysis_marks_[1] = -period;
+    mark_periods_[0] = mark_periods_[1] = period;
+    synthesis_phase_ = 1.0;
+    bypassed_ = false;
+    delay_start_ = 0;
+    delay_end_ = 0;
+    current_ratio_ = 1.0f;
+    target_ratio_ = 1.0f;
 }
 
 void PitchCorrector::initialize_parameters() {
-    // Calculate envelope follower coefficients
+    // Pitch glide rates: the ratio error decays by e^(-1) per glide time
     float attack_time_samples = params_.attack_time * sample_rate_;
     float release_time_samples = params_.release_time * sample_rate_;
     
-    attack_coeff_ = 1.0f - std::exp(-1.0f / attack_time_samples);
-    release_coeff_ = 1.0f - std::exp(-1.0f / release_time_samples);
+    attack_rate_ = -static_cast<float>(M_LOG2E) / std::max(attack_time_samples, 1.0f);
+    release_rate_ = -static_cast<float>(M_LOG2E) / std::max(release_time_samples, 1.0f);
+}
+
+void PitchCorrector::glide_ratio(float samples) {
+    // Attack while the correction grows, release while it relaxes
+    float rate = std::abs(target_ratio_ - 1.0f) > std::abs(current_ratio_ - 1.0f) ? attack_rate_ : release_rate_;
+    current_ratio_ += (1.0f - std::exp2(samples * rate)) * (target_ratio_ - current_ratio_);
+}
+
+void PitchCorrector::configure_periods() {
+    // Grains span two periods; a future grain can still reach three longest
+    // periods back from the newest input (see place_pitch_marks), so that is
+    // how long each output sample has to wait
+    min_period_ = std::max(2u, static_cast<uint32_t>(sample_rate_ / kMaximumPitch));
+    max_period_ = std::max(min_period_, static_cast<uint32_t>(std::ceil(sample_rate_ / min_pitch_)));
+    latency_ = 3 * max_period_;
+    
+    // Rings hold every input sample a pending grain may still read and every
+    // output sample a grain may still write, even after a full chunk
+    ring_size_ = next_power_of_two(5 * max_period_ + buffer_size_);
+    ring_mask_ = ring_size_ - 1;
+    
+    weight_ring_.assign(ring_size_, 0.0f);
+    grain_buffer_.assign(2 * max_period_ + 1, 0.0f);
+    window_.assign(2 * max_period_ + 1, 0.0f);
+}
+
+void PitchCorrector::allocate_channels(ChannelCount channels) {
+    // Existing channels keep their history; new ones start silent
+    input_history_.resize(static_cast<size_t>(channels) * ring_size_, 0.0f);
+    output_ring_.resize(static_cast<size_t>(channels) * ring_size_, 0.0f);
+    vocoder_.allocate_channels(channels);
+    frame_input_.resize(channels);
+    frame_output_.resize(channels);
+    channels_ = channels;
 }
 
 float PitchCorrector::calculate_pitch_ratio(float input_pitch, float target_pitch, float strength) {
@@ -132,100 +387,191 @@ float PitchCorrector::calculate_pitch_ratio(float input_pitch, float target_pitc
     return std::clamp(corrected_ratio, 0.5f, 2.0f);
 }
 
-bool PitchCorrector::apply_psola_shift(const Sample* input, Sample* output, 
-                                      uint32_t sample_count, float pitch_ratio) {
-    // Simplified PSOLA implementation
-    // In a real implementation, this would be much more sophisticated
+ProcessingResult PitchCorrector::process_channels(const Sample* const* input, Sample* const* output,
+                                                  ChannelCount channels, uint32_t offset, uint32_t sample_count,
+                                                  float input_pitch, float target_pitch, float strength) {
+    return backend_ == Backend::PHASE_VOCODER
+        ? shift_channels<Backend::PHASE_VOCODER>(input, output, channels, offset, sample_count,
+                                                 input_pitch, target_pitch, strength)
+        : shift_channels<Backend::PSOLA>(input, output, channels, offset, sample_count,
+                                         input_pitch, target_pitch, strength);
+}
+
+template <PitchCorrector::Backend B>
+ProcessingResult PitchCorrector::shift_channels(const Sample* const* input, Sample* const* output,
+                                                ChannelCount channels, uint32_t offset, uint32_t sample_count,
+                                                float input_pitch, float target_pitch, float strength) {
+    ProcessingResult result;
+    result.detected_pitch = input_pitch;
+    result.corrected_pitch = target_pitch;
+    result.latency_samples = get_latency_samples();
     
-    for (uint32_t i = 0; i < sample_count; ++i) {
-        // Simple linear interpolation approach
-        float read_pos = phase_accumulator_;
-        uint32_t read_index = static_cast<uint32_t>(read_pos);
-        float fraction = read_pos - read_index;
-        
-        // Bounds checking
-        if (read_index < sample_count - 1) {
-            // Linear interpolation
-            output[i] = input[read_index] * (1.0f - fraction) + 
-                       input[read_index + 1] * fraction;
-        } else if (read_index < sample_count) {
-            output[i] = input[read_index];
-        } else {
-            output[i] = 0.0f;
-        }
-        
-        // Update phase accumulator
-        phase_accumulator_ += pitch_ratio;
-        if (phase_accumulator_ >= sample_count) {
-            phase_accumulator_ = 0.0f;
+    // Unvoiced input keeps flowing through the shifter at ratio 1 with the
+    // last mark spacing, so the delay never changes
+    bool voiced = input_pitch > 0.0f;
+    float period = mark_periods_[1];
+    if (voiced) {
+        period = std::clamp(sample_rate_ / input_pitch,
+                            static_cast<float>(min_period_), static_cast<float>(max_period_));
+    }
+    target_ratio_ = strength > 0.0f ? calculate_pitch_ratio(input_pitch, target_pitch, strength) : 1.0f;
+    if (bypassed_) {
+        resume(period);
+    }
+    
+    if constexpr (B == Backend::PHASE_VOCODER) {
+        // Frames are shifted as whole units, so glide once per call
+        glide_ratio(static_cast<float>(sample_count));
+        vocoder_.process(input, output, channels, offset, sample_count, current_ratio_);
+    } else {
+        // Chunks of at most one buffer keep the rings large enough
+        for (uint32_t done = 0; done < sample_count; done += buffer_size_) {
+            uint32_t chunk = std::min(sample_count - done, buffer_size_);
+            apply_psola_shift(input, output, channels, offset + done, chunk, period);
         }
-        
-        // Apply envelope following for smooth transitions
-        float envelope = update_envelope(std::abs(input[i]));
-        output[i] *= envelope;
     }
     
-    return true;
+    result.success = true;
+    result.confidence = voiced && strength > 0.0f ? 0.8f : 0.0f; // Placeholder confidence
+    return result;
 }
 
-uint32_t PitchCorrector::find_pitch_marks(const Sample* samples, uint32_t sample_count,
-                                        float pitch, std::vector<uint32_t>& marks) {
-    marks.clear();
-    
-    if (pitch <= 0.0f || sample_count < 2) {
-        return 0;
-    }
+void PitchCorrector::apply_psola_shift(const Sample* const* input, Sample* const* output, ChannelCount channels,
+                                      uint32_t offset, uint32_t sample_count, float period) {
+    write_history(input, channels, offset, sample_count);
     
-    // Calculate expected period in samples
-    float period_samples = sample_rate_ / pitch;
+    int64_t input_end = input_position_ + sample_count;
+    place_pitch_marks(channels, input_end, period);
+    emit_samples(output, channels, offset, sample_count);
     
-    // Simple zero-crossing based pitch mark detection
-    // In a real implementation, you'd want more sophisticated pitch mark detection
-    bool was_positive = samples[0] >= 0.0f;
-    uint32_t last_mark = 0;
+    input_position_ = input_end;
+}
+
+void PitchCorrector::delay_psola(const Sample* const* input, Sample* const* output, ChannelCount channels,
+                                 uint32_t offset, uint32_t sample_count) {
+    write_history(input, channels, offset, sample_count);
+    emit_samples(output, channels, offset, sample_count);
+    input_position_ += sample_count;
+}
+
+void PitchCorrector::write_history(const Sample* const* input, ChannelCount channels,
+                                   uint32_t offset, uint32_t sample_count) {
+    uint32_t write = static_cast<uint32_t>(input_position_) & ring_mask_;
+    uint32_t first = std::min(sample_count, ring_size_ - write);
+    for (ChannelCount ch = 0; ch < channels; ++ch) {
+        Sample* history = input_history_.data() + static_cast<size_t>(ch) * ring_size_;
+        std::memcpy(history + write, input[ch] + offset, first * sizeof(Sample));
+        std::memcpy(history, input[ch] + offset + first, (sample_count - first) * sizeof(Sample));
+    }
+}
+
+void PitchCorrector::emit_samples(Sample* const* output, ChannelCount channels,
+                                  uint32_t offset, uint32_t sample_count) {
+    // Emit the samples that are now exactly latency_ old; no pending grain
+    // reaches them. Inside the delay span they are the input itself.
+    int64_t emit_position = input_position_ - latency_;
+    auto chunk_index = [&](int64_t position) -> uint32_t {
+        if (position <= emit_position) {
+            return 0;
+        }
+        if (position >= emit_position + sample_count) {
+            return sample_count;
+        }
+        return static_cast<uint32_t>(position - emit_position);
+    };
+    uint32_t delay_first = chunk_index(delay_start_);
+    uint32_t delay_last = std::max(delay_first, chunk_index(delay_end_));
     
-    for (uint32_t i = 1; i < sample_count; ++i) {
-        bool is_positive = samples[i] >= 0.0f;
-        
-        // Detect positive-going zero crossing
-        if (!was_positive && is_positive) {
-            // Check if enough time has passed since last mark
-            if (i - last_mark >= period_samples * 0.5f) {
-                marks.push_back(i);
-                last_mark = i;
-            }
+    for (uint32_t i = 0; i < sample_count; ++i) {
+        uint32_t index = static_cast<uint32_t>(emit_position + i) & ring_mask_;
+        bool delayed = i >= delay_first && i < delay_last;
+        float gain = 1.0f / std::max(weight_ring_[index], kMinimumWeight);
+        for (ChannelCount ch = 0; ch < channels; ++ch) {
+            size_t slot = static_cast<size_t>(ch) * ring_size_ + index;
+            output[ch][offset + i] = delayed ? input_history_[slot] : output_ring_[slot] * gain;
+            output_ring_[slot] = 0.0f;
         }
-        
-        was_positive = is_positive;
+        weight_ring_[index] = 0.0f;
     }
-    
-    return static_cast<uint32_t>(marks.size());
 }
 
-void PitchCorrector::apply_window(Sample* data, uint32_t size, int window_type) {
-    for (uint32_t i = 0; i < size && i < window_.size(); ++i) {
-        if (window_type == 0) {
-            // Hanning window
-            data[i] *= window_[i];
-        } else {
-            // Hamming window
-            data[i] *= 0.54f - 0.46f * std::cos(2.0f * M_PI * i / (size - 1));
+void PitchCorrector::place_pitch_marks(ChannelCount channels, int64_t input_end, float period) {
+    for (;;) {
+        // Synthesis marks advance 1 / ratio analysis intervals per grain and
+        // sit at the same fraction of the interval in time, so their spacing
+        // is the local period divided by the ratio and at ratio 1 they land
+        // exactly on the analysis marks. Each grain comes from the nearer end.
+        while (synthesis_phase_ <= 1.0) {
+            double interval = analysis_marks_[1] - analysis_marks_[0];
+            double synthesis_mark = analysis_marks_[0] + synthesis_phase_ * interval;
+            int nearest = synthesis_phase_ < 0.5 ? 0 : 1;
+            add_grain(channels, analysis_marks_[nearest], mark_periods_[nearest], synthesis_mark);
+            
+            // Glide towards the target ratio over the grain spacing
+            float step = static_cast<float>(interval) / current_ratio_;
+            synthesis_phase_ += 1.0 / current_ratio_;
+            glide_ratio(step);
         }
+        
+        // The next analysis mark needs its whole grain buffered. When it is
+        // not, the latest mark is newer than input_end - 2 * period and a
+        // pending grain lies past it, so the grain starts after
+        //   input_end - 2 * period - longest period >= input_end - latency_
+        // and everything before input_end - latency_ is final.
+        double next_mark = analysis_marks_[1] + period;
+        if (next_mark + period > static_cast<double>(input_end)) {
+            break;
+        }
+        analysis_marks_[0] = analysis_marks_[1];
+        mark_periods_[0] = mark_periods_[1];
+        analysis_marks_[1] = next_mark;
+        mark_periods_[1] = period;
+        synthesis_phase_ -= 1.0;
     }
 }
 
-float PitchCorrector::update_envelope(float input) {
-    float target = std::abs(input);
+void PitchCorrector::add_grain(ChannelCount channels, double analysis_mark, float period, double synthesis_mark) {
+    // Hann window spanning two periods around the mark, interpolated from
+    // the table at |k| / period and mirrored
+    int32_t radius = std::min(static_cast<int32_t>(period), static_cast<int32_t>(max_period_));
+    uint32_t length = 2 * static_cast<uint32_t>(radius) + 1;
+    const float* table = hann_table_->data();
+    float scale = kHannTableResolution / period;
+    window_[radius] = 1.0f;
+    for (int32_t k = 1; k <= radius; ++k) {
+        float position = std::min(k * scale, static_cast<float>(kHannTableResolution));
+        uint32_t index = static_cast<uint32_t>(position);
+        float value = table[index] + (position - index) * (table[index + 1] - table[index]);
+        window_[radius + k] = value;
+        window_[radius - k] = value;
+    }
     
-    if (target > envelope_follower_) {
-        // Attack
-        envelope_follower_ += attack_coeff_ * (target - envelope_follower_);
-    } else {
-        // Release
-        envelope_follower_ += release_coeff_ * (target - envelope_follower_);
+    int64_t source = static_cast<int64_t>(std::llround(analysis_mark)) - radius;
+    int64_t destination = static_cast<int64_t>(std::llround(synthesis_mark)) - radius;
+    uint32_t read = static_cast<uint32_t>(source) & ring_mask_;
+    uint32_t write = static_cast<uint32_t>(destination) & ring_mask_;
+    uint32_t read_first = std::min(length, ring_size_ - read);
+    uint32_t write_first = std::min(length, ring_size_ - write);
+    
+    for (uint32_t i = 0; i < write_first; ++i) {
+        weight_ring_[write + i] += window_[i];
+    }
+    for (uint32_t i = write_first; i < length; ++i) {
+        weight_ring_[i - write_first] += window_[i];
     }
     
-    return envelope_follower_;
+    for (ChannelCount ch = 0; ch < channels; ++ch) {
+        const Sample* history = input_history_.data() + static_cast<size_t>(ch) * ring_size_;
+        Sample* ring = output_ring_.data() + static_cast<size_t>(ch) * ring_size_;
+        Sample* grain = grain_buffer_.data();
+        
+        std::memcpy(grain, history + read, read_first * sizeof(Sample));
+        std::memcpy(grain + read_first, history, (length - read_first) * sizeof(Sample));
+        simd::multiply(grain, window_.data(), grain, length);
+        
+        simd::mix(ring + write, grain, ring + write, 1.0f, write_first);
+        simd::mix(ring, grain + write_first, ring, 1.0f, length - write_first);
+    }
 }
 
 } // namespace autotune
@@ -1,44 +1,59 @@
 #include "pitch_detector.h"
+#include "simd.h"
+#include "trace.h"
 #include <algorithm>
 #include <cmath>
 #include <numeric>
 
 namespace autotune {
 
+namespace {
+
+// The gate closes at half the opening level (-6 dB) ...
+constexpr float kGateCloseRatio = 0.5f;
+
+// ... once it has been below that for this long
+constexpr float kGateHoldSeconds = 0.05f;
+
+// Windows crossing zero faster than a sine this many times the highest
+// detectable pitch are noise-like
+constexpr float kUnvoicedCrossingFactor = 2.0f;
+
+// Smoothing at or above 1 would freeze the estimate
+constexpr float kMaxSmoothing = 0.99f;
+
+} // namespace
+
 PitchDetector::PitchDetector(SampleRate sample_rate, uint32_t buffer_size)
     : sample_rate_(sample_rate), buffer_size_(buffer_size),
       min_frequency_(80.0f), max_frequency_(2000.0f), confidence_threshold_(0.3f),
-      previous_pitch_(0.0f), pitch_smoothing_factor_(0.8f) {
+      autocorr_method_(AutocorrelationMethod::FFT), algorithm_(Algorithm::AUTOCORRELATION),
+      window_size_(0), hop_size_(0), history_position_(0), history_fill_(0), hop_countdown_(0),
+      tracked_pitch_(0.0f), tracked_confidence_(0.0f),
+      gate_threshold_(0.0f), gate_open_(false), gated_(false), gate_hold_(0),
+      previous_pitch_(0.0f), pitch_smoothing_factor_(kDefaultSmoothing) {
     
     // Initialize processing buffers
-    windowed_buffer_.resize(buffer_size);
-    autocorr_buffer_.resize(buffer_size);
-    hanning_window_.resize(buffer_size);
-    
-    // Precompute Hanning window
-    for (uint32_t i = 0; i < buffer_size; ++i) {
-        hanning_window_[i] = 0.5f * (1.0f - std::cos(2.0f * M_PI * i / (buffer_size - 1)));
-    }
+    mono_buffer_.resize(buffer_size);
+    estimator_ = make_estimator(algorithm_);
+    set_tracking(buffer_size, buffer_size);
 }
 
 PitchDetector::~PitchDetector() = default;
 
 float PitchDetector::detect_pitch(const Sample* samples, uint32_t sample_count, float& confidence) {
+    AUTOTUNE_TRACE_ZONE("PitchDetector::detect_pitch");
     if (!samples || sample_count == 0 || sample_count > buffer_size_) {
         confidence = 0.0f;
         return 0.0f;
     }
     
-    // Apply windowing to reduce spectral leakage
-    apply_window(samples, windowed_buffer_.data(), sample_count);
-    
-    // Compute autocorrelation
-    compute_autocorrelation(windowed_buffer_.data(), autocorr_buffer_.data(), sample_count);
-    
-    // Find peak in autocorrelation function
-    uint32_t peak_lag = find_autocorr_peak(autocorr_buffer_.data(), sample_count, confidence);
+    // Estimate the period within the configured frequency range
+    uint32_t min_lag = static_cast<uint32_t>(sample_rate_ / max_frequency_);
+    uint32_t max_lag = static_cast<uint32_t>(sample_rate_ / min_frequency_);
+    float peak_lag = estimate_period(samples, sample_count, min_lag, max_lag, confidence);
     
-    if (confidence < confidence_threshold_ || peak_lag == 0) {
+    if (confidence < confidence_threshold_ || peak_lag <= 0.0f) {
         confidence = 0.0f;
         return 0.0f;
     }
@@ -59,18 +74,87 @@ float PitchDetector::detect_pitch(const Sample* samples, uint32_t sample_count,
 }
 
 float PitchDetector::detect_pitch(const AudioFrame& frame, float& confidence) {
-    // Use first channel for mono processing
     if (frame.size() == 0) {
         confidence = 0.0f;
         return 0.0f;
     }
     
-    // For now, just use the first channel
-    // In a real implementation, you might want to mix channels or process them separately
-    std::vector<Sample> mono_samples(1);
-    mono_samples[0] = frame[0];
+    // Average the channels, as for blocks
+    Sample mono_sample = 0.0f;
+    for (ChannelCount ch = 0; ch < frame.size(); ++ch) {
+        mono_sample += frame[ch];
+    }
+    mono_sample /= static_cast<float>(frame.size());
     
-    return detect_pitch(mono_samples.data(), 1, confidence);
+    return detect_pitch(&mono_sample, 1, confidence);
+}
+
+float PitchDetector::detect_pitch(const AudioBlockView& block, float& confidence) {
+    if (!block.valid() || block.frame_count == 0 || block.frame_count > buffer_size_) {
+        confidence = 0.0f;
+        return 0.0f;
+    }
+    
+    if (block.channel_count == 1) {
+        return detect_pitch(block.channels[0], block.frame_count, confidence);
+    }
+    
+    simd::downmix(block.channels, block.channel_count, mono_buffer_.data(), block.frame_count);
+    
+    return detect_pitch(mono_buffer_.data(), block.frame_count, confidence);
+}
+
+void PitchDetector::set_tracking(uint32_t window_size, uint32_t hop_size) {
+    window_size_ = std::clamp(window_size, 1u, buffer_size_);
+    hop_size_ = std::clamp(hop_size, 1u, window_size_);
+    history_.assign(static_cast<size_t>(window_size_) * 2, 0.0f);
+    history_position_ = 0;
+    history_fill_ = 0;
+    hop_countdown_ = hop_size_;
+    tracked_pitch_ = 0.0f;
+    tracked_confidence_ = 0.0f;
+    gate_open_ = false;
+    gated_ = false;
+    gate_hold_ = 0;
+}
+
+uint32_t PitchDetector::push_samples(const Sample* samples, uint32_t sample_count) {
+    if (!samples) {
+        return 0;
+    }
+    
+    uint32_t estimates = 0;
+    while (sample_count > 0) {
+        uint32_t chunk = std::min(sample_count, hop_countdown_);
+        for (uint32_t i = 0; i < chunk; ++i) {
+            history_[history_position_] = samples[i];
+            history_[history_position_ + window_size_] = samples[i];
+            if (++history_position_ == window_size_) {
+                history_position_ = 0;
+            }
+        }
+        history_fill_ = std::min(history_fill_ + chunk, window_size_);
+        hop_countdown_ -= chunk;
+        samples += chunk;
+        sample_count -= chunk;
+        
+        // Only full windows are analysed, so start-up does not skew smoothing
+        if (hop_countdown_ == 0) {
+            hop_countdown_ = hop_size_;
+            if (history_fill_ == window_size_) {
+                const Sample* window = history_.data() + history_position_;
+                if (update_gate(window, window_size_)) {
+                    tracked_pitch_ = detect_pitch(window, window_size_, tracked_confidence_);
+                } else {
+                    tracked_pitch_ = 0.0f;
+                    tracked_confidence_ = 0.0f;
+                }
+                ++estimates;
+            }
+        }
+    }
+    
+    return estimates;
 }
 
 void PitchDetector::set_min_frequency(float min_freq) {
@@ -85,69 +169,180 @@ void PitchDetector::set_confidence_threshold(float threshold) {
     confidence_threshold_ = std::clamp(threshold, 0.0f, 1.0f);
 }
 
-void PitchDetector::reset() {
-    previous_pitch_ = 0.0f;
-    std::fill(windowed_buffer_.begin(), windowed_buffer_.end(), 0.0f);
-    std::fill(autocorr_buffer_.begin(), autocorr_buffer_.end(), 0.0f);
+void PitchDetector::set_smoothing(float factor) {
+    pitch_smoothing_factor_ = std::clamp(factor, 0.0f, kMaxSmoothing);
+}
+
+void PitchDetector::set_gate_threshold(float threshold) {
+    gate_threshold_ = std::max(threshold, 0.0f);
+    gated_ = false;
 }
 
-void PitchDetector::apply_window(const Sample* input, Sample* output, uint32_t size) {
-    for (uint32_t i = 0; i < size; ++i) {
-        output[i] = input[i] * hanning_window_[i];
+bool PitchDetector::update_gate(const Sample* samples, uint32_t sample_count) {
+    if (gate_threshold_ <= 0.0f) {
+        gated_ = false;
+        return true;
     }
+    
+    // Both measures are single passes, far cheaper than any estimator
+    float mean_square = simd::dot(samples, samples, sample_count) / sample_count;
+    uint32_t crossings = 0;
+    for (uint32_t i = 1; i < sample_count; ++i) {
+        crossings += (samples[i - 1] < 0.0f) != (samples[i] < 0.0f);
+    }
+    float crossing_frequency = 0.5f * crossings * sample_rate_ / sample_count;
+    
+    float level = gate_open_ ? gate_threshold_ * kGateCloseRatio : gate_threshold_;
+    if (mean_square >= level * level && crossing_frequency <= kUnvoicedCrossingFactor * max_frequency_) {
+        gate_open_ = true;
+        gate_hold_ = static_cast<uint32_t>(kGateHoldSeconds * sample_rate_);
+    } else if (gate_open_ && gate_hold_ > 0) {
+        gate_hold_ -= std::min(gate_hold_, hop_size_);
+    } else {
+        gate_open_ = false;
+    }
+    
+    gated_ = !gate_open_;
+    return gate_open_;
 }
 
-void PitchDetector::compute_autocorrelation(const Sample* input, Sample* output, uint32_t size) {
-    // Simple autocorrelation implementation
-    // In a production system, you'd want to use FFT for better performance
-    for (uint32_t lag = 0; lag < size; ++lag) {
-        float sum = 0.0f;
-        for (uint32_t i = 0; i < size - lag; ++i) {
-            sum += input[i] * input[i + lag];
+void PitchDetector::set_autocorrelation_method(AutocorrelationMethod method) {
+    autocorr_method_ = method;
+    if (algorithm_ == Algorithm::AUTOCORRELATION) {
+        static_cast<AutocorrelationEstimator&>(*estimator_).set_method(method);
+    }
+}
+
+void PitchDetector::set_algorithm(Algorithm algorithm) {
+    if (algorithm == Algorithm::CUSTOM || algorithm == algorithm_) {
+        return;
+    }
+    estimator_ = make_estimator(algorithm);
+    algorithm_ = algorithm;
+}
+
+void PitchDetector::set_analysis_rate(SampleRate analysis_rate) {
+    uint32_t factor = analysis_rate > 0 ? sample_rate_ / analysis_rate : 1;
+    if (factor < 2) {
+        if (decimator_) {
+            decimator_.reset();
+            if (algorithm_ != Algorithm::CUSTOM) {
+                estimator_ = make_estimator(algorithm_);
+            }
         }
-        output[lag] = sum;
+        return;
+    }
+    
+    decimator_ = std::make_unique<Decimator>(factor);
+    decimated_buffer_.assign(analysis_window_size(), 0.0f);
+    energy_prefix_.assign(buffer_size_ + 1, 0.0f);
+    
+    // Built-in estimators are sized for the (shorter) decimated window
+    if (algorithm_ != Algorithm::CUSTOM) {
+        estimator_ = make_estimator(algorithm_);
     }
 }
 
-uint32_t PitchDetector::find_autocorr_peak(const Sample* autocorr, uint32_t size, float& confidence) {
-    if (size < 2) {
-        confidence = 0.0f;
-        return 0;
+void PitchDetector::set_estimator(std::unique_ptr<PitchEstimator> estimator) {
+    if (!estimator) {
+        return;
+    }
+    estimator_ = std::move(estimator);
+    algorithm_ = Algorithm::CUSTOM;
+}
+
+void PitchDetector::reset() {
+    previous_pitch_ = 0.0f;
+    std::fill(mono_buffer_.begin(), mono_buffer_.end(), 0.0f);
+    std::fill(history_.begin(), history_.end(), 0.0f);
+    history_position_ = 0;
+    history_fill_ = 0;
+    hop_countdown_ = hop_size_;
+    tracked_pitch_ = 0.0f;
+    tracked_confidence_ = 0.0f;
+    gate_open_ = false;
+    gated_ = false;
+    gate_hold_ = 0;
+}
+
+float PitchDetector::estimate_period(const Sample* samples, uint32_t sample_count,
+                                     uint32_t min_lag, uint32_t max_lag, float& confidence) {
+    if (!decimator_) {
+        return estimator_->estimate_period(samples, sample_count, min_lag, max_lag, confidence);
     }
     
-    // Skip the first sample (lag = 0) which is always the maximum
-    uint32_t min_lag = static_cast<uint32_t>(sample_rate_ / max_frequency_);
-    uint32_t max_lag = static_cast<uint32_t>(sample_rate_ / min_frequency_);
+    uint32_t factor = decimator_->factor();
+    uint32_t decimated_count = decimator_->decimate(samples, sample_count, decimated_buffer_.data());
+    float coarse_period = estimator_->estimate_period(decimated_buffer_.data(), decimated_count,
+                                                      min_lag / factor, (max_lag + factor - 1) / factor,
+                                                      confidence);
+    if (coarse_period <= 0.0f) {
+        return 0.0f;
+    }
     
-    min_lag = std::max(1u, std::min(min_lag, size - 1));
-    max_lag = std::min(max_lag, size - 1);
+    return refine_period(samples, sample_count, coarse_period * factor);
+}
+
+float PitchDetector::refine_period(const Sample* samples, uint32_t sample_count, float coarse_period) {
+    if (sample_count < 4) {
+        return coarse_period;
+    }
     
-    if (min_lag >= max_lag) {
-        confidence = 0.0f;
-        return 0;
+    // Prefix sums of x^2 make each lag's energy term O(1)
+    energy_prefix_[0] = 0.0f;
+    for (uint32_t i = 0; i < sample_count; ++i) {
+        energy_prefix_[i + 1] = energy_prefix_[i] + samples[i] * samples[i];
     }
     
-    // Find maximum in valid range
-    uint32_t peak_lag = min_lag;
-    float peak_value = autocorr[min_lag];
+    auto nsdf = [&](uint32_t lag) {
+        uint32_t overlap = sample_count - lag;
+        float correlation = simd::dot(samples, samples + lag, overlap);
+        float energy = energy_prefix_[overlap] + (energy_prefix_[sample_count] - energy_prefix_[lag]);
+        return energy > 0.0f ? 2.0f * correlation / energy : 0.0f;
+    };
+    
+    // Hill-climb the full-rate NSDF from the coarse estimate. A correct coarse
+    // period is within a decimated sample; the step limit bounds the cost
+    // when the coarse estimate sat on the edge of its lag range.
+    uint32_t lag = static_cast<uint32_t>(std::clamp<long>(std::lround(coarse_period), 2, sample_count - 2));
+    float values[3] = {nsdf(lag - 1), nsdf(lag), nsdf(lag + 1)};
+    uint32_t max_steps = 2 * decimator_->factor();
     
-    for (uint32_t lag = min_lag + 1; lag <= max_lag; ++lag) {
-        if (autocorr[lag] > peak_value) {
-            peak_value = autocorr[lag];
-            peak_lag = lag;
+    for (uint32_t step = 0; step < max_steps; ++step) {
+        if (values[2] > values[1] && lag + 2 < sample_count) {
+            ++lag;
+            values[0] = values[1];
+            values[1] = values[2];
+            values[2] = nsdf(lag + 1);
+        } else if (values[0] > values[1] && lag > 2) {
+            --lag;
+            values[2] = values[1];
+            values[1] = values[0];
+            values[0] = nsdf(lag - 1);
+        } else {
+            break;
         }
     }
     
-    // Calculate confidence as ratio of peak to first value
-    confidence = (autocorr[0] > 0.0f) ? (peak_value / autocorr[0]) : 0.0f;
-    confidence = std::clamp(confidence, 0.0f, 1.0f);
-    
-    return peak_lag;
+    return (lag - 1) + PitchEstimator::parabolic_interpolation(values, 1, 3);
+}
+
+std::unique_ptr<PitchEstimator> PitchDetector::make_estimator(Algorithm algorithm) const {
+    switch (algorithm) {
+        case Algorithm::YIN:
+            return std::make_unique<YinEstimator>(analysis_window_size());
+        case Algorithm::MPM:
+            return std::make_unique<MpmEstimator>(analysis_window_size());
+        case Algorithm::AUTOCORRELATION:
+        case Algorithm::CUSTOM:
+            break;
+    }
+    return std::make_unique<AutocorrelationEstimator>(analysis_window_size(), autocorr_method_);
 }
 
-float PitchDetector::lag_to_frequency(uint32_t lag) const {
-    if (lag == 0) return 0.0f;
-    return static_cast<float>(sample_rate_) / static_cast<float>(lag);
+float PitchDetector::lag_to_frequency(float lag) const {
+    if (lag <= 0.0f) return 0.0f;
+    return static_cast<float>(sample_rate_) / lag;
 }
 
 float PitchDetector::smooth_pitch(float current_pitch) {
@@ -0,0 +1,302 @@
+#include "pitch_estimator.h"
+#include "simd.h"
+#include "table_cache.h"
+#include <algorithm>
+#include <cmath>
+
+namespace autotune {
+
+float PitchEstimator::parabolic_interpolation(const float* values, uint32_t index, uint32_t size) {
+    if (index == 0 || index + 1 >= size) {
+        return static_cast<float>(index);
+    }
+    
+    float left = values[index - 1];
+    float center = values[index];
+    float right = values[index + 1];
+    float curvature = left - 2.0f * center + right;
+    
+    if (std::abs(curvature) < 1e-12f) {
+        return static_cast<float>(index);
+    }
+    
+    // Vertex of the parabola; a true extremum lies within half a sample
+    float offset = std::clamp(0.5f * (left - right) / curvature, -0.5f, 0.5f);
+    return static_cast<float>(index) + offset;
+}
+
+// ---------------------------------------------------------------------------
+// AutocorrelationEstimator
+// ---------------------------------------------------------------------------
+
+AutocorrelationEstimator::AutocorrelationEstimator(uint32_t max_size, Method method)
+    : max_size_(max_size), method_(method), fft_(max_size * 2) {
+    
+    windowed_buffer_.resize(max_size);
+    autocorr_buffer_.resize(max_size);
+    fft_buffer_.resize(fft_.size(), 0.0f);
+    spectrum_buffer_.resize(fft_.bin_count());
+    
+    // Start from the shared Hanning window of the full size
+    window_ = shared_window(max_size);
+}
+
+std::shared_ptr<const std::vector<float>> AutocorrelationEstimator::shared_window(uint32_t size) {
+    return TableCache<AutocorrelationEstimator, uint32_t, std::vector<float>>::get(size, [size]() {
+        std::vector<float> window(size);
+        fill_window(window.data(), size);
+        return window;
+    });
+}
+
+void AutocorrelationEstimator::fill_window(float* window, uint32_t size) {
+    for (uint32_t i = 0; i < size; ++i) {
+        window[i] = 0.5f * (1.0f - std::cos(2.0f * M_PI * i / (size - 1)));
+    }
+}
+
+float AutocorrelationEstimator::estimate_period(const Sample* samples, uint32_t sample_count,
+                                                uint32_t min_lag, uint32_t max_lag, float& confidence) {
+    confidence = 0.0f;
+    if (!samples || sample_count < 2 || sample_count > max_size_) {
+        return 0.0f;
+    }
+    
+    // Apply windowing to reduce spectral leakage; shorter windows get their
+    // own full Hanning shape (fetched only when the length changes)
+    if (sample_count != window_->size()) {
+        window_ = shared_window(sample_count);
+    }
+    simd::multiply(samples, window_->data(), windowed_buffer_.data(), sample_count);
+    
+    if (method_ == Method::FFT) {
+        compute_fft(windowed_buffer_.data(), autocorr_buffer_.data(), sample_count);
+    } else {
+        compute_direct(windowed_buffer_.data(), autocorr_buffer_.data(), sample_count);
+    }
+    
+    // Skip the first sample (lag = 0) which is always the maximum
+    min_lag = std::max(1u, std::min(min_lag, sample_count - 1));
+    max_lag = std::min(max_lag, sample_count - 1);
+    
+    if (min_lag >= max_lag) {
+        return 0.0f;
+    }
+    
+    // Find maximum in valid range
+    const Sample* autocorr = autocorr_buffer_.data();
+    uint32_t peak_lag = min_lag;
+    float peak_value = autocorr[min_lag];
+    
+    for (uint32_t lag = min_lag + 1; lag <= max_lag; ++lag) {
+        if (autocorr[lag] > peak_value) {
+            peak_value = autocorr[lag];
+            peak_lag = lag;
+        }
+    }
+    
+    // Calculate confidence as ratio of peak to first value
+    confidence = (autocorr[0] > 0.0f) ? (peak_value / autocorr[0]) : 0.0f;
+    confidence = std::clamp(confidence, 0.0f, 1.0f);
+    
+    return parabolic_interpolation(autocorr, peak_lag, sample_count);
+}
+
+void AutocorrelationEstimator::compute_direct(const Sample* input, Sample* output, uint32_t size) {
+    for (uint32_t lag = 0; lag < size; ++lag) {
+        output[lag] = simd::dot(input, input + lag, size - lag);
+    }
+}
+
+void AutocorrelationEstimator::compute_fft(const Sample* input, Sample* output, uint32_t size) {
+    // Zero-pad to at least 2 * size so the circular correlation equals the linear one
+    std::copy(input, input + size, fft_buffer_.begin());
+    std::fill(fft_buffer_.begin() + size, fft_buffer_.end(), 0.0f);
+    
+    fft_.forward(fft_buffer_.data(), spectrum_buffer_.data());
+    
+    // Wiener-Khinchin: autocorrelation is the inverse transform of the power spectrum
+    for (auto& bin : spectrum_buffer_) {
+        bin = FFT::Complex(std::norm(bin), 0.0f);
+    }
+    
+    fft_.inverse(spectrum_buffer_.data(), fft_buffer_.data());
+    std::copy(fft_buffer_.begin(), fft_buffer_.begin() + size, output);
+}
+
+// ---------------------------------------------------------------------------
+// DifferenceEstimator
+// ---------------------------------------------------------------------------
+
+DifferenceEstimator::DifferenceEstimator(uint32_t max_size)
+    : fft_(max_size * 2) {
+    
+    autocorr_.resize(max_size, 0.0f);
+    energy_.resize(max_size, 0.0f);
+    function_.resize(max_size, 0.0f);
+    fft_buffer_.resize(fft_.size(), 0.0f);
+    spectrum_buffer_.resize(fft_.bin_count());
+}
+
+void DifferenceEstimator::compute_terms(const Sample* samples, uint32_t sample_count, uint32_t max_lag) {
+    // r(tau) of the unwindowed signal via the zero-padded power spectrum
+    std::copy(samples, samples + sample_count, fft_buffer_.begin());
+    std::fill(fft_buffer_.begin() + sample_count, fft_buffer_.end(), 0.0f);
+    
+    fft_.forward(fft_buffer_.data(), spectrum_buffer_.data());
+    for (auto& bin : spectrum_buffer_) {
+        bin = FFT::Complex(std::norm(bin), 0.0f);
+    }
+    fft_.inverse(spectrum_buffer_.data(), fft_buffer_.data());
+    std::copy(fft_buffer_.begin(), fft_buffer_.begin() + max_lag + 1, autocorr_.begin());
+    
+    // m(tau) drops one sample from each end of the overlap per lag step
+    energy_[0] = 2.0f * simd::dot(samples, samples, sample_count);
+    for (uint32_t tau = 1; tau <= max_lag; ++tau) {
+        float head = samples[tau - 1];
+        float tail = samples[sample_count - tau];
+        energy_[tau] = std::max(0.0f, energy_[tau - 1] - head * head - tail * tail);
+    }
+}
+
+bool DifferenceEstimator::clamp_lag_range(uint32_t sample_count, uint32_t& min_lag, uint32_t& max_lag) {
+    // At least two periods must fit in the window; keep one lag of headroom
+    // on each side for parabolic interpolation
+    min_lag = std::max(min_lag, 2u);
+    max_lag = std::min(max_lag, sample_count / 2);
+    return min_lag < max_lag;
+}
+
+// ---------------------------------------------------------------------------
+// YinEstimator
+// ---------------------------------------------------------------------------
+
+YinEstimator::YinEstimator(uint32_t max_size, float threshold)
+    : DifferenceEstimator(max_size), threshold_(0.15f) {
+    set_threshold(threshold);
+}
+
+void YinEstimator::set_threshold(float threshold) {
+    threshold_ = std::clamp(threshold, 0.01f, 1.0f);
+}
+
+float YinEstimator::estimate_period(const Sample* samples, uint32_t sample_count,
+                                    uint32_t min_lag, uint32_t max_lag, float& confidence) {
+    confidence = 0.0f;
+    if (!samples || sample_count > autocorr_.size() ||
+        !clamp_lag_range(sample_count, min_lag, max_lag)) {
+        return 0.0f;
+    }
+    
+    compute_terms(samples, sample_count, max_lag + 1);
+    
+    // Cumulative-mean-normalized difference: d'(tau) = d(tau) * tau / sum(d(1..tau))
+    function_[0] = 1.0f;
+    float running_sum = 0.0f;
+    for (uint32_t tau = 1; tau <= max_lag + 1; ++tau) {
+        float difference = std::max(0.0f, energy_[tau] - 2.0f * autocorr_[tau]);
+        running_sum += difference;
+        function_[tau] = running_sum > 0.0f ? difference * tau / running_sum : 1.0f;
+    }
+    
+    // First dip below the threshold, followed down to its local minimum
+    uint32_t best_lag = 0;
+    for (uint32_t tau = min_lag; tau <= max_lag; ++tau) {
+        if (function_[tau] < threshold_) {
+            while (tau + 1 <= max_lag && function_[tau + 1] < function_[tau]) {
+                ++tau;
+            }
+            best_lag = tau;
+            break;
+        }
+    }
+    
+    // No dip means the window is unvoiced
+    if (best_lag == 0) {
+        return 0.0f;
+    }
+    
+    confidence = std::clamp(1.0f - function_[best_lag], 0.0f, 1.0f);
+    return parabolic_interpolation(function_.data(), best_lag, max_lag + 2);
+}
+
+// ---------------------------------------------------------------------------
+// MpmEstimator
+// ---------------------------------------------------------------------------
+
+MpmEstimator::MpmEstimator(uint32_t max_size, float cutoff)
+    : DifferenceEstimator(max_size), cutoff_(0.9f) {
+    set_cutoff(cutoff);
+}
+
+void MpmEstimator::set_cutoff(float cutoff) {
+    cutoff_ = std::clamp(cutoff, 0.5f, 1.0f);
+}
+
+float MpmEstimator::estimate_period(const Sample* samples, uint32_t sample_count,
+                                    uint32_t min_lag, uint32_t max_lag, float& confidence) {
+    confidence = 0.0f;
+    if (!samples || sample_count > autocorr_.size() ||
+        !clamp_lag_range(sample_count, min_lag, max_lag)) {
+        return 0.0f;
+    }
+    
+    compute_terms(samples, sample_count, max_lag + 1);
+    
+    // Normalized square difference: n(tau) = 2 r(tau) / m(tau), in [-1, 1]
+    for (uint32_t tau = 0; tau <= max_lag + 1; ++tau) {
+        function_[tau] = energy_[tau] > 0.0f ? 2.0f * autocorr_[tau] / energy_[tau] : 0.0f;
+    }
+    
+    // Visit the key maximum of each positive lobe after the zero-lag lobe.
+    // Two passes over the lobes avoid storing them: first find the highest,
+    // then take the first one within cutoff of it.
+    auto for_each_key_maximum = [&](auto&& visit) {
+        uint32_t tau = 1;
+        while (tau <= max_lag && function_[tau] > 0.0f) {
+            ++tau;
+        }
+        
+        uint32_t lobe_peak = 0;
+        for (; tau <= max_lag; ++tau) {
+            if (function_[tau] > 0.0f) {
+                if (lobe_peak == 0 || function_[tau] > function_[lobe_peak]) {
+                    lobe_peak = tau;
+                }
+            } else if (lobe_peak != 0) {
+                if (lobe_peak >= min_lag && visit(lobe_peak)) {
+                    return;
+                }
+                lobe_peak = 0;
+            }
+        }
+        if (lobe_peak >= min_lag && lobe_peak != 0) {
+            visit(lobe_peak);
+        }
+    };
+    
+    float highest = 0.0f;
+    for_each_key_maximum([&](uint32_t lag) {
+        highest = std::max(highest, function_[lag]);
+        return false;
+    });
+    
+    if (highest <= 0.0f) {
+        return 0.0f;
+    }
+    
+    uint32_t best_lag = 0;
+    float threshold = cutoff_ * highest;
+    for_each_key_maximum([&](uint32_t lag) {
+        if (function_[lag] >= threshold) {
+            best_lag = lag;
+            return true;
+        }
+        return false;
+    });
+    
+    confidence = std::clamp(function_[best_lag], 0.0f, 1.0f);
+    return parabolic_interpolation(function_.data(), best_lag, max_lag + 2);
+}
+
+} // namespace autotune
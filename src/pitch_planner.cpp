@@ -0,0 +1,206 @@
+#include "pitch_planner.h"
+#include <algorithm>
+#include <cmath>
+
+namespace autotune {
+
+namespace {
+
+// A new note must hold this long before it is treated as one
+constexpr float kMinNoteSeconds = 0.03f;
+
+// Default time for a transition between notes
+constexpr float kDefaultRetuneSeconds = 0.05f;
+
+// Scale notes closer than this (semitones) are the same note
+constexpr float kSameNoteTolerance = 0.5f;
+
+// Spare ring slots for estimates denser than the hop (recorded tracks)
+constexpr uint32_t kSparePoints = 8;
+
+float to_midi(float frequency) {
+    return 69.0f + 12.0f * std::log2(frequency * (1.0f / 440.0f));
+}
+
+bool same_note(float a, float b) {
+    return std::abs(a - b) < kSameNoteTolerance;
+}
+
+} // namespace
+
+PitchPlanner::PitchPlanner()
+    : sample_rate_(44100), lookahead_(0), hop_size_(1), alignment_(0),
+      retune_time_(kDefaultRetuneSeconds), retune_half_(0), min_note_points_(1),
+      first_(0), end_(0), next_(0) {
+    reset();
+}
+
+void PitchPlanner::configure(SampleRate sample_rate, uint32_t lookahead, uint32_t window_size,
+                             uint32_t hop_size, uint32_t max_block) {
+    sample_rate_ = sample_rate;
+    lookahead_ = lookahead;
+    hop_size_ = std::max(hop_size, 1u);
+
+    // An estimate covers the window before it; apply it to the hop around
+    // the window centre, as far as the lookahead allows
+    alignment_ = std::min<int64_t>(lookahead, window_size > hop_size_ ? (window_size - hop_size_) / 2 : 0);
+    min_note_points_ = std::max(1u, static_cast<uint32_t>(std::lround(kMinNoteSeconds * sample_rate_ / hop_size_)));
+    set_retune_time(retune_time_);
+
+    // Everything from the longest retune window behind the stream to the
+    // newest estimate ahead of it
+    uint32_t max_half = static_cast<uint32_t>(std::ceil(0.5f * kMaxRetuneSeconds * sample_rate_ / hop_size_));
+    size_t ahead = (static_cast<size_t>(lookahead) + max_block + window_size) / hop_size_;
+    points_.assign(ahead + max_half + kSparePoints, Point());
+    reset();
+}
+
+void PitchPlanner::set_retune_time(float seconds) {
+    retune_time_ = std::clamp(seconds, 0.0f, kMaxRetuneSeconds);
+    retune_half_ = static_cast<uint32_t>(std::lround(0.5f * retune_time_ * sample_rate_ / hop_size_));
+}
+
+void PitchPlanner::reset() {
+    first_ = 0;
+    end_ = 0;
+    next_ = 0;
+    note_voiced_ = false;
+    note_ = 0.0f;
+    candidate_ = false;
+    candidate_start_ = 0;
+    candidate_count_ = 0;
+    candidate_note_ = 0.0f;
+}
+
+void PitchPlanner::push(uint64_t position, float pitch, float note) {
+    if (points_.empty()) {
+        return;
+    }
+    if (end_ - first_ == points_.size()) {
+        ++first_;
+        next_ = std::max(next_, first_);
+    }
+
+    Point& point = at(end_);
+    point.position = static_cast<int64_t>(position) - alignment_;
+    point.pitch = pitch;
+    point.voiced = pitch > 0.0f && note > 0.0f;
+    point.note = point.voiced ? to_midi(note) : 0.0f;
+    point.label = point.note;
+    point.planned = false;
+    point.input = 0.0f;
+    point.target = 0.0f;
+    label(end_);
+    ++end_;
+}
+
+void PitchPlanner::label(uint64_t sequence) {
+    Point& point = at(sequence);
+    if (!point.voiced) {
+        // A pending note that runs into silence was an excursion of the last one
+        note_voiced_ = false;
+        candidate_ = false;
+        return;
+    }
+    if (!note_voiced_) {
+        // Onsets after silence have nothing to hold on to
+        note_voiced_ = true;
+        note_ = point.note;
+        candidate_ = false;
+        point.label = note_;
+        return;
+    }
+
+    point.label = note_;
+    if (same_note(point.note, note_)) {
+        candidate_ = false;
+        return;
+    }
+    if (!candidate_ || !same_note(point.note, candidate_note_)) {
+        candidate_ = true;
+        candidate_start_ = sequence;
+        candidate_count_ = 0;
+        candidate_note_ = point.note;
+    }
+
+    // Confirmed: the note started where the candidate did
+    if (++candidate_count_ >= min_note_points_) {
+        note_ = candidate_note_;
+        for (uint64_t s = std::max(candidate_start_, first_); s <= sequence; ++s) {
+            at(s).label = note_;
+        }
+        candidate_ = false;
+    }
+}
+
+void PitchPlanner::finalize(uint64_t sequence) {
+    Point& point = at(sequence);
+    point.planned = true;
+    if (!point.voiced) {
+        return;
+    }
+
+    // Median of the voiced neighbours: steadies the estimate without lag
+    float previous = sequence > first_ && at(sequence - 1).voiced ? at(sequence - 1).pitch : point.pitch;
+    float next = sequence + 1 < end_ && at(sequence + 1).voiced ? at(sequence + 1).pitch : point.pitch;
+    point.input = std::max(std::min(previous, next), std::min(std::max(previous, next), point.pitch));
+
+    // Box average of the note labels over the retune window, within the
+    // voiced run: a linear ramp centred on each boundary. Summing offsets
+    // keeps the label exact inside a note.
+    float offset_sum = 0.0f;
+    uint32_t count = 1;
+    for (uint64_t s = sequence; s > first_ && sequence - s < retune_half_ && at(s - 1).voiced; --s) {
+        offset_sum += at(s - 1).label - point.label;
+        ++count;
+    }
+    for (uint64_t s = sequence + 1; s < end_ && s - sequence <= retune_half_ && at(s).voiced; ++s) {
+        offset_sum += at(s).label - point.label;
+        ++count;
+    }
+    point.target = point.label + offset_sum / static_cast<float>(count);
+}
+
+uint32_t PitchPlanner::plan(int64_t position, uint32_t frames, float strength, Segment* segments) {
+    uint32_t count = 0;
+    uint32_t done = 0;
+    while (done < frames) {
+        int64_t now = position + done;
+        while (next_ < end_ && at(next_).position <= now) {
+            ++next_;
+        }
+
+        float input = 0.0f;
+        float target = 0.0f;
+        if (next_ > first_) {
+            Point& point = at(next_ - 1);
+            if (!point.planned) {
+                finalize(next_ - 1);
+            }
+            if (point.voiced) {
+                input = point.input;
+                target = input * std::exp2(strength * (point.target - to_midi(input)) * (1.0f / 12.0f));
+            }
+        }
+
+        uint32_t length = frames - done;
+        if (next_ < end_) {
+            length = static_cast<uint32_t>(std::min<int64_t>(length, at(next_).position - now));
+        }
+        if (count > 0 && segments[count - 1].input_pitch == input && segments[count - 1].target_pitch == target) {
+            segments[count - 1].frames += length;
+        } else {
+            segments[count++] = {length, input, target};
+        }
+        done += length;
+    }
+
+    // Keep what the median and retune window of coming estimates still read
+    uint64_t keep = static_cast<uint64_t>(retune_half_) + 2;
+    if (next_ > keep) {
+        first_ = std::max(first_, next_ - keep);
+    }
+    return count;
+}
+
+} // namespace autotune
@@ -0,0 +1,241 @@
+#include "pitch_track.h"
+#include <cstdio>
+#include <cstring>
+
+namespace autotune {
+
+namespace {
+
+// File layout: magic, version, key, point count, then per point the
+// position delta (LEB128 varint), pitch and confidence (float32)
+constexpr char kMagic[4] = {'A', 'T', 'P', 'T'};
+constexpr uint32_t kVersion = 1;
+constexpr size_t kHeaderBytes = 4 + 4 + 8 + 5 * 4 + 5 * 4 + 8;
+constexpr size_t kMinPointBytes = 1 + 4 + 4;
+
+constexpr uint64_t kFnvPrime = 0x100000001b3ull;
+
+class Writer {
+public:
+    explicit Writer(std::vector<uint8_t>& bytes) : bytes_(bytes) {}
+    
+    void id(const char* id) {
+        for (int i = 0; i < 4; ++i) {
+            bytes_.push_back(static_cast<uint8_t>(id[i]));
+        }
+    }
+    
+    void u32(uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            bytes_.push_back(static_cast<uint8_t>(value >> (8 * i)));
+        }
+    }
+    
+    void u64(uint64_t value) {
+        u32(static_cast<uint32_t>(value));
+        u32(static_cast<uint32_t>(value >> 32));
+    }
+    
+    void f32(float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        u32(bits);
+    }
+    
+    void varint(uint64_t value) {
+        while (value >= 0x80) {
+            bytes_.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        bytes_.push_back(static_cast<uint8_t>(value));
+    }
+
+private:
+    std::vector<uint8_t>& bytes_;
+};
+
+class Reader {
+public:
+    Reader(const uint8_t* data, size_t size) : data_(data), size_(size), offset_(0), valid_(true) {}
+    
+    bool valid() const { return valid_; }
+    size_t remaining() const { return size_ - offset_; }
+    
+    uint32_t u32() {
+        if (!take(4)) {
+            return 0;
+        }
+        const uint8_t* bytes = data_ + offset_ - 4;
+        return static_cast<uint32_t>(bytes[0]) | static_cast<uint32_t>(bytes[1]) << 8 |
+               static_cast<uint32_t>(bytes[2]) << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+    }
+    
+    uint64_t u64() {
+        uint64_t low = u32();
+        return low | static_cast<uint64_t>(u32()) << 32;
+    }
+    
+    float f32() {
+        uint32_t bits = u32();
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+    
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (uint32_t shift = 0; shift < 64; shift += 7) {
+            if (!take(1)) {
+                return 0;
+            }
+            uint8_t byte = data_[offset_ - 1];
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        valid_ = false;
+        return 0;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t offset_;
+    bool valid_;
+    
+    bool take(size_t bytes) {
+        if (!valid_ || remaining() < bytes) {
+            valid_ = false;
+            return false;
+        }
+        offset_ += bytes;
+        return true;
+    }
+};
+
+} // namespace
+
+bool PitchTrack::AnalysisKey::operator==(const AnalysisKey& other) const {
+    return content_hash == other.content_hash && sample_rate == other.sample_rate &&
+           window_size == other.window_size && hop_size == other.hop_size &&
+           algorithm == other.algorithm && analysis_rate == other.analysis_rate &&
+           min_frequency == other.min_frequency && max_frequency == other.max_frequency &&
+           confidence_threshold == other.confidence_threshold && gate_threshold == other.gate_threshold &&
+           smoothing == other.smoothing;
+}
+
+std::vector<uint8_t> PitchTrack::serialize() const {
+    std::vector<uint8_t> bytes;
+    bytes.reserve(kHeaderBytes + points_.size() * (2 + 4 + 4));
+    
+    Writer writer(bytes);
+    writer.id(kMagic);
+    writer.u32(kVersion);
+    writer.u64(key_.content_hash);
+    writer.u32(key_.sample_rate);
+    writer.u32(key_.window_size);
+    writer.u32(key_.hop_size);
+    writer.u32(key_.algorithm);
+    writer.u32(key_.analysis_rate);
+    writer.f32(key_.min_frequency);
+    writer.f32(key_.max_frequency);
+    writer.f32(key_.confidence_threshold);
+    writer.f32(key_.gate_threshold);
+    writer.f32(key_.smoothing);
+    writer.u64(points_.size());
+    
+    uint64_t previous = 0;
+    for (const Point& point : points_) {
+        writer.varint(point.position - previous);
+        writer.f32(point.pitch);
+        writer.f32(point.confidence);
+        previous = point.position;
+    }
+    return bytes;
+}
+
+bool PitchTrack::deserialize(const uint8_t* data, size_t size) {
+    if (!data || size < kHeaderBytes || std::memcmp(data, kMagic, 4) != 0) {
+        return false;
+    }
+    
+    Reader reader(data + 4, size - 4);
+    if (reader.u32() != kVersion) {
+        return false;
+    }
+    AnalysisKey key;
+    key.content_hash = reader.u64();
+    key.sample_rate = reader.u32();
+    key.window_size = reader.u32();
+    key.hop_size = reader.u32();
+    key.algorithm = reader.u32();
+    key.analysis_rate = reader.u32();
+    key.min_frequency = reader.f32();
+    key.max_frequency = reader.f32();
+    key.confidence_threshold = reader.f32();
+    key.gate_threshold = reader.f32();
+    key.smoothing = reader.f32();
+    uint64_t count = reader.u64();
+    
+    // Bound the count by the data actually present before allocating
+    if (!reader.valid() || count > reader.remaining() / kMinPointBytes) {
+        return false;
+    }
+    
+    std::vector<Point> points(static_cast<size_t>(count));
+    uint64_t position = 0;
+    for (Point& point : points) {
+        position += reader.varint();
+        point.position = position;
+        point.pitch = reader.f32();
+        point.confidence = reader.f32();
+    }
+    if (!reader.valid() || reader.remaining() != 0) {
+        return false;
+    }
+    
+    key_ = key;
+    points_.swap(points);
+    return true;
+}
+
+bool PitchTrack::save(const std::string& path) const {
+    std::vector<uint8_t> bytes = serialize();
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool written = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    return std::fclose(file) == 0 && written;
+}
+
+bool PitchTrack::load(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+    std::vector<uint8_t> bytes;
+    uint8_t buffer[1 << 16];
+    size_t got;
+    while ((got = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        bytes.insert(bytes.end(), buffer, buffer + got);
+    }
+    bool read_ok = !std::ferror(file);
+    std::fclose(file);
+    return read_ok && deserialize(bytes.data(), bytes.size());
+}
+
+uint64_t PitchTrack::hash_samples(const Sample* samples, size_t count, uint64_t seed) {
+    // One FNV-1a round per 32-bit sample rather than per byte keeps hashing
+    // cheap next to decoding, and the result is the same however it is split
+    uint64_t hash = seed;
+    for (size_t i = 0; i < count; ++i) {
+        uint32_t bits;
+        std::memcpy(&bits, samples + i, sizeof(bits));
+        hash = (hash ^ bits) * kFnvPrime;
+    }
+    return hash;
+}
+
+} // namespace autotune
@@ -1,11 +1,326 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include <pybind11/numpy.h>
+#include "audio_buffer.h"
 #include "autotune_engine.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 namespace py = pybind11;
 using namespace autotune;
 
+namespace {
+
+/**
+ * @brief Streams chunks through an engine on a native worker thread
+ *
+ * push() and process_async() copy a chunk into a lock-free input ring and
+ * return at once. The worker runs the engine on each chunk in order with
+ * the GIL released, then takes the GIL only to hand the output to the
+ * chunk's callback (called on the worker thread) or asyncio future
+ * (resolved on its event loop). Outputs are views into a pool of NumPy
+ * buffers; a buffer is reused once Python drops every view of it, so a
+ * steady stream allocates nothing per chunk.
+ *
+ * Producers are serialized by the GIL, so any Python thread may push. Only
+ * the mailbox-backed engine setters (parameters, mode, scale, gate, grid)
+ * may be called while chunks are in flight.
+ */
+class StreamProcessor {
+public:
+    StreamProcessor(SampleRate sample_rate, uint32_t buffer_size, ChannelCount channels,
+                    uint32_t capacity, uint32_t max_pending, py::object callback)
+        : engine_(sample_rate, buffer_size, channels),
+          channels_(channels),
+          capacity_(std::max(capacity, 1u)),
+          input_ring_(capacity_, channels),
+          jobs_(round_up_power_of_two(std::max(max_pending, 1u))),
+          job_write_(0),
+          job_read_(0),
+          stopping_(false),
+          draining_(false),
+          callback_(std::move(callback)) {
+        if (channels == 0) {
+            throw std::runtime_error("StreamProcessor needs at least one channel");
+        }
+        engine_.prepare(capacity_);
+        
+        scratch_.assign(static_cast<size_t>(capacity_) * channels_ * 2, 0.0f);
+        input_channels_.resize(channels_);
+        output_channels_.resize(channels_);
+        for (ChannelCount ch = 0; ch < channels_; ++ch) {
+            input_channels_[ch] = scratch_.data() + static_cast<size_t>(ch) * capacity_;
+            output_channels_[ch] = scratch_.data() + static_cast<size_t>(channels_ + ch) * capacity_;
+        }
+        
+        asyncio_ = py::module_::import("asyncio");
+        resolve_ = py::cpp_function([](py::object future, py::object value) {
+            // The awaiting task may have been cancelled meanwhile
+            if (!future.attr("done")().cast<bool>()) {
+                future.attr("set_result")(value);
+            }
+        });
+        
+        worker_ = std::thread(&StreamProcessor::worker_loop, this);
+    }
+    
+    ~StreamProcessor() { close(true); }
+    
+    /**
+     * @brief Queue a chunk for the constructor callback (GIL held)
+     * @return False if the input ring or the chunk queue is full
+     */
+    bool push(py::array_t<float, py::array::c_style | py::array::forcecast> chunk, bool planar) {
+        if (callback_.is_none()) {
+            throw std::runtime_error("push() needs a callback; use process_async() otherwise");
+        }
+        return enqueue(chunk, planar, callback_);
+    }
+    
+    /**
+     * @brief Queue a chunk and return an asyncio future for its output (GIL held)
+     */
+    py::object process_async(py::array_t<float, py::array::c_style | py::array::forcecast> chunk, bool planar) {
+        py::object future = asyncio_.attr("get_running_loop")().attr("create_future")();
+        if (!enqueue(chunk, planar, future)) {
+            throw std::runtime_error("Stream input is full; await earlier chunks first");
+        }
+        return future;
+    }
+    
+    /**
+     * @brief Stop the worker (GIL held)
+     * @param drain Process the queued chunks first; otherwise their futures are cancelled
+     */
+    void close(bool drain) {
+        if (!worker_.joinable()) {
+            return;
+        }
+        if (std::this_thread::get_id() == worker_.get_id()) {
+            throw std::runtime_error("StreamProcessor cannot be closed from its own callback");
+        }
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            stopping_ = true;
+            draining_ = drain;
+        }
+        wake_condition_.notify_one();
+        {
+            // The worker needs the GIL to deliver its last results
+            py::gil_scoped_release release;
+            worker_.join();
+        }
+        
+        for (py::object& sink : pending_) {
+            if (py::hasattr(sink, "cancel")) {
+                try {
+                    sink.attr("get_loop")().attr("call_soon_threadsafe")(sink.attr("cancel"));
+                } catch (py::error_already_set&) {
+                    // Event loop already closed; nobody is waiting
+                }
+            }
+        }
+        pending_.clear();
+    }
+    
+    AutotuneEngine& engine() { return engine_; }
+    size_t pending() const { return pending_.size(); }
+    size_t pool_size() const { return pool_.size(); }
+    uint32_t capacity() const { return capacity_; }
+    bool closed() const { return !worker_.joinable(); }
+
+private:
+    struct Job {
+        uint32_t frames;
+        bool planar;
+    };
+    
+    AutotuneEngine engine_;
+    ChannelCount channels_;
+    uint32_t capacity_;
+    
+    // Producer (GIL holder) to worker: samples, then one job per chunk
+    AudioBuffer input_ring_;
+    std::vector<Job> jobs_;
+    std::atomic<uint32_t> job_write_;
+    std::atomic<uint32_t> job_read_;
+    
+    // Worker-only planar scratch
+    std::vector<Sample> scratch_;
+    std::vector<Sample*> input_channels_;
+    std::vector<Sample*> output_channels_;
+    
+    std::thread worker_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_condition_;
+    bool stopping_;                 // Guarded by wake_mutex_
+    bool draining_;
+    
+    // Python state (GIL held): result sinks in chunk order and output buffers
+    py::object callback_;
+    py::object asyncio_;
+    py::object resolve_;
+    std::deque<py::object> pending_;
+    std::vector<py::array_t<float>> pool_;
+    
+    static uint32_t round_up_power_of_two(uint32_t value) {
+        uint32_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+    
+    bool enqueue(py::array_t<float, py::array::c_style | py::array::forcecast>& chunk, bool planar,
+                 const py::object& sink) {
+        if (closed()) {
+            throw std::runtime_error("StreamProcessor is closed");
+        }
+        py::buffer_info buf = chunk.request();
+        py::ssize_t channel_axis = planar ? 0 : 1;
+        if (buf.ndim != 2 || buf.shape[channel_axis] != channels_) {
+            throw std::runtime_error(planar
+                ? "Chunk must be 2D (engine channels, frames)"
+                : "Chunk must be 2D (frames, engine channels)");
+        }
+        py::ssize_t frame_count = buf.shape[planar ? 1 : 0];
+        if (frame_count <= 0 || frame_count > static_cast<py::ssize_t>(capacity_)) {
+            throw std::runtime_error("Chunk must hold between 1 and capacity frames");
+        }
+        uint32_t frames = static_cast<uint32_t>(frame_count);
+        
+        uint32_t job_index = job_write_.load(std::memory_order_relaxed);
+        if (job_index - job_read_.load(std::memory_order_acquire) >= jobs_.size()) {
+            return false;
+        }
+        AudioBuffer::Region region = input_ring_.acquire_write(frames);
+        if (region.frame_count() < frames) {
+            return false;
+        }
+        
+        // Deinterleave straight into the ring (both wrap segments)
+        const float* source = static_cast<const float*>(buf.ptr);
+        uint32_t offset = 0;
+        for (const AudioBlockView* part : {&region.first, &region.second}) {
+            if (part->frame_count == 0) {
+                continue;
+            }
+            for (ChannelCount ch = 0; ch < channels_; ++ch) {
+                Sample* destination = part->channels[ch];
+                if (planar) {
+                    std::memcpy(destination, source + static_cast<size_t>(ch) * frames + offset,
+                                part->frame_count * sizeof(Sample));
+                } else {
+                    for (uint32_t i = 0; i < part->frame_count; ++i) {
+                        destination[i] = source[static_cast<size_t>(offset + i) * channels_ + ch];
+                    }
+                }
+            }
+            offset += part->frame_count;
+        }
+        input_ring_.commit_write(frames);
+        
+        // The sink goes first so it is in place when the worker delivers
+        pending_.push_back(sink);
+        jobs_[job_index & (jobs_.size() - 1)] = {frames, planar};
+        job_write_.store(job_index + 1, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+        }
+        wake_condition_.notify_one();
+        return true;
+    }
+    
+    bool has_job() const {
+        return job_read_.load(std::memory_order_relaxed) != job_write_.load(std::memory_order_acquire);
+    }
+    
+    void worker_loop() {
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(wake_mutex_);
+                wake_condition_.wait(lock, [this]() { return stopping_ || has_job(); });
+                if (stopping_ && (!draining_ || !has_job())) {
+                    return;
+                }
+            }
+            
+            uint32_t job_index = job_read_.load(std::memory_order_relaxed);
+            Job job = jobs_[job_index & (jobs_.size() - 1)];
+            
+            // No Python objects are touched here, so the GIL stays free
+            AudioBlockView input(input_channels_.data(), channels_, job.frames);
+            AudioBlockView output(output_channels_.data(), channels_, job.frames);
+            input_ring_.read(input);
+            ProcessingResult result = engine_.process(input, output);
+            job_read_.store(job_index + 1, std::memory_order_release);
+            
+            deliver(job, result);
+        }
+    }
+    
+    /**
+     * @brief Free pool buffer (no views left), grown by one if none is
+     */
+    py::array_t<float>& take_buffer() {
+        for (py::array_t<float>& buffer : pool_) {
+            if (buffer.ref_count() == 1) {
+                return buffer;
+            }
+        }
+        pool_.emplace_back(static_cast<py::ssize_t>(capacity_) * channels_);
+        return pool_.back();
+    }
+    
+    void deliver(const Job& job, const ProcessingResult& result) {
+        py::gil_scoped_acquire acquire;
+        
+        py::array_t<float>& buffer = take_buffer();
+        float* data = buffer.mutable_data();
+        for (ChannelCount ch = 0; ch < channels_; ++ch) {
+            const Sample* samples = output_channels_[ch];
+            if (job.planar) {
+                std::memcpy(data + static_cast<size_t>(ch) * job.frames, samples, job.frames * sizeof(Sample));
+            } else {
+                for (uint32_t i = 0; i < job.frames; ++i) {
+                    data[static_cast<size_t>(i) * channels_ + ch] = samples[i];
+                }
+            }
+        }
+        py::ssize_t frames = job.frames;
+        py::ssize_t channels = channels_;
+        py::array_t<float> view = job.planar
+            ? py::array_t<float>({channels, frames}, data, buffer)
+            : py::array_t<float>({frames, channels}, data, buffer);
+        
+        py::object sink = std::move(pending_.front());
+        pending_.pop_front();
+        try {
+            py::tuple value = py::make_tuple(view, result);
+            if (py::hasattr(sink, "set_result")) {
+                sink.attr("get_loop")().attr("call_soon_threadsafe")(resolve_, sink, value);
+            } else {
+                sink(*value);
+            }
+        } catch (py::error_already_set& error) {
+            // Nobody up the worker thread's stack could handle it
+            error.discard_as_unraisable("StreamProcessor result delivery");
+        }
+    }
+    
+    // Non-copyable
+    StreamProcessor(const StreamProcessor&) = delete;
+    StreamProcessor& operator=(const StreamProcessor&) = delete;
+};
+
+} // anonymous namespace
+
 /**
  * @brief Python bindings for AutoTune Real-Time Engine
  * 
@@ -48,7 +363,9 @@ PYBIND11_MODULE(pyautotune, m) {
         .def_readwrite("enable_quantization", &ProcessingParams::enable_quantization, 
                       "Enable quantization")
         .def_readwrite("quantize_strength", &ProcessingParams::quantize_strength, 
-                      "Quantization strength (0.0-1.0)");
+                      "Quantization strength (0.0-1.0)")
+        .def_readwrite("retune_time", &ProcessingParams::retune_time,
+                      "Note transition time in seconds when planning ahead (0 = instant)");
     
     py::class_<ProcessingResult>(m, "ProcessingResult")
         .def(py::init<>())
@@ -73,15 +390,35 @@ PYBIND11_MODULE(pyautotune, m) {
         .value("MIXOLYDIAN", Quantizer::Scale::MIXOLYDIAN)
         .value("CUSTOM", Quantizer::Scale::CUSTOM);
     
+    py::enum_<Quantizer::GridResolution>(m, "GridResolution")
+        .value("QUARTER_NOTE", Quantizer::GridResolution::QUARTER_NOTE)
+        .value("EIGHTH_NOTE", Quantizer::GridResolution::EIGHTH_NOTE)
+        .value("SIXTEENTH_NOTE", Quantizer::GridResolution::SIXTEENTH_NOTE)
+        .value("TRIPLET", Quantizer::GridResolution::TRIPLET)
+        .value("DOTTED", Quantizer::GridResolution::DOTTED);
+    
+    py::enum_<Quantizer::TimeSignature>(m, "TimeSignature")
+        .value("FOUR_FOUR", Quantizer::TimeSignature::FOUR_FOUR)
+        .value("THREE_FOUR", Quantizer::TimeSignature::THREE_FOUR)
+        .value("TWO_FOUR", Quantizer::TimeSignature::TWO_FOUR)
+        .value("SIX_EIGHT", Quantizer::TimeSignature::SIX_EIGHT)
+        .value("TWELVE_EIGHT", Quantizer::TimeSignature::TWELVE_EIGHT);
+    
     py::class_<Quantizer>(m, "Quantizer")
         .def(py::init<SampleRate, float>(), "Create Quantizer with sample rate and tempo")
         .def("quantize_pitch", &Quantizer::quantize_pitch,
              "Quantize pitch to musical scale",
              py::arg("input_pitch"), py::arg("scale"), 
              py::arg("key_center") = 60, py::arg("strength") = 1.0f)
+        .def("quantize_timing",
+             py::overload_cast<int64_t, Quantizer::GridResolution, float>(&Quantizer::quantize_timing),
+             "Quantize a time position (samples) to the rhythmic grid",
+             py::arg("input_time"), py::arg("grid_resolution"), py::arg("strength") = 1.0f)
         .def("set_tempo", &Quantizer::set_tempo, "Set tempo in BPM")
         .def("set_custom_scale", &Quantizer::set_custom_scale, 
              "Set custom scale intervals")
+        .def("prepare_scale", &Quantizer::prepare_scale,
+             "Build the pitch lookup table for a scale ahead of time")
         .def("get_nearest_note", &Quantizer::get_nearest_note,
              "Get nearest note in scale")
         .def_static("frequency_to_midi", &Quantizer::frequency_to_midi,
@@ -92,6 +429,12 @@ PYBIND11_MODULE(pyautotune, m) {
         .def("reset", &Quantizer::reset, "Reset quantizer state");
     
     // PitchDetector class
+    py::enum_<PitchDetector::Algorithm>(m, "DetectionAlgorithm")
+        .value("AUTOCORRELATION", PitchDetector::Algorithm::AUTOCORRELATION)
+        .value("YIN", PitchDetector::Algorithm::YIN)
+        .value("MPM", PitchDetector::Algorithm::MPM)
+        .value("CUSTOM", PitchDetector::Algorithm::CUSTOM);
+    
     py::class_<PitchDetector>(m, "PitchDetector")
         .def(py::init<SampleRate, uint32_t>(), 
              "Create PitchDetector with sample rate and buffer size")
@@ -112,8 +455,71 @@ PYBIND11_MODULE(pyautotune, m) {
              "Set maximum detectable frequency")
         .def("set_confidence_threshold", &PitchDetector::set_confidence_threshold,
              "Set confidence threshold")
+        .def("set_gate_threshold", &PitchDetector::set_gate_threshold,
+             "Set the silence gate opening level as linear RMS (0 disables)")
+        .def("is_gated", &PitchDetector::is_gated,
+             "Whether the gate skipped detection of the latest window")
+        .def("set_smoothing", &PitchDetector::set_smoothing,
+             "Set the one-pole smoothing of successive detections (0 = none)")
+        .def("get_smoothing", &PitchDetector::get_smoothing, "Get the detection smoothing factor")
+        .def("set_algorithm", &PitchDetector::set_algorithm,
+             "Select period estimation algorithm")
+        .def("get_algorithm", &PitchDetector::get_algorithm, "Get period estimation algorithm")
+        .def("set_analysis_rate", &PitchDetector::set_analysis_rate,
+             "Analyse at a reduced rate (0 = full rate)")
+        .def("set_tracking", &PitchDetector::set_tracking,
+             "Configure sliding analysis window and hop size",
+             py::arg("window_size"), py::arg("hop_size"))
+        .def("push_samples",
+             [](PitchDetector& detector, py::array_t<float, py::array::c_style | py::array::forcecast> samples) {
+                 py::buffer_info buf = samples.request();
+                 return detector.push_samples(static_cast<const Sample*>(buf.ptr),
+                                              static_cast<uint32_t>(buf.size));
+             },
+             "Append samples to the tracking history, returns number of new estimates")
+        .def("get_tracked_pitch", &PitchDetector::get_tracked_pitch, "Get latest tracked pitch")
+        .def("get_tracked_confidence", &PitchDetector::get_tracked_confidence,
+             "Get latest tracked confidence")
+        .def("get_analysis_rate", &PitchDetector::get_analysis_rate, "Get effective analysis rate")
         .def("reset", &PitchDetector::reset, "Reset detector state");
     
+    py::enum_<PitchCorrector::Backend>(m, "CorrectionBackend")
+        .value("PSOLA", PitchCorrector::Backend::PSOLA)
+        .value("PHASE_VOCODER", PitchCorrector::Backend::PHASE_VOCODER);
+    
+    // PitchTrack class
+    py::class_<PitchTrack>(m, "PitchTrack")
+        .def(py::init<>(), "Create an empty pitch track")
+        .def("save", &PitchTrack::save, "Write the track to a file")
+        .def("load", &PitchTrack::load, "Read a track written by save()")
+        .def("clear", &PitchTrack::clear, "Remove all estimates")
+        .def("__len__", &PitchTrack::size)
+        .def_property("content_hash",
+                      [](const PitchTrack& track) { return track.get_key().content_hash; },
+                      &PitchTrack::set_content_hash,
+                      "Caller-provided hash of the analysed audio")
+        .def("points",
+             [](const PitchTrack& track) {
+                 const auto& points = track.get_points();
+                 py::array_t<double> result({points.size(), static_cast<size_t>(3)});
+                 auto view = result.mutable_unchecked<2>();
+                 for (size_t i = 0; i < points.size(); ++i) {
+                     view(i, 0) = static_cast<double>(points[i].position);
+                     view(i, 1) = points[i].pitch;
+                     view(i, 2) = points[i].confidence;
+                 }
+                 return result;
+             },
+             "Estimates as a (points, 3) array of position, pitch, confidence")
+        .def_static("hash_samples",
+                    [](py::array_t<float, py::array::c_style | py::array::forcecast> samples, uint64_t seed) {
+                        py::buffer_info buf = samples.request();
+                        return PitchTrack::hash_samples(static_cast<const Sample*>(buf.ptr),
+                                                        static_cast<size_t>(buf.size), seed);
+                    },
+                    "Fold samples into a 64-bit content hash",
+                    py::arg("samples"), py::arg("seed") = PitchTrack::kHashSeed);
+    
     // AutotuneEngine class
     py::enum_<AutotuneEngine::Mode>(m, "Mode")
         .value("PITCH_CORRECTION", AutotuneEngine::Mode::PITCH_CORRECTION)
@@ -121,84 +527,228 @@ PYBIND11_MODULE(pyautotune, m) {
         .value("FULL_AUTOTUNE", AutotuneEngine::Mode::FULL_AUTOTUNE)
         .value("BYPASS", AutotuneEngine::Mode::BYPASS);
     
+    py::enum_<AutotuneEngine::LatencyProfile>(m, "LatencyProfile")
+        .value("LIVE", AutotuneEngine::LatencyProfile::LIVE)
+        .value("BALANCED", AutotuneEngine::LatencyProfile::BALANCED)
+        .value("STUDIO", AutotuneEngine::LatencyProfile::STUDIO);
+    
     py::class_<AutotuneEngine::PerformanceMetrics>(m, "PerformanceMetrics")
         .def(py::init<>())
         .def_readwrite("average_latency_ms", 
                       &AutotuneEngine::PerformanceMetrics::average_latency_ms)
+        .def_readwrite("p50_latency_ms", 
+                      &AutotuneEngine::PerformanceMetrics::p50_latency_ms)
+        .def_readwrite("p99_latency_ms", 
+                      &AutotuneEngine::PerformanceMetrics::p99_latency_ms)
+        .def_readwrite("p999_latency_ms", 
+                      &AutotuneEngine::PerformanceMetrics::p999_latency_ms)
+        .def_readwrite("max_latency_ms", 
+                      &AutotuneEngine::PerformanceMetrics::max_latency_ms)
         .def_readwrite("cpu_usage_percent", 
                       &AutotuneEngine::PerformanceMetrics::cpu_usage_percent)
+        .def_readwrite("detect_ms", 
+                      &AutotuneEngine::PerformanceMetrics::detect_ms)
+        .def_readwrite("quantize_ms", 
+                      &AutotuneEngine::PerformanceMetrics::quantize_ms)
+        .def_readwrite("correct_ms", 
+                      &AutotuneEngine::PerformanceMetrics::correct_ms)
+        .def_readwrite("deadline_misses", 
+                      &AutotuneEngine::PerformanceMetrics::deadline_misses)
         .def_readwrite("buffer_underruns", 
                       &AutotuneEngine::PerformanceMetrics::buffer_underruns)
+        .def_readwrite("callbacks", 
+                      &AutotuneEngine::PerformanceMetrics::callbacks)
         .def_readwrite("frames_processed", 
-                      &AutotuneEngine::PerformanceMetrics::frames_processed);
+                      &AutotuneEngine::PerformanceMetrics::frames_processed)
+        .def_readwrite("skipped_blocks", 
+                      &AutotuneEngine::PerformanceMetrics::skipped_blocks)
+        .def_readwrite("skipped_block_ratio", 
+                      &AutotuneEngine::PerformanceMetrics::skipped_block_ratio);
     
     py::class_<AutotuneEngine>(m, "AutotuneEngine")
         .def(py::init<SampleRate, uint32_t, ChannelCount>(),
              "Create AutotuneEngine with sample rate, buffer size, and channel count",
              py::arg("sample_rate"), py::arg("buffer_size") = 512, py::arg("channels") = 2)
-        .def("process_numpy", 
-             [](AutotuneEngine& engine, py::array_t<float> input_array) {
+        .def("process_numpy",
+             [](AutotuneEngine& engine,
+                py::array_t<float, py::array::c_style | py::array::forcecast> input_array,
+                py::object output_object, bool planar) {
+                 // C-contiguous float32 input is used in place; anything else
+                 // is converted once by forcecast
                  py::buffer_info buf = input_array.request();
+                 py::ssize_t channel_axis = planar ? 0 : 1;
+                 if (buf.ndim != 2 || buf.shape[channel_axis] != engine.get_channels()) {
+                     throw std::runtime_error(planar
+                         ? "Input array must be 2D (engine channels, frames)"
+                         : "Input array must be 2D (frames, engine channels)");
+                 }
                  
-                 if (buf.ndim != 2) {
-                     throw std::runtime_error("Input array must be 2D (frames, channels)");
+                 // Write into the caller's array when given, otherwise a new one
+                 py::array_t<float> output_array;
+                 if (output_object.is_none()) {
+                     output_array = py::array_t<float>({buf.shape[0], buf.shape[1]});
+                 } else {
+                     py::array output = py::reinterpret_borrow<py::array>(output_object);
+                     if (!py::isinstance<py::array_t<float>>(output) ||
+                         !(output.flags() & py::array::c_style) || !output.writeable() ||
+                         output.ndim() != 2 || output.shape(0) != buf.shape[0] ||
+                         output.shape(1) != buf.shape[1]) {
+                         throw std::runtime_error("Output must be a writeable C-contiguous float32 array "
+                                                  "shaped like the input");
+                     }
+                     output_array = py::reinterpret_borrow<py::array_t<float>>(output);
                  }
                  
-                 uint32_t frame_count = static_cast<uint32_t>(buf.shape[0]);
-                 ChannelCount channel_count = static_cast<ChannelCount>(buf.shape[1]);
+                 const float* input_ptr = static_cast<const float*>(buf.ptr);
+                 float* output_ptr = output_array.mutable_data();
+                 size_t frame_count = static_cast<size_t>(buf.shape[planar ? 1 : 0]);
+                 auto layout = planar ? AutotuneEngine::BufferLayout::PLANAR
+                                      : AutotuneEngine::BufferLayout::INTERLEAVED;
                  
-                 // Convert numpy array to AudioFrames
-                 std::vector<AudioFrame> input_frames(frame_count);
-                 std::vector<AudioFrame> output_frames(frame_count);
+                 ProcessingResult result;
+                 {
+                     // Only raw buffers are touched, so other Python threads
+                     // (and their engines) keep running
+                     py::gil_scoped_release release;
+                     result = engine.process_buffer(input_ptr, output_ptr, frame_count, layout);
+                 }
                  
-                 float* input_ptr = static_cast<float*>(buf.ptr);
+                 return py::make_tuple(output_array, result);
+             },
+             "Process a float32 array without copying, returns (output_array, result). "
+             "Interleaved arrays are (frames, channels), planar ones (channels, frames); "
+             "out may be a preallocated array (or the input itself).",
+             py::arg("input"), py::arg("out") = py::none(), py::arg("planar") = false)
+        .def("render_offline",
+             [](const AutotuneEngine& engine,
+                py::array_t<float, py::array::c_style | py::array::forcecast> input_array,
+                uint32_t segment_frames, uint32_t overlap_frames, uint32_t thread_count) {
+                 py::buffer_info buf = input_array.request();
                  
-                 for (uint32_t i = 0; i < frame_count; ++i) {
-                     input_frames[i] = AudioFrame(channel_count);
-                     output_frames[i] = AudioFrame(channel_count);
-                     for (ChannelCount ch = 0; ch < channel_count; ++ch) {
-                         input_frames[i][ch] = input_ptr[i * channel_count + ch];
-                     }
+                 if (buf.ndim != 2 || buf.shape[1] != engine.get_channels()) {
+                     throw std::runtime_error("Input array must be 2D (frames, engine channels)");
                  }
                  
-                 // Process audio
-                 ProcessingResult result = engine.process(input_frames.data(), 
-                                                        output_frames.data(), 
-                                                        frame_count);
-                 
-                 // Convert back to numpy array
-                 auto output_array = py::array_t<float>(
-                     {frame_count, channel_count},
-                     {sizeof(float) * channel_count, sizeof(float)}
-                 );
+                 size_t frame_count = static_cast<size_t>(buf.shape[0]);
+                 auto output_array = py::array_t<float>({buf.shape[0], buf.shape[1]});
+                 const float* input_ptr = static_cast<const float*>(buf.ptr);
+                 float* output_ptr = static_cast<float*>(output_array.request().ptr);
                  
-                 py::buffer_info output_buf = output_array.request();
-                 float* output_ptr = static_cast<float*>(output_buf.ptr);
+                 AutotuneEngine::OfflineRenderOptions options;
+                 options.segment_frames = segment_frames;
+                 options.overlap_frames = overlap_frames;
+                 options.thread_count = thread_count;
                  
-                 for (uint32_t i = 0; i < frame_count; ++i) {
-                     for (ChannelCount ch = 0; ch < channel_count; ++ch) {
-                         output_ptr[i * channel_count + ch] = output_frames[i][ch];
-                     }
+                 bool success;
+                 {
+                     // Worker threads never touch Python objects
+                     py::gil_scoped_release release;
+                     success = engine.render_offline(input_ptr, frame_count, output_ptr, options);
                  }
                  
-                 return py::make_tuple(output_array, result);
+                 if (!success) {
+                     throw std::runtime_error("Offline rendering failed");
+                 }
+                 return output_array;
              },
-             "Process numpy audio array, returns (output_array, result)")
+             "Render a whole (frames, channels) array offline on all cores",
+             py::arg("input"), py::arg("segment_frames") = 0, py::arg("overlap_frames") = 0,
+             py::arg("thread_count") = 0)
         .def("set_parameters", &AutotuneEngine::set_parameters, "Set processing parameters")
         .def("get_parameters", &AutotuneEngine::get_parameters, "Get current parameters")
         .def("set_mode", &AutotuneEngine::set_mode, "Set processing mode")
         .def("get_mode", &AutotuneEngine::get_mode, "Get current mode")
         .def("set_scale", &AutotuneEngine::set_scale, "Set musical scale and key center")
         .def("set_tempo", &AutotuneEngine::set_tempo, "Set tempo for quantization")
+        .def("set_time_signature", &AutotuneEngine::set_time_signature,
+             "Set the time signature the beat of the grid follows", py::arg("time_signature"))
+        .def("get_time_signature", &AutotuneEngine::get_time_signature, "Get the time signature")
+        .def("set_rhythm_grid", &AutotuneEngine::set_rhythm_grid,
+             "Set the grid QUANTIZATION and FULL_AUTOTUNE move onsets to", py::arg("grid"))
+        .def("get_rhythm_grid", &AutotuneEngine::get_rhythm_grid, "Get the rhythmic quantization grid")
+        .def("set_detection_algorithm", &AutotuneEngine::set_detection_algorithm,
+             "Select pitch detection algorithm")
+        .def("get_detection_algorithm", &AutotuneEngine::get_detection_algorithm,
+             "Get pitch detection algorithm")
+        .def("set_analysis_rate", &AutotuneEngine::set_analysis_rate,
+             "Run pitch analysis at a reduced rate (0 = full rate)")
+        .def("set_pitch_tracking", &AutotuneEngine::set_pitch_tracking,
+             "Configure sliding analysis window and hop size",
+             py::arg("window_size"), py::arg("hop_size"))
+        .def("get_analysis_rate", &AutotuneEngine::get_analysis_rate, "Get effective analysis rate")
+        .def("set_correction_backend", &AutotuneEngine::set_correction_backend,
+             "Select PSOLA or phase-vocoder pitch shifting")
+        .def("get_correction_backend", &AutotuneEngine::get_correction_backend,
+             "Get pitch shifting backend")
+        .def("set_vocoder_overlap", &AutotuneEngine::set_vocoder_overlap,
+             "Set phase-vocoder overlap factor (2 or 4)")
+        .def("set_latency_profile", &AutotuneEngine::set_latency_profile,
+             "Apply a LIVE, BALANCED or STUDIO latency profile", py::arg("profile"))
+        .def("get_latency_profile", &AutotuneEngine::get_latency_profile,
+             "Get the most recently applied latency profile")
+        .def("get_latency_samples", &AutotuneEngine::get_latency_samples,
+             "Get the delay between input and output in samples")
+        .def("set_lookahead", &AutotuneEngine::set_lookahead,
+             "Plan the pitch curve this many milliseconds ahead (0 = reactive)", py::arg("milliseconds"))
+        .def("get_lookahead", &AutotuneEngine::get_lookahead, "Get the planning lookahead in milliseconds")
+        .def("get_lookahead_samples", &AutotuneEngine::get_lookahead_samples,
+             "Get the planning lookahead in samples")
+        .def("set_silence_gate", &AutotuneEngine::set_silence_gate,
+             "Set the silence gate level in dBFS RMS (-inf disables)", py::arg("threshold_db"))
+        .def("get_silence_gate", &AutotuneEngine::get_silence_gate,
+             "Get the silence gate level in dBFS RMS")
         .def("configure_features", &AutotuneEngine::configure_features,
              "Configure processing features")
         .def("get_performance_metrics", &AutotuneEngine::get_performance_metrics,
              "Get performance metrics")
+        .def("record_pitch_track", &AutotuneEngine::record_pitch_track,
+             "Record pitch estimates into a track (None stops recording)",
+             py::arg("track"), py::keep_alive<1, 2>())
+        .def("set_pitch_track", &AutotuneEngine::set_pitch_track,
+             "Follow a recorded track instead of detecting pitch (None returns to live detection)",
+             py::arg("track"), py::keep_alive<1, 2>())
+        .def("pitch_track_matches",
+             [](const AutotuneEngine& engine, const PitchTrack& track) {
+                 return track.get_key() == engine.get_pitch_analysis_key(track.get_key().content_hash);
+             },
+             "Check that a track was recorded with the current detector settings")
+        .def("clone", &AutotuneEngine::clone,
+             "Create an engine with the same sizes and configuration and a fresh stream")
         .def("reset", &AutotuneEngine::reset, "Reset engine state")
         .def("is_initialized", &AutotuneEngine::is_initialized, "Check if initialized")
         .def_static("get_recommended_buffer_size", 
                    &AutotuneEngine::get_recommended_buffer_size,
-                   "Get recommended buffer size for sample rate");
+                   "Get recommended buffer size for sample rate",
+                   py::arg("sample_rate"), py::arg("profile") = AutotuneEngine::LatencyProfile::BALANCED);
+    
+    // Background streaming
+    py::class_<StreamProcessor>(m, "StreamProcessor")
+        .def(py::init<SampleRate, uint32_t, ChannelCount, uint32_t, uint32_t, py::object>(),
+             "Create a streaming engine on a native worker thread. capacity bounds the queued "
+             "frames (and the largest chunk), max_pending the queued chunks; callback(output, result) "
+             "receives push() results on the worker thread.",
+             py::arg("sample_rate"), py::arg("buffer_size") = 512, py::arg("channels") = 2,
+             py::arg("capacity") = 8192, py::arg("max_pending") = 64, py::arg("callback") = py::none())
+        .def("push", &StreamProcessor::push,
+             "Queue a float32 chunk for the callback without blocking, returns False if the queue is full. "
+             "Interleaved chunks are (frames, channels), planar ones (channels, frames).",
+             py::arg("chunk"), py::arg("planar") = false)
+        .def("process_async", &StreamProcessor::process_async,
+             "Queue a chunk from a running event loop, returns a future of (output_array, result). "
+             "Raises RuntimeError if the queue is full.",
+             py::arg("chunk"), py::arg("planar") = false)
+        .def("close", &StreamProcessor::close,
+             "Stop the worker; with drain=False queued chunks are dropped and their futures cancelled",
+             py::arg("drain") = true)
+        .def("__enter__", [](StreamProcessor& processor) -> StreamProcessor& { return processor; },
+             py::return_value_policy::reference_internal)
+        .def("__exit__", [](StreamProcessor& processor, py::args) { processor.close(true); })
+        .def_property_readonly("engine", &StreamProcessor::engine, py::return_value_policy::reference_internal,
+                               "The engine (only mailbox-backed setters while chunks are in flight)")
+        .def_property_readonly("pending", &StreamProcessor::pending, "Chunks queued but not yet delivered")
+        .def_property_readonly("pool_size", &StreamProcessor::pool_size, "Output buffers allocated so far")
+        .def_property_readonly("capacity", &StreamProcessor::capacity, "Largest chunk in frames")
+        .def_property_readonly("closed", &StreamProcessor::closed, "Whether close() has run");
     
     // Utility functions
     m.def("generate_sine_wave", 
@@ -247,8 +797,9 @@ engine.set_parameters(params)
 test_audio = pyautotune.generate_sine_wave(265.0, 44100, 1.0)  # Flat C4
 stereo_audio = np.column_stack([test_audio, test_audio])  # Make stereo
 
-# Process audio
-output_audio, result = engine.process_numpy(stereo_audio)
+# Process audio (zero-copy for C-contiguous float32; out= reuses a buffer)
+output_audio, result = engine.process_numpy(stereo_audio.astype(np.float32))
+engine.process_numpy(stereo_audio.astype(np.float32), out=output_audio)
 
 print(f"Detected pitch: {result.detected_pitch:.2f} Hz")
 print(f"Corrected pitch: {result.corrected_pitch:.2f} Hz")
@@ -258,4 +809,15 @@ print(f"Confidence: {result.confidence:.2f}")
 metrics = engine.get_performance_metrics()
 print(f"Average latency: {metrics.average_latency_ms:.2f} ms")
 print(f"CPU usage: {metrics.cpu_usage_percent:.1f}%")
+
+# Stream chunks without blocking the event loop; outputs are pooled arrays,
+# reused once no longer referenced (copy them to keep them longer)
+import asyncio
+
+async def tune_stream(chunks):
+    with pyautotune.StreamProcessor(44100, 512, 2) as stream:
+        stream.engine.set_scale(pyautotune.Scale.MAJOR, 60)
+        for chunk in chunks:
+            output, result = await stream.process_async(chunk)
+            yield output.copy()
 )";
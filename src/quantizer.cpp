@@ -1,14 +1,78 @@
 #include "quantizer.h"
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 
 namespace autotune {
 
+namespace {
+
+constexpr float kSemitonesPerOctave = 12.0f;
+
+/**
+ * @brief log2 accurate to ~2e-5 (0.02 cent) for positive normal floats
+ *
+ * Splits off the exponent bits and evaluates log2 of the mantissa m in
+ * [1, 2) through the atanh series in t = (m - 1) / (m + 1), |t| <= 1/3.
+ */
+inline float fast_log2(float x) {
+    uint32_t bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    int exponent = static_cast<int>((bits >> 23) & 0xFFu) - 127;
+    bits = (bits & 0x007FFFFFu) | 0x3F800000u;
+    float mantissa;
+    std::memcpy(&mantissa, &bits, sizeof(mantissa));
+    
+    float t = (mantissa - 1.0f) / (mantissa + 1.0f);
+    float t2 = t * t;
+    float series = t * (2.8853901f + t2 * (0.9617967f + t2 * (0.5770780f + t2 * 0.4121986f)));
+    return static_cast<float>(exponent) + series;
+}
+
+/**
+ * @brief exp2 with relative error ~3e-6 for |x| < 126
+ *
+ * Rounds x to an integer exponent n written straight into the float bits
+ * and evaluates 2^f for f = x - n in [-0.5, 0.5] with a degree-5 Taylor
+ * polynomial.
+ */
+inline float fast_exp2(float x) {
+    float whole = std::nearbyint(x);
+    float f = x - whole;
+    float p = 1.0f + f * (0.69314718f + f * (0.24022651f + f * (0.05550411f +
+              f * (0.00961813f + f * 0.00133336f))));
+    uint32_t bits = static_cast<uint32_t>(static_cast<int>(whole) + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+/**
+ * @brief Intervals of the built-in scales, indexed by Quantizer::Scale
+ */
+const std::array<std::vector<int>, 8>& builtin_scale_intervals() {
+    static const std::array<std::vector<int>, 8> intervals = {{
+        {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11},     // Chromatic scale (all semitones)
+        {0, 2, 4, 5, 7, 9, 11},                     // Major scale (Ionian)
+        {0, 2, 3, 5, 7, 8, 10},                     // Natural minor scale (Aeolian)
+        {0, 2, 4, 7, 9},                            // Pentatonic major
+        {0, 3, 5, 6, 7, 10},                        // Blues scale
+        {0, 2, 3, 5, 7, 9, 10},                     // Dorian mode
+        {0, 2, 4, 5, 7, 9, 10},                     // Mixolydian mode
+        {}                                          // Custom scale (initialized empty)
+    }};
+    return intervals;
+}
+
+} // namespace
+
 Quantizer::Quantizer(SampleRate sample_rate, float tempo)
-    : sample_rate_(sample_rate), tempo_(tempo), time_signature_(TimeSignature::FOUR_FOUR) {
+    : sample_rate_(sample_rate), tempo_(tempo), time_signature_(TimeSignature::FOUR_FOUR),
+      builtin_table_(nullptr), table_scale_(Scale::CHROMATIC), table_valid_(false), table_passthrough_(false) {
     
     initialize_scales();
     update_timing();
+    prepare_scale(Scale::CHROMATIC);
 }
 
 Quantizer::~Quantizer() = default;
@@ -18,41 +82,50 @@ float Quantizer::quantize_pitch(float input_pitch, Scale scale, int key_center,
         return input_pitch;
     }
     
-    // Convert frequency to MIDI note
-    float input_midi = frequency_to_midi(input_pitch);
+    prepare_scale(scale);
+    if (table_passthrough_) {
+        return input_pitch;
+    }
     
-    // Get scale intervals
-    const auto& intervals = get_scale_intervals(scale);
+    // Convert frequency to MIDI note
+    float input_midi = 69.0f + kSemitonesPerOctave * fast_log2(input_pitch * (1.0f / 440.0f));
     
     // Find nearest note in scale
-    float quantized_midi = find_nearest_scale_note(input_midi, intervals, key_center);
-    
-    // Apply quantization strength
-    float result_midi = input_midi + strength * (quantized_midi - input_midi);
+    float quantized_midi = lookup_scale_note(input_midi, key_center);
     
-    // Convert back to frequency
-    return midi_to_frequency(result_midi);
+    // Apply quantization strength as a ratio, so strength 0 is exact and
+    // only one exp2 is needed
+    strength = std::min(strength, 1.0f);
+    return input_pitch * fast_exp2(strength * (quantized_midi - input_midi) * (1.0f / kSemitonesPerOctave));
+}
+
+void Quantizer::prepare_scale(Scale scale) {
+    if (!table_valid_ || scale != table_scale_) {
+        build_scale_table(scale);
+    }
 }
 
 uint32_t Quantizer::quantize_timing(uint32_t input_time, GridResolution grid_resolution, float strength) {
+    return static_cast<uint32_t>(quantize_timing(static_cast<int64_t>(input_time), grid_resolution, strength));
+}
+
+int64_t Quantizer::quantize_timing(int64_t input_time, GridResolution grid_resolution, float strength) {
     if (strength <= 0.0f) {
         return input_time;
     }
     
-    // Calculate grid position
-    float grid_position = calculate_grid_position(input_time, grid_resolution);
+    // Grid position in double: float loses whole samples past 2^24
+    double samples_per_grid = get_samples_per_grid(grid_resolution);
+    double grid_position = static_cast<double>(input_time) / samples_per_grid;
     
     // Find nearest grid point
-    float nearest_grid = std::round(grid_position);
+    double nearest_grid = std::round(grid_position);
     
     // Apply quantization strength
-    float quantized_position = grid_position + strength * (nearest_grid - grid_position);
+    double quantized_position = grid_position + strength * (nearest_grid - grid_position);
     
     // Convert back to samples
-    float samples_per_grid = get_samples_per_grid(grid_resolution);
-    uint32_t quantized_time = static_cast<uint32_t>(quantized_position * samples_per_grid);
-    
-    return quantized_time;
+    return std::llround(quantized_position * samples_per_grid);
 }
 
 void Quantizer::set_tempo(float tempo) {
@@ -66,8 +139,13 @@ void Quantizer::set_time_signature(TimeSignature time_sig) {
 }
 
 void Quantizer::set_custom_scale(const std::vector<int>& intervals) {
-    custom_scale_intervals_ = intervals;
-    std::sort(custom_scale_intervals_.begin(), custom_scale_intervals_.end());
+    auto& custom = scale_intervals_[static_cast<size_t>(Scale::CUSTOM)];
+    custom = intervals;
+    std::sort(custom.begin(), custom.end());
+    
+    if (table_scale_ == Scale::CUSTOM) {
+        table_valid_ = false;
+    }
 }
 
 Note Quantizer::get_nearest_note(float input_pitch, Scale scale, int key_center) {
@@ -75,13 +153,13 @@ Note Quantizer::get_nearest_note(float input_pitch, Scale scale, int key_center)
         return Note(0.0f, 0, 0.0f);
     }
     
-    float input_midi = frequency_to_midi(input_pitch);
-    const auto& intervals = get_scale_intervals(scale);
-    float quantized_midi = find_nearest_scale_note(input_midi, intervals, key_center);
+    prepare_scale(scale);
+    float input_midi = 69.0f + kSemitonesPerOctave * fast_log2(input_pitch * (1.0f / 440.0f));
+    float quantized_midi = table_passthrough_ ? input_midi : lookup_scale_note(input_midi, key_center);
     float quantized_freq = midi_to_frequency(quantized_midi);
     
     // Calculate cents deviation
-    float cents = 1200.0f * std::log2(input_pitch / quantized_freq);
+    float cents = 100.0f * (input_midi - quantized_midi);
     
     return Note(quantized_freq, static_cast<int>(quantized_midi), cents);
 }
@@ -100,29 +178,7 @@ void Quantizer::reset() {
 }
 
 void Quantizer::initialize_scales() {
-    // Chromatic scale (all semitones)
-    scale_intervals_[0] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
-    
-    // Major scale (Ionian)
-    scale_intervals_[1] = {0, 2, 4, 5, 7, 9, 11};
-    
-    // Natural minor scale (Aeolian)
-    scale_intervals_[2] = {0, 2, 3, 5, 7, 8, 10};
-    
-    // Pentatonic major
-    scale_intervals_[3] = {0, 2, 4, 7, 9};
-    
-    // Blues scale
-    scale_intervals_[4] = {0, 3, 5, 6, 7, 10};
-    
-    // Dorian mode
-    scale_intervals_[5] = {0, 2, 3, 5, 7, 9, 10};
-    
-    // Mixolydian mode
-    scale_intervals_[6] = {0, 2, 4, 5, 7, 9, 10};
-    
-    // Custom scale (initialized empty)
-    scale_intervals_[7] = {};
+    scale_intervals_ = builtin_scale_intervals();
 }
 
 void Quantizer::update_timing() {
@@ -156,20 +212,68 @@ void Quantizer::update_timing() {
 }
 
 const std::vector<int>& Quantizer::get_scale_intervals(Scale scale) const {
-    switch (scale) {
-        case Scale::CHROMATIC: return scale_intervals_[0];
-        case Scale::MAJOR: return scale_intervals_[1];
-        case Scale::MINOR: return scale_intervals_[2];
-        case Scale::PENTATONIC: return scale_intervals_[3];
-        case Scale::BLUES: return scale_intervals_[4];
-        case Scale::DORIAN: return scale_intervals_[5];
-        case Scale::MIXOLYDIAN: return scale_intervals_[6];
-        case Scale::CUSTOM: return custom_scale_intervals_;
-        default: return scale_intervals_[0]; // Default to chromatic
+    size_t index = static_cast<size_t>(scale);
+    return index < scale_intervals_.size() ? scale_intervals_[index] : scale_intervals_[0];
+}
+
+void Quantizer::build_scale_table(Scale scale) {
+    const auto& intervals = get_scale_intervals(scale);
+    table_scale_ = scale;
+    table_valid_ = true;
+    table_passthrough_ = intervals.empty();
+    builtin_table_ = nullptr;
+    if (table_passthrough_) {
+        return;
+    }
+    
+    if (scale == Scale::CUSTOM) {
+        fill_scale_table(intervals, custom_table_);
+    } else {
+        builtin_table_ = &builtin_scale_tables()[static_cast<size_t>(scale)];
     }
 }
 
-float Quantizer::find_nearest_scale_note(float midi_note, const std::vector<int>& intervals, int key_center) const {
+const std::array<Quantizer::ScaleTable, 7>& Quantizer::builtin_scale_tables() {
+    // Built on first use (a constructor tabulates CHROMATIC), never on the audio thread
+    static const std::array<ScaleTable, 7> tables = []() {
+        std::array<ScaleTable, 7> built;
+        for (size_t scale = 0; scale < built.size(); ++scale) {
+            fill_scale_table(builtin_scale_intervals()[scale], built[scale]);
+        }
+        return built;
+    }();
+    return tables;
+}
+
+void Quantizer::fill_scale_table(const std::vector<int>& intervals, ScaleTable& table) {
+    // Scale notes are whole semitones apart, so the nearest-note function
+    // changes at most once inside a bin, at the midpoint of the notes on
+    // either side. Bins are evaluated with the reference search.
+    const float bin_width = 1.0f / kTableResolution;
+    for (uint32_t bin = 0; bin < table.size(); ++bin) {
+        float start = bin * bin_width;
+        auto& entry = table[bin];
+        entry.lower = find_nearest_scale_note(start, intervals, 0);
+        entry.upper = find_nearest_scale_note(start + 0.999f * bin_width, intervals, 0);
+        entry.boundary = entry.lower == entry.upper ? start + bin_width : 0.5f * (entry.lower + entry.upper);
+    }
+}
+
+float Quantizer::lookup_scale_note(float midi_note, int key_center) const {
+    float relative_note = midi_note - key_center;
+    float octave = std::floor(relative_note * (1.0f / kSemitonesPerOctave));
+    float note_in_octave = relative_note - octave * kSemitonesPerOctave;
+    
+    const ScaleTable& table = builtin_table_ ? *builtin_table_ : custom_table_;
+    uint32_t bin = std::min(static_cast<uint32_t>(note_in_octave * kTableResolution),
+                            static_cast<uint32_t>(table.size() - 1));
+    const auto& entry = table[bin];
+    float note = note_in_octave < entry.boundary ? entry.lower : entry.upper;
+    
+    return key_center + octave * kSemitonesPerOctave + note;
+}
+
+float Quantizer::find_nearest_scale_note(float midi_note, const std::vector<int>& intervals, int key_center) {
     if (intervals.empty()) {
         return midi_note; // No quantization if no scale intervals
     }
@@ -202,11 +306,6 @@ float Quantizer::find_nearest_scale_note(float midi_note, const std::vector<int>
     return key_center + octave * 12.0f + nearest_interval;
 }
 
-float Quantizer::calculate_grid_position(uint32_t time_samples, GridResolution resolution) const {
-    float samples_per_grid = get_samples_per_grid(resolution);
-    return static_cast<float>(time_samples) / samples_per_grid;
-}
-
 float Quantizer::get_samples_per_grid(GridResolution resolution) const {
     switch (resolution) {
         case GridResolution::QUARTER_NOTE:
@@ -0,0 +1,250 @@
+#include "rhythm_quantizer.h"
+#include "simd.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace autotune {
+
+namespace {
+
+// Onset detection resolution
+constexpr float kHopSeconds = 0.005f;
+
+// Crossfade between slips, and the gap it keeps before the onset
+constexpr float kFadeSeconds = 0.004f;
+constexpr float kOnsetMarginSeconds = 0.001f;
+
+// Largest distance an onset is moved; sets the delay
+constexpr float kMaxSlipSeconds = 0.06f;
+
+// Onsets closer together than this are one transient
+constexpr float kMinOnsetSeconds = 0.05f;
+
+// A hop is an onset when its mean square rises this far above the
+// envelope of the hops before it, and above the floor (-50 dBFS)
+constexpr float kOnsetRatio = 4.0f;
+constexpr float kOnsetFloor = 1e-5f;
+
+// Envelope decay per hop (about -190 dB/s)
+constexpr float kEnvelopeDecay = 0.8f;
+
+// The onset sample is the first of the hop above this fraction of its RMS
+// and above the peaks of the envelope level before it
+constexpr float kOnsetLevel = 0.5f;
+constexpr float kBackgroundPeak = 1.5f;
+
+uint32_t seconds_to_samples(float seconds, SampleRate sample_rate) {
+    return std::max(1u, static_cast<uint32_t>(std::lround(seconds * sample_rate)));
+}
+
+} // namespace
+
+RhythmQuantizer::RhythmQuantizer(SampleRate sample_rate, ChannelCount channels)
+    : sample_rate_(sample_rate), channels_(std::max(channels, 1u)),
+      hop_size_(seconds_to_samples(kHopSeconds, sample_rate)),
+      fade_(seconds_to_samples(kFadeSeconds, sample_rate)),
+      pre_roll_(fade_ + seconds_to_samples(kOnsetMarginSeconds, sample_rate)),
+      max_slip_(seconds_to_samples(kMaxSlipSeconds, sample_rate)),
+      min_onset_interval_(seconds_to_samples(kMinOnsetSeconds, sample_rate)),
+      max_block_(0), ring_size_(0), ring_mask_(0) {
+
+    // An onset is known by the end of its hop and its fade starts the
+    // pre-roll plus the slip before it
+    latency_ = max_slip_ + pre_roll_ + hop_size_;
+
+    const float pi = static_cast<float>(M_PI);
+    fade_curve_.resize(fade_);
+    for (uint32_t i = 0; i < fade_; ++i) {
+        fade_curve_[i] = 0.5f - 0.5f * std::cos(pi * (i + 0.5f) / fade_);
+    }
+    reset();
+}
+
+void RhythmQuantizer::prepare(uint32_t max_block) {
+    max_block_ = std::max(max_block, 1u);
+
+    // The oldest read is a block plus the delay and largest slip behind the
+    // newest input; onsets are refined within the newest hop
+    uint32_t needed = max_block_ + latency_ + max_slip_ + hop_size_;
+    ring_size_ = 1;
+    while (ring_size_ < needed) {
+        ring_size_ <<= 1;
+    }
+    ring_mask_ = ring_size_ - 1;
+    ring_.assign(static_cast<size_t>(ring_size_) * channels_, 0.0f);
+    reset(static_cast<uint64_t>(origin_));
+}
+
+void RhythmQuantizer::reset(int64_t position) {
+    origin_ = position;
+    written_ = origin_;
+    hop_fill_ = 0;
+    hop_energy_ = 0.0;
+    envelope_ = 0.0f;
+    last_onset_ = origin_ - static_cast<int64_t>(min_onset_interval_);
+    onset_count_ = 0;
+    switch_head_ = 0;
+    switch_count_ = 0;
+    scheduled_slip_ = 0;
+    scheduled_end_ = INT64_MIN;
+    slip_ = 0;
+    fade_from_ = 0;
+    fade_start_ = 0;
+    fading_ = false;
+}
+
+ProcessingResult RhythmQuantizer::process(const Sample* const* input, Sample* const* output,
+                                          ChannelCount channel_count, uint32_t frame_count,
+                                          Quantizer& quantizer, Quantizer::GridResolution grid,
+                                          float strength) {
+    ProcessingResult result;
+    if (!input || !output || channel_count == 0 || channel_count > channels_ || frame_count == 0 ||
+        frame_count > max_block_) {
+        result.success = false;
+        return result;
+    }
+    strength = std::clamp(strength, 0.0f, 1.0f);
+
+    // Into the delay line hop by hop, checking each full hop for an onset
+    uint32_t offset = 0;
+    while (offset < frame_count) {
+        uint32_t piece = std::min(frame_count - offset, hop_size_ - hop_fill_);
+        uint32_t index = static_cast<uint32_t>(static_cast<uint64_t>(written_) & ring_mask_);
+        uint32_t first = std::min(piece, ring_size_ - index);
+        for (ChannelCount ch = 0; ch < channel_count; ++ch) {
+            const Sample* source = input[ch] + offset;
+            Sample* ring = ring_channel(ch);
+            std::memcpy(ring + index, source, first * sizeof(Sample));
+            std::memcpy(ring, source + first, (piece - first) * sizeof(Sample));
+            hop_energy_ += simd::dot(source, source, piece);
+        }
+
+        written_ += piece;
+        offset += piece;
+        hop_fill_ += piece;
+        if (hop_fill_ == hop_size_) {
+            hop_energy_ /= static_cast<double>(hop_size_) * channel_count;
+            end_hop(channel_count, quantizer, grid, strength);
+            hop_fill_ = 0;
+            hop_energy_ = 0.0;
+        }
+    }
+
+    // Out of it at the delay plus the current slip, fading where slips change
+    int64_t start = written_ - frame_count;
+    uint32_t done = 0;
+    while (done < frame_count) {
+        int64_t now = start + done;
+        if (!fading_ && switch_count_ > 0 && switches_[switch_head_].time <= now) {
+            fade_from_ = slip_;
+            slip_ = switches_[switch_head_].slip;
+            fade_start_ = now;
+            fading_ = true;
+            switch_head_ = (switch_head_ + 1) % kMaxSwitches;
+            --switch_count_;
+        }
+
+        uint32_t count = frame_count - done;
+        int64_t position = now - latency_;
+        if (fading_) {
+            uint32_t elapsed = static_cast<uint32_t>(now - fade_start_);
+            count = std::min(count, fade_ - elapsed);
+            const float* gains = fade_curve_.data() + elapsed;
+            for (ChannelCount ch = 0; ch < channel_count; ++ch) {
+                Sample* destination = output[ch] + done;
+                for (uint32_t i = 0; i < count; ++i) {
+                    Sample outgoing = sample_at(ch, position + fade_from_ + i);
+                    Sample incoming = sample_at(ch, position + slip_ + i);
+                    destination[i] = outgoing + gains[i] * (incoming - outgoing);
+                }
+            }
+            fading_ = elapsed + count < fade_;
+        } else {
+            if (switch_count_ > 0) {
+                count = static_cast<uint32_t>(std::min<int64_t>(count, switches_[switch_head_].time - now));
+            }
+            for (ChannelCount ch = 0; ch < channel_count; ++ch) {
+                read(ch, position + slip_, output[ch] + done, count);
+            }
+        }
+        done += count;
+    }
+
+    result.success = true;
+    result.latency_samples = latency_;
+    return result;
+}
+
+void RhythmQuantizer::end_hop(ChannelCount channel_count, Quantizer& quantizer, Quantizer::GridResolution grid,
+                              float strength) {
+    float energy = static_cast<float>(hop_energy_);
+    float background = envelope_;
+    envelope_ = std::max(energy, envelope_ * kEnvelopeDecay);
+
+    if (energy < kOnsetFloor || energy < kOnsetRatio * background ||
+        written_ - last_onset_ < static_cast<int64_t>(min_onset_interval_)) {
+        return;
+    }
+
+    float threshold = std::max(kOnsetLevel * std::sqrt(energy), kBackgroundPeak * std::sqrt(background));
+    int64_t onset = refine_onset(channel_count, threshold);
+    last_onset_ = onset;
+    ++onset_count_;
+    schedule(onset, quantizer, grid, strength);
+}
+
+int64_t RhythmQuantizer::refine_onset(ChannelCount channel_count, float threshold) {
+    int64_t hop_start = written_ - hop_size_;
+    for (int64_t position = hop_start; position < written_; ++position) {
+        for (ChannelCount ch = 0; ch < channel_count; ++ch) {
+            if (std::abs(sample_at(ch, position)) >= threshold) {
+                return position;
+            }
+        }
+    }
+    return hop_start;
+}
+
+void RhythmQuantizer::schedule(int64_t onset, Quantizer& quantizer, Quantizer::GridResolution grid,
+                               float strength) {
+    int64_t target = quantizer.quantize_timing(onset, grid, strength);
+    int64_t slip = std::clamp<int64_t>(onset - target,
+                                       -static_cast<int64_t>(max_slip_), max_slip_);
+    if (slip == scheduled_slip_) {
+        return;
+    }
+
+    // Fade so both the material before the onset (old slip) and the onset
+    // itself (new slip) play unblended
+    int64_t time = onset - pre_roll_ + latency_ - std::max(slip, scheduled_slip_);
+    if (time < scheduled_end_ || switch_count_ == kMaxSwitches) {
+        return;
+    }
+    switches_[(switch_head_ + switch_count_) % kMaxSwitches] = {time, slip};
+    ++switch_count_;
+    scheduled_slip_ = slip;
+    scheduled_end_ = time + fade_;
+}
+
+void RhythmQuantizer::read(ChannelCount ch, int64_t position, Sample* destination, uint32_t count) {
+    if (position < origin_) {
+        uint32_t silent = static_cast<uint32_t>(std::min<int64_t>(count, origin_ - position));
+        std::memset(destination, 0, silent * sizeof(Sample));
+        destination += silent;
+        position += silent;
+        count -= silent;
+    }
+
+    const Sample* ring = ring_channel(ch);
+    while (count > 0) {
+        uint32_t index = static_cast<uint32_t>(static_cast<uint64_t>(position) & ring_mask_);
+        uint32_t run = std::min(count, ring_size_ - index);
+        std::memcpy(destination, ring + index, run * sizeof(Sample));
+        destination += run;
+        position += run;
+        count -= run;
+    }
+}
+
+} // namespace autotune
@@ -0,0 +1,981 @@
+#include "simd.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define AUTOTUNE_SIMD_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define AUTOTUNE_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+// AVX2 kernels are compiled for AVX2 regardless of the global -march flags
+// and only called after the runtime CPU check
+#if defined(AUTOTUNE_SIMD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define AUTOTUNE_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define AUTOTUNE_TARGET_AVX2
+#endif
+
+namespace autotune {
+namespace simd {
+
+namespace {
+
+struct KernelTable {
+    InstructionSet instruction_set;
+    void (*multiply)(const Sample*, const Sample*, Sample*, uint32_t);
+    void (*mix)(const Sample*, const Sample*, Sample*, float, uint32_t);
+    void (*scale)(const Sample*, float, Sample*, uint32_t);
+    float (*dot)(const Sample*, const Sample*, uint32_t);
+    void (*scale_lanes)(const Sample*, const float*, Sample*, uint32_t, uint32_t);
+    void (*dot_lanes)(const Sample*, const Sample*, float*, uint32_t, uint32_t);
+    void (*butterfly_lanes)(Sample*, Sample*, const float*, uint32_t, uint32_t, uint32_t, uint32_t, bool);
+    void (*fused_butterfly_lanes)(Sample*, Sample*, const float*, uint32_t, uint32_t, uint32_t, uint32_t, bool);
+    void (*int16_to_float)(const int16_t*, Sample*, uint32_t);
+    void (*float_to_int16)(const Sample*, int16_t*, uint32_t);
+};
+
+// PCM full scale
+constexpr float kInt16Scale = 32768.0f;
+constexpr float kInt24Scale = 8388608.0f;
+
+// Lanes first .. lanes - 1 of interleaved frames, i.e. whatever a vector
+// kernel leaves over when the lane count is not a multiple of its width
+void scale_lane_range(const Sample* input, const float* gains, Sample* output,
+                      uint32_t first, uint32_t lanes, uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i) {
+        size_t frame = static_cast<size_t>(i) * lanes;
+        for (uint32_t v = first; v < lanes; ++v) {
+            output[frame + v] = input[frame + v] * gains[i];
+        }
+    }
+}
+
+void dot_lane_range(const Sample* a, const Sample* b, float* output,
+                    uint32_t first, uint32_t lanes, uint32_t count) {
+    for (uint32_t v = first; v < lanes; ++v) {
+        output[v] = 0.0f;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        size_t frame = static_cast<size_t>(i) * lanes;
+        for (uint32_t v = first; v < lanes; ++v) {
+            output[v] += a[frame + v] * b[frame + v];
+        }
+    }
+}
+
+void butterfly_lane_range(Sample* re, Sample* im, const float* twiddles, uint32_t twiddle_step,
+                          uint32_t half_length, uint32_t row_count, uint32_t first, uint32_t lanes,
+                          bool inverse) {
+    if (first >= lanes) {
+        return;
+    }
+    float sign = inverse ? -1.0f : 1.0f;
+    size_t distance = static_cast<size_t>(half_length) * lanes;
+    for (uint32_t group = 0; group < row_count; group += 2 * half_length) {
+        for (uint32_t j = 0; j < half_length; ++j) {
+            float w_re = twiddles[2 * j * twiddle_step];
+            float w_im = sign * twiddles[2 * j * twiddle_step + 1];
+            Sample* a_re = re + static_cast<size_t>(group + j) * lanes;
+            Sample* a_im = im + static_cast<size_t>(group + j) * lanes;
+            for (uint32_t v = first; v < lanes; ++v) {
+                float b_re = a_re[v + distance];
+                float b_im = a_im[v + distance];
+                float t_re = b_re * w_re - b_im * w_im;
+                float t_im = b_re * w_im + b_im * w_re;
+                a_re[v + distance] = a_re[v] - t_re;
+                a_im[v + distance] = a_im[v] - t_im;
+                a_re[v] += t_re;
+                a_im[v] += t_im;
+            }
+        }
+    }
+}
+
+void fused_butterfly_lane_range(Sample* re, Sample* im, const float* twiddles, uint32_t twiddle_step,
+                                uint32_t quarter_length, uint32_t row_count, uint32_t first, uint32_t lanes,
+                                bool inverse) {
+    if (first >= lanes) {
+        return;
+    }
+    float sign = inverse ? -1.0f : 1.0f;
+    size_t q = static_cast<size_t>(quarter_length) * lanes;
+    for (uint32_t group = 0; group < row_count; group += 4 * quarter_length) {
+        for (uint32_t j = 0; j < quarter_length; ++j) {
+            const float* w1 = twiddles + 4 * j * twiddle_step;
+            const float* w2 = twiddles + 2 * j * twiddle_step;
+            const float* w3 = twiddles + 2 * (j + quarter_length) * twiddle_step;
+            float w1_re = w1[0], w1_im = sign * w1[1];
+            float w2_re = w2[0], w2_im = sign * w2[1];
+            float w3_re = w3[0], w3_im = sign * w3[1];
+            Sample* x_re = re + static_cast<size_t>(group + j) * lanes;
+            Sample* x_im = im + static_cast<size_t>(group + j) * lanes;
+            for (uint32_t v = first; v < lanes; ++v) {
+                // First stage: (x0, x1) and (x2, x3), both with w1
+                float t_re = x_re[v + q] * w1_re - x_im[v + q] * w1_im;
+                float t_im = x_re[v + q] * w1_im + x_im[v + q] * w1_re;
+                float a0_re = x_re[v] + t_re, a0_im = x_im[v] + t_im;
+                float a1_re = x_re[v] - t_re, a1_im = x_im[v] - t_im;
+                t_re = x_re[v + 3 * q] * w1_re - x_im[v + 3 * q] * w1_im;
+                t_im = x_re[v + 3 * q] * w1_im + x_im[v + 3 * q] * w1_re;
+                float a2_re = x_re[v + 2 * q] + t_re, a2_im = x_im[v + 2 * q] + t_im;
+                float a3_re = x_re[v + 2 * q] - t_re, a3_im = x_im[v + 2 * q] - t_im;
+                
+                // Second stage: (a0, a2) with w2 and (a1, a3) with w3
+                t_re = a2_re * w2_re - a2_im * w2_im;
+                t_im = a2_re * w2_im + a2_im * w2_re;
+                x_re[v] = a0_re + t_re;
+                x_im[v] = a0_im + t_im;
+                x_re[v + 2 * q] = a0_re - t_re;
+                x_im[v + 2 * q] = a0_im - t_im;
+                t_re = a3_re * w3_re - a3_im * w3_im;
+                t_im = a3_re * w3_im + a3_im * w3_re;
+                x_re[v + q] = a1_re + t_re;
+                x_im[v + q] = a1_im + t_im;
+                x_re[v + 3 * q] = a1_re - t_re;
+                x_im[v + 3 * q] = a1_im - t_im;
+            }
+        }
+    }
+}
+
+#if defined(AUTOTUNE_SIMD_X86)
+
+// SSE2 kernels (baseline on x86-64)
+void multiply_sse2(const Sample* a, const Sample* b, Sample* output, uint32_t count) {
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(output + i, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+    }
+    scalar::multiply(a + i, b + i, output + i, count - i);
+}
+
+void mix_sse2(const Sample* a, const Sample* b, Sample* output, float gain, uint32_t count) {
+    __m128 g = _mm_set1_ps(gain);
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        __m128 sum = _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i));
+        _mm_storeu_ps(output + i, _mm_mul_ps(sum, g));
+    }
+    scalar::mix(a + i, b + i, output + i, gain, count - i);
+}
+
+void scale_sse2(const Sample* input, float gain, Sample* output, uint32_t count) {
+    __m128 g = _mm_set1_ps(gain);
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_ps(output + i, _mm_mul_ps(_mm_loadu_ps(input + i), g));
+    }
+    scalar::scale(input + i, gain, output + i, count - i);
+}
+
+float dot_sse2(const Sample* a, const Sample* b, uint32_t count) {
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, _mm_add_ps(acc0, acc1));
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + scalar::dot(a + i, b + i, count - i);
+}
+
+void scale_lanes_sse2_range(const Sample* input, const float* gains, Sample* output,
+                            uint32_t first, uint32_t lanes, uint32_t count) {
+    uint32_t vector_end = first + ((lanes - first) & ~3u);
+    for (uint32_t i = 0; i < count; ++i) {
+        size_t frame = static_cast<size_t>(i) * lanes;
+        __m128 g = _mm_set1_ps(gains[i]);
+        for (uint32_t v = first; v < vector_end; v += 4) {
+            _mm_storeu_ps(output + frame + v, _mm_mul_ps(_mm_loadu_ps(input + frame + v), g));
+        }
+    }
+    scale_lane_range(input, gains, output, vector_end, lanes, count);
+}
+
+void scale_lanes_sse2(const Sample* input, const float* gains, Sample* output, uint32_t lanes, uint32_t count) {
+    scale_lanes_sse2_range(input, gains, output, 0, lanes, count);
+}
+
+void dot_lanes_sse2_range(const Sample* a, const Sample* b, float* output,
+                          uint32_t first, uint32_t lanes, uint32_t count) {
+    uint32_t vector_end = first + ((lanes - first) & ~3u);
+    for (uint32_t v = first; v < vector_end; v += 4) {
+        // Alternate frames feed separate accumulators to hide the add latency
+        __m128 acc0 = _mm_setzero_ps();
+        __m128 acc1 = _mm_setzero_ps();
+        uint32_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            size_t frame = static_cast<size_t>(i) * lanes + v;
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + frame), _mm_loadu_ps(b + frame)));
+            acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + frame + lanes), _mm_loadu_ps(b + frame + lanes)));
+        }
+        if (i < count) {
+            size_t frame = static_cast<size_t>(i) * lanes + v;
+            acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + frame), _mm_loadu_ps(b + frame)));
+        }
+        _mm_storeu_ps(output + v, _mm_add_ps(acc0, acc1));
+    }
+    dot_lane_range(a, b, output, vector_end, lanes, count);
+}
+
+void dot_lanes_sse2(const Sample* a, const Sample* b, float* output, uint32_t lanes, uint32_t count) {
+    dot_lanes_sse2_range(a, b, output, 0, lanes, count);
+}
+
+void butterfly_lanes_sse2_range(Sample* re, Sample* im, const float* twiddles, uint32_t twiddle_step,
+                                uint32_t half_length, uint32_t row_count, uint32_t first, uint32_t lanes,
+                                bool inverse) {
+    uint32_t vector_end = first + ((lanes - first) & ~3u);
+    if (vector_end > first) {
+        float sign = inverse ? -1.0f : 1.0f;
+        size_t distance = static_cast<size_t>(half_length) * lanes;
+        for (uint32_t group = 0; group < row_count; group += 2 * half_length) {
+            for (uint32_t j = 0; j < half_length; ++j) {
+                __m128 w_re = _mm_set1_ps(twiddles[2 * j * twiddle_step]);
+                __m128 w_im = _mm_set1_ps(sign * twiddles[2 * j * twiddle_step + 1]);
+                Sample* a_re = re + static_cast<size_t>(group + j) * lanes;
+                Sample* a_im = im + static_cast<size_t>(group + j) * lanes;
+                for (uint32_t v = first; v < vector_end; v += 4) {
+                    __m128 b_re = _mm_loadu_ps(a_re + v + distance);
+                    __m128 b_im = _mm_loadu_ps(a_im + v + distance);
+                    __m128 t_re = _mm_sub_ps(_mm_mul_ps(b_re, w_re), _mm_mul_ps(b_im, w_im));
+                    __m128 t_im = _mm_add_ps(_mm_mul_ps(b_re, w_im), _mm_mul_ps(b_im, w_re));
+                    __m128 x_re = _mm_loadu_ps(a_re + v);
+                    __m128 x_im = _mm_loadu_ps(a_im + v);
+                    _mm_storeu_ps(a_re + v + distance, _mm_sub_ps(x_re, t_re));
+                    _mm_storeu_ps(a_im + v + distance, _mm_sub_ps(x_im, t_im));
+                    _mm_storeu_ps(a_re + v, _mm_add_ps(x_re, t_re));
+                    _mm_storeu_ps(a_im + v, _mm_add_ps(x_im, t_im));
+                }
+            }
+        }
+    }
+    butterfly_lane_range(re, im, twiddles, twiddle_step, half_length, row_count, vector_end, lanes, inverse);
+}
+
+void butterfly_lanes_sse2(Sample* re, Sample* im, const float* twiddles, uint32_t twiddle_step,
+                          uint32_t half_length, uint32_t row_count, uint32_t lanes, bool inverse) {
+    butterfly_lanes_sse2_range(re, im, twiddles, twiddle_step, half_length, row_count, 0, lanes, inverse);
+}
+
+// (a_re + i a_im) * (w_re + i w_im)
+inline void complex_multiply_sse2(__m128 a_re, __m128 a_im, __m128 w_re, __m128 w_im,
+                                  __m128& out_re, __m128& out_im) {
+    out_re = _mm_sub_ps(_mm_mul_ps(a_re, w_re), _mm_mul_ps(a_im, w_im));
+    out_im = _mm_add_ps(_mm_mul_ps(a_re, w_im), _mm_mul_ps(a_im, w_re));
+}
+
+void fused_butterfly_lanes_sse2_range(Sample* re, Sample* im, const float* twiddles, uint32_t twiddle_step,
+                                      uint32_t quarter_length, uint32_t row_count, uint32_t first,
+                                      uint32_t lanes, bool inverse) {
+    uint32_t vector_end = first + ((lanes - first) & ~3u);
+    if (vector_end > first) {
+        float sign = inverse ? -1.0f : 1.0f;
+        size_t q = static_cast<size_t>(quarter_length) * lanes;
+        for (uint32_t group = 0; group < row_count; group += 4 * quarter_length) {
+            for (uint32_t j = 0; j < quarter_length; ++j) {
+                const float* w1 = twiddles + 4 * j * twiddle_step;
+                const float* w2 = twiddles + 2 * j * twiddle_step;
+                const float* w3 = twiddles + 2 * (j + quarter_length) * twiddle_step;
+                __m128 w1_re = _mm_set1_ps(w1[0]), w1_im = _mm_set1_ps(sign * w1[1]);
+                __m128 w2_re = _mm_set1_ps(w2[0]), w2_im = _mm_set1_ps(sign * w2[1]);
+                __m128 w3_re = _mm_set1_ps(w3[0]), w3_im = _mm_set1_ps(sign * w3[1]);
+                Sample* x_re = re + static_cast<size_t>(group + j) * lanes;
+                Sample* x_im = im + static_cast<size_t>(group + j) * lanes;
+                for (uint32_t v = first; v < vector_end; v += 4) {
+                    __m128 t_re, t_im;
+                    __m128 x0_re = _mm_loadu_ps(x_re + v), x0_im = _mm_loadu_ps(x_im + v);
+                    complex_multiply_sse2(_mm_loadu_ps(x_re + v + q), _mm_loadu_ps(x_im + v + q), w1_re, w1_im, t_re, t_im);
+                    __m128 a0_re = _mm_add_ps(x0_re, t_re), a0_im = _mm_add_ps(x0_im, t_im);
+                    __m128 a1_re = _mm_sub_ps(x0_re, t_re), a1_im = _mm_sub_ps(x0_im, t_im);
+                    __m128 x2_re = _mm_loadu_ps(x_re + v + 2 * q), x2_im = _mm_loadu_ps(x_im + v + 2 * q);
+                    complex_multiply_sse2(_mm_loadu_ps(x_re + v + 3 * q), _mm_loadu_ps(x_im + v + 3 * q),
+                                          w1_re, w1_im, t_re, t_im);
+                    __m128 a2_re = _mm_add_ps(x2_re, t_re), a2_im = _mm_add_ps(x2_im, t_im);
+                    __m128 a3_re = _mm_sub_ps(x2_re, t_re), a3_im = _mm_sub_ps(x2_im, t_im);
+                    
+                    complex_multiply_sse2(a2_re, a2_im, w2_re, w2_im, t_re, t_im);
+                    _mm_storeu_ps(x_re + v, _mm_add_ps(a0_re, t_re));
+                    _mm_storeu_ps(x_im + v, _mm_add_ps(a0_im, t_im));
+                    _mm_storeu_ps(x_re + v + 2 * q, _mm_sub_ps(a0_re, t_re));
+                    _mm_storeu_ps(x_im + v + 2 * q, _mm_sub_ps(a0_im, t_im));
+                    complex_multiply_sse2(a3_re, a3_im, w3_re, w3_im, t_re, t_im);
+                    _mm_storeu_ps(x_re + v + q, _mm_add_ps(a1_re, t_re));
+                    _mm_storeu_ps(x_im + v + q, _mm_add_ps(a1_im, t_im));
+                    _mm_storeu_ps(x_re + v + 3 * q, _mm_sub_ps(a1_re, t_re));
+                    _mm_storeu_ps(x_im + v + 3 * q, _mm_sub_ps(a1_im, t_im));
+                }
+            }
+        }
+    }
+    fused_butterfly_lane_range(re, im, twiddles, twiddle_step, quarter_length, row_count, vector_end, lanes, inverse);
+}
+
+void fused_butterfly_lanes_sse2(Sample* re, Sample* im, const float* twiddles, uint32_t twiddle_step,
+                                uint32_t quarter_length, uint32_t row_count, uint32_t lanes, bool inverse) {
+    fused_butterfly_lanes_sse2_range(re, im, twiddles, twiddle_step, quarter_length, row_count, 0, lanes, inverse);
+}
+
+void int16_to_float_sse2(const int16_t* input, Sample* output, uint32_t count) {
+    __m128 g = _mm_set1_ps(1.0f / kInt16Scale);
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i pcm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        // Sign-extend by placing each sample in the high half and shifting back
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(pcm, pcm), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(pcm, pcm), 16);
+        _mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), g));
+        _mm_storeu_ps(output + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), g));
+    }
+    scalar::int16_to_float(input + i, output + i, count - i);
+}
+
+void float_to_int16_sse2(const Sample* input, int16_t* output, uint32_t count) {
+    __m128 g = _mm_set1_ps(kInt16Scale);
+    __m128 low = _mm_set1_ps(-kInt16Scale);
+    __m128 high = _mm_set1_ps(kInt16Scale - 1.0f);
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128 a = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(input + i), g), low), high);
+        __m128 b = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_loadu_ps(input + i + 4), g), low), high);
+        __m128i pcm = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), pcm);
+    }
+    scalar::float_to_int16(input + i, output + i, count - i);
+}
+
+// AVX2 kernels
+AUTOTUNE_TARGET_AVX2 void multiply_avx2(const Sample* a, const Sample* b, Sample* output, uint32_t count) {
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(output + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    scalar::multiply(a + i, b + i, output + i, count - i);
+}
+
+AUTOTUNE_TARGET_AVX2 void mix_avx2(const Sample* a, const Sample* b, Sample* output, float gain, uint32_t count) {
+    __m256 g = _mm256_set1_ps(gain);
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 sum = _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        _mm256_storeu_ps(output + i, _mm256_mul_ps(sum, g));
+    }
+    scalar::mix(a + i, b + i, output + i, gain, count - i);
+}
+
+AUTOTUNE_TARGET_AVX2 void scale_avx2(const Sample* input, float gain, Sample* output, uint32_t count) {
+    __m256 g = _mm256_set1_ps(gain);
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_ps(output + i, _mm256_mul_ps(_mm256_loadu_ps(input + i), g));
+    }
+    scalar::scale(input + i, gain, output + i, count - i);
+}
+
+AUTOTUNE_TARGET_AVX2 float dot_avx2(const Sample* a, const Sample* b, uint32_t count) {
+    __m256 acc0 = _mm256_setzero_ps();
+    __m256 acc1 = _mm256_setzero_ps();
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+    }
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, _mm256_add_ps(acc0, acc1));
+    float sum = 0.0f;
+    for (float lane : lanes) {
+        sum += lane;
+    }
+    return sum + scalar::dot(a + i, b + i, count - i);
+}
+
+// Lanes past the last multiple of 8 go through the 128-bit kernels
+AUTOTUNE_TARGET_AVX2 void scale_lanes_avx2(const Sample* input, const float* gains, Sample* output,
+                                           uint32_t lanes, uint32_t count) {
+    uint32_t vector_end = lanes & ~7u;
+    for (uint32_t i = 0; i < count; ++i) {
+        size_t frame = static_cast<size_t>(i) * lanes;
+        __m256 g = _mm256_set1_ps(gains[i]);
+        for (uint32_t v = 0; v < vector_end; v += 8) {
+            _mm256_storeu_ps(output + frame + v, _mm256_mul_ps(_mm256_loadu_ps(input + frame + v), g));
+        }
+    }
+    scale_lanes_sse2_range(input, gains, output, vector_end, lanes, count);
+}
+
+AUTOTUNE_TARGET_AVX2 void dot_lanes_avx2(const Sample* a, const Sample* b, float* output,
+                                         uint32_t lanes, uint32_t count) {
+    uint32_t vector_end = lanes & ~7u;
+    for (uint32_t v = 0; v < vector_end; v += 8) {
+        __m256 acc0 = _mm256_setzero_ps();
+        __m256 acc1 = _mm256_setzero_ps();
+        uint32_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            size_t frame = static_cast<size_t>(i) * lanes + v;
+            acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + frame), _mm256_loadu_ps(b + frame)));
+            acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(a + frame + lanes),
+                                                     _mm256_loadu_ps(b + frame + lanes)));
+        }
+        if (i < count) {
+            size_t frame = static_cast<size_t>(i) * lanes + v;
+            acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + frame), _mm256_loadu_ps(b + frame)));
+        }
+        _mm256_storeu_ps(output + v, _mm256_add_ps(acc0, acc1));
+    }
+    dot_lanes_sse2_range(a, b, output, vector_end, lanes, count);
+}
+
+AUTOTUNE_TARGET_AVX2 void butterfly_lanes_avx2(Sample* re, Sample* im, const float* twiddles,
+                                               uint32_t twiddle_step, uint32_t half_length,
+                                               uint32_t row_count, uint32_t lanes, bool inverse) {
+    uint32_t vector_end = lanes & ~7u;
+    if (vector_end > 0) {
+        float sign = inverse ? -1.0f : 1.0f;
+        size_t distance = static_cast<size_t>(half_length) * lanes;
+        for (uint32_t group = 0; group < row_count; group += 2 * half_length) {
+            for (uint32_t j = 0; j < half_length; ++j) {
+                __m256 w_re = _mm256_set1_ps(twiddles[2 * j * twiddle_step]);
+                __m256 w_im = _mm256_set1_ps(sign * twiddles[2 * j * twiddle_step + 1]);
+                Sample* a_re = re + static_cast<size_t>(group + j) * lanes;
+                Sample* a_im = im + static_cast<size_t>(group + j) * lanes;
+                for (uint32_t v = 0; v < vector_end; v += 8) {
+                    __m256 b_re = _mm256_loadu_ps(a_re + v + distance);
+                    __m256 b_im = _mm256_loadu_ps(a_im + v + distance);
+                    __m256 t_re = _mm256_sub_ps(_mm256_mul_ps(b_re, w_re), _mm256_mul_ps(b_im, w_im));
+                    __m256 t_im = _mm256_add_ps(_mm256_mul_ps(b_re, w_im), _mm256_mul_ps(b_im, w_re));
+                    __m256 x_re = _mm256_loadu_ps(a_re + v);
+                    __m256 x_im = _mm256_loadu_ps(a_im + v);
+                    _mm256_storeu_ps(a_re + v + distance, _mm256_sub_ps(x_re, t_re));
+                    _mm256_storeu_ps(a_im + v + distance, _mm256_sub_ps(x_im, t_im));
+                    _mm256_storeu_ps(a_re + v, _mm256_add_ps(x_re, t_re));
+                    _mm256_storeu_ps(a_im + v, _mm256_add_ps(x_im, t_im));
+                }
+            }
+        }
+    }
+    butterfly_lanes_sse2_range(re, im, twiddles, twiddle_step, half_length, row_count, vector_end, lanes, inverse);
+}
+
+AUTOTUNE_TARGET_AVX2 inline void complex_multiply_avx2(__m256 a_re, __m256 a_im, __m256 w_re, __m256 w_im,
+                                                       __m256& out_re, __m256& out_im) {
+    out_re = _mm256_sub_ps(_mm256_mul_ps(a_re, w_re), _mm256_mul_ps(a_im, w_im));
+    out_im = _mm256_add_ps(_mm256_mul_ps(a_re, w_im), _mm256_mul_ps(a_im, w_re));
+}
+
+AUTOTUNE_TARGET_AVX2 void fused_butterfly_lanes_avx2(Sample* re, Sample* im, const float* twiddles,
+                                                     uint32_t twiddle_step, uint32_t quarter_length,
+                                                     uint32_t row_count, uint32_t lanes, bool inverse) {
+    uint32_t vector_end = lanes & ~7u;
+    if (vector_end > 0) {
+        float sign = inverse ? -1.0f : 1.0f;
+        size_t q = static_cast<size_t>(quarter_length) * lanes;
+        for (uint32_t group = 0; group < row_count; group += 4 * quarter_length) {
+            for (uint32_t j = 0; j < quarter_length; ++j) {
+                const float* w1 = twiddles + 4 * j * twiddle_step;
+                const float* w2 = twiddles + 2 * j * twiddle_step;
+                const float* w3 = twiddles + 2 * (j + quarter_length) * twiddle_step;
+                __m256 w1_re = _mm256_set1_ps(w1[0]), w1_im = _mm256_set1_ps(sign * w1[1]);
+                __m256 w2_re = _mm256_set1_ps(w2[0]), w2_im = _mm256_set1_ps(sign * w2[1]);
+                __m256 w3_re = _mm256_set1_ps(w3[0]), w3_im = _mm256_set1_ps(sign * w3[1]);
+                Sample* x_re = re + static_cast<size_t>(group + j) * lanes;
+                Sample* x_im = im + static_cast<size_t>(group + j) * lanes;
+                for (uint32_t v = 0; v < vector_end; v += 8) {
+                    __m256 t_re, t_im;
+                    __m256 x0_re = _mm256_loadu_ps(x_re + v), x0_im = _mm256_loadu_ps(x_im + v);
+                    complex_multiply_avx2(_mm256_loadu_ps(x_re + v + q), _mm256_loadu_ps(x_im + v + q),
+                                          w1_re, w1_im, t_re, t_im);
+                    __m256 a0_re = _mm256_add_ps(x0_re, t_re), a0_im = _mm256_add_ps(x0_im, t_im);
+                    __m256 a1_re = _mm256_sub_ps(x0_re, t_re), a1_im = _mm256_sub_ps(x0_im, t_im);
+                    __m256 x2_re = _mm256_loadu_ps(x_re + v + 2 * q), x2_im = _mm256_loadu_ps(x_im + v + 2 * q);
+                    complex_multiply_avx2(_mm256_loadu_ps(x_re + v + 3 * q), _mm256_loadu_ps(x_im + v + 3 * q),
+                                          w1_re, w1_im, t_re, t_im);
+                    __m256 a2_re = _mm256_add_ps(x2_re, t_re), a2_im = _mm256_add_ps(x2_im, t_im);
+                    __m256 a3_re = _mm256_sub_ps(x2_re, t_re), a3_im = _mm256_sub_ps(x2_im, t_im);
+                    
+                    complex_multiply_avx2(a2_re, a2_im, w2_re, w2_im, t_re, t_im);
+                    _mm256_storeu_ps(x_re + v, _mm256_add_ps(a0_re, t_re));
+                    _mm256_storeu_ps(x_im + v, _mm256_add_ps(a0_im, t_im));
+                    _mm256_storeu_ps(x_re + v + 2 * q, _mm256_sub_ps(a0_re, t_re));
+                    _mm256_storeu_ps(x_im + v + 2 * q, _mm256_sub_ps(a0_im, t_im));
+                    complex_multiply_avx2(a3_re, a3_im, w3_re, w3_im, t_re, t_im);
+                    _mm256_storeu_ps(x_re + v + q, _mm256_add_ps(a1_re, t_re));
+                    _mm256_storeu_ps(x_im + v + q, _mm256_add_ps(a1_im, t_im));
+                    _mm256_storeu_ps(x_re + v + 3 * q, _mm256_sub_ps(a1_re, t_re));
+                    _mm256_storeu_ps(x_im + v + 3 * q, _mm256_sub_ps(a1_im, t_im));
+                }
+            }
+        }
+    }
+    fused_butterfly_lanes_sse2_range(re, im, twiddles, twiddle_step, quarter_length, row_count, vector_end,
+                                     lanes, inverse);
+}
+
+AUTOTUNE_TARGET_AVX2 void int16_to_float_avx2(const int16_t* input, Sample* output, uint32_t count) {
+    __m256 g = _mm256_set1_ps(1.0f / kInt16Scale);
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i pcm = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+        _mm256_storeu_ps(output + i, _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(pcm)), g));
+    }
+    scalar::int16_to_float(input + i, output + i, count - i);
+}
+
+AUTOTUNE_TARGET_AVX2 void float_to_int16_avx2(const Sample* input, int16_t* output, uint32_t count) {
+    __m256 g = _mm256_set1_ps(kInt16Scale);
+    __m256 low = _mm256_set1_ps(-kInt16Scale);
+    __m256 high = _mm256_set1_ps(kInt16Scale - 1.0f);
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(input + i), g), low), high);
+        __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(_mm256_loadu_ps(input + i + 8), g), low), high);
+        // packs works per 128-bit lane; restore sample order afterwards
+        __m256i pcm = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+        pcm = _mm256_permute4x64_epi64(pcm, 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), pcm);
+    }
+    scalar::float_to_int16(input + i, output + i, count - i);
+}
+
+bool cpu_supports_avx2() {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+    __cpuid(info, 1);
+    bool os_saves_ymm = (info[2] & (1 << 27)) && ((_xgetbv(0) & 0x6) == 0x6);
+    __cpuidex(info, 7, 0);
+    return os_saves_ymm && (info[1] & (1 << 5));
+#else
+    return false;
+#endif
+}
+
+#endif // AUTOTUNE_SIMD_X86
+
+#if defined(AUTOTUNE_SIMD_NEON)
+
+void multiply_neon(const Sample* a, const Sample* b, Sample* output, uint32_t count) {
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(output + i, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+    }
+    scalar::multiply(a + i, b + i, output + i, count - i);
+}
+
+void mix_neon(const Sample* a, const Sample* b, Sample* output, float gain, uint32_t count) {
+    float32x4_t g = vdupq_n_f32(gain);
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t sum = vaddq_f32(vld1q_f32(a + i), vld1q_f32(b + i));
+        vst1q_f32(output + i, vmulq_f32(sum, g));
+    }
+    scalar::mix(a + i, b + i, output + i, gain, count - i);
+}
+
+void scale_neon(const Sample* input, float gain, Sample* output, uint32_t count) {
+    float32x4_t g = vdupq_n_f32(gain);
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        vst1q_f32(output + i, vmulq_f32(vld1q_f32(input + i), g));
+    }
+    scalar::scale(input + i, gain, output + i, count - i);
+}
+
+float dot_neon(const Sample* a, const Sample* b, uint32_t count) {
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+    }
+    float32x4_t acc = vaddq_f32(acc0, acc1);
+    float sum = vgetq_lane_f32(acc, 0) + vgetq_lane_f32(acc, 1) +
+                vgetq_lane_f32(acc, 2) + vgetq_lane_f32(acc, 3);
+    return sum + scalar::dot(a + i, b + i, count - i);
+}
+
+void scale_lanes_neon(const Sample* input, const float* gains, Sample* output, uint32_t lanes, uint32_t count) {
+    uint32_t vector_end = lanes & ~3u;
+    for (uint32_t i = 0; i < count; ++i) {
+        size_t frame = static_cast<size_t>(i) * lanes;
+        for (uint32_t v = 0; v < vector_end; v += 4) {
+            vst1q_f32(output + frame + v, vmulq_n_f32(vld1q_f32(input + frame + v), gains[i]));
+        }
+    }
+    scale_lane_range(input, gains, output, vector_end, lanes, count);
+}
+
+void dot_lanes_neon(const Sample* a, const Sample* b, float* output, uint32_t lanes, uint32_t count) {
+    uint32_t vector_end = lanes & ~3u;
+    for (uint32_t v = 0; v < vector_end; v += 4) {
+        float32x4_t acc0 = vdupq_n_f32(0.0f);
+        float32x4_t acc1 = vdupq_n_f32(0.0f);
+        uint32_t i = 0;
+        for (; i + 2 <= count; i += 2) {
+            size_t frame = static_cast<size_t>(i) * lanes + v;
+            acc0 = vmlaq_f32(acc0, vld1q_f32(a + frame), vld1q_f32(b + frame));
+            acc1 = vmlaq_f32(acc1, vld1q_f32(a + frame + lanes), vld1q_f32(b + frame + lanes));
+        }
+        if (i < count) {
+            size_t frame = static_cast<size_t>(i) * lanes + v;
+            acc0 = vmlaq_f32(acc0, vld1q_f32(a + frame), vld1q_f32(b + frame));
+        }
+        vst1q_f32(output + v, vaddq_f32(acc0, acc1));
+    }
+    dot_lane_range(a, b, output, vector_end, lanes, count);
+}
+
+void butterfly_lanes_neon(Sample* re, Sample* im, const float* twiddles, uint32_t twiddle_step,
+                          uint32_t half_length, uint32_t row_count, uint32_t lanes, bool inverse) {
+    uint32_t vector_end = lanes & ~3u;
+    if (vector_end > 0) {
+        float sign = inverse ? -1.0f : 1.0f;
+        size_t distance = static_cast<size_t>(half_length) * lanes;
+        for (uint32_t group = 0; group < row_count; group += 2 * half_length) {
+            for (uint32_t j = 0; j < half_length; ++j) {
+                float w_re = twiddles[2 * j * twiddle_step];
+                float w_im = sign * twiddles[2 * j * twiddle_step + 1];
+                Sample* a_re = re + static_cast<size_t>(group + j) * lanes;
+                Sample* a_im = im + static_cast<size_t>(group + j) * lanes;
+                for (uint32_t v = 0; v < vector_end; v += 4) {
+                    float32x4_t b_re = vld1q_f32(a_re + v + distance);
+                    float32x4_t b_im = vld1q_f32(a_im + v + distance);
+                    float32x4_t t_re = vsubq_f32(vmulq_n_f32(b_re, w_re), vmulq_n_f32(b_im, w_im));
+                    float32x4_t t_im = vaddq_f32(vmulq_n_f32(b_re, w_im), vmulq_n_f32(b_im, w_re));
+                    float32x4_t x_re = vld1q_f32(a_re + v);
+                    float32x4_t x_im = vld1q_f32(a_im + v);
+                    vst1q_f32(a_re + v + distance, vsubq_f32(x_re, t_re));
+                    vst1q_f32(a_im + v + distance, vsubq_f32(x_im, t_im));
+                    vst1q_f32(a_re + v, vaddq_f32(x_re, t_re));
+                    vst1q_f32(a_im + v, vaddq_f32(x_im, t_im));
+                }
+            }
+        }
+    }
+    butterfly_lane_range(re, im, twiddles, twiddle_step, half_length, row_count, vector_end, lanes, inverse);
+}
+
+// (a_re + i a_im) * (w_re + i w_im)
+inline void complex_multiply_neon(float32x4_t a_re, float32x4_t a_im, float w_re, float w_im,
+                                  float32x4_t& out_re, float32x4_t& out_im) {
+    out_re = vsubq_f32(vmulq_n_f32(a_re, w_re), vmulq_n_f32(a_im, w_im));
+    out_im = vaddq_f32(vmulq_n_f32(a_re, w_im), vmulq_n_f32(a_im, w_re));
+}
+
+void fused_butterfly_lanes_neon(Sample* re, Sample* im, const float* twiddles, uint32_t twiddle_step,
+                                uint32_t quarter_length, uint32_t row_count, uint32_t lanes, bool inverse) {
+    uint32_t vector_end = lanes & ~3u;
+    if (vector_end > 0) {
+        float sign = inverse ? -1.0f : 1.0f;
+        size_t q = static_cast<size_t>(quarter_length) * lanes;
+        for (uint32_t group = 0; group < row_count; group += 4 * quarter_length) {
+            for (uint32_t j = 0; j < quarter_length; ++j) {
+                const float* w1 = twiddles + 4 * j * twiddle_step;
+                const float* w2 = twiddles + 2 * j * twiddle_step;
+                const float* w3 = twiddles + 2 * (j + quarter_length) * twiddle_step;
+                Sample* x_re = re + static_cast<size_t>(group + j) * lanes;
+                Sample* x_im = im + static_cast<size_t>(group + j) * lanes;
+                for (uint32_t v = 0; v < vector_end; v += 4) {
+                    float32x4_t t_re, t_im;
+                    float32x4_t x0_re = vld1q_f32(x_re + v), x0_im = vld1q_f32(x_im + v);
+                    complex_multiply_neon(vld1q_f32(x_re + v + q), vld1q_f32(x_im + v + q),
+                                          w1[0], sign * w1[1], t_re, t_im);
+                    float32x4_t a0_re = vaddq_f32(x0_re, t_re), a0_im = vaddq_f32(x0_im, t_im);
+                    float32x4_t a1_re = vsubq_f32(x0_re, t_re), a1_im = vsubq_f32(x0_im, t_im);
+                    float32x4_t x2_re = vld1q_f32(x_re + v + 2 * q), x2_im = vld1q_f32(x_im + v + 2 * q);
+                    complex_multiply_neon(vld1q_f32(x_re + v + 3 * q), vld1q_f32(x_im + v + 3 * q),
+                                          w1[0], sign * w1[1], t_re, t_im);
+                    float32x4_t a2_re = vaddq_f32(x2_re, t_re), a2_im = vaddq_f32(x2_im, t_im);
+                    float32x4_t a3_re = vsubq_f32(x2_re, t_re), a3_im = vsubq_f32(x2_im, t_im);
+                    
+                    complex_multiply_neon(a2_re, a2_im, w2[0], sign * w2[1], t_re, t_im);
+                    vst1q_f32(x_re + v, vaddq_f32(a0_re, t_re));
+                    vst1q_f32(x_im + v, vaddq_f32(a0_im, t_im));
+                    vst1q_f32(x_re + v + 2 * q, vsubq_f32(a0_re, t_re));
+                    vst1q_f32(x_im + v + 2 * q, vsubq_f32(a0_im, t_im));
+                    complex_multiply_neon(a3_re, a3_im, w3[0], sign * w3[1], t_re, t_im);
+                    vst1q_f32(x_re + v + q, vaddq_f32(a1_re, t_re));
+                    vst1q_f32(x_im + v + q, vaddq_f32(a1_im, t_im));
+                    vst1q_f32(x_re + v + 3 * q, vsubq_f32(a1_re, t_re));
+                    vst1q_f32(x_im + v + 3 * q, vsubq_f32(a1_im, t_im));
+                }
+            }
+        }
+    }
+    fused_butterfly_lane_range(re, im, twiddles, twiddle_step, quarter_length, row_count, vector_end, lanes, inverse);
+}
+
+void int16_to_float_neon(const int16_t* input, Sample* output, uint32_t count) {
+    float32x4_t g = vdupq_n_f32(1.0f / kInt16Scale);
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t pcm = vld1q_s16(input + i);
+        vst1q_f32(output + i, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(pcm))), g));
+        vst1q_f32(output + i + 4, vmulq_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(pcm))), g));
+    }
+    scalar::int16_to_float(input + i, output + i, count - i);
+}
+
+#endif // AUTOTUNE_SIMD_NEON
+
+const KernelTable kScalarKernels = {
+    InstructionSet::SCALAR, scalar::multiply, scalar::mix, scalar::scale, scalar::dot,
+    scalar::scale_lanes, scalar::dot_lanes, scalar::butterfly_lanes, scalar::fused_butterfly_lanes,
+    scalar::int16_to_float, scalar::float_to_int16
+};
+
+#if defined(AUTOTUNE_SIMD_X86)
+const KernelTable kSse2Kernels = {
+    InstructionSet::SSE2, multiply_sse2, mix_sse2, scale_sse2, dot_sse2,
+    scale_lanes_sse2, dot_lanes_sse2, butterfly_lanes_sse2, fused_butterfly_lanes_sse2,
+    int16_to_float_sse2, float_to_int16_sse2
+};
+const KernelTable kAvx2Kernels = {
+    InstructionSet::AVX2, multiply_avx2, mix_avx2, scale_avx2, dot_avx2,
+    scale_lanes_avx2, dot_lanes_avx2, butterfly_lanes_avx2, fused_butterfly_lanes_avx2,
+    int16_to_float_avx2, float_to_int16_avx2
+};
+#endif
+
+#if defined(AUTOTUNE_SIMD_NEON)
+const KernelTable kNeonKernels = {
+    InstructionSet::NEON, multiply_neon, mix_neon, scale_neon, dot_neon,
+    scale_lanes_neon, dot_lanes_neon, butterfly_lanes_neon, fused_butterfly_lanes_neon,
+    // vcvtq_s32_f32 truncates; the scalar loop keeps rounding identical
+    int16_to_float_neon, scalar::float_to_int16
+};
+#endif
+
+const KernelTable* table_for(InstructionSet instruction_set) {
+    switch (instruction_set) {
+#if defined(AUTOTUNE_SIMD_X86)
+        case InstructionSet::SSE2: return &kSse2Kernels;
+        case InstructionSet::AVX2: return cpu_supports_avx2() ? &kAvx2Kernels : nullptr;
+#endif
+#if defined(AUTOTUNE_SIMD_NEON)
+        case InstructionSet::NEON: return &kNeonKernels;
+#endif
+        case InstructionSet::SCALAR: return &kScalarKernels;
+        default: return nullptr;
+    }
+}
+
+const KernelTable* best_table() {
+    const InstructionSet preference[] = {
+        InstructionSet::AVX2, InstructionSet::NEON, InstructionSet::SSE2, InstructionSet::SCALAR
+    };
+    for (InstructionSet instruction_set : preference) {
+        if (const KernelTable* table = table_for(instruction_set)) {
+            return table;
+        }
+    }
+    return &kScalarKernels;
+}
+
+std::atomic<const KernelTable*>& active_table() {
+    static std::atomic<const KernelTable*> table(best_table());
+    return table;
+}
+
+inline const KernelTable& kernels() {
+    return *active_table().load(std::memory_order_relaxed);
+}
+
+} // namespace
+
+InstructionSet active_instruction_set() {
+    return kernels().instruction_set;
+}
+
+bool set_instruction_set(InstructionSet instruction_set) {
+    const KernelTable* table = table_for(instruction_set);
+    if (!table) {
+        return false;
+    }
+    active_table().store(table, std::memory_order_relaxed);
+    return true;
+}
+
+bool is_supported(InstructionSet instruction_set) {
+    return table_for(instruction_set) != nullptr;
+}
+
+const char* instruction_set_name(InstructionSet instruction_set) {
+    switch (instruction_set) {
+        case InstructionSet::SCALAR: return "scalar";
+        case InstructionSet::SSE2: return "SSE2";
+        case InstructionSet::AVX2: return "AVX2";
+        case InstructionSet::NEON: return "NEON";
+        default: return "unknown";
+    }
+}
+
+void multiply(const Sample* a, const Sample* b, Sample* output, uint32_t count) {
+    kernels().multiply(a, b, output, count);
+}
+
+void mix(const Sample* a, const Sample* b, Sample* output, float gain, uint32_t count) {
+    kernels().mix(a, b, output, gain, count);
+}
+
+void downmix(const Sample* const* channels, ChannelCount channel_count, Sample* output, uint32_t count) {
+    if (channel_count == 0) {
+        std::memset(output, 0, count * sizeof(Sample));
+        return;
+    }
+    if (channel_count == 1) {
+        if (output != channels[0]) {
+            std::memcpy(output, channels[0], count * sizeof(Sample));
+        }
+        return;
+    }
+    
+    const KernelTable& table = kernels();
+    float gain = 1.0f / static_cast<float>(channel_count);
+    if (channel_count == 2) {
+        table.mix(channels[0], channels[1], output, gain, count);
+        return;
+    }
+    
+    table.mix(channels[0], channels[1], output, 1.0f, count);
+    for (ChannelCount ch = 2; ch < channel_count; ++ch) {
+        table.mix(output, channels[ch], output, 1.0f, count);
+    }
+    table.scale(output, gain, output, count);
+}
+
+void scale(const Sample* input, float gain, Sample* output, uint32_t count) {
+    kernels().scale(input, gain, output, count);
+}
+
+float dot(const Sample* a, const Sample* b, uint32_t count) {
+    return kernels().dot(a, b, count);
+}
+
+void scale_lanes(const Sample* input, const float* gains, Sample* output, uint32_t lanes, uint32_t count) {
+    kernels().scale_lanes(input, gains, output, lanes, count);
+}
+
+void dot_lanes(const Sample* a, const Sample* b, float* output, uint32_t lanes, uint32_t count) {
+    kernels().dot_lanes(a, b, output, lanes, count);
+}
+
+void butterfly_lanes(Sample* re, Sample* im, const float* twiddles, uint32_t twiddle_step,
+                     uint32_t half_length, uint32_t row_count, uint32_t lanes, bool inverse) {
+    kernels().butterfly_lanes(re, im, twiddles, twiddle_step, half_length, row_count, lanes, inverse);
+}
+
+void fused_butterfly_lanes(Sample* re, Sample* im, const float* twiddles, uint32_t twiddle_step,
+                           uint32_t quarter_length, uint32_t row_count, uint32_t lanes, bool inverse) {
+    kernels().fused_butterfly_lanes(re, im, twiddles, twiddle_step, quarter_length, row_count, lanes, inverse);
+}
+
+void int16_to_float(const int16_t* input, Sample* output, uint32_t count) {
+    kernels().int16_to_float(input, output, count);
+}
+
+void float_to_int16(const Sample* input, int16_t* output, uint32_t count) {
+    kernels().float_to_int16(input, output, count);
+}
+
+// Packed 24-bit samples have no natural vector width without byte shuffles
+// (SSSE3+); these loops are kept simple enough for the compiler to vectorize
+void int24_to_float(const uint8_t* input, Sample* output, uint32_t count) {
+    const float g = 1.0f / kInt24Scale;
+    for (uint32_t i = 0; i < count; ++i) {
+        const uint8_t* bytes = input + 3 * i;
+        uint32_t value = static_cast<uint32_t>(bytes[0]) << 8 | static_cast<uint32_t>(bytes[1]) << 16 |
+                         static_cast<uint32_t>(bytes[2]) << 24;
+        output[i] = static_cast<float>(static_cast<int32_t>(value) >> 8) * g;
+    }
+}
+
+void float_to_int24(const Sample* input, uint8_t* output, uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i) {
+        float value = std::min(std::max(input[i] * kInt24Scale, -kInt24Scale), kInt24Scale - 1.0f);
+        uint32_t pcm = static_cast<uint32_t>(static_cast<int32_t>(std::lrint(value)));
+        output[3 * i] = static_cast<uint8_t>(pcm);
+        output[3 * i + 1] = static_cast<uint8_t>(pcm >> 8);
+        output[3 * i + 2] = static_cast<uint8_t>(pcm >> 16);
+    }
+}
+
+namespace scalar {
+
+void multiply(const Sample* a, const Sample* b, Sample* output, uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i) {
+        output[i] = a[i] * b[i];
+    }
+}
+
+void mix(const Sample* a, const Sample* b, Sample* output, float gain, uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i) {
+        output[i] = (a[i] + b[i]) * gain;
+    }
+}
+
+void scale(const Sample* input, float gain, Sample* output, uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i) {
+        output[i] = input[i] * gain;
+    }
+}
+
+float dot(const Sample* a, const Sample* b, uint32_t count) {
+    float sum = 0.0f;
+    for (uint32_t i = 0; i < count; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+void scale_lanes(const Sample* input, const float* gains, Sample* output, uint32_t lanes, uint32_t count) {
+    scale_lane_range(input, gains, output, 0, lanes, count);
+}
+
+void dot_lanes(const Sample* a, const Sample* b, float* output, uint32_t lanes, uint32_t count) {
+    dot_lane_range(a, b, output, 0, lanes, count);
+}
+
+void butterfly_lanes(Sample* re, Sample* im, const float* twiddles, uint32_t twiddle_step,
+                     uint32_t half_length, uint32_t row_count, uint32_t lanes, bool inverse) {
+    butterfly_lane_range(re, im, twiddles, twiddle_step, half_length, row_count, 0, lanes, inverse);
+}
+
+void fused_butterfly_lanes(Sample* re, Sample* im, const float* twiddles, uint32_t twiddle_step,
+                           uint32_t quarter_length, uint32_t row_count, uint32_t lanes, bool inverse) {
+    fused_butterfly_lane_range(re, im, twiddles, twiddle_step, quarter_length, row_count, 0, lanes, inverse);
+}
+
+void int16_to_float(const int16_t* input, Sample* output, uint32_t count) {
+    const float g = 1.0f / kInt16Scale;
+    for (uint32_t i = 0; i < count; ++i) {
+        output[i] = static_cast<float>(input[i]) * g;
+    }
+}
+
+void float_to_int16(const Sample* input, int16_t* output, uint32_t count) {
+    for (uint32_t i = 0; i < count; ++i) {
+        float value = std::min(std::max(input[i] * kInt16Scale, -kInt16Scale), kInt16Scale - 1.0f);
+        output[i] = static_cast<int16_t>(std::lrint(value));
+    }
+}
+
+} // namespace scalar
+
+} // namespace simd
+} // namespace autotune
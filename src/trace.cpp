@@ -0,0 +1,231 @@
+#include "trace.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+
+namespace autotune {
+namespace trace {
+
+namespace {
+
+/**
+ * @brief Zone ring of one thread
+ *
+ * Slots are atomics so a reader racing the writer sees stale or new
+ * fields, never torn ones; head tells which of them to trust.
+ */
+struct ThreadRing {
+    struct Slot {
+        std::atomic<const char*> name{nullptr};
+        std::atomic<uint64_t> start_ns{0};
+        std::atomic<uint64_t> duration_ns{0};
+        std::atomic<int32_t> voice{kNoVoice};
+    };
+
+    explicit ThreadRing(uint32_t index) : slots(new Slot[kRingCapacity]), thread(index) {}
+
+    std::unique_ptr<Slot[]> slots;
+    std::atomic<uint64_t> head{0};      // Zones written (owning thread only)
+    std::atomic<uint64_t> floor{0};     // Zones dropped by clear()
+    uint32_t thread;
+    std::string name;                   // Guarded by the registry mutex
+};
+
+/**
+ * @brief Every ring ever registered (rings outlive their threads)
+ */
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+};
+
+Registry& registry() {
+    static Registry instance;
+    return instance;
+}
+
+thread_local ThreadRing* current_ring = nullptr;
+
+ThreadRing& ring_for_this_thread() {
+    if (!current_ring) {
+        Registry& reg = registry();
+        std::lock_guard<std::mutex> lock(reg.mutex);
+        reg.rings.push_back(std::make_shared<ThreadRing>(static_cast<uint32_t>(reg.rings.size())));
+        current_ring = reg.rings.back().get();
+    }
+    return *current_ring;
+}
+
+std::vector<std::shared_ptr<ThreadRing>> registered_rings() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    return reg.rings;
+}
+
+/**
+ * @brief Append a JSON string literal
+ */
+void append_json_string(std::string& out, const char* text) {
+    out += '"';
+    for (const char* c = text; *c; ++c) {
+        unsigned char ch = static_cast<unsigned char>(*c);
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+            out += *c;
+        } else if (ch < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", ch);
+            out += escaped;
+        } else {
+            out += *c;
+        }
+    }
+    out += '"';
+}
+
+/**
+ * @brief Append nanoseconds as microseconds with three decimals
+ */
+void append_microseconds(std::string& out, uint64_t nanoseconds) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%llu.%03llu",
+                  static_cast<unsigned long long>(nanoseconds / 1000),
+                  static_cast<unsigned long long>(nanoseconds % 1000));
+    out += text;
+}
+
+} // anonymous namespace
+
+uint64_t now() {
+    using Clock = std::chrono::steady_clock;
+    static const Clock::time_point epoch = Clock::now();
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count());
+}
+
+void record(const char* name, uint64_t start_ns, uint64_t end_ns, int32_t voice) {
+    ThreadRing& ring = ring_for_this_thread();
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    
+    // Orders the slot stores after the publication of the zones they
+    // overwrite; pairs with the acquire fence in collect()
+    std::atomic_thread_fence(std::memory_order_release);
+    ThreadRing::Slot& slot = ring.slots[head % kRingCapacity];
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start_ns.store(start_ns, std::memory_order_relaxed);
+    slot.duration_ns.store(end_ns > start_ns ? end_ns - start_ns : 0, std::memory_order_relaxed);
+    slot.voice.store(voice, std::memory_order_relaxed);
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+void register_thread() {
+    ring_for_this_thread();
+}
+
+void set_thread_name(const char* name) {
+    ThreadRing& ring = ring_for_this_thread();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    ring.name = name ? name : "";
+}
+
+std::vector<Event> collect() {
+    std::vector<Event> events;
+    for (const std::shared_ptr<ThreadRing>& ring : registered_rings()) {
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        uint64_t first = std::max(ring->floor.load(std::memory_order_relaxed),
+                                  head > kRingCapacity ? head - kRingCapacity : 0);
+        size_t copied_from = events.size();
+        for (uint64_t i = first; i < head; ++i) {
+            const ThreadRing::Slot& slot = ring->slots[i % kRingCapacity];
+            events.push_back({slot.name.load(std::memory_order_relaxed),
+                              slot.start_ns.load(std::memory_order_relaxed),
+                              slot.duration_ns.load(std::memory_order_relaxed),
+                              ring->thread,
+                              slot.voice.load(std::memory_order_relaxed)});
+        }
+
+        // Drop slots the writer may have reused meanwhile, including the
+        // one it may be filling now
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t new_head = ring->head.load(std::memory_order_relaxed);
+        uint64_t valid_from = new_head + 1 > kRingCapacity ? new_head + 1 - kRingCapacity : 0;
+        if (valid_from > first) {
+            size_t stale = static_cast<size_t>(std::min(valid_from, head) - first);
+            events.erase(events.begin() + copied_from, events.begin() + copied_from + stale);
+        }
+    }
+
+    std::stable_sort(events.begin(), events.end(),
+                     [](const Event& a, const Event& b) { return a.start_ns < b.start_ns; });
+    return events;
+}
+
+std::vector<ThreadInfo> threads() {
+    Registry& reg = registry();
+    std::lock_guard<std::mutex> lock(reg.mutex);
+    std::vector<ThreadInfo> result;
+    result.reserve(reg.rings.size());
+    for (const std::shared_ptr<ThreadRing>& ring : reg.rings) {
+        result.push_back({ring->thread, ring->name});
+    }
+    return result;
+}
+
+void clear() {
+    for (const std::shared_ptr<ThreadRing>& ring : registered_rings()) {
+        ring->floor.store(ring->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+std::string export_chrome_json() {
+    std::vector<Event> events = collect();
+    std::string out = "{\"traceEvents\":[";
+    bool first = true;
+
+    for (const ThreadInfo& info : threads()) {
+        if (info.name.empty()) {
+            continue;
+        }
+        out += first ? "\n" : ",\n";
+        first = false;
+        out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(info.thread) +
+               ",\"args\":{\"name\":";
+        append_json_string(out, info.name.c_str());
+        out += "}}";
+    }
+
+    for (const Event& event : events) {
+        out += first ? "\n" : ",\n";
+        first = false;
+        out += "{\"name\":";
+        append_json_string(out, event.name ? event.name : "");
+        out += ",\"cat\":\"autotune\",\"ph\":\"X\",\"ts\":";
+        append_microseconds(out, event.start_ns);
+        out += ",\"dur\":";
+        append_microseconds(out, event.duration_ns);
+        out += ",\"pid\":1,\"tid\":" + std::to_string(event.thread);
+        if (event.voice != kNoVoice) {
+            out += ",\"args\":{\"voice\":" + std::to_string(event.voice) + "}";
+        }
+        out += "}";
+    }
+
+    out += "\n],\"displayTimeUnit\":\"ns\"}\n";
+    return out;
+}
+
+bool save_chrome_json(const std::string& path) {
+    std::string json = export_chrome_json();
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool written = std::fwrite(json.data(), 1, json.size(), file) == json.size();
+    return std::fclose(file) == 0 && written;
+}
+
+} // namespace trace
+} // namespace autotune
@@ -0,0 +1,110 @@
+#include "allocation_tracker.h"
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+namespace {
+
+thread_local bool tracking_active = false;
+thread_local std::size_t allocation_count = 0;
+
+void release_aligned(void* ptr) {
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+void* allocate(std::size_t size) {
+    AllocationTracker::record();
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* allocate_aligned(std::size_t size, std::align_val_t alignment) {
+    AllocationTracker::record();
+    std::size_t align = static_cast<std::size_t>(alignment);
+#ifdef _WIN32
+    void* ptr = _aligned_malloc(size == 0 ? 1 : size, align);
+#else
+    std::size_t rounded = (size + align - 1) / align * align;
+    void* ptr = std::aligned_alloc(align, rounded == 0 ? align : rounded);
+#endif
+    if (!ptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+} // namespace
+
+void AllocationTracker::start() {
+    allocation_count = 0;
+    tracking_active = true;
+}
+
+std::size_t AllocationTracker::stop() {
+    tracking_active = false;
+    return allocation_count;
+}
+
+void AllocationTracker::record() {
+    if (tracking_active) {
+        ++allocation_count;
+    }
+}
+
+// Global allocation hooks for the test executable
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) { return allocate_aligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment) { return allocate_aligned(size, alignment); }
+
+// Nothrow forms, so they are counted and freed by the matching allocator
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(size);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return allocate_aligned(size, alignment);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    try {
+        return allocate_aligned(size, alignment);
+    } catch (const std::bad_alloc&) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete[](void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { release_aligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { release_aligned(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { release_aligned(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { release_aligned(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { std::free(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { release_aligned(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { release_aligned(ptr); }
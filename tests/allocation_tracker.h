@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+
+/**
+ * @brief Counts heap allocations made by the current thread
+ *
+ * The test executable replaces the global operator new; while a tracker
+ * is active on a thread, every allocation on that thread is counted.
+ * Used to verify that the audio-thread hot path never allocates.
+ */
+class AllocationTracker {
+public:
+    /**
+     * @brief Start counting allocations on the calling thread
+     */
+    static void start();
+    
+    /**
+     * @brief Stop counting on the calling thread
+     * @return Number of allocations made since start()
+     */
+    static std::size_t stop();
+    
+    /**
+     * @brief Record one allocation (called from operator new)
+     */
+    static void record();
+};
+
+/**
+ * @brief RAII helper that tracks allocations for the lifetime of a scope
+ */
+class ScopedAllocationTracker {
+public:
+    ScopedAllocationTracker() { AllocationTracker::start(); }
+    ~ScopedAllocationTracker() { if (active_) AllocationTracker::stop(); }
+    
+    std::size_t stop() {
+        active_ = false;
+        return AllocationTracker::stop();
+    }
+
+private:
+    bool active_ = true;
+};
@@ -1,7 +1,9 @@
 #include "audio_buffer.h"
+#include "test_runner.h"
 #include <iostream>
-
-extern class TestRunner;
+#include <algorithm>
+#include <thread>
+#include <vector>
 
 void test_audio_buffer() {
     using namespace autotune;
@@ -112,4 +114,130 @@ void test_audio_buffer() {
         read = buffer.read(frames.data(), 0);
         TestRunner::run_test("AudioBuffer zero read count", read == 0);
     }
+    
+    // Test 6: Planar block write and read
+    {
+        AudioBuffer buffer(16, 2);
+        
+        std::vector<Sample> left(8), right(8);
+        for (size_t i = 0; i < left.size(); ++i) {
+            left[i] = static_cast<float>(i) * 0.1f;
+            right[i] = static_cast<float>(i) * -0.1f;
+        }
+        const Sample* input_channels[] = {left.data(), right.data()};
+        AudioBlockView input(input_channels, 2, 8);
+        
+        uint32_t written = buffer.write(input);
+        TestRunner::run_test("AudioBuffer block write", written == 8 && buffer.available() == 8);
+        
+        std::vector<Sample> out_left(8, 0.0f), out_right(8, 0.0f);
+        Sample* output_channels[] = {out_left.data(), out_right.data()};
+        AudioBlockView output(output_channels, 2, 8);
+        
+        uint32_t read = buffer.read(output);
+        TestRunner::run_test("AudioBuffer block read", read == 8 && buffer.empty());
+        TestRunner::run_test("AudioBuffer block data integrity", out_left == left && out_right == right);
+    }
+    
+    // Test 7: Wrap-around with non power-of-two capacity
+    {
+        AudioBuffer buffer(12, 1);
+        TestRunner::run_test("AudioBuffer full capacity usable", buffer.space() == 12);
+        
+        std::vector<Sample> chunk(5), result(5);
+        Sample* chunk_channels[] = {chunk.data()};
+        Sample* result_channels[] = {result.data()};
+        AudioBlockView input(chunk_channels, 1, 5);
+        AudioBlockView output(result_channels, 1, 5);
+        
+        bool wrap_ok = true;
+        float next_value = 0.0f;
+        float expected_value = 0.0f;
+        for (int round = 0; round < 20; ++round) {
+            for (auto& sample : chunk) sample = next_value++;
+            buffer.write(input);
+            
+            uint32_t read = buffer.read(output);
+            for (uint32_t i = 0; i < read; ++i) {
+                wrap_ok = wrap_ok && result[i] == expected_value++;
+            }
+        }
+        TestRunner::run_test("AudioBuffer wrap-around integrity", wrap_ok && buffer.empty());
+    }
+    
+    // Test 8: Zero-copy acquire/commit and peek/release
+    {
+        AudioBuffer buffer(8, 2);
+        
+        // Advance so the region wraps
+        std::vector<AudioFrame> frames(6, AudioFrame(2));
+        buffer.write(frames.data(), 6);
+        buffer.read(frames.data(), 6);
+        
+        AudioBuffer::Region region = buffer.acquire_write(5);
+        TestRunner::run_test("AudioBuffer acquire_write region size", region.frame_count() == 5);
+        TestRunner::run_test("AudioBuffer acquire_write wraps", region.second.frame_count > 0);
+        
+        float value = 1.0f;
+        for (const AudioBlockView* part : {&region.first, &region.second}) {
+            for (uint32_t i = 0; i < part->frame_count; ++i) {
+                (*part)(0, i) = value;
+                (*part)(1, i) = -value;
+                value += 1.0f;
+            }
+        }
+        TestRunner::run_test("AudioBuffer not visible before commit", buffer.empty());
+        buffer.commit_write(region.frame_count());
+        TestRunner::run_test("AudioBuffer visible after commit", buffer.available() == 5);
+        
+        AudioBuffer::Region readable = buffer.peek_read(16);
+        bool peek_ok = readable.frame_count() == 5;
+        value = 1.0f;
+        for (const AudioBlockView* part : {&readable.first, &readable.second}) {
+            for (uint32_t i = 0; i < part->frame_count; ++i) {
+                peek_ok = peek_ok && (*part)(0, i) == value && (*part)(1, i) == -value;
+                value += 1.0f;
+            }
+        }
+        TestRunner::run_test("AudioBuffer peek_read data", peek_ok);
+        
+        buffer.release_read(readable.frame_count());
+        TestRunner::run_test("AudioBuffer empty after release", buffer.empty());
+    }
+    
+    // Test 9: Concurrent producer and consumer
+    {
+        AudioBuffer buffer(256, 1);
+        const uint32_t total_frames = 200000;
+        
+        std::thread producer([&buffer, total_frames]() {
+            std::vector<Sample> chunk(37);
+            Sample* channels[] = {chunk.data()};
+            uint32_t sent = 0;
+            while (sent < total_frames) {
+                uint32_t count = std::min(static_cast<uint32_t>(chunk.size()), total_frames - sent);
+                for (uint32_t i = 0; i < count; ++i) {
+                    chunk[i] = static_cast<Sample>((sent + i) % 65536);
+                }
+                AudioBlockView block(channels, 1, count);
+                sent += buffer.write(block);
+            }
+        });
+        
+        std::vector<Sample> chunk(53);
+        Sample* channels[] = {chunk.data()};
+        AudioBlockView block(channels, 1, static_cast<uint32_t>(chunk.size()));
+        uint32_t received = 0;
+        bool ordered = true;
+        while (received < total_frames) {
+            uint32_t read = buffer.read(block);
+            for (uint32_t i = 0; i < read; ++i) {
+                ordered = ordered && chunk[i] == static_cast<Sample>((received + i) % 65536);
+            }
+            received += read;
+        }
+        producer.join();
+        
+        TestRunner::run_test("AudioBuffer concurrent SPSC ordering", ordered && buffer.empty());
+    }
 }
@@ -0,0 +1,126 @@
+#include "engine_pool.h"
+#include "test_runner.h"
+#include <cmath>
+#include <vector>
+
+namespace {
+
+// Planar test signal storage for one voice
+struct VoiceBuffers {
+    std::vector<autotune::Sample> in_left, in_right, out_left, out_right;
+    const autotune::Sample* input_channels[2];
+    autotune::Sample* output_channels[2];
+    
+    VoiceBuffers(uint32_t frames, float frequency, float sample_rate)
+        : in_left(frames), in_right(frames), out_left(frames, 0.0f), out_right(frames, 0.0f) {
+        for (uint32_t i = 0; i < frames; ++i) {
+            in_left[i] = in_right[i] = 0.5f * std::sin(2.0f * M_PI * frequency * i / sample_rate);
+        }
+        input_channels[0] = in_left.data();
+        input_channels[1] = in_right.data();
+        output_channels[0] = out_left.data();
+        output_channels[1] = out_right.data();
+    }
+};
+
+} // namespace
+
+void test_engine_pool() {
+    using namespace autotune;
+    
+    // Test 1: Construction
+    {
+        EnginePool pool(8, 44100, 512, 2, 3);
+        TestRunner::run_test("EnginePool construction",
+                           pool.voice_count() == 8 && pool.worker_count() == 3);
+        
+        EnginePool capped(2, 44100, 512, 2, 16);
+        TestRunner::run_test("EnginePool worker count capped by voices", capped.worker_count() == 2);
+    }
+    
+    // Test 2: Pool output matches standalone engines
+    {
+        const uint32_t voices = 6;
+        const uint32_t frames = 1024;
+        const SampleRate sample_rate = 2000;  // 0.5 s callback period leaves ample deadline slack
+        EnginePool pool(voices, sample_rate, frames, 2, 2);
+        
+        std::vector<VoiceBuffers> buffers;
+        std::vector<AudioBlockView> inputs, outputs;
+        buffers.reserve(voices);
+        for (uint32_t v = 0; v < voices; ++v) {
+            buffers.emplace_back(frames, 200.0f + 30.0f * v, static_cast<float>(sample_rate));
+        }
+        for (auto& voice : buffers) {
+            inputs.emplace_back(voice.input_channels, 2, frames);
+            outputs.emplace_back(voice.output_channels, 2, frames);
+        }
+        
+        bool all_met = true;
+        for (int callback = 0; callback < 5; ++callback) {
+            all_met = pool.process(inputs.data(), outputs.data()) && all_met;
+        }
+        TestRunner::run_test("EnginePool meets generous deadline", all_met && pool.get_missed_voices().empty());
+        
+        bool all_success = true;
+        for (uint32_t v = 0; v < voices; ++v) {
+            all_success = all_success && pool.get_result(v).success;
+        }
+        TestRunner::run_test("EnginePool voice results", all_success);
+        
+        // Same five callbacks through a standalone engine must give identical output
+        AutotuneEngine reference(sample_rate, frames, 2);
+        VoiceBuffers expected(frames, 200.0f + 30.0f * 3, static_cast<float>(sample_rate));
+        AudioBlockView expected_in(expected.input_channels, 2, frames);
+        AudioBlockView expected_out(expected.output_channels, 2, frames);
+        for (int callback = 0; callback < 5; ++callback) {
+            reference.process(expected_in, expected_out);
+        }
+        TestRunner::run_test("EnginePool output matches standalone engine",
+                           buffers[3].out_left == expected.out_left && buffers[3].out_right == expected.out_right);
+    }
+    
+    // Test 3: Deadline misses are reported
+    {
+        const uint32_t voices = 48;
+        const uint32_t frames = 512;
+        EnginePool pool(voices, 192000, frames, 2, 1);
+        pool.set_deadline_fraction(0.05f);  // ~133 us for 48 voices
+        
+        std::vector<VoiceBuffers> buffers;
+        std::vector<AudioBlockView> inputs, outputs;
+        buffers.reserve(voices);
+        for (uint32_t v = 0; v < voices; ++v) {
+            buffers.emplace_back(frames, 440.0f, 192000.0f);
+        }
+        for (auto& voice : buffers) {
+            inputs.emplace_back(voice.input_channels, 2, frames);
+            outputs.emplace_back(voice.output_channels, 2, frames);
+        }
+        
+        bool met = pool.process(inputs.data(), outputs.data());
+        const auto& missed = pool.get_missed_voices();
+        
+        uint64_t total_misses = 0;
+        for (uint32_t v = 0; v < voices; ++v) {
+            total_misses += pool.get_deadline_misses(v);
+        }
+        TestRunner::run_test("EnginePool reports missed deadline", !met && !missed.empty());
+        TestRunner::run_test("EnginePool miss counters", total_misses == missed.size());
+        
+        bool cancelled_dry = true;
+        for (uint32_t voice : missed) {
+            if (!pool.get_result(voice).success) {
+                cancelled_dry = cancelled_dry && buffers[voice].out_left == buffers[voice].in_left;
+            }
+        }
+        TestRunner::run_test("EnginePool cancelled voices pass through", cancelled_dry);
+        
+        pool.reset_statistics();
+        total_misses = 0;
+        for (uint32_t v = 0; v < voices; ++v) {
+            total_misses += pool.get_deadline_misses(v);
+        }
+        TestRunner::run_test("EnginePool reset statistics", total_misses == 0 && pool.get_missed_voices().empty());
+    }
+}
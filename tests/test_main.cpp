@@ -1,75 +1,20 @@
+#include "test_runner.h"
 #include <iostream>
 #include <string>
-#include <vector>
-
-// Simple test framework
-class TestRunner {
-public:
-    struct TestResult {
-        std::string name;
-        bool passed;
-        std::string message;
-    };
-    
-    static std::vector<TestResult> results;
-    
-    static void run_test(const std::string& name, bool condition, const std::string& message = "") {
-        results.push_back({name, condition, message});
-        if (condition) {
-            std::cout << "[PASS] " << name << std::endl;
-        } else {
-            std::cout << "[FAIL] " << name;
-            if (!message.empty()) {
-                std::cout << " - " << message;
-            }
-            std::cout << std::endl;
-        }
-    }
-    
-    static void print_summary() {
-        int passed = 0;
-        int total = static_cast<int>(results.size());
-        
-        for (const auto& result : results) {
-            if (result.passed) passed++;
-        }
-        
-        std::cout << "\n=== Test Summary ===" << std::endl;
-        std::cout << "Passed: " << passed << "/" << total << std::endl;
-        
-        if (passed == total) {
-            std::cout << "All tests passed! ✓" << std::endl;
-        } else {
-            std::cout << "Some tests failed! ✗" << std::endl;
-            
-            std::cout << "\nFailed tests:" << std::endl;
-            for (const auto& result : results) {
-                if (!result.passed) {
-                    std::cout << "  - " << result.name;
-                    if (!result.message.empty()) {
-                        std::cout << " (" << result.message << ")";
-                    }
-                    std::cout << std::endl;
-                }
-            }
-        }
-    }
-    
-    static bool all_passed() {
-        for (const auto& result : results) {
-            if (!result.passed) return false;
-        }
-        return true;
-    }
-};
-
-std::vector<TestRunner::TestResult> TestRunner::results;
 
 // Test function declarations
 void test_audio_buffer();
 void test_pitch_detector();
+void test_pitch_corrector();
 void test_quantizer();
 void test_autotune_engine();
+void test_realtime();
+void test_simd();
+void test_engine_pool();
+void test_performance_monitor();
+void test_audio_file();
+void test_pitch_track();
+void test_trace();
 
 int main(int argc, char* argv[]) {
     std::cout << "AutoTune Engine Test Suite" << std::endl;
@@ -92,6 +37,11 @@ int main(int argc, char* argv[]) {
             test_pitch_detector();
         }
         
+        if (test_name.empty() || test_name == "pitch_corrector") {
+            std::cout << "\nRunning PitchCorrector tests..." << std::endl;
+            test_pitch_corrector();
+        }
+        
         if (test_name.empty() || test_name == "quantizer") {
             std::cout << "\nRunning Quantizer tests..." << std::endl;
             test_quantizer();
@@ -102,6 +52,41 @@ int main(int argc, char* argv[]) {
             test_autotune_engine();
         }
         
+        if (test_name.empty() || test_name == "realtime") {
+            std::cout << "\nRunning real-time safety tests..." << std::endl;
+            test_realtime();
+        }
+        
+        if (test_name.empty() || test_name == "simd") {
+            std::cout << "\nRunning SIMD kernel tests..." << std::endl;
+            test_simd();
+        }
+        
+        if (test_name.empty() || test_name == "engine_pool") {
+            std::cout << "\nRunning EnginePool tests..." << std::endl;
+            test_engine_pool();
+        }
+        
+        if (test_name.empty() || test_name == "performance_monitor") {
+            std::cout << "\nRunning PerformanceMonitor tests..." << std::endl;
+            test_performance_monitor();
+        }
+        
+        if (test_name.empty() || test_name == "audio_file") {
+            std::cout << "\nRunning audio file I/O tests..." << std::endl;
+            test_audio_file();
+        }
+        
+        if (test_name.empty() || test_name == "pitch_track") {
+            std::cout << "\nRunning PitchTrack tests..." << std::endl;
+            test_pitch_track();
+        }
+        
+        if (test_name.empty() || test_name == "trace") {
+            std::cout << "\nRunning trace tests..." << std::endl;
+            test_trace();
+        }
+        
         TestRunner::print_summary();
         
         return TestRunner::all_passed() ? 0 : 1;
@@ -0,0 +1,125 @@
+#include "performance_monitor.h"
+#include "autotune_engine.h"
+#include "allocation_tracker.h"
+#include "test_runner.h"
+#include <atomic>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+void test_performance_monitor() {
+    using namespace autotune;
+    
+    // Test 1: Every duration lands in a bucket whose edge is within 6.25% above it
+    {
+        bool bounded = true;
+        uint32_t previous = 0;
+        for (uint64_t ns = 1; ns < (uint64_t(1) << 34); ns = ns * 17 / 16 + 1) {
+            uint32_t bucket = PerformanceMonitor::bucket_index(ns);
+            uint64_t edge = PerformanceMonitor::bucket_upper_edge(bucket);
+            bounded = bounded && bucket < PerformanceMonitor::kBucketCount && bucket >= previous &&
+                      edge > ns && edge <= ns + ns / 16 + 1 &&
+                      (bucket == 0 || PerformanceMonitor::bucket_upper_edge(bucket - 1) <= ns);
+            previous = bucket;
+        }
+        TestRunner::run_test("Histogram buckets are ordered and tight", bounded);
+    }
+    
+    // Test 2: Percentiles, maximum and deadline misses
+    {
+        const SampleRate sample_rate = 48000;
+        PerformanceMonitor monitor(sample_rate);
+        
+        // 480 frames give a 10 ms deadline; 1..1000 us plus ten slow callbacks
+        for (uint64_t us = 1; us <= 1000; ++us) {
+            monitor.add_stage_time(PerformanceMonitor::Stage::CORRECT, us * 500);
+            if (us % 4 == 0) {
+                monitor.mark_skipped();
+            }
+            monitor.record_callback(us * 1000, 480);
+        }
+        for (int i = 0; i < 10; ++i) {
+            monitor.record_callback(12000000, 480);
+        }
+        
+        PerformanceMonitor::Snapshot snapshot = monitor.snapshot();
+        TestRunner::run_test("Monitor counts callbacks and frames",
+                             snapshot.callbacks == 1010 && snapshot.frames_processed == 1010 * 480);
+        TestRunner::run_test("Monitor p50 within bucket precision",
+                             snapshot.p50_ms >= 0.505 && snapshot.p50_ms <= 0.505 * 1.0625);
+        TestRunner::run_test("Monitor p99 within bucket precision",
+                             snapshot.p99_ms >= 0.9999 && snapshot.p99_ms <= 1.0625);
+        TestRunner::run_test("Monitor p99.9 and max see the slow callbacks",
+                             std::abs(snapshot.p999_ms - 12.0) < 1e-9 && std::abs(snapshot.max_ms - 12.0) < 1e-9);
+        TestRunner::run_test("Monitor counts deadline misses against the callback period",
+                             snapshot.deadline_misses == 10);
+        TestRunner::run_test("Monitor stage means are per callback",
+                             std::abs(snapshot.stage_mean_ms[2] - 0.25025 * 1000 / 1010) < 1e-6 &&
+                             std::abs(snapshot.stage_max_ms[2] - 0.5) < 1e-9);
+        TestRunner::run_test("Monitor counts skipped callbacks",
+                             snapshot.skipped_callbacks == 250 &&
+                             std::abs(snapshot.skipped_ratio - 250.0 / 1010.0) < 1e-12);
+        
+        monitor.reset();
+        TestRunner::run_test("Monitor reset clears statistics", monitor.snapshot().callbacks == 0);
+    }
+    
+    // Test 3: Recording is allocation-free and polling never disturbs it
+    {
+        PerformanceMonitor monitor(44100);
+        std::atomic<bool> done(false);
+        std::atomic<bool> monotonic(true);
+        std::thread reader([&]() {
+            uint64_t last = 0;
+            while (!done) {
+                PerformanceMonitor::Snapshot snapshot = monitor.snapshot();
+                if (snapshot.callbacks < last || snapshot.max_ms < snapshot.p50_ms) {
+                    monotonic = false;
+                }
+                last = snapshot.callbacks;
+            }
+        });
+        
+        ScopedAllocationTracker tracker;
+        for (uint64_t i = 0; i < 200000; ++i) {
+            monitor.add_stage_time(PerformanceMonitor::Stage::DETECT, i % 997);
+            monitor.record_callback(1000 + i % 5000, 64);
+        }
+        std::size_t allocations = tracker.stop();
+        done = true;
+        reader.join();
+        
+        TestRunner::run_test("Recording callbacks is allocation-free", allocations == 0);
+        TestRunner::run_test("Concurrent snapshots stay consistent",
+                             monotonic && monitor.snapshot().callbacks == 200000);
+    }
+    
+    // Test 4: Engine reports real frame counts and stage timings
+    {
+        AutotuneEngine engine(44100, 512, 1);
+        std::vector<Sample> input(300), output(300);
+        for (size_t i = 0; i < input.size(); ++i) {
+            input[i] = 0.5f * std::sin(2.0f * M_PI * 220.0f * i / 44100.0f);
+        }
+        const Sample* input_channels[] = {input.data()};
+        Sample* output_channels[] = {output.data()};
+        AudioBlockView input_view(input_channels, 1, 300);
+        AudioBlockView output_view(output_channels, 1, 300);
+        for (int i = 0; i < 20; ++i) {
+            engine.process(input_view, output_view);
+        }
+        
+        auto metrics = engine.get_performance_metrics();
+        TestRunner::run_test("Engine counts the frames actually processed",
+                             metrics.frames_processed == 20 * 300 && metrics.callbacks == 20);
+        TestRunner::run_test("Engine reports stage timings",
+                             metrics.detect_ms > 0.0f && metrics.correct_ms > 0.0f &&
+                             metrics.detect_ms + metrics.quantize_ms + metrics.correct_ms <=
+                             metrics.average_latency_ms * 1.001f);
+        TestRunner::run_test("Engine latency percentiles are ordered",
+                             metrics.p50_latency_ms <= metrics.p99_latency_ms &&
+                             metrics.p99_latency_ms <= metrics.p999_latency_ms &&
+                             metrics.p999_latency_ms <= metrics.max_latency_ms &&
+                             metrics.buffer_underruns == metrics.deadline_misses);
+    }
+}
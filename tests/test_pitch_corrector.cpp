@@ -0,0 +1,391 @@
+#include "fft.h"
+#include "pitch_corrector.h"
+#include "pitch_detector.h"
+#include "test_runner.h"
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::vector<autotune::Sample> make_sine(size_t count, float frequency, float sample_rate) {
+    std::vector<autotune::Sample> samples(count);
+    for (size_t i = 0; i < count; ++i) {
+        samples[i] = 0.5f * std::sin(2.0f * M_PI * frequency * i / sample_rate);
+    }
+    return samples;
+}
+
+// Streams a mono signal through the corrector in fixed-size calls
+std::vector<autotune::Sample> correct_in_blocks(autotune::PitchCorrector& corrector,
+                                                const std::vector<autotune::Sample>& input,
+                                                uint32_t block, float input_pitch, float target_pitch) {
+    std::vector<autotune::Sample> output(input.size(), 0.0f);
+    for (size_t offset = 0; offset < input.size(); offset += block) {
+        uint32_t count = static_cast<uint32_t>(std::min<size_t>(block, input.size() - offset));
+        corrector.correct_pitch(input.data() + offset, output.data() + offset, count, input_pitch, target_pitch);
+    }
+    return output;
+}
+
+// Magnitude-weighted mean frequency of a Hann-windowed segment
+// Phase of a sinusoid at the given frequency (correlation against a complex exponential)
+float phase_at(const autotune::Sample* samples, uint32_t count, float frequency, float sample_rate) {
+    double re = 0.0, im = 0.0;
+    for (uint32_t i = 0; i < count; ++i) {
+        double angle = 2.0 * M_PI * frequency * i / sample_rate;
+        re += samples[i] * std::cos(angle);
+        im -= samples[i] * std::sin(angle);
+    }
+    return static_cast<float>(std::atan2(im, re));
+}
+
+float spectral_centroid(const autotune::Sample* samples, uint32_t count, float sample_rate) {
+    autotune::FFT fft(count);
+    std::vector<autotune::Sample> windowed(fft.size(), 0.0f);
+    for (uint32_t i = 0; i < count; ++i) {
+        windowed[i] = samples[i] * 0.5f * (1.0f - std::cos(2.0f * M_PI * i / count));
+    }
+    std::vector<autotune::FFT::Complex> spectrum(fft.bin_count());
+    fft.forward(windowed.data(), spectrum.data());
+    
+    double weighted = 0.0, total = 0.0;
+    for (uint32_t k = 0; k < fft.bin_count(); ++k) {
+        double magnitude = std::abs(spectrum[k]);
+        weighted += magnitude * k * sample_rate / fft.size();
+        total += magnitude;
+    }
+    return total > 0.0 ? static_cast<float>(weighted / total) : 0.0f;
+}
+
+} // namespace
+
+void test_pitch_corrector() {
+    using namespace autotune;
+    
+    // Test 1: Latency is bounded and reported
+    {
+        PitchCorrector corrector(44100, 512);
+        std::vector<Sample> input(512, 0.0f), output(512);
+        ProcessingResult result = corrector.correct_pitch(input.data(), output.data(), 512, 220.0f, 240.0f);
+        
+        TestRunner::run_test("PitchCorrector reports latency",
+                           result.success && result.latency_samples == corrector.get_latency_samples());
+        TestRunner::run_test("PitchCorrector latency bounded",
+                           corrector.get_latency_samples() > 0 && corrector.get_latency_samples() < 0.04f * 44100,
+                           "Latency: " + std::to_string(corrector.get_latency_samples()) + " samples");
+        
+        ProcessingResult unvoiced = corrector.correct_pitch(input.data(), output.data(), 512, 0.0f, 0.0f);
+        TestRunner::run_test("PitchCorrector latency unchanged when unvoiced",
+                           unvoiced.latency_samples == result.latency_samples);
+    }
+    
+    // Test 2: Unity ratio reproduces the input delayed by exactly the reported latency
+    {
+        const size_t frames = 16384;
+        PitchCorrector corrector(44100, 512);
+        std::vector<Sample> input = make_sine(frames, 220.0f, 44100.0f);
+        for (size_t i = 0; i < frames; ++i) {
+            input[i] += 0.2f * std::sin(2.0f * M_PI * 1375.0f * i / 44100.0f);
+        }
+        std::vector<Sample> output = correct_in_blocks(corrector, input, 300, 220.0f, 220.0f);
+        
+        // Skip the first grains, which overlap the silent history
+        uint32_t latency = corrector.get_latency_samples();
+        float max_error = 0.0f;
+        for (size_t i = latency + 1024; i < frames; ++i) {
+            max_error = std::max(max_error, std::abs(output[i] - input[i - latency]));
+        }
+        TestRunner::run_test("PitchCorrector unity ratio is a pure delay", max_error < 1e-4f,
+                           "Max error: " + std::to_string(max_error));
+    }
+    
+    // Test 3: Output does not depend on how the stream is split into calls
+    {
+        const size_t frames = 12000;
+        std::vector<Sample> input = make_sine(frames, 196.0f, 44100.0f);
+        PitchCorrector small_calls(44100, 512);
+        PitchCorrector large_calls(44100, 512);
+        std::vector<Sample> small = correct_in_blocks(small_calls, input, 64, 196.0f, 220.0f);
+        std::vector<Sample> large = correct_in_blocks(large_calls, input, 1000, 196.0f, 220.0f);
+        
+        float max_difference = 0.0f;
+        for (size_t i = 0; i < frames; ++i) {
+            max_difference = std::max(max_difference, std::abs(small[i] - large[i]));
+        }
+        TestRunner::run_test("PitchCorrector streaming independent of call size", max_difference < 1e-5f,
+                           "Max difference: " + std::to_string(max_difference));
+    }
+    
+    // Test 4: Shifted output has the target pitch
+    {
+        const size_t frames = 16384;
+        const float targets[] = {246.94f, 174.61f};
+        for (float target : targets) {
+            PitchCorrector corrector(44100, 512);
+            std::vector<Sample> input = make_sine(frames, 220.0f, 44100.0f);
+            std::vector<Sample> output = correct_in_blocks(corrector, input, 512, 220.0f, target);
+            
+            PitchDetector detector(44100, 2048);
+            detector.set_algorithm(PitchDetector::Algorithm::YIN);
+            float confidence = 0.0f;
+            float detected = detector.detect_pitch(output.data() + frames - 2048, 2048, confidence);
+            TestRunner::run_test("PitchCorrector shifts 220 Hz to " + std::to_string(static_cast<int>(target)) + " Hz",
+                               std::abs(detected - target) < 2.0f,
+                               "Detected: " + std::to_string(detected) + " Hz");
+        }
+    }
+    
+    // Test 5: Block channels share pitch marks but keep their own signal
+    {
+        const size_t frames = 8192;
+        std::vector<Sample> left = make_sine(frames, 220.0f, 44100.0f);
+        std::vector<Sample> right = make_sine(frames, 330.0f, 44100.0f);
+        std::vector<Sample> out_left(frames), out_right(frames);
+        const Sample* input_channels[] = {left.data(), right.data()};
+        Sample* output_channels[] = {out_left.data(), out_right.data()};
+        
+        PitchCorrector stereo(44100, 512, 2);
+        for (size_t offset = 0; offset < frames; offset += 512) {
+            const Sample* input_block[] = {input_channels[0] + offset, input_channels[1] + offset};
+            Sample* output_block[] = {output_channels[0] + offset, output_channels[1] + offset};
+            AudioBlockView input(input_block, 2, 512);
+            AudioBlockView output(output_block, 2, 512);
+            stereo.correct_pitch(input, output, 220.0f, 233.08f);
+        }
+        
+        PitchCorrector mono_left(44100, 512);
+        PitchCorrector mono_right(44100, 512);
+        std::vector<Sample> expected_left = correct_in_blocks(mono_left, left, 512, 220.0f, 233.08f);
+        std::vector<Sample> expected_right = correct_in_blocks(mono_right, right, 512, 220.0f, 233.08f);
+        TestRunner::run_test("PitchCorrector block channels match mono processing",
+                           out_left == expected_left && out_right == expected_right);
+    }
+    
+    // Test 6: One block call matches the per-run calls it replaces
+    {
+        const uint32_t frames = 4096;
+        std::vector<Sample> left = make_sine(frames, 220.0f, 44100.0f);
+        std::vector<Sample> right = make_sine(frames, 277.0f, 44100.0f);
+        const Sample* input_channels[] = {left.data(), right.data()};
+        
+        // Pitch changes every 128 frames, as the engine's tracker hop does
+        std::vector<float> input_pitch(frames), target_pitch(frames);
+        for (uint32_t i = 0; i < frames; ++i) {
+            input_pitch[i] = (i / 128) % 3 == 2 ? 0.0f : 220.0f + (i / 128);
+            target_pitch[i] = 233.08f;
+        }
+        
+        std::vector<Sample> block_left(frames), block_right(frames);
+        Sample* block_channels[] = {block_left.data(), block_right.data()};
+        PitchCorrector block_corrector(44100, 512, 2);
+        ProcessingResult block_result = block_corrector.correct_block(
+            input_channels, block_channels, 2, frames,
+            PitchCorrector::PitchCurve(input_pitch.data(), target_pitch.data(), 0.9f));
+        
+        std::vector<Sample> run_left(frames), run_right(frames);
+        PitchCorrector run_corrector(44100, 512, 2);
+        for (uint32_t offset = 0; offset < frames; offset += 128) {
+            const Sample* run_input[] = {left.data() + offset, right.data() + offset};
+            Sample* run_output[] = {run_left.data() + offset, run_right.data() + offset};
+            AudioBlockView input(run_input, 2, 128);
+            AudioBlockView output(run_output, 2, 128);
+            run_corrector.correct_pitch(input, output, input_pitch[offset], target_pitch[offset], 0.9f);
+        }
+        
+        TestRunner::run_test("PitchCorrector correct_block follows pitch curve",
+                           block_result.success && block_left == run_left && block_right == run_right);
+        TestRunner::run_test("PitchCorrector correct_block reports last frame",
+                           block_result.detected_pitch == input_pitch[frames - 1] &&
+                           block_result.latency_samples == block_corrector.get_latency_samples());
+        
+        // Frame-at-a-time calls now correct every channel with the same state
+        std::vector<Sample> frame_left(frames), frame_right(frames);
+        PitchCorrector frame_corrector(44100, 512, 2);
+        AudioFrame in_frame(2), out_frame(2);
+        for (uint32_t i = 0; i < frames; ++i) {
+            in_frame[0] = left[i];
+            in_frame[1] = right[i];
+            frame_corrector.correct_pitch(in_frame, out_frame, input_pitch[i], target_pitch[i], 0.9f);
+            frame_left[i] = out_frame[0];
+            frame_right[i] = out_frame[1];
+        }
+        TestRunner::run_test("PitchCorrector frame calls process all channels",
+                           frame_left == block_left && frame_right == block_right);
+        
+        TestRunner::run_test("PitchCorrector correct_block rejects missing curve",
+                           !block_corrector.correct_block(input_channels, block_channels, 2, frames,
+                                                          PitchCorrector::PitchCurve()).success);
+    }
+    
+    // Test 7: Phase-vocoder backend
+    {
+        PitchCorrector corrector(44100, 512);
+        uint32_t psola_latency = corrector.get_latency_samples();
+        corrector.set_backend(PitchCorrector::Backend::PHASE_VOCODER);
+        uint32_t latency = corrector.get_latency_samples();
+        corrector.set_vocoder_overlap(2);
+        TestRunner::run_test("PitchCorrector vocoder backend selection",
+                           corrector.get_backend() == PitchCorrector::Backend::PHASE_VOCODER &&
+                           corrector.get_vocoder_overlap() == 2 && latency != psola_latency);
+        corrector.set_vocoder_overlap(3);
+        TestRunner::run_test("PitchCorrector vocoder rejects unsupported overlap",
+                           corrector.get_vocoder_overlap() == 2);
+        
+        // Unity ratio reconstructs the input one frame late
+        const size_t frames = 16384;
+        PitchCorrector unity(44100, 512);
+        unity.set_backend(PitchCorrector::Backend::PHASE_VOCODER);
+        std::vector<Sample> input = make_sine(frames, 220.0f, 44100.0f);
+        for (size_t i = 0; i < frames; ++i) {
+            input[i] += 0.2f * std::sin(2.0f * M_PI * 1375.0f * i / 44100.0f);
+        }
+        std::vector<Sample> output = correct_in_blocks(unity, input, 300, 220.0f, 220.0f);
+        float max_error = 0.0f;
+        for (size_t i = 2 * latency; i < frames; ++i) {
+            max_error = std::max(max_error, std::abs(output[i] - input[i - latency]));
+        }
+        TestRunner::run_test("PitchCorrector vocoder unity ratio is a pure delay", max_error < 1e-3f,
+                           "Max error: " + std::to_string(max_error));
+        
+        // Shifts at both overlap factors land on the target
+        for (uint32_t overlap : {2u, 4u}) {
+            PitchCorrector shifter(44100, 512);
+            shifter.set_backend(PitchCorrector::Backend::PHASE_VOCODER);
+            shifter.set_vocoder_overlap(overlap);
+            std::vector<Sample> shifted = correct_in_blocks(shifter, make_sine(frames, 220.0f, 44100.0f),
+                                                            512, 220.0f, 329.63f);
+            PitchDetector detector(44100, 2048);
+            detector.set_algorithm(PitchDetector::Algorithm::YIN);
+            float confidence = 0.0f;
+            float detected = detector.detect_pitch(shifted.data() + frames - 2048, 2048, confidence);
+            TestRunner::run_test("PitchCorrector vocoder shifts a fifth at " + std::to_string(overlap) + "x overlap",
+                               std::abs(detected - 329.63f) < 2.0f,
+                               "Detected: " + std::to_string(detected) + " Hz");
+        }
+    }
+    
+    // Test 8: Formant preservation keeps the spectral envelope in place
+    {
+        // Harmonics of 150 Hz under a single resonance at 1 kHz
+        const size_t frames = 32768;
+        const float ratio = 1.5f;
+        std::vector<Sample> voice(frames, 0.0f);
+        for (int harmonic = 1; harmonic <= 30; ++harmonic) {
+            float frequency = 150.0f * harmonic;
+            float detune = (frequency - 1000.0f) / 250.0f;
+            float amplitude = 0.3f / (1.0f + detune * detune);
+            for (size_t i = 0; i < frames; ++i) {
+                voice[i] += amplitude * std::sin(2.0f * M_PI * frequency * i / 44100.0f);
+            }
+        }
+        
+        float centroids[2];
+        for (int preserve = 0; preserve < 2; ++preserve) {
+            PitchCorrector corrector(44100, 512);
+            corrector.set_backend(PitchCorrector::Backend::PHASE_VOCODER);
+            corrector.set_formant_preservation(preserve != 0);
+            std::vector<Sample> shifted = correct_in_blocks(corrector, voice, 512, 150.0f, 150.0f * ratio);
+            centroids[preserve] = spectral_centroid(shifted.data() + frames - 8192, 8192, 44100.0f);
+        }
+        float original = spectral_centroid(voice.data() + frames - 8192, 8192, 44100.0f);
+        
+        TestRunner::run_test("PitchCorrector vocoder without formants moves the envelope",
+                           centroids[0] > original * 1.3f,
+                           "Centroid: " + std::to_string(centroids[0]) + " Hz vs " + std::to_string(original));
+        TestRunner::run_test("PitchCorrector vocoder preserves formants",
+                           std::abs(centroids[1] - original) < original * 0.1f,
+                           "Centroid: " + std::to_string(centroids[1]) + " Hz vs " + std::to_string(original));
+    }
+    
+    // Test 9: Linked vocoder channels keep their phase relationship
+    {
+        // The same voice in both channels, one radian apart (a wide double)
+        const size_t frames = 32768;
+        const float offset = 1.0f;
+        std::vector<Sample> left(frames), right(frames);
+        for (size_t i = 0; i < frames; ++i) {
+            float angle = 2.0f * M_PI * 220.0f * i / 44100.0f;
+            left[i] = 0.5f * std::sin(angle);
+            right[i] = 0.5f * std::sin(angle - offset);
+        }
+        
+        PitchCorrector corrector(44100, 512, 2);
+        corrector.set_backend(PitchCorrector::Backend::PHASE_VOCODER);
+        std::vector<Sample> out_left(frames), out_right(frames);
+        for (size_t start = 0; start < frames; start += 512) {
+            const Sample* input_block[] = {left.data() + start, right.data() + start};
+            Sample* output_block[] = {out_left.data() + start, out_right.data() + start};
+            AudioBlockView input(input_block, 2, 512);
+            AudioBlockView output(output_block, 2, 512);
+            corrector.correct_pitch(input, output, 220.0f, 261.63f);
+        }
+        
+        const uint32_t window = 8192;
+        float difference = phase_at(out_left.data() + frames - window, window, 261.63f, 44100.0f) -
+                           phase_at(out_right.data() + frames - window, window, 261.63f, 44100.0f);
+        difference = std::remainder(difference, 2.0f * static_cast<float>(M_PI));
+        TestRunner::run_test("PitchCorrector vocoder keeps the stereo image", std::abs(difference - offset) < 0.1f,
+                           "Phase difference: " + std::to_string(difference) + " rad");
+    }
+    
+    // Test 10: Bypassed blocks are a pure delay and hand over to correction without a seam
+    {
+        const size_t frames = 32768;
+        const uint32_t block = 300;
+        std::vector<Sample> input = make_sine(frames, 220.0f, 44100.0f);
+        for (size_t i = 0; i < frames; ++i) {
+            input[i] += 0.2f * std::sin(2.0f * M_PI * 1375.0f * i / 44100.0f);
+        }
+        
+        // Long bypass spans, and spans shorter than the latency
+        for (PitchCorrector::Backend backend : {PitchCorrector::Backend::PSOLA, PitchCorrector::Backend::PHASE_VOCODER}) {
+            bool vocoder = backend == PitchCorrector::Backend::PHASE_VOCODER;
+            for (uint32_t period : {10u, 3u}) {
+                PitchCorrector corrector(44100, 512);
+                corrector.set_backend(backend);
+                std::vector<Sample> output(frames, 0.0f);
+                uint32_t bypassed = 0;
+                for (size_t offset = 0, b = 0; offset < frames; offset += block, ++b) {
+                    uint32_t count = static_cast<uint32_t>(std::min<size_t>(block, frames - offset));
+                    const Sample* in = input.data() + offset;
+                    Sample* out = output.data() + offset;
+                    if (b % period >= period / 2 + 1) {
+                        corrector.bypass_block(&in, &out, 1, count);
+                        bypassed += corrector.is_bypassed() ? 1 : 0;
+                    } else {
+                        corrector.correct_pitch(in, out, count, 220.0f, 220.0f);
+                    }
+                }
+                
+                uint32_t latency = corrector.get_latency_samples();
+                float max_error = 0.0f;
+                for (size_t i = 2 * latency; i < frames; ++i) {
+                    max_error = std::max(max_error, std::abs(output[i] - input[i - latency]));
+                }
+                TestRunner::run_test(std::string("PitchCorrector ") + (vocoder ? "vocoder" : "PSOLA") +
+                                   " bypass hands over seamlessly (" + std::to_string(period) + "-block cycle)",
+                                   bypassed > 0 && max_error < (vocoder ? 1e-3f : 1e-4f),
+                                   "Bypassed blocks: " + std::to_string(bypassed) +
+                                   ", max error: " + std::to_string(max_error));
+            }
+        }
+        
+        // A shifted voice glides back to unity before the shifter is skipped
+        PitchCorrector corrector(44100, 512);
+        correct_in_blocks(corrector, std::vector<Sample>(input.begin(), input.begin() + 8192), 512, 220.0f, 261.63f);
+        std::vector<Sample> output(512);
+        const Sample* in = input.data() + 8192;
+        Sample* out = output.data();
+        corrector.bypass_block(&in, &out, 1, 512);
+        bool gliding = !corrector.is_bypassed();
+        uint32_t blocks = 1;
+        while (!corrector.is_bypassed() && blocks < 200) {
+            corrector.bypass_block(&in, &out, 1, 512);
+            ++blocks;
+        }
+        TestRunner::run_test("PitchCorrector bypass waits for the glide to settle",
+                           gliding && corrector.is_bypassed(), "Blocks: " + std::to_string(blocks));
+    }
+}
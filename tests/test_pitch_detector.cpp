@@ -1,8 +1,12 @@
 #include "pitch_detector.h"
+#include "batch_pitch_detector.h"
+#include "test_runner.h"
 #include <iostream>
 #include <cmath>
-
-extern class TestRunner;
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
 
 void test_pitch_detector() {
     using namespace autotune;
@@ -119,4 +123,333 @@ void test_pitch_detector() {
         TestRunner::run_test("PitchDetector frequency range filtering", 
                            detected_pitch == 0.0f || (detected_pitch >= 200.0f && detected_pitch <= 800.0f));
     }
+    
+    // Test 7: FFT and direct autocorrelation agree
+    {
+        PitchDetector direct_detector(44100, 2048);
+        PitchDetector fft_detector(44100, 2048);
+        direct_detector.set_autocorrelation_method(PitchDetector::AutocorrelationMethod::DIRECT);
+        fft_detector.set_autocorrelation_method(PitchDetector::AutocorrelationMethod::FFT);
+        
+        // Generate 196 Hz tone with a harmonic (low voice)
+        std::vector<Sample> samples(2048);
+        for (size_t i = 0; i < samples.size(); ++i) {
+            float t = static_cast<float>(i) / 44100.0f;
+            samples[i] = 0.5f * std::sin(2.0f * M_PI * 196.0f * t) +
+                         0.2f * std::sin(2.0f * M_PI * 392.0f * t);
+        }
+        
+        float direct_confidence = 0.0f;
+        float fft_confidence = 0.0f;
+        float direct_pitch = direct_detector.detect_pitch(samples.data(), 2048, direct_confidence);
+        float fft_pitch = fft_detector.detect_pitch(samples.data(), 2048, fft_confidence);
+        
+        TestRunner::run_test("PitchDetector FFT autocorrelation default",
+                           fft_detector.get_autocorrelation_method() == PitchDetector::AutocorrelationMethod::FFT);
+        TestRunner::run_test("PitchDetector FFT matches direct pitch",
+                           direct_pitch > 0.0f && std::abs(direct_pitch - fft_pitch) < 0.5f,
+                           "Direct: " + std::to_string(direct_pitch) + " Hz, FFT: " + std::to_string(fft_pitch) + " Hz");
+        TestRunner::run_test("PitchDetector FFT matches direct confidence",
+                           std::abs(direct_confidence - fft_confidence) < 1e-3f);
+    }
+    
+    // Test 8: FFT round trip
+    {
+        FFT fft(256);
+        std::vector<Sample> input(fft.size());
+        std::vector<Sample> output(fft.size());
+        std::vector<FFT::Complex> spectrum(fft.bin_count());
+        
+        for (size_t i = 0; i < input.size(); ++i) {
+            input[i] = std::sin(0.3f * i) + 0.25f * std::cos(1.7f * i);
+        }
+        
+        fft.forward(input.data(), spectrum.data());
+        fft.inverse(spectrum.data(), output.data());
+        
+        float max_error = 0.0f;
+        for (size_t i = 0; i < input.size(); ++i) {
+            max_error = std::max(max_error, std::abs(input[i] - output[i]));
+        }
+        TestRunner::run_test("FFT forward/inverse round trip", max_error < 1e-4f);
+        TestRunner::run_test("FFT size rounding", FFT(1000).size() == 1024);
+    }
+    
+    // Test 9: YIN and MPM sub-sample accuracy on 1024-sample windows
+    {
+        const float frequencies[] = {146.83f, 261.63f, 349.23f, 523.25f};
+        std::vector<Sample> samples(1024);
+        
+        for (PitchDetector::Algorithm algorithm : {PitchDetector::Algorithm::YIN, PitchDetector::Algorithm::MPM}) {
+            const char* name = algorithm == PitchDetector::Algorithm::YIN ? "YIN" : "MPM";
+            float max_error = 0.0f;
+            float min_confidence = 1.0f;
+            
+            for (float frequency : frequencies) {
+                // Harmonic-rich tone with a strong second harmonic (octave-error bait)
+                for (size_t i = 0; i < samples.size(); ++i) {
+                    float t = static_cast<float>(i) / 44100.0f;
+                    samples[i] = 0.3f * std::sin(2.0f * M_PI * frequency * t) +
+                                 0.5f * std::sin(2.0f * M_PI * 2.0f * frequency * t) +
+                                 0.2f * std::sin(2.0f * M_PI * 3.0f * frequency * t);
+                }
+                
+                // Fresh detector per tone so smoothing does not blend estimates
+                PitchDetector detector(44100, 1024);
+                detector.set_algorithm(algorithm);
+                float confidence = 0.0f;
+                float pitch = detector.detect_pitch(samples.data(), 1024, confidence);
+                max_error = std::max(max_error, std::abs(pitch - frequency));
+                min_confidence = std::min(min_confidence, confidence);
+            }
+            
+            TestRunner::run_test(std::string("PitchDetector ") + name + " accuracy", max_error < 0.5f,
+                               "Max error: " + std::to_string(max_error) + " Hz");
+            TestRunner::run_test(std::string("PitchDetector ") + name + " confidence", min_confidence > 0.8f,
+                               "Min confidence: " + std::to_string(min_confidence));
+        }
+        
+        PitchDetector detector(44100, 1024);
+        detector.set_algorithm(PitchDetector::Algorithm::YIN);
+        float confidence = 1.0f;
+        std::vector<Sample> silence(1024, 0.0f);
+        float pitch = detector.detect_pitch(silence.data(), 1024, confidence);
+        TestRunner::run_test("PitchDetector YIN silence unvoiced", pitch == 0.0f && confidence == 0.0f);
+        TestRunner::run_test("PitchDetector algorithm selection",
+                           detector.get_algorithm() == PitchDetector::Algorithm::YIN &&
+                           std::string(detector.get_estimator().name()) == "yin");
+        
+        detector.set_estimator(std::make_unique<MpmEstimator>(1024, 0.8f));
+        TestRunner::run_test("PitchDetector custom estimator",
+                           detector.get_algorithm() == PitchDetector::Algorithm::CUSTOM &&
+                           std::string(detector.get_estimator().name()) == "mpm");
+    }
+    
+    // Test 10: Parabolic interpolation recovers a sampled parabola's vertex
+    {
+        // (x - 1.7)^2 sampled at x = 0..3
+        const float values[] = {2.89f, 0.49f, 0.09f, 1.69f};
+        float vertex = PitchEstimator::parabolic_interpolation(values, 2, 4);
+        TestRunner::run_test("Parabolic interpolation exact for parabola", std::abs(vertex - 1.7f) < 1e-4f);
+        TestRunner::run_test("Parabolic interpolation edge index", PitchEstimator::parabolic_interpolation(values, 0, 4) == 0.0f);
+    }
+    
+    // Test 11: Decimated analysis at 192 kHz matches full-rate accuracy
+    {
+        const float frequencies[] = {196.0f, 440.0f, 880.0f, 1200.0f};
+        std::vector<Sample> samples(2048);
+        
+        for (PitchDetector::Algorithm algorithm : {PitchDetector::Algorithm::YIN, PitchDetector::Algorithm::MPM}) {
+            float max_error = 0.0f;
+            for (float frequency : frequencies) {
+                for (size_t i = 0; i < samples.size(); ++i) {
+                    float t = static_cast<float>(i) / 192000.0f;
+                    samples[i] = 0.4f * std::sin(2.0f * M_PI * frequency * t) +
+                                 0.3f * std::sin(2.0f * M_PI * 2.0f * frequency * t);
+                }
+                
+                PitchDetector detector(192000, 2048);
+                detector.set_algorithm(algorithm);
+                detector.set_analysis_rate(16000);
+                float confidence = 0.0f;
+                float pitch = detector.detect_pitch(samples.data(), 2048, confidence);
+                max_error = std::max(max_error, std::abs(pitch - frequency));
+            }
+            const char* name = algorithm == PitchDetector::Algorithm::YIN ? "YIN" : "MPM";
+            TestRunner::run_test(std::string("PitchDetector decimated ") + name + " accuracy", max_error < 0.1f,
+                               "Max error: " + std::to_string(max_error) + " Hz");
+        }
+        
+        PitchDetector detector(192000, 2048);
+        detector.set_analysis_rate(16000);
+        TestRunner::run_test("PitchDetector analysis rate",
+                           detector.get_decimation_factor() == 12 && detector.get_analysis_rate() == 16000);
+        detector.set_analysis_rate(0);
+        TestRunner::run_test("PitchDetector full-rate analysis",
+                           detector.get_decimation_factor() == 1 && detector.get_analysis_rate() == 192000);
+    }
+    
+    // Test 12: Decimator passband and anti-aliasing
+    {
+        Decimator decimator(12);
+        std::vector<Sample> input(4096), output(decimator.output_count(4096));
+        
+        // Amplitude from RMS, as decimated samples rarely hit the sine peak
+        auto output_amplitude = [&](float frequency) {
+            for (size_t i = 0; i < input.size(); ++i) {
+                input[i] = std::sin(2.0f * M_PI * frequency * i / 192000.0f);
+            }
+            uint32_t count = decimator.decimate(input.data(), 4096, output.data());
+            float power = 0.0f;
+            for (uint32_t i = 0; i < count; ++i) {
+                power += output[i] * output[i];
+            }
+            return std::sqrt(2.0f * power / count);
+        };
+        
+        TestRunner::run_test("Decimator output count", decimator.output_count(4096) == (4096 - decimator.taps()) / 12 + 1);
+        TestRunner::run_test("Decimator passband", std::abs(output_amplitude(1000.0f) - 1.0f) < 0.02f,
+                           "Amplitude: " + std::to_string(output_amplitude(1000.0f)));
+        // 14 kHz would alias to 2 kHz at the 16 kHz output rate
+        TestRunner::run_test("Decimator stopband", output_amplitude(14000.0f) < 0.01f,
+                           "Amplitude: " + std::to_string(output_amplitude(14000.0f)));
+    }
+    
+    // Test 13: Sliding-window tracking is independent of push size
+    {
+        std::vector<Sample> samples(4096);
+        for (size_t i = 0; i < samples.size(); ++i) {
+            samples[i] = 0.5f * std::sin(2.0f * M_PI * 440.0f * i / 44100.0f);
+        }
+        
+        auto track = [&](uint32_t push_size, float& pitch) {
+            PitchDetector detector(44100, 1024);
+            detector.set_tracking(1024, 256);
+            uint32_t estimates = 0;
+            for (uint32_t offset = 0; offset < samples.size(); offset += push_size) {
+                uint32_t count = std::min<uint32_t>(push_size, static_cast<uint32_t>(samples.size()) - offset);
+                estimates += detector.push_samples(samples.data() + offset, count);
+            }
+            pitch = detector.get_tracked_pitch();
+            return estimates;
+        };
+        
+        float small_pitch = 0.0f;
+        float large_pitch = 0.0f;
+        uint32_t small_estimates = track(64, small_pitch);
+        uint32_t large_estimates = track(1000, large_pitch);
+        
+        // First estimate once the window is full, then one per hop
+        TestRunner::run_test("PitchDetector tracking hop count", small_estimates == (4096 - 1024) / 256 + 1,
+                           "Estimates: " + std::to_string(small_estimates));
+        TestRunner::run_test("PitchDetector tracking push size independent",
+                           small_estimates == large_estimates && small_pitch == large_pitch);
+        TestRunner::run_test("PitchDetector tracking pitch", std::abs(small_pitch - 440.0f) < 5.0f,
+                           "Tracked: " + std::to_string(small_pitch) + " Hz");
+        
+        PitchDetector detector(44100, 1024);
+        detector.set_tracking(4096, 0);
+        TestRunner::run_test("PitchDetector tracking clamps",
+                           detector.get_window_size() == 1024 && detector.get_hop_size() == 1 &&
+                           detector.samples_until_estimate() == 1);
+    }
+    
+    // Test 14: Silence gate skips quiet and noise-like windows, with hysteresis
+    {
+        const SampleRate sample_rate = 44100;
+        PitchDetector detector(sample_rate, 1024);
+        detector.set_tracking(1024, 256);
+        detector.set_gate_threshold(0.01f);        // Opens at -40 dBFS RMS, closes at -46
+        
+        double phase = 0.0;
+        auto push_tone = [&](float amplitude, uint32_t count) {
+            std::vector<Sample> samples(count);
+            for (Sample& sample : samples) {
+                sample = amplitude * static_cast<float>(std::sin(phase));
+                phase += 2.0 * M_PI * 220.0 / sample_rate;
+            }
+            detector.push_samples(samples.data(), count);
+            return detector.get_tracked_pitch();
+        };
+        
+        // Sine RMS is amplitude / sqrt(2)
+        float loud = push_tone(0.5f, 4096);
+        bool open = !detector.is_gated() && std::abs(loud - 220.0f) < 5.0f;
+        float between = push_tone(0.01f, 8192);
+        bool held_open = !detector.is_gated() && std::abs(between - 220.0f) < 5.0f;
+        float quiet = push_tone(0.004f, 8192);
+        bool closed = detector.is_gated() && quiet == 0.0f && detector.get_tracked_confidence() == 0.0f;
+        push_tone(0.01f, 8192);
+        bool stays_closed = detector.is_gated();
+        TestRunner::run_test("PitchDetector gate has hysteresis",
+                           open && held_open && closed && stays_closed,
+                           "Tracked: " + std::to_string(loud) + " / " + std::to_string(between) + " Hz");
+        
+        // Loud white noise crosses zero far too often to be voiced
+        std::vector<Sample> noise(8192);
+        uint32_t state = 12345;
+        for (Sample& sample : noise) {
+            state = state * 1664525u + 1013904223u;
+            sample = 0.5f * (static_cast<float>(state >> 8) / 8388608.0f - 1.0f);
+        }
+        detector.push_samples(noise.data(), static_cast<uint32_t>(noise.size()));
+        bool noise_gated = detector.is_gated() && detector.get_tracked_pitch() == 0.0f;
+        float reopened = push_tone(0.5f, 2048);
+        TestRunner::run_test("PitchDetector gate skips noise and reopens on a voice",
+                           noise_gated && !detector.is_gated() && std::abs(reopened - 220.0f) < 5.0f,
+                           "Tracked: " + std::to_string(reopened) + " Hz");
+        
+        detector.set_gate_threshold(0.0f);
+        push_tone(0.004f, 2048);
+        TestRunner::run_test("PitchDetector gate can be disabled", !detector.is_gated());
+    }
+    
+    // Test 15: Batched detection matches one detector per voice
+    {
+        const SampleRate sample_rate = 44100;
+        const uint32_t window = 1024;
+        
+        // 11 voices: one 8-lane vector plus a scalar tail; the last voice is silent
+        const uint32_t voice_count = 11;
+        std::vector<std::vector<Sample>> voices(voice_count, std::vector<Sample>(window, 0.0f));
+        std::vector<const Sample*> windows(voice_count);
+        for (uint32_t v = 0; v < voice_count; ++v) {
+            if (v + 1 < voice_count) {
+                float frequency = 110.0f * std::pow(2.0f, v / 4.0f);
+                for (uint32_t i = 0; i < window; ++i) {
+                    voices[v][i] = 0.5f * std::sin(2.0f * M_PI * frequency * i / sample_rate) +
+                                   0.2f * std::sin(4.0f * M_PI * frequency * i / sample_rate);
+                }
+            }
+            windows[v] = voices[v].data();
+        }
+        
+        std::vector<BatchPitchDetector::Estimate> estimates(voice_count);
+        for (auto method : {PitchDetector::AutocorrelationMethod::FFT, PitchDetector::AutocorrelationMethod::DIRECT}) {
+            BatchPitchDetector batch(voice_count, sample_rate, window);
+            batch.set_autocorrelation_method(method);
+            std::vector<std::unique_ptr<PitchDetector>> singles;
+            for (uint32_t v = 0; v < voice_count; ++v) {
+                singles.push_back(std::make_unique<PitchDetector>(sample_rate, window));
+                singles[v]->set_autocorrelation_method(method);
+            }
+            
+            // Two calls so per-voice smoothing is exercised too
+            bool matches = true;
+            std::string detail;
+            for (int call = 0; call < 2; ++call) {
+                batch.detect_pitch(windows.data(), window, estimates.data());
+                for (uint32_t v = 0; v < voice_count; ++v) {
+                    float confidence = 0.0f;
+                    float pitch = singles[v]->detect_pitch(windows[v], window, confidence);
+                    if (std::abs(estimates[v].pitch - pitch) > 0.01f ||
+                        std::abs(estimates[v].confidence - confidence) > 1e-3f) {
+                        matches = false;
+                        detail = "Voice " + std::to_string(v) + ": " + std::to_string(estimates[v].pitch) +
+                                 " vs " + std::to_string(pitch) + " Hz";
+                    }
+                }
+            }
+            std::string name = method == PitchDetector::AutocorrelationMethod::FFT ? "FFT" : "direct";
+            TestRunner::run_test("BatchPitchDetector matches per-voice detection (" + name + ")", matches, detail);
+            TestRunner::run_test("BatchPitchDetector reports silence as unvoiced (" + name + ")",
+                               estimates[voice_count - 1].pitch == 0.0f &&
+                               estimates[voice_count - 1].confidence == 0.0f);
+        }
+        
+        // Pre-interleaved input, without smoothing
+        std::vector<Sample> interleaved(static_cast<size_t>(window) * voice_count);
+        BatchPitchDetector::interleave(windows.data(), voice_count, window, interleaved.data());
+        BatchPitchDetector fresh(voice_count, sample_rate, window);
+        fresh.set_smoothing(0.0f);
+        fresh.detect_pitch(interleaved.data(), window, estimates.data());
+        float expected = 110.0f * std::pow(2.0f, 5.0f / 4.0f);
+        TestRunner::run_test("BatchPitchDetector interleaved input",
+                           std::abs(estimates[5].pitch - expected) < 2.0f,
+                           "Detected: " + std::to_string(estimates[5].pitch) + " Hz");
+        
+        fresh.detect_pitch(interleaved.data(), window + 1, estimates.data());
+        TestRunner::run_test("BatchPitchDetector rejects oversized windows",
+                           estimates[0].pitch == 0.0f && estimates[0].confidence == 0.0f);
+    }
 }
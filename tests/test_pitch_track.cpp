@@ -0,0 +1,153 @@
+#include "pitch_track.h"
+#include "autotune_engine.h"
+#include "test_runner.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+using namespace autotune;
+
+/**
+ * @brief Interleaved stereo glide from 200 Hz to 260 Hz
+ */
+std::vector<Sample> make_glide(size_t frames, SampleRate sample_rate) {
+    std::vector<Sample> signal(frames * 2);
+    double phase = 0.0;
+    for (size_t i = 0; i < frames; ++i) {
+        double frequency = 200.0 + 60.0 * i / frames;
+        phase += 2.0 * M_PI * frequency / sample_rate;
+        signal[2 * i] = static_cast<Sample>(0.5 * std::sin(phase));
+        signal[2 * i + 1] = static_cast<Sample>(0.4 * std::sin(phase));
+    }
+    return signal;
+}
+
+/**
+ * @brief Render a signal block by block, returning the output
+ */
+std::vector<Sample> render(AutotuneEngine& engine, const std::vector<Sample>& signal, uint32_t block) {
+    std::vector<Sample> output(signal.size());
+    size_t frames = signal.size() / 2;
+    for (size_t offset = 0; offset < frames; offset += block) {
+        size_t count = std::min<size_t>(block, frames - offset);
+        engine.process_buffer(signal.data() + offset * 2, output.data() + offset * 2, count);
+    }
+    return output;
+}
+
+} // namespace
+
+void test_pitch_track() {
+    const SampleRate sample_rate = 44100;
+    
+    // Test 1: Serialization round trip keeps key and points exactly
+    {
+        PitchTrack track;
+        PitchTrack::AnalysisKey key;
+        key.content_hash = 0x0123456789abcdefull;
+        key.sample_rate = 48000;
+        key.window_size = 1024;
+        key.hop_size = 256;
+        key.algorithm = 2;
+        key.analysis_rate = 16000;
+        key.min_frequency = 80.0f;
+        key.max_frequency = 1000.0f;
+        key.confidence_threshold = 0.3f;
+        key.gate_threshold = 0.001f;
+        key.smoothing = 0.5f;
+        track.set_key(key);
+        for (uint64_t i = 0; i < 1000; ++i) {
+            track.add(i * 256 + (i == 500 ? 100000 : 0), 100.0f + 0.37f * i, (i % 10) / 10.0f);
+        }
+        
+        std::vector<uint8_t> bytes = track.serialize();
+        PitchTrack decoded;
+        bool ok = decoded.deserialize(bytes.data(), bytes.size()) && decoded.get_key() == key &&
+                  decoded.size() == track.size();
+        for (size_t i = 0; ok && i < track.size(); ++i) {
+            const PitchTrack::Point& a = track.get_points()[i];
+            const PitchTrack::Point& b = decoded.get_points()[i];
+            ok = a.position == b.position && a.pitch == b.pitch && a.confidence == b.confidence;
+        }
+        TestRunner::run_test("Pitch track serialization round trip", ok);
+        TestRunner::run_test("Pitch track encoding is compact", bytes.size() < track.size() * 11,
+                           std::to_string(bytes.size()) + " bytes");
+        
+        // Truncated or corrupted data is rejected and leaves the track alone
+        bool truncated = !decoded.deserialize(bytes.data(), bytes.size() - 1);
+        std::vector<uint8_t> corrupt = bytes;
+        corrupt[0] = 'X';
+        bool bad_magic = !decoded.deserialize(corrupt.data(), corrupt.size());
+        TestRunner::run_test("Invalid pitch track data rejected",
+                           truncated && bad_magic && decoded.size() == track.size());
+        
+        // Unknown format versions are rejected
+        std::vector<uint8_t> future = bytes;
+        future[4] = 2;
+        TestRunner::run_test("Unknown pitch track version rejected",
+                           !decoded.deserialize(future.data(), future.size()) && decoded.size() == track.size());
+        
+        const char* path = "pitch_track_test.bin";
+        PitchTrack loaded;
+        TestRunner::run_test("Pitch track save/load",
+                           track.save(path) && loaded.load(path) && loaded.get_key() == key &&
+                           loaded.size() == track.size() && !loaded.load("pitch_track_test_missing.bin"));
+        std::remove(path);
+    }
+    
+    // Test 2: Content hash does not depend on how the audio is split
+    {
+        std::vector<Sample> signal = make_glide(4096, sample_rate);
+        uint64_t whole = PitchTrack::hash_samples(signal.data(), signal.size());
+        uint64_t split = PitchTrack::hash_samples(signal.data(), 1001);
+        split = PitchTrack::hash_samples(signal.data() + 1001, signal.size() - 1001, split);
+        signal[77] += 1e-6f;
+        uint64_t changed = PitchTrack::hash_samples(signal.data(), signal.size());
+        TestRunner::run_test("Content hash is split-independent and content-sensitive",
+                           whole == split && whole != changed);
+    }
+    
+    // Test 3: Playing back a recorded track reproduces the live render and
+    // re-renders with a new scale match live detection exactly
+    {
+        const uint32_t block = 256;
+        std::vector<Sample> signal = make_glide(sample_rate, sample_rate);
+        
+        AutotuneEngine engine(sample_rate, 1024, 2);
+        engine.set_scale(Quantizer::Scale::MAJOR, 60);
+        PitchTrack track;
+        track.set_content_hash(PitchTrack::hash_samples(signal.data(), signal.size()));
+        engine.record_pitch_track(&track);
+        std::vector<Sample> live = render(engine, signal, block);
+        engine.record_pitch_track(nullptr);
+        
+        bool keyed = track.get_key() == engine.get_pitch_analysis_key(track.get_key().content_hash) &&
+                     track.get_key().content_hash != 0 &&
+                     track.size() == (sample_rate - engine.get_analysis_window()) / engine.get_analysis_hop() + 1;
+        TestRunner::run_test("Recording stores one point per hop and the analysis key", keyed,
+                           std::to_string(track.size()) + " points");
+        
+        engine.reset();
+        bool attached = engine.set_pitch_track(&track);
+        std::vector<Sample> replayed = render(engine, signal, block);
+        TestRunner::run_test("Pitch track playback reproduces the live render",
+                           attached && replayed == live);
+        
+        // New scale: replay vs. a fresh engine detecting live
+        engine.reset();
+        engine.set_scale(Quantizer::Scale::BLUES, 57);
+        std::vector<Sample> rescaled = render(engine, signal, block);
+        
+        AutotuneEngine reference(sample_rate, 1024, 2);
+        reference.set_scale(Quantizer::Scale::BLUES, 57);
+        std::vector<Sample> expected = render(reference, signal, block);
+        TestRunner::run_test("Re-render from pitch track matches live detection with new scale",
+                           rescaled == expected && rescaled != live);
+        
+        AutotuneEngine other_rate(48000, 1024, 2);
+        TestRunner::run_test("Pitch track with another sample rate rejected",
+                           !other_rate.set_pitch_track(&track) && other_rate.set_pitch_track(nullptr));
+    }
+}
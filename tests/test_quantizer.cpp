@@ -1,9 +1,13 @@
 #include "quantizer.h"
+#include "test_runner.h"
 #include "autotune_engine.h"
+#include "pitch_planner.h"
+#include "allocation_tracker.h"
 #include <iostream>
+#include <algorithm>
 #include <cmath>
-
-extern class TestRunner;
+#include <memory>
+#include <vector>
 
 void test_quantizer() {
     using namespace autotune;
@@ -98,6 +102,18 @@ void test_quantizer() {
                                                             Quantizer::GridResolution::QUARTER_NOTE, 
                                                             0.0f);
         TestRunner::run_test("Timing quantization zero strength", no_timing_quant == input_time);
+        
+        // Stream positions far past float precision and 32 bits still land on the grid
+        Quantizer stream_quantizer(48000, 120.0f);
+        const int64_t beat = 24000;
+        const int64_t far_beat = beat * 10000000;    // ~58 hours in
+        bool sample_accurate = stream_quantizer.quantize_timing(far_beat + 7, Quantizer::GridResolution::QUARTER_NOTE,
+                                                                1.0f) == far_beat &&
+                               stream_quantizer.quantize_timing(far_beat - 7, Quantizer::GridResolution::QUARTER_NOTE,
+                                                                1.0f) == far_beat &&
+                               stream_quantizer.quantize_timing(far_beat + 1000, Quantizer::GridResolution::QUARTER_NOTE,
+                                                                0.5f) == far_beat + 500;
+        TestRunner::run_test("Timing quantization of long stream positions", sample_accurate);
     }
     
     // Test 7: Edge cases
@@ -116,6 +132,63 @@ void test_quantizer() {
         quantizer.reset();
         TestRunner::run_test("Quantizer reset", true); // Check it doesn't crash
     }
+    
+    // Test 8: Table lookup matches the exact log2 / nearest-note / pow path
+    {
+        Quantizer quantizer(44100, 120.0f);
+        const std::vector<int> major = {0, 2, 4, 5, 7, 9, 11};
+        const std::vector<int> custom = {0, 3, 7};
+        quantizer.set_custom_scale(custom);
+        
+        auto exact_nearest = [](double midi, const std::vector<int>& intervals, int key) {
+            double best = 0.0;
+            double best_distance = 1e9;
+            for (int octave = -6; octave <= 6; ++octave) {
+                for (int interval : intervals) {
+                    double note = key + 12.0 * octave + interval;
+                    if (std::abs(midi - note) < best_distance) {
+                        best_distance = std::abs(midi - note);
+                        best = note;
+                    }
+                }
+            }
+            return best;
+        };
+        
+        double worst_cents = 0.0;
+        int compared = 0;
+        for (int i = 0; i < 4000; ++i) {
+            float frequency = 60.0f * std::pow(2.0f, i * 5.0f / 4000.0f);
+            const auto& intervals = i % 2 ? custom : major;
+            int key = 57 + i % 7;
+            float strength = (i % 4) / 3.0f;
+            
+            // Skip inputs within 0.01 semitone of a decision boundary
+            double midi = 69.0 + 12.0 * std::log2(frequency / 440.0);
+            double nearest = exact_nearest(midi, intervals, key);
+            if (exact_nearest(midi - 0.01, intervals, key) != exact_nearest(midi + 0.01, intervals, key)) {
+                continue;
+            }
+            
+            double expected = 440.0 * std::pow(2.0, (midi + strength * (nearest - midi) - 69.0) / 12.0);
+            float quantized = quantizer.quantize_pitch(frequency, i % 2 ? Quantizer::Scale::CUSTOM :
+                                                       Quantizer::Scale::MAJOR, key, strength);
+            worst_cents = std::max(worst_cents, std::abs(1200.0 * std::log2(quantized / expected)));
+            ++compared;
+        }
+        TestRunner::run_test("Table quantization matches exact path", compared > 3500 && worst_cents < 0.1);
+        
+        // Changing the custom intervals rebuilds the table
+        float before = quantizer.quantize_pitch(293.66f, Quantizer::Scale::CUSTOM, 60, 1.0f);
+        quantizer.set_custom_scale({0, 2, 4, 7, 9});
+        float after = quantizer.quantize_pitch(293.66f, Quantizer::Scale::CUSTOM, 60, 1.0f);
+        TestRunner::run_test("Custom scale change rebuilds table",
+                             std::abs(before - 311.13f) < 0.1f && std::abs(after - 293.66f) < 0.1f);
+        
+        quantizer.set_custom_scale({});
+        TestRunner::run_test("Empty custom scale passes pitch through",
+                             quantizer.quantize_pitch(301.0f, Quantizer::Scale::CUSTOM, 60, 1.0f) == 301.0f);
+    }
 }
 
 void test_autotune_engine() {
@@ -231,4 +304,764 @@ void test_autotune_engine() {
         TestRunner::run_test("Recommended buffer size 48kHz", buffer_48k > 0 && buffer_48k <= 2048);
         TestRunner::run_test("Buffer size scaling", buffer_48k >= buffer_44k);
     }
+    
+    // Test 9: Planar block processing
+    {
+        AutotuneEngine engine(44100, 512, 2);
+        
+        std::vector<Sample> left(512), right(512);
+        for (size_t i = 0; i < left.size(); ++i) {
+            left[i] = 0.5f * std::sin(2.0f * M_PI * 440.0f * i / 44100.0f);
+            right[i] = left[i];
+        }
+        std::vector<Sample> out_left(512, 0.0f), out_right(512, 0.0f);
+        const Sample* input_channels[] = {left.data(), right.data()};
+        Sample* output_channels[] = {out_left.data(), out_right.data()};
+        AudioBlockView input(input_channels, 2, 512);
+        AudioBlockView output(output_channels, 2, 512);
+        
+        ProcessingResult result = engine.process(input, output);
+        TestRunner::run_test("Block processing", result.success);
+        TestRunner::run_test("Block processing pitch detection", std::abs(result.detected_pitch - 440.0f) < 10.0f,
+                           "Detected: " + std::to_string(result.detected_pitch) + " Hz");
+        
+        engine.set_mode(AutotuneEngine::Mode::BYPASS);
+        result = engine.process(input, output);
+        TestRunner::run_test("Block processing bypass", result.success && out_left == left && out_right == right);
+        
+        AudioBlockView mismatched(output_channels, 1, 512);
+        result = engine.process(input, mismatched);
+        TestRunner::run_test("Block processing channel mismatch", !result.success);
+    }
+    
+    // Test 10: Small host buffers still get a full analysis window
+    {
+        AutotuneEngine engine(44100, 1024, 2);
+        engine.set_pitch_tracking(1024, 256);
+        TestRunner::run_test("Engine pitch tracking configuration",
+                           engine.get_analysis_window() == 1024 && engine.get_analysis_hop() == 256);
+        
+        std::vector<Sample> left(64), right(64), out_left(64), out_right(64);
+        const Sample* input_channels[] = {left.data(), right.data()};
+        Sample* output_channels[] = {out_left.data(), out_right.data()};
+        AudioBlockView input(input_channels, 2, 64);
+        AudioBlockView output(output_channels, 2, 64);
+        
+        ProcessingResult result;
+        uint32_t position = 0;
+        for (int callback = 0; callback < 40; ++callback) {
+            for (uint32_t i = 0; i < 64; ++i, ++position) {
+                left[i] = 0.5f * std::sin(2.0f * M_PI * 220.0f * position / 44100.0f);
+                right[i] = left[i];
+            }
+            result = engine.process(input, output);
+        }
+        TestRunner::run_test("Engine tracks pitch across 64-frame callbacks",
+                           result.success && std::abs(result.detected_pitch - 220.0f) < 5.0f,
+                           "Detected: " + std::to_string(result.detected_pitch) + " Hz");
+    }
+    
+    // Test 11: Offline rendering
+    {
+        const SampleRate sample_rate = 22050;
+        const size_t frames = 20000;
+        std::vector<float> input(frames * 2);
+        for (size_t i = 0; i < frames; ++i) {
+            input[i * 2] = 0.5f * std::sin(2.0f * M_PI * 220.0f * i / sample_rate);
+            input[i * 2 + 1] = 0.5f * std::sin(2.0f * M_PI * 330.0f * i / sample_rate);
+        }
+        
+        AutotuneEngine engine(sample_rate, 512, 2);
+        AutotuneEngine::OfflineRenderOptions options;
+        options.segment_frames = 4096;
+        options.overlap_frames = 512;
+        
+        // Single-threaded render is the reference for multi-threaded ones
+        options.thread_count = 1;
+        std::vector<float> single(frames * 2, 0.0f);
+        bool single_ok = engine.render_offline(input.data(), frames, single.data(), options);
+        
+        options.thread_count = 4;
+        std::vector<float> parallel(frames * 2, 0.0f);
+        bool parallel_ok = engine.render_offline(input.data(), frames, parallel.data(), options);
+        TestRunner::run_test("Offline render", single_ok && parallel_ok);
+        TestRunner::run_test("Offline render independent of thread count", single == parallel);
+        
+        bool finite = std::all_of(parallel.begin(), parallel.end(), [](float s) { return std::isfinite(s); });
+        TestRunner::run_test("Offline render output finite", finite);
+        
+        // One segment covering the file equals block-by-block streaming
+        // advanced by the reported latency
+        AutotuneEngine::OfflineRenderOptions whole;
+        whole.segment_frames = frames;
+        std::vector<float> rendered(frames * 2, 0.0f);
+        engine.render_offline(input.data(), frames, rendered.data(), whole);
+        
+        AutotuneEngine streaming(sample_rate, 512, 2);
+        const size_t latency = streaming.get_latency_samples();
+        std::vector<Sample> left(512), right(512), out_left(512), out_right(512);
+        const Sample* input_channels[] = {left.data(), right.data()};
+        Sample* output_channels[] = {out_left.data(), out_right.data()};
+        bool streaming_matches = true;
+        bool latency_reported = true;
+        for (size_t offset = 0; offset < frames + latency; offset += 512) {
+            uint32_t block = static_cast<uint32_t>(std::min<size_t>(512, frames + latency - offset));
+            for (uint32_t i = 0; i < block; ++i) {
+                size_t frame = offset + i;
+                left[i] = frame < frames ? input[frame * 2] : 0.0f;
+                right[i] = frame < frames ? input[frame * 2 + 1] : 0.0f;
+            }
+            AudioBlockView in_view(input_channels, 2, block);
+            AudioBlockView out_view(output_channels, 2, block);
+            latency_reported = latency_reported && streaming.process(in_view, out_view).latency_samples == latency;
+            for (uint32_t i = 0; i < block; ++i) {
+                size_t frame = offset + i;
+                if (frame >= latency) {
+                    streaming_matches = streaming_matches &&
+                                        rendered[(frame - latency) * 2] == out_left[i] &&
+                                        rendered[(frame - latency) * 2 + 1] == out_right[i];
+                }
+            }
+        }
+        TestRunner::run_test("Offline render matches streaming", streaming_matches);
+        TestRunner::run_test("Engine reports corrector and rhythm latency",
+                           latency > PitchCorrector(sample_rate, 512).get_latency_samples() && latency_reported);
+        
+        // Bypass seams cross-fade identical signals, so the file comes back unchanged
+        engine.set_mode(AutotuneEngine::Mode::BYPASS);
+        std::vector<float> bypassed(frames * 2, 0.0f);
+        engine.render_offline(input.data(), frames, bypassed.data(), options);
+        float max_error = 0.0f;
+        for (size_t i = 0; i < bypassed.size(); ++i) {
+            max_error = std::max(max_error, std::abs(bypassed[i] - input[i]));
+        }
+        TestRunner::run_test("Offline render bypass seams transparent", max_error < 1e-6f,
+                           "Max error: " + std::to_string(max_error));
+        
+        TestRunner::run_test("Offline render rejects aliased output",
+                           !engine.render_offline(input.data(), frames, input.data(), options));
+    }
+    
+    // Test 12: Frame and planar APIs correct identically, channel by channel
+    {
+        const uint32_t frames = 512;
+        AutotuneEngine frame_engine(44100, frames, 2);
+        AutotuneEngine block_engine(44100, frames, 2);
+        std::vector<AudioFrame> in_frames(frames, AudioFrame(2)), out_frames(frames, AudioFrame(2));
+        std::vector<Sample> left(frames), right(frames), out_left(frames), out_right(frames);
+        const Sample* input_channels[] = {left.data(), right.data()};
+        Sample* output_channels[] = {out_left.data(), out_right.data()};
+        AudioBlockView input(input_channels, 2, frames);
+        AudioBlockView output(output_channels, 2, frames);
+        
+        bool identical = true;
+        bool channels_differ = false;
+        uint32_t position = 0;
+        for (int callback = 0; callback < 12; ++callback) {
+            for (uint32_t i = 0; i < frames; ++i, ++position) {
+                left[i] = in_frames[i][0] = 0.5f * std::sin(2.0f * M_PI * 210.0f * position / 44100.0f);
+                right[i] = in_frames[i][1] = 0.3f * std::sin(2.0f * M_PI * 315.0f * position / 44100.0f);
+            }
+            frame_engine.process(in_frames.data(), out_frames.data(), frames);
+            block_engine.process(input, output);
+            for (uint32_t i = 0; i < frames; ++i) {
+                identical = identical && out_frames[i][0] == out_left[i] && out_frames[i][1] == out_right[i];
+                channels_differ = channels_differ || out_left[i] != out_right[i];
+            }
+        }
+        TestRunner::run_test("Engine frame API matches planar API", identical);
+        TestRunner::run_test("Engine corrects every channel", channels_differ);
+    }
+    
+    // Test 13: Correction backend selection reaches the corrector
+    {
+        AutotuneEngine engine(44100, 512, 2);
+        engine.set_mode(AutotuneEngine::Mode::PITCH_CORRECTION);
+        engine.set_correction_backend(PitchCorrector::Backend::PHASE_VOCODER);
+        engine.set_vocoder_overlap(2);
+        
+        std::vector<Sample> left(512, 0.0f), right(512, 0.0f);
+        const Sample* input_channels[] = {left.data(), right.data()};
+        Sample* output_channels[] = {left.data(), right.data()};
+        AudioBlockView input(input_channels, 2, 512);
+        AudioBlockView output(output_channels, 2, 512);
+        ProcessingResult result = engine.process(input, output);
+        
+        PitchCorrector reference(44100, 512);
+        reference.set_backend(PitchCorrector::Backend::PHASE_VOCODER);
+        TestRunner::run_test("Engine correction backend",
+                           engine.get_correction_backend() == PitchCorrector::Backend::PHASE_VOCODER &&
+                           result.success && result.latency_samples == reference.get_latency_samples());
+    }
+    
+    // Test 14: Contiguous buffers match the frame API in both layouts
+    {
+        const uint32_t frames = 3000;   // Several blocks plus a partial one
+        const ChannelCount channels = 2;
+        std::vector<float> interleaved(frames * channels), planar(frames * channels);
+        std::vector<AudioFrame> input_frames(frames, AudioFrame(channels));
+        for (uint32_t i = 0; i < frames; ++i) {
+            for (ChannelCount ch = 0; ch < channels; ++ch) {
+                float value = 0.4f * std::sin(2.0f * M_PI * (210.0f + 20.0f * ch) * i / 44100.0f);
+                interleaved[i * channels + ch] = value;
+                planar[ch * frames + i] = value;
+                input_frames[i][ch] = value;
+            }
+        }
+        
+        AutotuneEngine frame_engine(44100, 512, channels);
+        AutotuneEngine interleaved_engine(44100, 512, channels);
+        AutotuneEngine planar_engine(44100, 512, channels);
+        
+        std::vector<AudioFrame> output_frames(frames, AudioFrame(channels));
+        for (uint32_t offset = 0; offset < frames; offset += 512) {
+            uint32_t block = std::min(512u, frames - offset);
+            frame_engine.process(input_frames.data() + offset, output_frames.data() + offset, block);
+        }
+        
+        std::vector<float> interleaved_out(frames * channels);
+        ProcessingResult interleaved_result = interleaved_engine.process_buffer(
+            interleaved.data(), interleaved_out.data(), frames);
+        
+        // Planar runs in place
+        ScopedAllocationTracker tracker;
+        ProcessingResult planar_result = planar_engine.process_buffer(
+            planar.data(), planar.data(), frames, AutotuneEngine::BufferLayout::PLANAR);
+        std::size_t allocations = tracker.stop();
+        
+        float interleaved_error = 0.0f;
+        float planar_error = 0.0f;
+        for (uint32_t i = 0; i < frames; ++i) {
+            for (ChannelCount ch = 0; ch < channels; ++ch) {
+                interleaved_error = std::max(interleaved_error,
+                                             std::abs(interleaved_out[i * channels + ch] - output_frames[i][ch]));
+                planar_error = std::max(planar_error, std::abs(planar[ch * frames + i] - output_frames[i][ch]));
+            }
+        }
+        TestRunner::run_test("Interleaved buffer matches frame API",
+                             interleaved_result.success && interleaved_error == 0.0f);
+        TestRunner::run_test("Planar in-place buffer matches frame API",
+                             planar_result.success && planar_error == 0.0f);
+        TestRunner::run_test("Long buffers process without allocating", allocations == 0);
+        TestRunner::run_test("Empty buffer is rejected",
+                             !planar_engine.process_buffer(nullptr, planar.data(), frames).success);
+    }
+    
+    // Test 15: Latency profiles order the delay and report it exactly
+    {
+        const SampleRate sample_rate = 44100;
+        const uint32_t block = 512;
+        const AutotuneEngine::LatencyProfile profiles[] = {
+            AutotuneEngine::LatencyProfile::LIVE, AutotuneEngine::LatencyProfile::BALANCED,
+            AutotuneEngine::LatencyProfile::STUDIO
+        };
+        
+        AutotuneEngine defaults(sample_rate, block, 1);
+        defaults.set_mode(AutotuneEngine::Mode::PITCH_CORRECTION);
+        bool default_balanced = defaults.get_latency_profile() == AutotuneEngine::LatencyProfile::BALANCED &&
+                                defaults.get_latency_samples() == PitchCorrector(sample_rate, block).get_latency_samples();
+        
+        uint32_t latencies[3] = {};
+        bool delays_match = true;
+        std::string detail;
+        for (int p = 0; p < 3; ++p) {
+            AutotuneEngine engine(sample_rate, block, 1);
+            engine.set_latency_profile(profiles[p]);
+            engine.set_mode(AutotuneEngine::Mode::PITCH_CORRECTION);
+            latencies[p] = engine.get_latency_samples();
+            
+            // An unvoiced click passes unshifted, so its peak shows the delay
+            const size_t frames = latencies[p] + 4 * block;
+            const size_t click = 1000;
+            std::vector<Sample> signal(frames, 0.0f);
+            signal[click] = 1.0f;
+            engine.process_buffer(signal.data(), signal.data(), frames);
+            size_t peak = std::max_element(signal.begin(), signal.end(),
+                                           [](Sample a, Sample b) { return std::abs(a) < std::abs(b); }) -
+                          signal.begin();
+            delays_match = delays_match && peak == click + latencies[p];
+            detail += std::to_string(latencies[p]) + "/" + std::to_string(peak - click) + " ";
+        }
+        
+        TestRunner::run_test("Engine defaults to the balanced latency profile", default_balanced);
+        TestRunner::run_test("Latency profiles ordered live < balanced < studio",
+                           latencies[0] < latencies[1] && latencies[1] < latencies[2], detail);
+        TestRunner::run_test("Reported latency matches the measured delay", delays_match, detail);
+        
+        AutotuneEngine live(sample_rate, 128, 1);
+        live.set_latency_profile(AutotuneEngine::LatencyProfile::LIVE);
+        live.set_mode(AutotuneEngine::Mode::PITCH_CORRECTION);
+        uint32_t live_frames = live.get_latency_samples();
+        live.set_mode(AutotuneEngine::Mode::BYPASS);
+        TestRunner::run_test("Small live blocks stay under 5 ms and bypass adds none",
+                           live_frames * 1000 < 5 * sample_rate && live.get_latency_samples() == 0,
+                           std::to_string(live_frames) + " samples");
+        TestRunner::run_test("Recommended buffer size follows the profile",
+                           AutotuneEngine::get_recommended_buffer_size(48000, AutotuneEngine::LatencyProfile::LIVE) <
+                           AutotuneEngine::get_recommended_buffer_size(48000) &&
+                           AutotuneEngine::get_recommended_buffer_size(48000) <
+                           AutotuneEngine::get_recommended_buffer_size(48000, AutotuneEngine::LatencyProfile::STUDIO));
+    }
+    
+    // Test 16: Pitch is detected on the downmix of every channel
+    {
+        const uint32_t frames = 512;
+        AutotuneEngine engine(44100, 1024, 4);
+        std::vector<Sample> silent(frames, 0.0f), voice(frames), output(frames * 4);
+        const Sample* input_channels[] = {silent.data(), silent.data(), silent.data(), voice.data()};
+        Sample* output_channels[] = {output.data(), output.data() + frames, output.data() + 2 * frames,
+                                     output.data() + 3 * frames};
+        AudioBlockView input(input_channels, 4, frames);
+        AudioBlockView out(output_channels, 4, frames);
+        
+        ProcessingResult result;
+        uint32_t position = 0;
+        for (int callback = 0; callback < 8; ++callback) {
+            for (uint32_t i = 0; i < frames; ++i, ++position) {
+                voice[i] = 0.5f * std::sin(2.0f * M_PI * 220.0f * position / 44100.0f);
+            }
+            result = engine.process(input, out);
+        }
+        TestRunner::run_test("Engine detects pitch in any channel of a multichannel block",
+                           result.success && std::abs(result.detected_pitch - 220.0f) < 5.0f,
+                           "Detected: " + std::to_string(result.detected_pitch) + " Hz");
+    }
+    
+    // Test 17: Mode pipelines switch per block and specializations agree
+    {
+        const uint32_t frames = 512;
+        AutotuneEngine mono(44100, frames, 1);          // Mono-specialized chain
+        AutotuneEngine stereo(44100, frames, 2);        // Generic chain for mono blocks
+        std::vector<Sample> voice(frames), mono_out(frames), stereo_out(frames);
+        const Sample* input_channels[] = {voice.data()};
+        Sample* mono_channels[] = {mono_out.data()};
+        Sample* stereo_channels[] = {stereo_out.data()};
+        AudioBlockView input(input_channels, 1, frames);
+        AudioBlockView mono_view(mono_channels, 1, frames);
+        AudioBlockView stereo_view(stereo_channels, 1, frames);
+        
+        bool agree = true;
+        bool quantize_delays = true;
+        bool corrects = false;
+        uint32_t position = 0;
+        std::vector<Sample> quantized_input;    // Input since entering QUANTIZATION
+        for (int callback = 0; callback < 16; ++callback) {
+            for (uint32_t i = 0; i < frames; ++i, ++position) {
+                voice[i] = 0.5f * std::sin(2.0f * M_PI * 207.0f * position / 44100.0f);
+            }
+            AutotuneEngine::Mode mode = callback % 8 < 4 ? AutotuneEngine::Mode::FULL_AUTOTUNE
+                                                          : AutotuneEngine::Mode::QUANTIZATION;
+            mono.set_mode(mode);
+            stereo.set_mode(mode);
+            agree = agree && mono.process(input, mono_view).success &&
+                    stereo.process(input, stereo_view).success && mono_out == stereo_out;
+            if (mode == AutotuneEngine::Mode::QUANTIZATION) {
+                // The rhythm delay line restarts on entering the mode, and
+                // the tone's only onset is where it starts
+                size_t entered = quantized_input.size();
+                quantized_input.insert(quantized_input.end(), voice.begin(), voice.end());
+                size_t latency = mono.get_latency_samples();
+                for (uint32_t i = 0; i < frames; ++i) {
+                    size_t frame = entered + i;
+                    Sample expected = frame >= latency ? quantized_input[frame - latency] : 0.0f;
+                    quantize_delays = quantize_delays && mono_out[i] == expected;
+                }
+            } else {
+                quantized_input.clear();
+                corrects = corrects || mono_out != voice;
+            }
+        }
+        TestRunner::run_test("Specialized and generic pipelines agree", agree);
+        TestRunner::run_test("Mode switches select the matching pipeline", quantize_delays && corrects);
+    }
+    
+    // Test 18: Silence skips detection and correction and hands back cleanly
+    {
+        const SampleRate sample_rate = 44100;
+        const uint32_t frames = 256;
+        
+        // 0.5 s of an off-scale voice, 1 s of -80 dBFS hiss, 0.5 s of voice
+        std::vector<Sample> signal(2 * sample_rate);
+        uint32_t state = 1;
+        for (size_t i = 0; i < signal.size(); ++i) {
+            state = state * 1664525u + 1013904223u;
+            bool voiced = i < sample_rate / 2 || i >= 3 * sample_rate / 2;
+            signal[i] = voiced ? 0.5f * std::sin(2.0f * M_PI * 233.0f * i / sample_rate)
+                               : 1e-4f * (static_cast<float>(state >> 8) / 8388608.0f - 1.0f);
+        }
+        
+        auto render = [&](AutotuneEngine& engine, std::vector<Sample>& output, ProcessingResult& result) {
+            engine.set_mode(AutotuneEngine::Mode::PITCH_CORRECTION);
+            output.assign(signal.size(), 0.0f);
+            for (size_t offset = 0; offset < signal.size(); offset += frames) {
+                uint32_t count = static_cast<uint32_t>(std::min<size_t>(frames, signal.size() - offset));
+                const Sample* input_channels[] = {signal.data() + offset};
+                Sample* output_channels[] = {output.data() + offset};
+                AudioBlockView input(input_channels, 1, count);
+                AudioBlockView out(output_channels, 1, count);
+                result = engine.process(input, out);
+            }
+            return engine.get_performance_metrics();
+        };
+        
+        AutotuneEngine engine(sample_rate, 1024, 1);
+        std::vector<Sample> output;
+        ProcessingResult result;
+        AutotuneEngine::PerformanceMetrics metrics = render(engine, output, result);
+        TestRunner::run_test("Engine skips blocks of silence",
+                           metrics.skipped_blocks > 0 && metrics.skipped_block_ratio > 0.25f &&
+                           metrics.skipped_block_ratio < 0.5f &&
+                           metrics.skipped_blocks == static_cast<uint64_t>(
+                               std::lround(metrics.skipped_block_ratio * metrics.callbacks)),
+                           "Skipped: " + std::to_string(metrics.skipped_block_ratio));
+        
+        // Skipped blocks are the input, delayed; the voice comes back corrected
+        uint32_t latency = engine.get_latency_samples();
+        bool delayed = true;
+        for (size_t i = sample_rate; i < 3 * sample_rate / 2; ++i) {
+            delayed = delayed && output[i] == signal[i - latency];
+        }
+        float max_step = 0.0f;
+        for (size_t i = 1; i < output.size(); ++i) {
+            max_step = std::max(max_step, std::abs(output[i] - output[i - 1]));
+        }
+        TestRunner::run_test("Engine resumes detection and correction after silence",
+                           delayed && std::abs(result.detected_pitch - 233.0f) < 5.0f &&
+                           std::abs(result.corrected_pitch - 233.0f) > 5.0f,
+                           "Detected: " + std::to_string(result.detected_pitch) + " Hz");
+        TestRunner::run_test("Engine gate transitions are click-free", max_step < 0.06f,
+                           "Largest step: " + std::to_string(max_step));
+        
+        // Without the gate the hiss is analysed on every hop
+        AutotuneEngine ungated(sample_rate, 1024, 1);
+        ungated.set_silence_gate(-INFINITY);
+        AutotuneEngine::PerformanceMetrics ungated_metrics = render(ungated, output, result);
+        TestRunner::run_test("Engine silence gate setting",
+                           engine.get_silence_gate() == -60.0f &&
+                           std::abs(engine.get_pitch_analysis_key().gate_threshold - 1e-3f) < 1e-6f &&
+                           ungated.get_pitch_analysis_key().gate_threshold == 0.0f);
+        TestRunner::run_test("Engine gate saves detection time",
+                           metrics.detect_ms < ungated_metrics.detect_ms,
+                           std::to_string(metrics.detect_ms) + " ms vs " +
+                           std::to_string(ungated_metrics.detect_ms) + " ms per block");
+    }
+    
+    // Test 19: The planner finds note boundaries ahead and ramps centred on them
+    {
+        const SampleRate sample_rate = 44100;
+        const uint32_t hop = 256;
+        const uint32_t points = 40;
+        const float low = 220.0f;
+        const float high = 293.66f;
+        
+        // A to D at point 20, with a two-point excursion to B at point 10
+        auto plan_curve = [&](float retune_time, std::vector<float>& targets) {
+            PitchPlanner planner;
+            planner.configure(sample_rate, 4096, 1024, hop, hop);
+            planner.set_retune_time(retune_time);
+            for (uint32_t k = 0; k < points; ++k) {
+                float note = k >= 20 ? high : (k == 10 || k == 11 ? 246.94f : low);
+                planner.push(k * hop, note * 1.01f, note);
+            }
+            
+            std::vector<PitchPlanner::Segment> segments(hop);
+            targets.clear();
+            bool covered = true;
+            for (uint32_t block = 0; block < points; ++block) {
+                uint32_t count = planner.plan(static_cast<int64_t>(block) * hop, hop, 1.0f, segments.data());
+                uint32_t frames = 0;
+                for (uint32_t s = 0; s < count; ++s) {
+                    targets.insert(targets.end(), segments[s].frames, segments[s].target_pitch);
+                    frames += segments[s].frames;
+                }
+                covered = covered && frames == hop && count <= 2;
+            }
+            return covered;
+        };
+        
+        // Estimates move back to the window centre: (1024 - 256) / 2 frames
+        const size_t boundary = 20 * hop - 384;
+        std::vector<float> hard;
+        bool covered = plan_curve(0.0f, hard);
+        bool stepped = true;
+        for (size_t i = 0; i + 384 < hard.size(); ++i) {
+            float expected = i < boundary ? low : high;
+            stepped = stepped && std::abs(hard[i] - expected) < 0.01f;
+        }
+        TestRunner::run_test("Planner segments cover each block", covered);
+        TestRunner::run_test("Planner aligns boundaries and ignores short excursions", stepped);
+        
+        std::vector<float> ramped;
+        plan_curve(0.1f, ramped);
+        bool monotonic = true;
+        size_t ramp_start = 0;
+        size_t ramp_end = 0;
+        size_t midpoint = 0;
+        const float middle = std::sqrt(low * high);
+        for (size_t i = 3 * hop; i + 384 < ramped.size(); ++i) {
+            monotonic = monotonic && ramped[i] >= ramped[i - 1];
+            if (ramp_start == 0 && ramped[i] > low + 0.01f) ramp_start = i;
+            if (ramp_end == 0 && ramped[i] > high - 0.01f) ramp_end = i;
+            if (midpoint == 0 && ramped[i] >= middle) midpoint = i;
+        }
+        float ramp_ms = 1000.0f * (ramp_end - ramp_start) / sample_rate;
+        TestRunner::run_test("Planner retune ramp is centred on the boundary",
+                           monotonic && ramp_start < boundary && ramp_end > boundary &&
+                           std::abs(static_cast<float>(midpoint) - boundary) <= hop &&
+                           std::abs(ramp_ms - 100.0f) < 15.0f,
+                           std::to_string(ramp_ms) + " ms ramp, midpoint " + std::to_string(midpoint));
+    }
+    
+    // Test 20: Lookahead in the engine: reported latency, earlier transitions,
+    // replay from a pitch track
+    {
+        const SampleRate sample_rate = 44100;
+        const uint32_t frames = 256;
+        const size_t boundary = sample_rate / 2;
+        
+        // Off-scale notes near A3 then D4, stepping at 0.5 s
+        std::vector<Sample> signal(sample_rate);
+        double phase = 0.0;
+        for (size_t i = 0; i < signal.size(); ++i) {
+            phase += 2.0 * M_PI * (i < boundary ? 228.0 : 300.0) / sample_rate;
+            signal[i] = static_cast<Sample>(0.5 * std::sin(phase));
+        }
+        
+        // Input frame at which the target first moves closer to D than to A
+        auto transition = [&](AutotuneEngine& engine, std::vector<Sample>& output) {
+            output.assign(signal.size(), 0.0f);
+            int64_t crossing = -1;
+            for (size_t offset = 0; offset < signal.size(); offset += frames) {
+                uint32_t count = static_cast<uint32_t>(std::min<size_t>(frames, signal.size() - offset));
+                const Sample* input_channels[] = {signal.data() + offset};
+                Sample* output_channels[] = {output.data() + offset};
+                AudioBlockView input(input_channels, 1, count);
+                AudioBlockView out(output_channels, 1, count);
+                ProcessingResult result = engine.process(input, out);
+                if (crossing < 0 && result.corrected_pitch > std::sqrt(220.0f * 293.66f)) {
+                    crossing = static_cast<int64_t>(offset + count) - engine.get_lookahead_samples();
+                }
+            }
+            return crossing;
+        };
+        
+        AutotuneEngine reactive(sample_rate, 1024, 1);
+        reactive.set_scale(Quantizer::Scale::MAJOR, 60);
+        std::vector<Sample> reactive_output;
+        int64_t reactive_crossing = transition(reactive, reactive_output);
+        
+        AutotuneEngine planned(sample_rate, 1024, 1);
+        planned.set_scale(Quantizer::Scale::MAJOR, 60);
+        ProcessingParams params = planned.get_parameters();
+        params.quantize_strength = 1.0f;
+        params.retune_time = 0.02f;
+        planned.set_parameters(params);
+        uint32_t base_latency = planned.get_latency_samples();
+        planned.set_lookahead(80.0f);
+        PitchTrack track;
+        planned.record_pitch_track(&track);
+        std::vector<Sample> planned_output;
+        int64_t planned_crossing = transition(planned, planned_output);
+        planned.record_pitch_track(nullptr);
+        
+        TestRunner::run_test("Engine reports lookahead latency",
+                           planned.get_lookahead_samples() == 3528 &&
+                           planned.get_latency_samples() == base_latency + 3528 &&
+                           planned.get_pitch_analysis_key().smoothing == 0.0f &&
+                           reactive.get_pitch_analysis_key().smoothing == PitchDetector::kDefaultSmoothing);
+        TestRunner::run_test("Lookahead moves note transitions onto the boundary",
+                           planned_crossing >= 0 && reactive_crossing > planned_crossing &&
+                           std::abs(planned_crossing - static_cast<int64_t>(boundary)) <= 2 * static_cast<int64_t>(frames),
+                           "Planned at " + std::to_string(planned_crossing) + ", reactive at " +
+                           std::to_string(reactive_crossing));
+        
+        planned.reset();
+        std::vector<Sample> replayed_output;
+        planned.set_pitch_track(&track);
+        transition(planned, replayed_output);
+        TestRunner::run_test("Lookahead render replays from a pitch track", replayed_output == planned_output);
+        
+        planned.set_lookahead(0.0f);
+        TestRunner::run_test("Lookahead can be turned off",
+                           planned.get_lookahead_samples() == 0 && planned.get_latency_samples() == base_latency);
+    }
+    
+    // Test 21: Rhythmic quantization slips onsets onto the grid and copies
+    // the audio between them unchanged
+    {
+        const SampleRate sample_rate = 44100;
+        const uint32_t grid = 22050;            // Every other eighth at 120 BPM
+        const size_t frames = 4 * sample_rate;
+        const int offsets[] = {441, -882, 1764, -300, 0, 1000, -1500};
+        const int burst_count = 7;
+        
+        // Short decaying 1 kHz bursts around the grid, quieter on the right
+        std::vector<Sample> signal(frames * 2, 0.0f);
+        std::vector<size_t> starts;
+        for (int k = 0; k < burst_count; ++k) {
+            size_t start = (k + 1) * grid + offsets[k];
+            starts.push_back(start);
+            for (size_t i = 0; i < 1323; ++i) {
+                float value = 0.8f * std::exp(-static_cast<float>(i) / 350.0f) *
+                              std::sin(2.0f * M_PI * 1000.0f * i / sample_rate);
+                signal[2 * (start + i)] = value;
+                signal[2 * (start + i) + 1] = 0.75f * value;
+            }
+        }
+        
+        auto make_engine = [&](float strength) {
+            auto engine = std::make_unique<AutotuneEngine>(sample_rate, 512, 2);
+            ProcessingParams params = engine->get_parameters();
+            params.quantize_strength = strength;
+            engine->set_parameters(params);
+            engine->set_mode(AutotuneEngine::Mode::QUANTIZATION);
+            engine->set_rhythm_grid(Quantizer::GridResolution::EIGHTH_NOTE);
+            return engine;
+        };
+        
+        // Streamed in odd-sized blocks, run on past the end by the latency
+        auto stream = [&](AutotuneEngine& engine) {
+            size_t latency = engine.get_latency_samples();
+            std::vector<Sample> input(signal);
+            input.resize((frames + latency) * 2, 0.0f);
+            std::vector<Sample> output(input.size());
+            for (size_t offset = 0; offset < frames + latency; offset += 300) {
+                size_t count = std::min<size_t>(300, frames + latency - offset);
+                engine.process_buffer(input.data() + offset * 2, output.data() + offset * 2, count);
+            }
+            return output;
+        };
+        
+        // Each burst plays unchanged from its grid point (up to the few
+        // frames its onset is found after its start)
+        auto lands = [&](const std::vector<Sample>& output, size_t latency) {
+            for (int k = 0; k < burst_count; ++k) {
+                size_t grid_point = (k + 1) * grid + latency;
+                bool found = false;
+                for (size_t lead = 0; lead <= 16 && !found; ++lead) {
+                    found = true;
+                    for (size_t i = 0; i < 882 && found; ++i) {
+                        size_t from = 2 * (starts[k] + i);
+                        size_t to = 2 * (grid_point - lead + i);
+                        found = output[to] == signal[from] && output[to + 1] == signal[from + 1];
+                    }
+                }
+                if (!found) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        
+        auto engine = make_engine(1.0f);
+        size_t latency = engine->get_latency_samples();
+        std::vector<Sample> streamed = stream(*engine);
+        TestRunner::run_test("Rhythmic quantization reports its delay",
+                           latency > 0 && latency < sample_rate / 10,
+                           std::to_string(latency) + " samples");
+        TestRunner::run_test("Rhythmic quantization moves onsets onto the grid", lands(streamed, latency));
+        
+        // Offline segments place the grid from the start of the file
+        AutotuneEngine::OfflineRenderOptions options;
+        options.segment_frames = 48510;
+        options.thread_count = 2;
+        std::vector<Sample> offline(frames * 2);
+        TestRunner::run_test("Offline rhythmic quantization moves onsets onto the grid",
+                           engine->render_offline(signal.data(), frames, offline.data(), options) &&
+                           lands(offline, 0));
+        
+        // Without strength nothing moves and the output is the delayed input
+        auto still = make_engine(0.0f);
+        std::vector<Sample> delayed = stream(*still);
+        bool exact = still->get_latency_samples() == latency;
+        for (size_t i = 0; i < frames * 2 && exact; ++i) {
+            exact = delayed[i + latency * 2] == signal[i];
+        }
+        TestRunner::run_test("Unquantized rhythm output is the input delayed", exact);
+        
+        // Tempo and time signature reach the grid with the next block: at
+        // 90 BPM in 6/8 the beat is an eighth note and a dotted beat is the
+        // same 22050 frames (either setting alone gives another grid)
+        auto six_eight = make_engine(1.0f);
+        six_eight->set_tempo(90.0f);
+        six_eight->set_time_signature(Quantizer::TimeSignature::SIX_EIGHT);
+        six_eight->set_rhythm_grid(Quantizer::GridResolution::DOTTED);
+        TestRunner::run_test("Rhythmic quantization follows tempo and time signature",
+                           six_eight->get_time_signature() == Quantizer::TimeSignature::SIX_EIGHT &&
+                           lands(stream(*six_eight), latency));
+        
+        // FULL_AUTOTUNE slips the corrected bursts onto the same grid, on top
+        // of the corrector's delay
+        auto full = make_engine(1.0f);
+        full->set_mode(AutotuneEngine::Mode::FULL_AUTOTUNE);
+        AutotuneEngine corrector(sample_rate, 512, 2);
+        corrector.set_mode(AutotuneEngine::Mode::PITCH_CORRECTION);
+        size_t full_latency = full->get_latency_samples();
+        std::vector<Sample> corrected = stream(*full);
+        bool slipped = true;
+        std::string detail = "Onsets off by";
+        for (int k = 0; k < burst_count; ++k) {
+            size_t grid_point = (k + 1) * grid + full_latency;
+            size_t onset = grid_point - grid / 2;
+            while (onset < grid_point + grid / 2 && std::abs(corrected[2 * onset]) < 0.1f) {
+                ++onset;
+            }
+            long error = static_cast<long>(onset) - static_cast<long>(grid_point);
+            slipped = slipped && std::abs(error) <= 16;
+            detail += " " + std::to_string(error);
+        }
+        TestRunner::run_test("Full autotune adds the rhythm delay to the corrector's",
+                           full_latency == corrector.get_latency_samples() + latency,
+                           std::to_string(full_latency) + " samples");
+        TestRunner::run_test("Full autotune moves corrected onsets onto the grid", slipped, detail);
+    }        
+    // Test 22: Clones are configured like their template and start a fresh
+    // stream wherever the template is in its own
+    {
+        const SampleRate sample_rate = 44100;
+        const uint32_t frames = 256;
+        
+        // Off-scale glide around A3
+        std::vector<Sample> signal(sample_rate / 2);
+        double phase = 0.0;
+        for (size_t i = 0; i < signal.size(); ++i) {
+            phase += 2.0 * M_PI * (226.0 + 10.0 * i / signal.size()) / sample_rate;
+            signal[i] = static_cast<Sample>(0.5 * std::sin(phase));
+        }
+        
+        auto run = [&](AutotuneEngine& engine) {
+            std::vector<Sample> output(signal.size(), 0.0f);
+            for (size_t offset = 0; offset < signal.size(); offset += frames) {
+                uint32_t count = static_cast<uint32_t>(std::min<size_t>(frames, signal.size() - offset));
+                const Sample* input_channels[] = {signal.data() + offset};
+                Sample* output_channels[] = {output.data() + offset};
+                AudioBlockView input(input_channels, 1, count);
+                AudioBlockView out(output_channels, 1, count);
+                engine.process(input, out);
+            }
+            return output;
+        };
+        
+        AutotuneEngine original(sample_rate, 128, 1);
+        original.set_scale(Quantizer::Scale::MINOR, 57);
+        ProcessingParams params = original.get_parameters();
+        params.quantize_strength = 0.8f;
+        params.retune_time = 0.03f;
+        original.set_parameters(params);
+        original.set_lookahead(10.0f);
+        original.prepare(frames);
+        
+        std::unique_ptr<AutotuneEngine> early = original.clone();
+        TestRunner::run_test("Clone keeps size and configuration",
+                           early->is_initialized() && early->get_max_block_size() == frames &&
+                           early->get_mode() == original.get_mode() &&
+                           early->get_lookahead_samples() == original.get_lookahead_samples() &&
+                           early->get_parameters().quantize_strength == 0.8f);
+        
+        std::vector<Sample> reference = run(original);
+        std::unique_ptr<AutotuneEngine> late = original.clone();
+        TestRunner::run_test("Clone sounds like its template", reference == run(*early));
+        TestRunner::run_test("Clone of a running engine starts a fresh stream", reference == run(*late));
+    }
 }
+
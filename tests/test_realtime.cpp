@@ -0,0 +1,191 @@
+#include "autotune_engine.h"
+#include "allocation_tracker.h"
+#include "test_runner.h"
+#include "trace.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <new>
+#include <thread>
+#include <vector>
+
+void test_realtime() {
+    using namespace autotune;
+    
+    // Trace builds allocate a thread's zone ring with its first zone
+    AUTOTUNE_TRACE_THREAD_NAME("realtime test");
+    
+    const uint32_t block_size = 512;
+    const AutotuneEngine::Mode modes[] = {
+        AutotuneEngine::Mode::PITCH_CORRECTION,
+        AutotuneEngine::Mode::QUANTIZATION,
+        AutotuneEngine::Mode::FULL_AUTOTUNE,
+        AutotuneEngine::Mode::BYPASS
+    };
+    
+    // Test 1: Frame API makes no allocations after prepare()
+    {
+        AutotuneEngine engine(44100, block_size, 2);
+        engine.prepare(block_size);
+        
+        std::vector<AudioFrame> input(block_size, AudioFrame(2));
+        std::vector<AudioFrame> output(block_size, AudioFrame(2));
+        for (uint32_t i = 0; i < block_size; ++i) {
+            input[i][0] = input[i][1] = 0.5f * std::sin(2.0f * M_PI * 440.0f * i / 44100.0f);
+        }
+        
+        bool all_modes_clean = true;
+        for (auto mode : modes) {
+            engine.set_mode(mode);
+            
+            ScopedAllocationTracker tracker;
+            for (uint32_t frames = block_size; frames >= 64; frames /= 2) {
+                engine.process(input.data(), output.data(), frames);
+            }
+            all_modes_clean = tracker.stop() == 0 && all_modes_clean;
+        }
+        TestRunner::run_test("Frame processing is allocation-free", all_modes_clean);
+        TestRunner::run_test("Prepared block size", engine.get_max_block_size() == block_size);
+    }
+    
+    // Test 2: Planar block API makes no allocations
+    {
+        AutotuneEngine engine(44100, block_size, 2);
+        
+        std::vector<Sample> left(block_size), right(block_size);
+        std::vector<Sample> out_left(block_size), out_right(block_size);
+        for (uint32_t i = 0; i < block_size; ++i) {
+            left[i] = right[i] = 0.5f * std::sin(2.0f * M_PI * 220.0f * i / 44100.0f);
+        }
+        const Sample* input_channels[] = {left.data(), right.data()};
+        Sample* output_channels[] = {out_left.data(), out_right.data()};
+        AudioBlockView input(input_channels, 2, block_size);
+        AudioBlockView output(output_channels, 2, block_size);
+        
+        bool all_modes_clean = true;
+        for (auto mode : modes) {
+            engine.set_mode(mode);
+            
+            ScopedAllocationTracker tracker;
+            for (int i = 0; i < 200; ++i) {
+                engine.process(input, output);
+            }
+            all_modes_clean = tracker.stop() == 0 && all_modes_clean;
+        }
+        TestRunner::run_test("Block processing is allocation-free", all_modes_clean);
+        
+        auto metrics = engine.get_performance_metrics();
+        TestRunner::run_test("Metrics count every processed block",
+                           metrics.callbacks == 800 && metrics.frames_processed == 800u * block_size);
+        TestRunner::run_test("Latency percentiles are ordered",
+                           metrics.p50_latency_ms <= metrics.p99_latency_ms &&
+                           metrics.p99_latency_ms <= metrics.max_latency_ms && metrics.max_latency_ms > 0.0);
+    }
+    
+    // Test 3: Tracker detects allocations
+    {
+        ScopedAllocationTracker tracker;
+        std::vector<float>* allocation = new std::vector<float>(16);
+        std::size_t count = tracker.stop();
+        delete allocation;
+        TestRunner::run_test("Allocation tracker detects allocations", count >= 2);
+        
+        ScopedAllocationTracker nothrow_tracker;
+        float* nothrow_allocation = new (std::nothrow) float[16];
+        count = nothrow_tracker.stop();
+        delete[] nothrow_allocation;
+        TestRunner::run_test("Allocation tracker detects nothrow allocations", count == 1);
+    }
+    
+    // Test 4: Mailbox hands over the latest complete snapshot
+    {
+        struct Snapshot { int a; int b; };
+        ParameterMailbox<Snapshot> mailbox(Snapshot{0, 0});
+        Snapshot received{-1, -1};
+        bool empty_fetch = !mailbox.fetch(received) && received.a == -1;
+        mailbox.publish(Snapshot{1, 1});
+        mailbox.publish(Snapshot{2, 2});
+        bool latest = mailbox.fetch(received) && received.a == 2 && received.b == 2;
+        bool consumed = !mailbox.fetch(received);
+        TestRunner::run_test("Parameter mailbox delivers latest snapshot once", empty_fetch && latest && consumed);
+        
+        // Torn snapshots would show up as a != b
+        std::atomic<bool> done(false);
+        std::thread writer([&]() {
+            for (int i = 3; i < 200000; ++i) {
+                mailbox.publish(Snapshot{i, i});
+            }
+            done = true;
+        });
+        bool consistent = true;
+        int last = received.a;
+        while (!done) {
+            if (mailbox.fetch(received)) {
+                consistent = consistent && received.a == received.b && received.a > last;
+                last = received.a;
+            }
+        }
+        writer.join();
+        TestRunner::run_test("Parameter mailbox never tears or reorders", consistent);
+    }
+    
+    // Test 5: Smoothed parameters ramp linearly to the target
+    {
+        SmoothedParameter strength(0.0f, 100);
+        strength.set_target(1.0f);
+        std::vector<float> ramp(150);
+        strength.fill(ramp.data(), 150);
+        bool smooth = true;
+        for (size_t i = 1; i < ramp.size(); ++i) {
+            smooth = smooth && ramp[i] >= ramp[i - 1] && ramp[i] - ramp[i - 1] <= 0.0101f;
+        }
+        TestRunner::run_test("Smoothed parameter ramps without steps",
+                             smooth && ramp[99] == 1.0f && !strength.is_ramping());
+    }
+    
+    // Test 6: Setters from another thread take effect at block boundaries
+    {
+        AutotuneEngine engine(44100, block_size, 2);
+        
+        std::vector<Sample> left(block_size), right(block_size);
+        std::vector<Sample> out_left(block_size), out_right(block_size);
+        for (uint32_t i = 0; i < block_size; ++i) {
+            left[i] = right[i] = 0.5f * std::sin(2.0f * M_PI * 233.0f * i / 44100.0f);
+        }
+        const Sample* input_channels[] = {left.data(), right.data()};
+        Sample* output_channels[] = {out_left.data(), out_right.data()};
+        AudioBlockView input(input_channels, 2, block_size);
+        AudioBlockView output(output_channels, 2, block_size);
+        
+        std::atomic<bool> stop(false);
+        std::thread control([&]() {
+            ProcessingParams params;
+            for (int i = 0; !stop; ++i) {
+                params.correction_strength = (i % 10) / 9.0f;
+                params.attack_time = 0.005f + 0.001f * (i % 5);
+                engine.set_parameters(params);
+                engine.set_scale(i % 2 ? Quantizer::Scale::MINOR : Quantizer::Scale::MAJOR, 57 + i % 5);
+                engine.set_mode(i % 3 ? AutotuneEngine::Mode::PITCH_CORRECTION : AutotuneEngine::Mode::FULL_AUTOTUNE);
+                std::this_thread::yield();
+            }
+        });
+        
+        bool processed = true;
+        ScopedAllocationTracker tracker;
+        for (int i = 0; i < 200; ++i) {
+            processed = engine.process(input, output).success && processed;
+        }
+        size_t allocations = tracker.stop();
+        stop = true;
+        control.join();
+        
+        bool finite = std::all_of(out_left.begin(), out_left.end(), [](Sample s) { return std::isfinite(s); });
+        TestRunner::run_test("Concurrent parameter updates while processing", processed && finite);
+        TestRunner::run_test("Picking up parameter updates is allocation-free", allocations == 0);
+        
+        engine.set_mode(AutotuneEngine::Mode::BYPASS);
+        engine.process(input, output);
+        TestRunner::run_test("Mode change applies at the next block", std::equal(left.begin(), left.end(), out_left.begin()));
+    }
+}
+
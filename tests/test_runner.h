@@ -0,0 +1,66 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Simple test framework
+class TestRunner {
+public:
+    struct TestResult {
+        std::string name;
+        bool passed;
+        std::string message;
+    };
+    
+    static inline std::vector<TestResult> results;
+    
+    static void run_test(const std::string& name, bool condition, const std::string& message = "") {
+        results.push_back({name, condition, message});
+        if (condition) {
+            std::cout << "[PASS] " << name << std::endl;
+        } else {
+            std::cout << "[FAIL] " << name;
+            if (!message.empty()) {
+                std::cout << " - " << message;
+            }
+            std::cout << std::endl;
+        }
+    }
+    
+    static void print_summary() {
+        int passed = 0;
+        int total = static_cast<int>(results.size());
+        
+        for (const auto& result : results) {
+            if (result.passed) passed++;
+        }
+        
+        std::cout << "\n=== Test Summary ===" << std::endl;
+        std::cout << "Passed: " << passed << "/" << total << std::endl;
+        
+        if (passed == total) {
+            std::cout << "All tests passed! ✓" << std::endl;
+        } else {
+            std::cout << "Some tests failed! ✗" << std::endl;
+            
+            std::cout << "\nFailed tests:" << std::endl;
+            for (const auto& result : results) {
+                if (!result.passed) {
+                    std::cout << "  - " << result.name;
+                    if (!result.message.empty()) {
+                        std::cout << " (" << result.message << ")";
+                    }
+                    std::cout << std::endl;
+                }
+            }
+        }
+    }
+    
+    static bool all_passed() {
+        for (const auto& result : results) {
+            if (!result.passed) return false;
+        }
+        return true;
+    }
+};
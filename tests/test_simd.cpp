@@ -0,0 +1,168 @@
+#include "simd.h"
+#include "test_runner.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+void test_simd() {
+    using namespace autotune;
+    
+    simd::InstructionSet default_set = simd::active_instruction_set();
+    TestRunner::run_test("SIMD default instruction set supported", simd::is_supported(default_set),
+                       simd::instruction_set_name(default_set));
+    TestRunner::run_test("SIMD scalar always supported", simd::is_supported(simd::InstructionSet::SCALAR));
+    
+    // Odd length exercises both the vector body and the scalar tail
+    const uint32_t count = 1027;
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<Sample> a(count), b(count), c(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        a[i] = dist(rng);
+        b[i] = dist(rng);
+        c[i] = dist(rng);
+    }
+    
+    std::vector<Sample> ref_multiply(count), ref_mix(count), ref_scale(count), ref_downmix(count);
+    simd::scalar::multiply(a.data(), b.data(), ref_multiply.data(), count);
+    simd::scalar::mix(a.data(), b.data(), ref_mix.data(), 0.5f, count);
+    simd::scalar::scale(a.data(), 0.25f, ref_scale.data(), count);
+    float ref_dot = simd::scalar::dot(a.data(), b.data(), count);
+    for (uint32_t i = 0; i < count; ++i) {
+        ref_downmix[i] = (a[i] + b[i] + c[i]) / 3.0f;
+    }
+    
+    auto max_error = [](const std::vector<Sample>& x, const std::vector<Sample>& y) {
+        float error = 0.0f;
+        for (size_t i = 0; i < x.size(); ++i) {
+            error = std::max(error, std::abs(x[i] - y[i]));
+        }
+        return error;
+    };
+    
+    const simd::InstructionSet sets[] = {
+        simd::InstructionSet::SCALAR, simd::InstructionSet::SSE2,
+        simd::InstructionSet::AVX2, simd::InstructionSet::NEON
+    };
+    
+    for (simd::InstructionSet set : sets) {
+        if (!simd::set_instruction_set(set)) {
+            continue;
+        }
+        std::string name = simd::instruction_set_name(set);
+        
+        std::vector<Sample> out(count);
+        simd::multiply(a.data(), b.data(), out.data(), count);
+        TestRunner::run_test("SIMD multiply matches scalar (" + name + ")", max_error(out, ref_multiply) == 0.0f);
+        
+        simd::mix(a.data(), b.data(), out.data(), 0.5f, count);
+        TestRunner::run_test("SIMD mix matches scalar (" + name + ")", max_error(out, ref_mix) == 0.0f);
+        
+        simd::scale(a.data(), 0.25f, out.data(), count);
+        TestRunner::run_test("SIMD scale matches scalar (" + name + ")", max_error(out, ref_scale) == 0.0f);
+        
+        const Sample* channels[] = {a.data(), b.data(), c.data()};
+        simd::downmix(channels, 3, out.data(), count);
+        TestRunner::run_test("SIMD downmix matches scalar (" + name + ")", max_error(out, ref_downmix) < 1e-6f);
+        
+        float result = simd::dot(a.data(), b.data(), count);
+        TestRunner::run_test("SIMD dot within tolerance (" + name + ")",
+                           std::abs(result - ref_dot) < 1e-4f * std::max(1.0f, std::abs(ref_dot)));
+        
+        // In-place and short inputs
+        std::vector<Sample> in_place = a;
+        simd::multiply(in_place.data(), b.data(), in_place.data(), count);
+        TestRunner::run_test("SIMD multiply in place (" + name + ")", max_error(in_place, ref_multiply) == 0.0f);
+        TestRunner::run_test("SIMD dot short input (" + name + ")",
+                           simd::dot(a.data(), b.data(), 3) == simd::scalar::dot(a.data(), b.data(), 3));
+        
+        // Lane-interleaved kernels: lane counts below, at and between vector widths
+        for (uint32_t lanes : {1u, 3u, 4u, 8u, 13u, 16u}) {
+            uint32_t frames = count / lanes;
+            std::vector<Sample> lane_out(frames * lanes), ref_lane_out(frames * lanes);
+            simd::scale_lanes(a.data(), b.data(), lane_out.data(), lanes, frames);
+            simd::scalar::scale_lanes(a.data(), b.data(), ref_lane_out.data(), lanes, frames);
+            
+            std::vector<float> sums(lanes), ref_sums(lanes);
+            simd::dot_lanes(a.data(), c.data(), sums.data(), lanes, frames);
+            simd::scalar::dot_lanes(a.data(), c.data(), ref_sums.data(), lanes, frames);
+            bool sums_match = true;
+            for (uint32_t v = 0; v < lanes; ++v) {
+                float expected = 0.0f;
+                for (uint32_t i = 0; i < frames; ++i) {
+                    expected += a[i * lanes + v] * c[i * lanes + v];
+                }
+                sums_match = sums_match && std::abs(sums[v] - ref_sums[v]) < 1e-4f * std::max(1.0f, std::abs(expected)) &&
+                             std::abs(ref_sums[v] - expected) < 1e-4f * std::max(1.0f, std::abs(expected));
+            }
+            
+            std::string lane_name = std::to_string(lanes) + " lanes, " + name;
+            TestRunner::run_test("SIMD scale_lanes matches scalar (" + lane_name + ")",
+                               max_error(lane_out, ref_lane_out) == 0.0f);
+            TestRunner::run_test("SIMD dot_lanes within tolerance (" + lane_name + ")", sums_match);
+            
+            // A 32-point transform: one single stage, then two fused pairs,
+            // checked against five single scalar stages
+            const uint32_t rows = 32;
+            std::vector<float> twiddles(rows);
+            for (uint32_t k = 0; k < rows / 2; ++k) {
+                twiddles[2 * k] = std::cos(-2.0f * static_cast<float>(M_PI) * k / rows);
+                twiddles[2 * k + 1] = std::sin(-2.0f * static_cast<float>(M_PI) * k / rows);
+            }
+            for (bool inverse : {false, true}) {
+                std::vector<Sample> re(a.begin(), a.begin() + rows * lanes), im(b.begin(), b.begin() + rows * lanes);
+                std::vector<Sample> ref_re = re, ref_im = im;
+                simd::butterfly_lanes(re.data(), im.data(), twiddles.data(), rows / 2, 1, rows, lanes, inverse);
+                simd::fused_butterfly_lanes(re.data(), im.data(), twiddles.data(), rows / 8, 2, rows, lanes, inverse);
+                simd::fused_butterfly_lanes(re.data(), im.data(), twiddles.data(), rows / 32, 8, rows, lanes, inverse);
+                for (uint32_t length = 2; length <= rows; length <<= 1) {
+                    simd::scalar::butterfly_lanes(ref_re.data(), ref_im.data(), twiddles.data(), rows / length,
+                                                  length / 2, rows, lanes, inverse);
+                }
+                TestRunner::run_test("SIMD lane butterflies match scalar stages (" + lane_name +
+                                   (inverse ? ", inverse)" : ")"),
+                                   max_error(re, ref_re) < 1e-5f && max_error(im, ref_im) < 1e-5f);
+            }
+        }
+        
+        // PCM conversion: out-of-range input clips, rounding matches the scalar path
+        std::vector<Sample> loud(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            loud[i] = 1.5f * a[i];
+        }
+        std::vector<int16_t> pcm(count), ref_pcm(count);
+        simd::float_to_int16(loud.data(), pcm.data(), count);
+        simd::scalar::float_to_int16(loud.data(), ref_pcm.data(), count);
+        TestRunner::run_test("SIMD float_to_int16 matches scalar (" + name + ")", pcm == ref_pcm);
+        
+        std::vector<Sample> decoded(count), ref_decoded(count);
+        simd::int16_to_float(pcm.data(), decoded.data(), count);
+        simd::scalar::int16_to_float(pcm.data(), ref_decoded.data(), count);
+        TestRunner::run_test("SIMD int16_to_float matches scalar (" + name + ")",
+                           max_error(decoded, ref_decoded) == 0.0f);
+    }
+    
+    // Full-scale edges and 24-bit packing
+    {
+        const Sample edges[] = {-2.0f, -1.0f, -0.5f, 0.0f, 0.5f, 1.0f - 1.0f / 32768.0f, 1.0f, 2.0f};
+        int16_t pcm[8];
+        simd::float_to_int16(edges, pcm, 8);
+        TestRunner::run_test("int16 conversion clips to full scale",
+                           pcm[0] == -32768 && pcm[1] == -32768 && pcm[2] == -16384 && pcm[3] == 0 &&
+                           pcm[4] == 16384 && pcm[5] == 32767 && pcm[6] == 32767 && pcm[7] == 32767);
+        
+        uint8_t packed[8 * 3];
+        Sample decoded[8];
+        simd::float_to_int24(edges, packed, 8);
+        simd::int24_to_float(packed, decoded, 8);
+        TestRunner::run_test("int24 conversion round trip",
+                           decoded[0] == -1.0f && decoded[1] == -1.0f && decoded[2] == -0.5f &&
+                           decoded[3] == 0.0f && decoded[4] == 0.5f &&
+                           decoded[7] == 1.0f - 1.0f / 8388608.0f &&
+                           packed[3 * 2] == 0x00 && packed[3 * 2 + 1] == 0x00 && packed[3 * 2 + 2] == 0xC0);
+    }
+    
+    simd::set_instruction_set(default_set);
+}
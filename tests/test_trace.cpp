@@ -0,0 +1,108 @@
+#include "autotune_engine.h"
+#include "test_runner.h"
+#include "trace.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+void test_trace() {
+    using namespace autotune;
+    
+    // Test 1: Zones are recorded with duration and voice
+    trace::set_thread_name("test main");
+    trace::clear();
+    {
+        trace::Zone outer("test outer");
+        trace::Zone inner("test inner", 7);
+    }
+    std::vector<trace::Event> events = trace::collect();
+    bool recorded = events.size() == 2 && std::string(events[0].name) == "test outer" &&
+                    events[1].voice == 7 && events[0].voice == trace::kNoVoice &&
+                    events[0].start_ns <= events[1].start_ns &&
+                    events[0].duration_ns >= events[1].duration_ns;
+    TestRunner::run_test("Trace zones recorded in start order", recorded);
+    
+    // Test 2: clear() drops earlier zones only
+    trace::clear();
+    trace::record("after clear", trace::now(), trace::now());
+    events = trace::collect();
+    TestRunner::run_test("Trace clear drops earlier zones",
+                       events.size() == 1 && std::string(events[0].name) == "after clear");
+    
+    // Test 3: A full ring keeps the newest zones (less the slot a write may be in)
+    trace::clear();
+    for (uint32_t i = 0; i < trace::kRingCapacity + 100; ++i) {
+        trace::record("overflow", i, i + 1, static_cast<int32_t>(i));
+    }
+    events = trace::collect();
+    TestRunner::run_test("Trace ring keeps newest zones when full",
+                       events.size() == trace::kRingCapacity - 1 && events.front().voice == 101 &&
+                       events.back().voice == static_cast<int32_t>(trace::kRingCapacity + 99));
+    
+    // Test 4: Zones of other threads are collected, also after they exit
+    trace::clear();
+    std::thread worker([]() {
+        trace::set_thread_name("test worker");
+        trace::Zone zone("worker zone", 3);
+    });
+    worker.join();
+    events = trace::collect();
+    bool other_thread = events.size() == 1 && std::string(events[0].name) == "worker zone";
+    std::vector<trace::ThreadInfo> threads = trace::threads();
+    bool named = std::any_of(threads.begin(), threads.end(), [](const trace::ThreadInfo& info) {
+        return info.name == "test worker";
+    });
+    TestRunner::run_test("Trace collects zones of exited threads", other_thread && named);
+    
+    // Test 5: Chrome trace export
+    std::string json = trace::export_chrome_json();
+    bool chrome = json.find("\"traceEvents\"") != std::string::npos &&
+                  json.find("\"name\":\"worker zone\"") != std::string::npos &&
+                  json.find("\"ph\":\"X\"") != std::string::npos &&
+                  json.find("\"args\":{\"voice\":3}") != std::string::npos &&
+                  json.find("\"args\":{\"name\":\"test worker\"}") != std::string::npos;
+    TestRunner::run_test("Trace exports Chrome trace JSON", chrome);
+    
+    std::string path = "test_trace_export.json";
+    bool saved = trace::save_chrome_json(path);
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    bool readable = file != nullptr;
+    if (file) {
+        std::fclose(file);
+    }
+    std::remove(path.c_str());
+    TestRunner::run_test("Trace saves Chrome trace file", saved && readable);
+    
+    // Test 6: Engine hot path zones exist exactly when tracing is compiled in
+    AutotuneEngine engine(44100, 512, 1);
+    engine.set_mode(AutotuneEngine::Mode::FULL_AUTOTUNE);
+    std::vector<Sample> input(512), output(512);
+    for (size_t i = 0; i < input.size(); ++i) {
+        input[i] = 0.5f * std::sin(2.0f * static_cast<float>(M_PI) * 220.0f * i / 44100.0f);
+    }
+    Sample* input_channels[] = {input.data()};
+    Sample* output_channels[] = {output.data()};
+    AudioBlockView input_view(input_channels, 1, 512);
+    AudioBlockView output_view(output_channels, 1, 512);
+    trace::clear();
+    for (int block = 0; block < 4; ++block) {
+        engine.process(input_view, output_view);
+    }
+    events = trace::collect();
+#if defined(AUTOTUNE_TRACING)
+    auto count_named = [&events](const std::string& name) {
+        return std::count_if(events.begin(), events.end(),
+                             [&name](const trace::Event& event) { return name == event.name; });
+    };
+    TestRunner::run_test("Trace zones in engine hot path",
+                       count_named("AutotuneEngine::process") == 4 &&
+                       count_named("PitchDetector::detect_pitch") > 0 &&
+                       count_named("PitchCorrector::correct_block") +
+                       count_named("PitchCorrector::bypass_block") == 4);
+#else
+    TestRunner::run_test("Trace hooks compiled out", events.empty());
+#endif
+}
@@ -0,0 +1,376 @@
+#include "audio_file.h"
+#include "autotune_engine.h"
+#include "pitch_track.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+// Streaming file processor: reads a WAV/RF64/raw PCM file chunk by chunk,
+// runs it through AutotuneEngine and writes the result as it goes, so
+// memory use does not depend on the file size.
+
+using namespace autotune;
+
+namespace {
+
+constexpr size_t kChunkFrames = 1 << 16;   // Frames converted per read/write
+
+struct Options {
+    std::string input_path;
+    std::string output_path;
+    Quantizer::Scale scale = Quantizer::Scale::MAJOR;
+    int key_center = 60;
+    float strength = 1.0f;
+    AutotuneEngine::Mode mode = AutotuneEngine::Mode::FULL_AUTOTUNE;
+    AutotuneEngine::LatencyProfile profile = AutotuneEngine::LatencyProfile::STUDIO;
+    uint32_t block_size = 512;
+    float gate_db = -60.0f;
+    float lookahead_ms = 0.0f;
+    float retune_ms = 50.0f;
+    float tempo = 120.0f;
+    Quantizer::GridResolution grid = Quantizer::GridResolution::SIXTEENTH_NOTE;
+    bool output_format_set = false;
+    SampleFormat output_format = SampleFormat::INT16;
+    bool raw_input = false;
+    SampleRate raw_sample_rate = 44100;
+    ChannelCount raw_channels = 1;
+    SampleFormat raw_format = SampleFormat::INT16;
+    bool raw_output = false;
+    bool memory_mapping = true;
+    bool quiet = false;
+    std::string pitch_cache_path;
+};
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [options] <input> <output>\n"
+              << "\n"
+              << "Pitch-corrects a WAV, RF64/BW64 or raw PCM file of any size.\n"
+              << "\n"
+              << "Options:\n"
+              << "  --scale NAME        chromatic, major, minor, pentatonic, blues, dorian,\n"
+              << "                      mixolydian (default: major)\n"
+              << "  --key NOTE          Key center as a MIDI note number (default: 60)\n"
+              << "  --strength X        Correction strength 0.0 - 1.0 (default: 1.0)\n"
+              << "  --mode NAME         full, correct, quantize or bypass (default: full)\n"
+              << "  --profile NAME      live, balanced or studio latency profile (default: studio)\n"
+              << "  --block N           Engine block size in frames (default: 512)\n"
+              << "  --gate DB           Silence gate level in dBFS RMS, or off (default: -60)\n"
+              << "  --lookahead MS      Plan note transitions MS ahead (default: 0, reactive)\n"
+              << "  --retune MS         Note transition time with lookahead (default: 50)\n"
+              << "  --tempo BPM         Tempo of the rhythmic grid (default: 120)\n"
+              << "  --grid NAME         quarter, eighth, sixteenth, triplet or dotted grid onsets\n"
+              << "                      are moved to in quantize mode (default: sixteenth)\n"
+              << "  --format F          Output format int16, int24 or float32 (default: input's)\n"
+              << "  --raw R:C:F         Input is headerless PCM at rate R with C channels of format F\n"
+              << "  --raw-output        Write headerless PCM instead of WAV\n"
+              << "  --no-mmap           Read through a buffer instead of memory-mapping the input\n"
+              << "  --pitch-cache FILE  Reuse the pitch analysis in FILE if it matches the input and\n"
+              << "                      detector settings, otherwise record it there for re-renders\n"
+              << "  --quiet             Only print errors\n";
+}
+
+bool parse_scale(const std::string& name, Quantizer::Scale& scale) {
+    static const struct { const char* name; Quantizer::Scale scale; } kScales[] = {
+        {"chromatic", Quantizer::Scale::CHROMATIC}, {"major", Quantizer::Scale::MAJOR},
+        {"minor", Quantizer::Scale::MINOR}, {"pentatonic", Quantizer::Scale::PENTATONIC},
+        {"blues", Quantizer::Scale::BLUES}, {"dorian", Quantizer::Scale::DORIAN},
+        {"mixolydian", Quantizer::Scale::MIXOLYDIAN}
+    };
+    for (const auto& entry : kScales) {
+        if (name == entry.name) {
+            scale = entry.scale;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parse_mode(const std::string& name, AutotuneEngine::Mode& mode) {
+    static const struct { const char* name; AutotuneEngine::Mode mode; } kModes[] = {
+        {"full", AutotuneEngine::Mode::FULL_AUTOTUNE}, {"correct", AutotuneEngine::Mode::PITCH_CORRECTION},
+        {"quantize", AutotuneEngine::Mode::QUANTIZATION}, {"bypass", AutotuneEngine::Mode::BYPASS}
+    };
+    for (const auto& entry : kModes) {
+        if (name == entry.name) {
+            mode = entry.mode;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parse_grid(const std::string& name, Quantizer::GridResolution& grid) {
+    static const struct { const char* name; Quantizer::GridResolution grid; } kGrids[] = {
+        {"quarter", Quantizer::GridResolution::QUARTER_NOTE}, {"eighth", Quantizer::GridResolution::EIGHTH_NOTE},
+        {"sixteenth", Quantizer::GridResolution::SIXTEENTH_NOTE}, {"triplet", Quantizer::GridResolution::TRIPLET},
+        {"dotted", Quantizer::GridResolution::DOTTED}
+    };
+    for (const auto& entry : kGrids) {
+        if (name == entry.name) {
+            grid = entry.grid;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parse_profile(const std::string& name, AutotuneEngine::LatencyProfile& profile) {
+    static const struct { const char* name; AutotuneEngine::LatencyProfile profile; } kProfiles[] = {
+        {"live", AutotuneEngine::LatencyProfile::LIVE}, {"balanced", AutotuneEngine::LatencyProfile::BALANCED},
+        {"studio", AutotuneEngine::LatencyProfile::STUDIO}
+    };
+    for (const auto& entry : kProfiles) {
+        if (name == entry.name) {
+            profile = entry.profile;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Parse "rate:channels:format" for --raw
+ */
+bool parse_raw_layout(const std::string& text, Options& options) {
+    size_t first = text.find(':');
+    size_t second = first == std::string::npos ? first : text.find(':', first + 1);
+    if (second == std::string::npos) {
+        return false;
+    }
+    long rate = std::strtol(text.substr(0, first).c_str(), nullptr, 10);
+    long channels = std::strtol(text.substr(first + 1, second - first - 1).c_str(), nullptr, 10);
+    if (rate <= 0 || channels <= 0 || !parse_sample_format(text.substr(second + 1), options.raw_format)) {
+        return false;
+    }
+    options.raw_sample_rate = static_cast<SampleRate>(rate);
+    options.raw_channels = static_cast<ChannelCount>(channels);
+    options.raw_input = true;
+    return true;
+}
+
+bool parse_arguments(int argc, char* argv[], Options& options) {
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--scale" && has_value) {
+            if (!parse_scale(argv[++i], options.scale)) return false;
+        } else if (arg == "--key" && has_value) {
+            options.key_center = std::atoi(argv[++i]);
+        } else if (arg == "--strength" && has_value) {
+            options.strength = static_cast<float>(std::atof(argv[++i]));
+            if (options.strength < 0.0f || options.strength > 1.0f) return false;
+        } else if (arg == "--mode" && has_value) {
+            if (!parse_mode(argv[++i], options.mode)) return false;
+        } else if (arg == "--profile" && has_value) {
+            if (!parse_profile(argv[++i], options.profile)) return false;
+        } else if (arg == "--gate" && has_value) {
+            std::string value = argv[++i];
+            char* end = nullptr;
+            options.gate_db = value == "off" ? -std::numeric_limits<float>::infinity()
+                                             : std::strtof(value.c_str(), &end);
+            if (value != "off" && (end == value.c_str() || *end != '\0' || options.gate_db > 0.0f)) return false;
+        } else if (arg == "--lookahead" && has_value) {
+            options.lookahead_ms = static_cast<float>(std::atof(argv[++i]));
+            if (options.lookahead_ms < 0.0f) return false;
+        } else if (arg == "--retune" && has_value) {
+            options.retune_ms = static_cast<float>(std::atof(argv[++i]));
+            if (options.retune_ms < 0.0f) return false;
+        } else if (arg == "--tempo" && has_value) {
+            options.tempo = static_cast<float>(std::atof(argv[++i]));
+            if (options.tempo <= 0.0f) return false;
+        } else if (arg == "--grid" && has_value) {
+            if (!parse_grid(argv[++i], options.grid)) return false;
+        } else if (arg == "--block" && has_value) {
+            long block = std::strtol(argv[++i], nullptr, 10);
+            if (block <= 0) return false;
+            options.block_size = static_cast<uint32_t>(block);
+        } else if (arg == "--format" && has_value) {
+            if (!parse_sample_format(argv[++i], options.output_format)) return false;
+            options.output_format_set = true;
+        } else if (arg == "--raw" && has_value) {
+            if (!parse_raw_layout(argv[++i], options)) return false;
+        } else if (arg == "--raw-output") {
+            options.raw_output = true;
+        } else if (arg == "--pitch-cache" && has_value) {
+            options.pitch_cache_path = argv[++i];
+        } else if (arg == "--no-mmap") {
+            options.memory_mapping = false;
+        } else if (arg == "--quiet") {
+            options.quiet = true;
+        } else if (!arg.empty() && arg[0] == '-') {
+            return false;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() != 2) {
+        return false;
+    }
+    options.input_path = positional[0];
+    options.output_path = positional[1];
+    return true;
+}
+
+/**
+ * @brief Open the input as configured
+ */
+bool open_input(AudioFileReader& reader, const Options& options) {
+    reader.set_memory_mapping(options.memory_mapping);
+    return options.raw_input
+        ? reader.open_raw(options.input_path, options.raw_sample_rate, options.raw_channels, options.raw_format)
+        : reader.open(options.input_path);
+}
+
+/**
+ * @brief Hash the decoded input (one pass at disk speed; leaves the reader at the start)
+ */
+bool hash_input(AudioFileReader& reader, const Options& options, uint64_t& content_hash) {
+    std::vector<Sample> chunk(kChunkFrames * reader.get_info().channels);
+    content_hash = PitchTrack::kHashSeed;
+    while (size_t frames = reader.read(chunk.data(), kChunkFrames)) {
+        content_hash = PitchTrack::hash_samples(chunk.data(), frames * reader.get_info().channels, content_hash);
+    }
+    return open_input(reader, options);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parse_arguments(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 2;
+    }
+    
+    AudioFileReader reader;
+    if (!open_input(reader, options)) {
+        std::cerr << "Error: " << options.input_path << ": " << reader.get_error() << std::endl;
+        return 1;
+    }
+    const AudioFileInfo& info = reader.get_info();
+    
+    SampleFormat output_format = options.output_format_set ? options.output_format : info.format;
+    AudioFileWriter writer;
+    if (!writer.open(options.output_path, info.sample_rate, info.channels, output_format,
+                     options.raw_output ? AudioFileWriter::Container::RAW : AudioFileWriter::Container::WAV)) {
+        std::cerr << "Error: " << options.output_path << ": " << writer.get_error() << std::endl;
+        return 1;
+    }
+    
+    AutotuneEngine engine(info.sample_rate, options.block_size, info.channels);
+    if (!engine.is_initialized()) {
+        std::cerr << "Error: cannot initialize the engine for " << info.sample_rate << " Hz, "
+                  << info.channels << " channels" << std::endl;
+        return 1;
+    }
+    ProcessingParams params = engine.get_parameters();
+    params.correction_strength = options.strength;
+    params.retune_time = options.retune_ms / 1000.0f;
+    engine.set_parameters(params);
+    engine.set_latency_profile(options.profile);
+    engine.set_lookahead(options.lookahead_ms);
+    engine.set_mode(options.mode);
+    engine.set_scale(options.scale, options.key_center);
+    engine.set_silence_gate(options.gate_db);
+    engine.set_tempo(options.tempo);
+    engine.set_rhythm_grid(options.grid);
+    
+    // Pitch depends only on the audio and the detector settings: replay a
+    // matching cached track, or record one while processing
+    PitchTrack pitch_track;
+    bool recording = false;
+    if (!options.pitch_cache_path.empty()) {
+        uint64_t content_hash = 0;
+        if (!hash_input(reader, options, content_hash)) {
+            std::cerr << "Error: " << options.input_path << ": " << reader.get_error() << std::endl;
+            return 1;
+        }
+        bool cached = pitch_track.load(options.pitch_cache_path) &&
+                      pitch_track.get_key() == engine.get_pitch_analysis_key(content_hash) &&
+                      engine.set_pitch_track(&pitch_track);
+        if (!cached) {
+            pitch_track.set_content_hash(content_hash);
+            engine.record_pitch_track(&pitch_track);
+            recording = true;
+        }
+        if (!options.quiet) {
+            std::cerr << (cached ? "Using cached pitch track " : "Recording pitch track to ")
+                      << options.pitch_cache_path << std::endl;
+        }
+    }
+    
+    if (!options.quiet) {
+        std::cerr << options.input_path << ": " << info.sample_rate << " Hz, " << info.channels << " ch, "
+                  << sample_format_name(info.format) << (info.rf64 ? " (RF64)" : "") << ", "
+                  << std::fixed << std::setprecision(1)
+                  << static_cast<double>(info.frame_count) / info.sample_rate << " s"
+                  << (reader.is_memory_mapped() ? ", memory-mapped" : "") << std::endl;
+    }
+    
+    // One chunk buffer, processed in place; the engine splits it into blocks.
+    // Output trails input by the engine latency: drop that much from the
+    // front and feed as much silence at the end to keep the file aligned
+    std::vector<Sample> chunk(kChunkFrames * info.channels);
+    uint64_t skip = engine.get_latency_samples();
+    uint64_t flush = skip;
+    auto start = std::chrono::steady_clock::now();
+    auto last_report = start;
+    bool success = true;
+    
+    for (;;) {
+        size_t frames = reader.read(chunk.data(), kChunkFrames);
+        if (frames == 0) {
+            if (flush == 0) {
+                break;
+            }
+            frames = static_cast<size_t>(std::min<uint64_t>(flush, kChunkFrames));
+            std::fill(chunk.begin(), chunk.begin() + frames * info.channels, 0.0f);
+            flush -= frames;
+        }
+        success = engine.process_buffer(chunk.data(), chunk.data(), frames).success && success;
+        
+        size_t dropped = static_cast<size_t>(std::min<uint64_t>(skip, frames));
+        skip -= dropped;
+        if (!writer.write(chunk.data() + dropped * info.channels, frames - dropped)) {
+            std::cerr << "\nError: " << options.output_path << ": " << writer.get_error() << std::endl;
+            return 1;
+        }
+        
+        auto now = std::chrono::steady_clock::now();
+        if (!options.quiet && now - last_report >= std::chrono::seconds(1)) {
+            last_report = now;
+            std::cerr << "\r" << std::setw(5) << std::setprecision(1)
+                      << 100.0 * reader.get_position() / info.frame_count << "%" << std::flush;
+        }
+    }
+    
+    if (!writer.close()) {
+        std::cerr << "Error: " << options.output_path << ": " << writer.get_error() << std::endl;
+        return 1;
+    }
+    if (recording && !pitch_track.save(options.pitch_cache_path)) {
+        std::cerr << "Warning: cannot write pitch track " << options.pitch_cache_path << std::endl;
+    }
+    
+    if (!options.quiet) {
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double audio_seconds = static_cast<double>(writer.get_frames_written()) / info.sample_rate;
+        std::cerr << "\r" << options.output_path << ": " << writer.get_frames_written() << " frames, "
+                  << sample_format_name(output_format) << (writer.get_info().rf64 ? " (RF64)" : "")
+                  << ", " << std::setprecision(2) << seconds << " s ("
+                  << std::setprecision(1) << (seconds > 0.0 ? audio_seconds / seconds : 0.0)
+                  << "x real time, " << std::setprecision(0)
+                  << 100.0 * engine.get_performance_metrics().skipped_block_ratio << "% of blocks skipped)"
+                  << std::endl;
+    }
+    if (!success) {
+        std::cerr << "Warning: some blocks failed to process" << std::endl;
+    }
+    return success ? 0 : 1;
+}